@@ -0,0 +1,206 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "carena.h"
+#include "cobject.h"
+#include <stdlib.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Used to align objects for any type.
+ */
+union carena_align_t
+{
+    long double calign_ld;
+    long long   calign_ll;
+    void*       calign_p;
+    void      (*calign_f)( void );
+};
+
+/* A block of memory objects are bumped through. The free region follows
+ * this structure in memory.
+ */
+struct carena_block_t
+{
+    struct carena_block_t* cnext;
+    size_t                 csize;
+};
+
+/* Precedes every object in the arena and links it into the list of objects
+ * to destroy.
+ */
+struct carena_header_t
+{
+    struct carena_header_t* cnext;
+};
+union carena_header_u
+{
+    struct carena_header_t header;
+    union carena_align_t   calign;
+};
+
+#define CARENA_ALIGN		sizeof(union carena_align_t)
+#define CARENA_ROUND_UP(x)	((((x) + CARENA_ALIGN - 1) / CARENA_ALIGN) * CARENA_ALIGN)
+#define CARENA_BLOCK_HEADER	CARENA_ROUND_UP(sizeof(struct carena_block_t))
+#define CARENA_OBJECT_HEADER	sizeof(union carena_header_u)
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+/* Start bumping through a new block with room for at least size bytes.
+ */
+static int carena_grow( struct carena_t* self, size_t size )
+{
+	struct carena_block_t* block;
+	size_t block_size;
+
+	block_size = self->cblock_size;
+	if( block_size < CARENA_BLOCK_HEADER + size ) {
+		block_size = CARENA_BLOCK_HEADER + size;
+	}
+
+	block = malloc(block_size);
+	if( block == NULL ) {
+		return 0;
+	}
+	block->csize = block_size;
+	block->cnext = self->cblocks;
+	self->cblocks = block;
+
+	self->cnext = ((char*) block) + CARENA_BLOCK_HEADER;
+	self->cend = ((char*) block) + block_size;
+	return 1;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void carena_init( struct carena_t* self, size_t block_size )
+{
+	if( block_size == 0 ) {
+		block_size = CARENA_DEFAULT_BLOCK_SIZE;
+	}
+	self->cblock_size = block_size;
+	self->cblocks = NULL;
+	self->cnext = NULL;
+	self->cend = NULL;
+	self->cobjects = NULL;
+	self->ccount = 0;
+}
+
+void carena_destroy( struct carena_t* self )
+{
+	carena_reset(self);
+	if( self->cblocks != NULL ) {
+		free(self->cblocks);
+		self->cblocks = NULL;
+	}
+	self->cnext = NULL;
+	self->cend = NULL;
+}
+
+void* carena_alloc( struct carena_t* self, size_t size )
+{
+	struct carena_header_t* header;
+	struct cobject_t*       object;
+
+	size = CARENA_OBJECT_HEADER + CARENA_ROUND_UP(size);
+	if( self->cnext == NULL || (size_t) (self->cend - self->cnext) < size ) {
+		if( !carena_grow(self, size) ) {
+			return NULL;
+		}
+	}
+
+	header = (struct carena_header_t*) self->cnext;
+	self->cnext += size;
+
+	/* Link into the list of objects to destroy. */
+	header->cnext = self->cobjects;
+	self->cobjects = header;
+	++self->ccount;
+
+	/* No vtable until the object is constructed, carena_reset( ) skips
+	 * objects which never were.
+	 */
+	object = (struct cobject_t*) (((char*) header) + CARENA_OBJECT_HEADER);
+	object->cclass.cvtable = NULL;
+	return object;
+}
+
+void carena_reset( struct carena_t* self )
+{
+	const struct cobject_vtable_t* vtable;
+	struct carena_header_t*        header;
+	struct carena_block_t*         block;
+	struct cobject_t*              object;
+
+	/* Run destructor chains, most recent object first. */
+	for( header = self->cobjects; header != NULL; header = header->cnext ) {
+		object = (struct cobject_t*) (((char*) header) + CARENA_OBJECT_HEADER);
+		vtable = cclass_get_vtable(object);
+		if( vtable == NULL || vtable->cdestructor == cobject_destructor ) {
+			/* Nothing to destroy. */
+			continue;
+		}
+		/* The arena owns the memory, the chain must not free it. */
+		object->cfree = NULL;
+		vtable->cdestructor(object);
+	}
+	self->cobjects = NULL;
+	self->ccount = 0;
+
+	/* Release every block except the oldest, which is reused if it's
+	 * a standard size.
+	 */
+	while( self->cblocks != NULL && self->cblocks->cnext != NULL ) {
+		block = self->cblocks;
+		self->cblocks = block->cnext;
+		free(block);
+	}
+	block = self->cblocks;
+	if( block != NULL && block->csize != self->cblock_size ) {
+		free(block);
+		self->cblocks = block = NULL;
+	}
+	if( block != NULL ) {
+		self->cnext = ((char*) block) + CARENA_BLOCK_HEADER;
+		self->cend = ((char*) block) + block->csize;
+	}
+	else {
+		self->cnext = NULL;
+		self->cend = NULL;
+	}
+}
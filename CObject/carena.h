@@ -0,0 +1,142 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+#ifndef CARENA_H_
+#define CARENA_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Default size of the blocks an arena bumps through.
+ */
+#define CARENA_DEFAULT_BLOCK_SIZE	(64 * 1024)
+
+/**
+ * @struct carena_t
+ * @brief
+ *	Bump allocator for objects which are all destroyed together.
+ * @details
+ *	Objects are allocated by bumping a pointer through large blocks of memory.
+ *	The arena remembers every object allocated from it, and carena_reset( )
+ *	destroys all of them in one pass, most recently allocated first, then
+ *	releases their memory at once.
+ *	@code
+ *		struct carena_t arena;
+ *
+ *		carena_init(&arena, 0);
+ *		while( ... ) {
+ *			struct point_t* point = carena_alloc(&arena, sizeof(*point));
+ *			point_init(point);
+ *			...
+ *		}
+ *		carena_reset(&arena);
+ *	@endcode
+ *	Objects whose destructor is cobject_destructor( ) have nothing to destroy,
+ *	so they are skipped entirely. Do not use cmalloc( ) or cdestroy( ) on
+ *	objects allocated from an arena, the arena owns their memory.
+ *
+ *	An arena does no locking.
+ */
+struct carena_block_t;
+struct carena_header_t;
+struct carena_t
+{
+    /* Size of each block allocated.
+     */
+    size_t cblock_size;
+
+    /* Blocks of memory, the current block first, and the free region
+     * of the current block.
+     */
+    struct carena_block_t* cblocks;
+    char*                  cnext;
+    char*                  cend;
+
+    /* Objects allocated since the last reset, most recent first.
+     */
+    struct carena_header_t* cobjects;
+    size_t                  ccount;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof carena_t
+ * @constructor
+ * @details
+ *	Constructor. No memory is allocated until the first call to carena_alloc( ).
+ * @param self
+ *	The arena to construct.
+ * @param block_size
+ *	Size of the blocks the arena allocates, or zero for CARENA_DEFAULT_BLOCK_SIZE.
+ *	Objects larger than a block get a block to themselves.
+ */
+void carena_init( struct carena_t* self, size_t block_size );
+
+/**
+ * @memberof carena_t
+ * @details
+ *	Reset the arena then free all of its memory.
+ * @param self
+ *	The arena to destroy.
+ */
+void carena_destroy( struct carena_t* self );
+
+/**
+ * @memberof carena_t
+ * @details
+ *	Allocate memory for an object. The memory is suitably aligned for any type.
+ *	An object must be constructed in the memory before the next
+ *	carena_reset( ), or not at all.
+ * @param self
+ *	The arena to allocate from.
+ * @param size
+ *	Size of the object, at least sizeof(struct cobject_t).
+ * @returns
+ *	Memory for the object, or NULL if malloc( ) failed.
+ */
+void* carena_alloc( struct carena_t* self, size_t size );
+
+/**
+ * @memberof carena_t
+ * @details
+ *	Destroy every object allocated from the arena, most recently allocated
+ *	first, then release their memory. One block is kept to be reused.
+ * @param self
+ *	The arena to reset.
+ */
+void carena_reset( struct carena_t* self );
+
+
+#endif /* CARENA_H_ */
@@ -0,0 +1,398 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "ccensus.h"
+#include "cobject.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* A class' counters in one thread's shard. Only the owning thread writes
+ * them, snapshots read them.
+ */
+struct ccensus_counter_t
+{
+    const struct cclass_info_t* cinfo;
+    size_t                      cconstructed;
+    size_t                      cdestroyed;
+
+    /* Live objects not yet folded into the shared count.
+     */
+    long cdelta;
+};
+
+/* A thread's counters. Shards of exited threads are kept, counts included,
+ * and taken over by new threads.
+ */
+struct ccensus_shard_t
+{
+    struct ccensus_counter_t ccounters[CCENSUS_CLASSES];
+    struct ccensus_shard_t*  cnext;
+    int                      cowned;
+} __attribute__((aligned(64)));
+
+/* A class' shared live count.
+ */
+struct ccensus_class_t
+{
+    const struct cclass_info_t* cinfo;
+    long                        clive;
+    long                        cpeak;
+};
+
+static struct ccensus_class_t  ccensus_classes[CCENSUS_CLASSES];
+static struct ccensus_shard_t* ccensus_shards;
+static __thread struct ccensus_shard_t* ccensus_local;
+static pthread_key_t  ccensus_key;
+static pthread_once_t ccensus_once = PTHREAD_ONCE_INIT;
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+/* Fibonacci hashing, the high bits of the product are the well mixed ones.
+ */
+static size_t ccensus_hash( const struct cclass_info_t* info )
+{
+	return (size_t) ((((uint64_t) (uintptr_t) info) * 0x9E3779B97F4A7C15ull) >> 40);
+}
+
+/* Counters are only written by one thread, plain loads and relaxed stores
+ * keep snapshots from reading torn values.
+ */
+static void ccensus_add( size_t* counter, size_t amount )
+{
+	__atomic_store_n(counter, *counter + amount, __ATOMIC_RELAXED);
+}
+
+static void ccensus_fold( struct ccensus_counter_t* counter )
+{
+	struct ccensus_class_t* class;
+	long live, peak;
+	size_t slot, i;
+
+	slot = ccensus_hash(counter->cinfo);
+	for( i = 0; i < CCENSUS_CLASSES; ++i ) {
+		class = &ccensus_classes[(slot + i) & (CCENSUS_CLASSES - 1)];
+		if( __atomic_load_n(&class->cinfo, __ATOMIC_ACQUIRE) == counter->cinfo ) {
+			break;
+		}
+		if( class->cinfo == NULL ) {
+			const struct cclass_info_t* empty = NULL;
+
+			if( __atomic_compare_exchange_n(&class->cinfo, &empty, counter->cinfo, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+			    empty == counter->cinfo ) {
+				break;
+			}
+		}
+	}
+	if( i == CCENSUS_CLASSES ) {
+		return;
+	}
+
+	live = __atomic_add_fetch(&class->clive, counter->cdelta, __ATOMIC_RELAXED);
+	__atomic_store_n(&counter->cdelta, 0, __ATOMIC_RELAXED);
+	peak = __atomic_load_n(&class->cpeak, __ATOMIC_RELAXED);
+	while( live > peak ) {
+		if( __atomic_compare_exchange_n(&class->cpeak, &peak, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ) {
+			break;
+		}
+	}
+}
+
+/* Fold what's left of an exiting thread's live counts, and let another
+ * thread take its shard.
+ */
+static void ccensus_release( void* arg )
+{
+	struct ccensus_shard_t* shard = arg;
+	size_t i;
+
+	for( i = 0; i < CCENSUS_CLASSES; ++i ) {
+		if( shard->ccounters[i].cinfo != NULL && shard->ccounters[i].cdelta != 0 ) {
+			ccensus_fold(&shard->ccounters[i]);
+		}
+	}
+	ccensus_local = NULL;
+	__atomic_store_n(&shard->cowned, 0, __ATOMIC_RELEASE);
+}
+
+static void ccensus_key_init( void )
+{
+	pthread_key_create(&ccensus_key, ccensus_release);
+}
+
+static struct ccensus_shard_t* ccensus_shard( void )
+{
+	struct ccensus_shard_t* shard;
+	int owned;
+
+	if( ccensus_local != NULL ) {
+		return ccensus_local;
+	}
+	pthread_once(&ccensus_once, ccensus_key_init);
+
+	for( shard = __atomic_load_n(&ccensus_shards, __ATOMIC_ACQUIRE); shard != NULL; shard = shard->cnext ) {
+		owned = 0;
+		if( __atomic_compare_exchange_n(&shard->cowned, &owned, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ) {
+			break;
+		}
+	}
+	if( shard == NULL ) {
+		shard = calloc(1, sizeof(*shard));
+		if( shard == NULL ) {
+			return NULL;
+		}
+		shard->cowned = 1;
+		shard->cnext = __atomic_load_n(&ccensus_shards, __ATOMIC_RELAXED);
+		while( !__atomic_compare_exchange_n(&ccensus_shards, &shard->cnext, shard, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED) ) {
+			continue;
+		}
+	}
+	pthread_setspecific(ccensus_key, shard);
+	ccensus_local = shard;
+	return shard;
+}
+
+/* The calling thread's counters for a class.
+ */
+static struct ccensus_counter_t* ccensus_counter( const struct cclass_info_t* info )
+{
+	struct ccensus_shard_t* shard;
+	struct ccensus_counter_t* counter;
+	size_t slot, i;
+
+	shard = ccensus_shard( );
+	if( shard == NULL ) {
+		return NULL;
+	}
+	slot = ccensus_hash(info);
+	for( i = 0; i < CCENSUS_CLASSES; ++i ) {
+		counter = &shard->ccounters[(slot + i) & (CCENSUS_CLASSES - 1)];
+		if( counter->cinfo == info ) {
+			return counter;
+		}
+		if( counter->cinfo == NULL ) {
+			/* Published last, snapshots skip it until then. */
+			__atomic_store_n(&counter->cinfo, info, __ATOMIC_RELEASE);
+			return counter;
+		}
+	}
+	return NULL;
+}
+
+static void ccensus_live( struct ccensus_counter_t* counter, long amount )
+{
+	__atomic_store_n(&counter->cdelta, counter->cdelta + amount, __ATOMIC_RELAXED);
+	if( counter->cdelta >= CCENSUS_SLOP || counter->cdelta <= -CCENSUS_SLOP ) {
+		ccensus_fold(counter);
+	}
+}
+
+/* Find or add a class in a snapshot being merged.
+ */
+static struct ccensus_entry_t* ccensus_entry( struct ccensus_entry_t* entries, size_t* count, const struct cclass_info_t* info )
+{
+	size_t i;
+
+	for( i = 0; i < *count; ++i ) {
+		if( entries[i].cinfo == info ) {
+			return &entries[i];
+		}
+	}
+	if( *count == CCENSUS_CLASSES ) {
+		return NULL;
+	}
+	entries[*count].cinfo = info;
+	entries[*count].cconstructed = 0;
+	entries[*count].cdestroyed = 0;
+	entries[*count].clive = 0;
+	entries[*count].cpeak = 0;
+	entries[*count].cbytes = 0;
+	return &entries[(*count)++];
+}
+
+static int ccensus_compare( const void* a_, const void* b_ )
+{
+	const struct ccensus_entry_t* a = a_;
+	const struct ccensus_entry_t* b = b_;
+
+	if( a->cbytes != b->cbytes ) {
+		return a->cbytes < b->cbytes ? 1 : -1;
+	}
+	return a->clive < b->clive ? 1 : a->clive > b->clive ? -1 : 0;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+size_t ccensus_snapshot( struct ccensus_entry_t* entries, size_t max )
+{
+	struct ccensus_entry_t  merged[CCENSUS_CLASSES];
+	long                    live[CCENSUS_CLASSES];
+	struct ccensus_shard_t* shard;
+	struct ccensus_entry_t* entry;
+	const struct cclass_info_t* info;
+	size_t count, i;
+
+	count = 0;
+	for( i = 0; i < CCENSUS_CLASSES; ++i ) {
+		info = __atomic_load_n(&ccensus_classes[i].cinfo, __ATOMIC_ACQUIRE);
+		if( info != NULL ) {
+			entry = ccensus_entry(merged, &count, info);
+			if( entry == NULL ) {
+				break;
+			}
+			live[entry - merged] = __atomic_load_n(&ccensus_classes[i].clive, __ATOMIC_RELAXED);
+			entry->cpeak = __atomic_load_n(&ccensus_classes[i].cpeak, __ATOMIC_RELAXED);
+		}
+	}
+	for( i = count; i < CCENSUS_CLASSES; ++i ) {
+		live[i] = 0;
+	}
+
+	for( shard = __atomic_load_n(&ccensus_shards, __ATOMIC_ACQUIRE); shard != NULL; shard = shard->cnext ) {
+		for( i = 0; i < CCENSUS_CLASSES; ++i ) {
+			info = __atomic_load_n(&shard->ccounters[i].cinfo, __ATOMIC_ACQUIRE);
+			if( info == NULL ) {
+				continue;
+			}
+			entry = ccensus_entry(merged, &count, info);
+			if( entry == NULL ) {
+				continue;
+			}
+			entry->cconstructed += __atomic_load_n(&shard->ccounters[i].cconstructed, __ATOMIC_RELAXED);
+			entry->cdestroyed += __atomic_load_n(&shard->ccounters[i].cdestroyed, __ATOMIC_RELAXED);
+			live[entry - merged] += __atomic_load_n(&shard->ccounters[i].cdelta, __ATOMIC_RELAXED);
+		}
+	}
+
+	for( i = 0; i < count; ++i ) {
+		/* Counters are read while they change, don't report less than none. */
+		merged[i].clive = live[i] > 0 ? (size_t) live[i] : 0;
+		if( merged[i].cpeak < merged[i].clive ) {
+			merged[i].cpeak = merged[i].clive;
+		}
+		merged[i].cbytes = merged[i].clive * merged[i].cinfo->csize;
+	}
+	qsort(merged, count, sizeof(merged[0]), ccensus_compare);
+
+	for( i = 0; i < count && i < max; ++i ) {
+		entries[i] = merged[i];
+	}
+	return count;
+}
+
+void ccensus_write( FILE* out, const struct ccensus_entry_t* entries, size_t count, int format )
+{
+	size_t i;
+
+	if( format == CCENSUS_JSON ) {
+		fprintf(out, "{\n  \"classes\": [");
+		for( i = 0; i < count; ++i ) {
+			fprintf(out, "%s\n    { \"class\": \"%s\", \"size\": %zu, \"constructed\": %zu, \"destroyed\": %zu, "
+				"\"live\": %zu, \"peak\": %zu, \"bytes\": %zu }",
+				i == 0 ? "" : ",", entries[i].cinfo->cname, entries[i].cinfo->csize,
+				entries[i].cconstructed, entries[i].cdestroyed,
+				entries[i].clive, entries[i].cpeak, entries[i].cbytes);
+		}
+		fprintf(out, "\n  ]\n}\n");
+		return;
+	}
+
+	fprintf(out, "%-24s %12s %12s %12s %12s %14s\n", "class", "constructed", "destroyed", "live", "peak", "bytes");
+	for( i = 0; i < count; ++i ) {
+		fprintf(out, "%-24s %12zu %12zu %12zu %12zu %14zu\n",
+			entries[i].cinfo->cname, entries[i].cconstructed, entries[i].cdestroyed,
+			entries[i].clive, entries[i].cpeak, entries[i].cbytes);
+	}
+}
+
+void ccensus_dump( FILE* out, int format )
+{
+	struct ccensus_entry_t entries[CCENSUS_CLASSES];
+	size_t count;
+
+	count = ccensus_snapshot(entries, CCENSUS_CLASSES);
+	ccensus_write(out, entries, count < CCENSUS_CLASSES ? count : CCENSUS_CLASSES, format);
+}
+
+void ccensus_construct( const struct cclass_info_t* info )
+{
+	struct ccensus_counter_t* counter;
+
+	counter = ccensus_counter(info);
+	if( counter != NULL ) {
+		ccensus_add(&counter->cconstructed, 1);
+		ccensus_live(counter, 1);
+	}
+}
+
+void ccensus_retag( void* self, const void* vtable )
+{
+	const struct cclass_info_t* from;
+	const struct cclass_info_t* to;
+	struct ccensus_counter_t* counter;
+
+	/* Interfaces point back to their object. */
+	if( ((struct cclass_t*) self)->croot != self ) {
+		return;
+	}
+	from = ((const struct cobject_vtable_t*) cclass_get_vtable(self))->cinfo;
+	to = ((const struct cobject_vtable_t*) vtable)->cinfo;
+	if( from == to ) {
+		return;
+	}
+
+	counter = ccensus_counter(from);
+	if( counter != NULL ) {
+		ccensus_add(&counter->cconstructed, (size_t) -1);
+		ccensus_live(counter, -1);
+	}
+	ccensus_construct(to);
+}
+
+void ccensus_destruct( const struct cclass_info_t* info )
+{
+	struct ccensus_counter_t* counter;
+
+	counter = ccensus_counter(info);
+	if( counter != NULL ) {
+		ccensus_add(&counter->cdestroyed, 1);
+		ccensus_live(counter, -1);
+	}
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	A census of live objects by class. When the library, and all code using
+ *	it, is compiled with CCENSUS defined (make CCENSUS=1), cobject_init( ),
+ *	cclass_set_cvtable( ), cdestroy( ) and cdestroy_batch( ) count every
+ *	object against its class. Without CCENSUS the hooks aren't compiled,
+ *	nothing is counted, and a snapshot has no classes.
+ *
+ *	An object is counted against cobject_t in cobject_init( ), then moved to
+ *	each subclass as its constructor maps its vtable, so it ends up counted
+ *	against its most derived class. Objects in a struct carena_t are never
+ *	destroyed, so they stay live in the census after carena_reset( ).
+ *
+ *	Counters are kept per thread, so counting doesn't share cache lines
+ *	between threads, and are merged by ccensus_snapshot( ). Live counts are
+ *	folded into a shared count every CCENSUS_SLOP objects to track peaks, so
+ *	a peak may be off by CCENSUS_SLOP objects per thread.
+ *	@code
+ *		ccensus_dump(stderr, CCENSUS_TEXT);
+ *	@endcode
+ */
+
+#ifndef CCENSUS_H_
+#define CCENSUS_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cclass.h"
+#include <stdio.h>
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Most classes the census can count. Must be a power of two. Classes past
+ * this are not counted.
+ */
+#ifndef CCENSUS_CLASSES
+#define CCENSUS_CLASSES	256
+#endif
+
+/* Objects a thread's live count can drift from the shared live count.
+ */
+#ifndef CCENSUS_SLOP
+#define CCENSUS_SLOP	32
+#endif
+
+/* Output formats of ccensus_write( ).
+ */
+#define CCENSUS_TEXT	0
+#define CCENSUS_JSON	1
+
+/**
+ * @struct ccensus_entry_t
+ * @brief
+ *	One class in a census snapshot.
+ */
+struct ccensus_entry_t
+{
+    const struct cclass_info_t* cinfo;
+
+    /* Objects constructed as and destroyed as this class.
+     */
+    size_t cconstructed;
+    size_t cdestroyed;
+
+    /* Objects of this class live now and at most, and the bytes live now.
+     */
+    size_t clive;
+    size_t cpeak;
+    size_t cbytes;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	Merge every thread's counters. Classes are sorted by live bytes, most
+ *	first.
+ * @param entries
+ *	Classes are written here.
+ * @param max
+ *	The size of param entries.
+ * @returns
+ *	The number of classes counted, which can be more than param max. Only
+ *	param max classes are written.
+ */
+size_t ccensus_snapshot( struct ccensus_entry_t* entries, size_t max );
+
+/**
+ * @details
+ *	Write a snapshot as text, a table with a class per line, or JSON.
+ * @param out
+ *	The stream to write to.
+ * @param entries
+ *	The snapshot.
+ * @param count
+ *	The number of classes in the snapshot.
+ * @param format
+ *	CCENSUS_TEXT or CCENSUS_JSON.
+ */
+void ccensus_write( FILE* out, const struct ccensus_entry_t* entries, size_t count, int format );
+
+/**
+ * @details
+ *	Take a snapshot and write it.
+ * @param out
+ *	The stream to write to.
+ * @param format
+ *	CCENSUS_TEXT or CCENSUS_JSON.
+ */
+void ccensus_dump( FILE* out, int format );
+
+/**
+ * @details
+ *	Count an object constructed as a class. Called by cobject_init( ).
+ * @param info
+ *	The object's class.
+ */
+void ccensus_construct( const struct cclass_info_t* info );
+
+/**
+ * @details
+ *	Move an object's count from its class to the class of a new vtable.
+ *	Called by cclass_set_cvtable( ) before it maps the vtable, it ignores
+ *	interfaces.
+ * @param self
+ *	The object or interface.
+ * @param vtable
+ *	Its new vtable.
+ */
+void ccensus_retag( void* self, const void* vtable );
+
+/**
+ * @details
+ *	Count an object destroyed. Called by cdestroy( ) and cdestroy_batch( ).
+ * @param info
+ *	The object's class.
+ */
+void ccensus_destruct( const struct cclass_info_t* info );
+
+
+#endif /* CCENSUS_H_ */
@@ -29,6 +29,7 @@
  * ==========================================================================
  */
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 /*
@@ -130,12 +131,320 @@ struct cclass_t
     void*  croot;
 };
 
+/* Set in the cvtable pointer of a compact interface header. Vtables are
+ * pointer aligned, so the low bit of a real vtable pointer is always clear.
+ */
+#define CCLASS_TAG_COMPACT	((uintptr_t) 1)
+
+/**
+ * @struct cclass_compact_t
+ * @brief
+ *	Header of a compact interface.
+ * @details
+ *	A compact interface only holds a vtable pointer, instead of the vtable
+ *	and croot pointers of a struct cclass_t. The distance from the interface to
+ *	the top of the object is the same for every instance of a class, so it is
+ *	stored once, in the interface's vtable, rather than in every object. See
+ *	struct cinterface_compact_t.
+ *
+ *	The cvtable pointer of a compact interface has CCLASS_TAG_COMPACT set,
+ *	which is how ccast( ) tells it apart from a struct cclass_t.
+ */
+struct cclass_compact_t
+{
+    /* Reference to the vtable, with CCLASS_TAG_COMPACT set.
+     */
+    const void* cvtable;
+};
+
+/**
+ * @struct cclass_compact_vtable_t
+ * @brief
+ *	First member of a compact interface's vtable.
+ */
+struct cclass_compact_vtable_t
+{
+    /* Offset in bytes of the interface from the top of the object.
+     */
+    ptrdiff_t coffset;
+};
+
+/* Set in the cvtable pointer of a header in a shared memory heap, see
+ * cshm.h. Vtable addresses differ between processes, so the pointer holds a
+ * class ID, above CCLASS_SHARED_SHIFT, and an offset into the class' vtable,
+ * in CCLASS_SHARED_OFFSET, instead. CCLASS_TAG_COMPACT is kept. They're only
+ * resolved in builds with CSHM defined.
+ */
+#define CCLASS_TAG_SHARED	((uintptr_t) 2)
+#define CCLASS_SHARED_SHIFT	32
+#define CCLASS_SHARED_OFFSET	((uintptr_t) 0xFFFFFFFC)
+
+#ifdef CSHM
+#if UINTPTR_MAX <= 0xFFFFFFFF
+#error "CSHM needs 64 bit pointers"
+#endif
+/* Every registered class' vtable by ID, in this process, see cregistry.h. */
+extern const char* cregistry_vtables[];
+#endif
+
+/* Number of entries in a class' ancestor display. Classes can be at most
+ * this many levels deep, counting cobject_t at depth zero.
+ */
+#ifndef CCLASS_INFO_DEPTH
+#define CCLASS_INFO_DEPTH	16
+#endif
+
+/**
+ * @struct cclass_info_t
+ * @brief
+ *	Type descriptor of a class.
+ * @details
+ *	Every class has exactly one of these, reachable from its vtable with
+ *	cobject_get_info( ). Besides describing the class, it holds the class'
+ *	ancestor display: cdisplay[d] is the class' ancestor at depth d, with
+ *	cobject_t at depth zero and the class itself at cdepth. Entries past
+ *	cdepth are NULL. A class X is an instance of class Y if, and only if,
+ *	X's cdisplay[Y's cdepth] is Y's descriptor, which makes cinstanceof( ) one
+ *	load and compare no matter how deep the hierarchy is.
+ *	Descriptors are built at compile time with CCLASS_INFO_INIT( ).
+ */
+struct cclass_info_t
+{
+    /* Name of the class.
+     */
+    const char* cname;
+
+    /* Size and alignment of the class' structure.
+     */
+    size_t csize;
+    size_t calign;
+
+    /* Descriptor of the super class, NULL for cobject_t.
+     */
+    const struct cclass_info_t* cparent;
+
+    /* Depth of the class in the hierarchy, cobject_t is zero.
+     */
+    size_t cdepth;
+
+    /* Ancestors of the class, indexed by their depth.
+     */
+    const struct cclass_info_t* cdisplay[CCLASS_INFO_DEPTH];
+
+    /* Offsets in bytes of the class' interface headers from the top of the
+     * object, inherited ones included, terminated by a zero. NULL if the
+     * class has none. The object's own header, at offset zero, isn't listed.
+     */
+    const size_t* cinterfaces;
+};
+
+/* Alignment requirement of a type.
+ */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define CCLASS_ALIGNOF( type )	_Alignof(type)
+#else
+#define CCLASS_ALIGNOF( type )	offsetof(struct { char cchar; type ctype; }, ctype)
+#endif
+
+/* Number of descriptors in a display list.
+ */
+#define CCLASS_INFO_COUNT( ... )						\
+	(sizeof((const struct cclass_info_t*[]) { __VA_ARGS__ }) / sizeof(const struct cclass_info_t*))
+
+/**
+ * @details
+ *	Initializer for a class' struct cclass_info_t. The display list is the
+ *	super's display list followed by the class' own descriptor. Each class
+ *	provides its list as a macro for its subclasses to extend, the same way
+ *	vtable initializers are extended (see CCLASS_VTABLE( )).
+ *	@code
+ *		extern const struct cclass_info_t point_info;
+ *		#define POINT_INFO_DISPLAY COBJECT_INFO_DISPLAY, &point_info
+ *
+ *		const struct cclass_info_t point_info =
+ *			CCLASS_INFO_INIT(struct point_t, "point_t", &cobject_info, POINT_INFO_DISPLAY);
+ *	@endcode
+ *	The class' vtable initializer then points CObject_VTable.cinfo at the
+ *	descriptor. A hierarchy deeper than CCLASS_INFO_DEPTH fails to compile.
+ * @param type
+ *	The class' structure.
+ * @param name
+ *	The class' name.
+ * @param parent
+ *	Pointer to the super class' descriptor.
+ * @param ...
+ *	The class' display list.
+ */
+#define CCLASS_INFO_INIT( type, name, parent, ... )				\
+	CCLASS_INFO_INIT_INTERFACES(type, name, parent, NULL, __VA_ARGS__)
+
+/**
+ * @details
+ *	Initializer for the struct cclass_info_t of a class with interfaces.
+ *	Same as CCLASS_INFO_INIT( ), plus the offsets of every interface header
+ *	in the class, built with CCLASS_INTERFACES( ). A super object is at the
+ *	top of its subclass, so its interfaces are at the same offsets in the
+ *	subclass. Each class provides its offsets as a macro, next to its
+ *	display list, for its subclasses to extend.
+ *	@code
+ *		#define SHAPE_INFO_INTERFACES offsetof(struct shape_t, drawable), \
+ *			offsetof(struct shape_t, drawable.printable)
+ *
+ *		const struct cclass_info_t shape_info =
+ *			CCLASS_INFO_INIT_INTERFACES(struct shape_t, "shape_t", &cobject_info,
+ *				CCLASS_INTERFACES(SHAPE_INFO_INTERFACES), SHAPE_INFO_DISPLAY);
+ *	@endcode
+ *	Every interface initialized with cinterface_init( ) or
+ *	cinterface_compact_init( ) must be listed, csnap.h and cshm.h find the
+ *	headers to rewrite with these, and cobject_copy( ) the croots.
+ * @param interfaces
+ *	The class' interface offsets, see CCLASS_INTERFACES( ).
+ */
+#define CCLASS_INFO_INIT_INTERFACES( type, name, parent, interfaces, ... )	\
+	{									\
+		.cname = name,							\
+		.csize = sizeof(type),						\
+		.calign = CCLASS_ALIGNOF(type),					\
+		.cparent = parent,						\
+		.cdepth = (CCLASS_INFO_COUNT(__VA_ARGS__) - 1) +		\
+			0 * sizeof(char[1 - 2 * (CCLASS_INFO_COUNT(__VA_ARGS__) > CCLASS_INFO_DEPTH)]), \
+		.cdisplay = { __VA_ARGS__ },					\
+		.cinterfaces = interfaces					\
+	}
+
+/* Zero terminated list of interface offsets, for CCLASS_INFO_INIT_INTERFACES( ).
+ */
+#define CCLASS_INTERFACES( ... )	((const size_t[]) { __VA_ARGS__, 0 })
+
+/* States of a struct cclass_once_t.
+ */
+#define CCLASS_ONCE_UNINIT	0
+#define CCLASS_ONCE_RUNNING	1
+#define CCLASS_ONCE_DONE	2
+
+/* Static initializer for a struct cclass_once_t.
+ */
+#define CCLASS_ONCE_INIT	{ CCLASS_ONCE_UNINIT }
+
+/**
+ * @struct cclass_once_t
+ * @brief
+ *	Guard for one time initialization of a class' virtual table.
+ * @details
+ *	A class' vtable only needs to be built once, no matter how many
+ *	instances of the class are constructed. Prefer CCLASS_VTABLE( ), which
+ *	builds the vtable at compile time. When a vtable can only be built at
+ *	runtime, for example, when the super's vtable initializer is not visible,
+ *	the *_VTable_Key( ) function keeps one of these next to its static vtable
+ *	and uses cclass_once_begin( ) and cclass_once_end( ) to guard the code
+ *	which fills in the vtable.
+ *	After the first call, the cost of the guard is a single acquire load.
+ *	It is safe to construct objects from multiple threads at once.
+ */
+struct cclass_once_t
+{
+    /* One of CCLASS_ONCE_UNINIT, CCLASS_ONCE_RUNNING, or CCLASS_ONCE_DONE.
+     */
+    int cstate;
+};
+
+/*
+ * ==========================================================================
+ * ------------------------ Static Const Vtables ----------------------------
+ * ==========================================================================
+ */
+/* Wrapped around a vtable initializer that overrides entries of an inherited
+ * initializer. C99 6.7.8.19 says later designated initializers override earlier
+ * ones for the same subobject, which is exactly how a subclass overrides its
+ * super's methods, but -Wextra warns about it.
+ */
+#if defined(__clang__)
+#define CCLASS_OVERRIDE_INIT_BEGIN						\
+	_Pragma("clang diagnostic push")					\
+	_Pragma("clang diagnostic ignored \"-Winitializer-overrides\"")
+#define CCLASS_OVERRIDE_INIT_END						\
+	_Pragma("clang diagnostic pop")
+#elif defined(__GNUC__)
+#define CCLASS_OVERRIDE_INIT_BEGIN						\
+	_Pragma("GCC diagnostic push")						\
+	_Pragma("GCC diagnostic ignored \"-Woverride-init\"")
+#define CCLASS_OVERRIDE_INIT_END						\
+	_Pragma("GCC diagnostic pop")
+#else
+#define CCLASS_OVERRIDE_INIT_BEGIN
+#define CCLASS_OVERRIDE_INIT_END
+#endif
+
+/**
+ * @details
+ *	Define a class' vtable as a static const object which is fully built at
+ *	compile time. The vtable is placed in read only memory, there is no
+ *	runtime setup, and the compiler can see the constant function pointers
+ *	stored in it.
+ *
+ *	Every class provides a macro that expands to the brace enclosed initializer
+ *	of its vtable. A subclass' initializer starts with the super's initializer
+ *	and then overrides entries with designated initializers. Interface vtables
+ *	embedded in the class' vtable are overridden the same way.
+ *	@code
+ *		#define POINT_VTABLE_INIT					\
+ *			{							\
+ *				.cobject_vtable = COBJECT_VTABLE_INIT,		\
+ *				.move = point_move_impl				\
+ *			}
+ *		CCLASS_VTABLE(struct point_vtable_t, point_vtable_instance, POINT_VTABLE_INIT);
+ *
+ *		#define SQUARE_VTABLE_INIT					\
+ *			{							\
+ *				.point_vtable = POINT_VTABLE_INIT,		\
+ *				.point_vtable.move = square_move_impl,		\
+ *				.supers_point_vtable = &point_vtable_instance	\
+ *			}
+ *		CCLASS_VTABLE(struct square_vtable_t, square_vtable_instance, SQUARE_VTABLE_INIT);
+ *	@endcode
+ *	The initializer macro must be visible everywhere a subclass is defined. If
+ *	subclasses live in other translation units, the macro goes in the class'
+ *	header and the methods it names must have external linkage.
+ * @param type
+ *	The vtable's type, for example, struct point_vtable_t.
+ * @param name
+ *	The name of the vtable object.
+ * @param ...
+ *	The brace enclosed initializer.
+ */
+#define CCLASS_VTABLE( type, name, ... )					\
+	CCLASS_OVERRIDE_INIT_BEGIN						\
+	static const type name = __VA_ARGS__;					\
+	CCLASS_OVERRIDE_INIT_END						\
+	extern const type name
+
 /*
  * ==========================================================================
  * ----------------------- Function Declarations ----------------------------
  * ==========================================================================
  */
 
+/* The cvtable pointer of any header, with its tags. It's read through a
+ * one word type, a compact header has no croot after it.
+ */
+static inline uintptr_t cclass_header_word( const void* header )
+{
+	return (uintptr_t) ((const struct cclass_compact_t*) header)->cvtable;
+}
+
+/* Address of the vtable a header's cvtable pointer refers to, without its
+ * tags. A shared header's is looked up in this process' cregistry_vtables.
+ */
+static inline uintptr_t cclass_untag( uintptr_t vtable )
+{
+#ifdef CSHM
+	if( __builtin_expect(vtable & CCLASS_TAG_SHARED, 0) ) {
+		return (uintptr_t) cregistry_vtables[vtable >> CCLASS_SHARED_SHIFT] + (vtable & CCLASS_SHARED_OFFSET);
+	}
+#endif
+	return vtable & ~CCLASS_TAG_COMPACT;
+}
+
 /**
  * @ingroup cclass_t
  * @details
@@ -156,7 +465,21 @@ struct cclass_t
  */
 static inline void* ccast( void const* reference )
 {
-	return ((struct cclass_t*) reference)->croot;
+	uintptr_t vtable;
+
+	vtable = cclass_header_word(reference);
+	if( vtable & CCLASS_TAG_COMPACT ) {
+		/* Compact interface, the offset to the top is in its vtable. */
+		const struct cclass_compact_vtable_t* compact;
+
+		compact = (const struct cclass_compact_vtable_t*) cclass_untag(vtable);
+		return ((char*) reference) - compact->coffset;
+	}
+	/* A full header, which has a croot. Its address is made from an integer,
+	 * so compilers which can't tell the branches apart don't take the load
+	 * for a read past a compact header at the end of an object.
+	 */
+	return *(void* const*) ((uintptr_t) reference + offsetof(struct cclass_t, croot));
 }
 
 
@@ -180,8 +503,22 @@ static inline void* ccast( void const* reference )
  * @param vtable
  *	The pointer to the class' virtual table.
  */
+#ifdef CCENSUS
+void ccensus_retag( void* self, const void* vtable );
+#endif
+#ifdef CTRACE
+void ctrace_vtable( void* self, const void* vtable );
+#endif
 static inline void cclass_set_cvtable( void* self, const void* vtable)
 {
+#ifdef CCENSUS
+	/* Count the object against its new class, see ccensus.h. */
+	ccensus_retag(self, vtable);
+#endif
+#ifdef CTRACE
+	/* Trace the constructor chain, see ctrace.h. */
+	ctrace_vtable(self, vtable);
+#endif
 	((struct cclass_t*) self)->cvtable = vtable;
 }
 
@@ -210,7 +547,7 @@ static inline void cclass_set_cvtable( void* self, const void* vtable)
  *	Then, application code simply calls point_move, which has the
  *	code for actually finding and calling the virtual method. 
  *
- *	This method works on references to objects and interfaces.
+ *	This method works on references to objects, interfaces, and compact interfaces.
  *
  * @param self
  *	A pointer to the object whos virtual table is needed. 
@@ -219,7 +556,92 @@ static inline void cclass_set_cvtable( void* self, const void* vtable)
  */
 static inline const void* cclass_get_vtable( void* self )
 {
-	return ((struct cclass_t*) self)->cvtable;
+	uintptr_t vtable;
+
+	vtable = cclass_header_word(self);
+	return (const void*) cclass_untag(vtable);
+}
+
+
+/**
+ * @memberof cclass_t
+ * @details
+ *	Like cclass_get_vtable( ), for a reference to an object, never to an
+ *	interface. An object's vtable pointer is never tagged compact, so it's
+ *	only checked for a shared tag, and only in builds with CSHM defined.
+ */
+static inline const void* cclass_get_object_vtable( const void* self )
+{
+#ifdef CSHM
+	return (const void*) cclass_untag((uintptr_t) ((const struct cclass_t*) self)->cvtable);
+#else
+	return ((const struct cclass_t*) self)->cvtable;
+#endif
+}
+
+
+/**
+ * @memberof cclass_once_t
+ * @details
+ *	Start one time initialization of a class' virtual table. If this returns
+ *	non zero, the caller must initialize the vtable and then call cclass_once_end( ).
+ *	If this returns zero, the vtable has already been initialized (possibly by
+ *	another thread which this call waited on) and is safe to read.
+ *	@code
+ *		const struct point_vtable_t* point_vtable( )
+ *		{
+ *			static struct point_vtable_t vtable;
+ *			static struct cclass_once_t once = CCLASS_ONCE_INIT;
+ *
+ *			if( cclass_once_begin(&once) ) {
+ *				vtable.cobject_vtable = *cobject_vtable( );
+ *				vtable.move = point_move_impl;
+ *				cclass_once_end(&once);
+ *			}
+ *			return &vtable;
+ *		}
+ *	@endcode
+ * @param once
+ *	The guard for the vtable being initialized.
+ * @returns
+ *	Non zero if the caller must do the initialization, zero otherwise.
+ */
+static inline int cclass_once_begin( struct cclass_once_t* once )
+{
+	int state;
+
+	/* Fast path, vtable is already built. */
+	state = __atomic_load_n(&once->cstate, __ATOMIC_ACQUIRE);
+	if( state == CCLASS_ONCE_DONE ) {
+		return 0;
+	}
+
+	/* Race to become the thread doing the initialization. */
+	state = CCLASS_ONCE_UNINIT;
+	if( __atomic_compare_exchange_n(&once->cstate, &state, CCLASS_ONCE_RUNNING, 0,
+					__ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) ) {
+		return 1;
+	}
+
+	/* Lost the race, wait for the winner to finish. */
+	while( __atomic_load_n(&once->cstate, __ATOMIC_ACQUIRE) != CCLASS_ONCE_DONE ) {
+		continue;
+	}
+	return 0;
+}
+
+/**
+ * @memberof cclass_once_t
+ * @details
+ *	Finish one time initialization started by a successful call to
+ *	cclass_once_begin( ). Writes made to the vtable before this call are
+ *	visible to every thread which subsequently calls cclass_once_begin( ).
+ * @param once
+ *	The guard for the vtable which was initialized.
+ */
+static inline void cclass_once_end( struct cclass_once_t* once )
+{
+	__atomic_store_n(&once->cstate, CCLASS_ONCE_DONE, __ATOMIC_RELEASE);
 }
 
 
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cepoch.h"
+#include "cobject.h"
+#include <stdlib.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Initial capacity of a limbo list.
+ */
+#define CEPOCH_LIMBO_INITIAL	16
+
+/* Epochs announced by threads lose their top bit to the active flag.
+ */
+#define CEPOCH_ANNOUNCED(epoch)	((epoch) & (~0UL >> 1))
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+/* The lock only guards the list of threads, readers never take it.
+ */
+static void cepoch_lock( struct cepoch_t* self )
+{
+	while( __atomic_exchange_n(&self->clock, 1, __ATOMIC_ACQUIRE) ) {
+		while( __atomic_load_n(&self->clock, __ATOMIC_RELAXED) ) { }
+	}
+}
+
+static int cepoch_trylock( struct cepoch_t* self )
+{
+	return !__atomic_exchange_n(&self->clock, 1, __ATOMIC_ACQUIRE);
+}
+
+static void cepoch_unlock( struct cepoch_t* self )
+{
+	__atomic_store_n(&self->clock, 0, __ATOMIC_RELEASE);
+}
+
+/* True once objects retired in param retired are safe to destroy.
+ */
+static int cepoch_is_safe( unsigned long epoch, unsigned long retired )
+{
+	return epoch - retired >= 2;
+}
+
+/* Advance the global epoch if every thread in a critical section has
+ * announced it. Returns the global epoch.
+ */
+static unsigned long cepoch_try_advance( struct cepoch_t* self )
+{
+	struct cepoch_thread_t* thread;
+	unsigned long epoch, state;
+
+	/* Pairs with the fence in cepoch_enter( ), a thread is either seen in its
+	 * critical section or will read the objects left after it.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if( !cepoch_trylock(self) ) {
+		/* Another thread is advancing it. */
+		return __atomic_load_n(&self->cepoch, __ATOMIC_ACQUIRE);
+	}
+
+	epoch = __atomic_load_n(&self->cepoch, __ATOMIC_RELAXED);
+	for( thread = self->cthreads; thread != NULL; thread = thread->cnext ) {
+		state = __atomic_load_n(&thread->cstate, __ATOMIC_RELAXED);
+		if( (state & 1) && (state >> 1) != CEPOCH_ANNOUNCED(epoch) ) {
+			cepoch_unlock(self);
+			return epoch;
+		}
+	}
+
+	/* Reads made by threads which exited happen before the objects they
+	 * read are destroyed.
+	 */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	++epoch;
+	__atomic_store_n(&self->cepoch, epoch, __ATOMIC_RELEASE);
+	cepoch_unlock(self);
+	return epoch;
+}
+
+/* Destroy every object in a limbo list. The list is detached first, in case
+ * a destructor retires more objects.
+ */
+static size_t cepoch_limbo_flush( struct cepoch_thread_t* thread, struct cepoch_limbo_t* limbo )
+{
+	void** objects;
+	size_t count, capacity;
+
+	objects = limbo->cobjects;
+	count = limbo->ccount;
+	capacity = limbo->ccapacity;
+	limbo->cobjects = NULL;
+	limbo->ccount = 0;
+	limbo->ccapacity = 0;
+	thread->cretired -= count;
+
+	cdestroy_batch(objects, count);
+
+	/* Keep the memory, unless a destructor started a new list. */
+	if( limbo->cobjects == NULL ) {
+		limbo->cobjects = objects;
+		limbo->ccapacity = capacity;
+	}
+	else {
+		free(objects);
+	}
+	return count;
+}
+
+static int cepoch_limbo_grow( struct cepoch_limbo_t* limbo )
+{
+	void** objects;
+	size_t capacity;
+
+	capacity = limbo->ccapacity == 0 ? CEPOCH_LIMBO_INITIAL : limbo->ccapacity * 2;
+	objects = realloc(limbo->cobjects, capacity * sizeof(*objects));
+	if( objects == NULL ) {
+		return 0;
+	}
+	limbo->cobjects = objects;
+	limbo->ccapacity = capacity;
+	return 1;
+}
+
+/* Wait until objects retired in epoch param retired are safe to destroy.
+ */
+static void cepoch_wait( struct cepoch_t* self, unsigned long retired )
+{
+	while( !cepoch_is_safe(cepoch_try_advance(self), retired) ) { }
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void cepoch_init( struct cepoch_t* self )
+{
+	self->cepoch = 0;
+	self->cthreads = NULL;
+	self->clock = 0;
+}
+
+void cepoch_destroy( struct cepoch_t* self )
+{
+	self->cthreads = NULL;
+}
+
+void cepoch_register( struct cepoch_t* self, struct cepoch_thread_t* thread )
+{
+	size_t i;
+
+	thread->cdomain = self;
+	thread->cstate = 0;
+	thread->cnest = 0;
+	thread->cretired = 0;
+	for( i = 0; i < 3; ++i ) {
+		thread->climbo[i].cepoch = 0;
+		thread->climbo[i].cobjects = NULL;
+		thread->climbo[i].ccount = 0;
+		thread->climbo[i].ccapacity = 0;
+	}
+
+	cepoch_lock(self);
+	thread->cnext = self->cthreads;
+	self->cthreads = thread;
+	cepoch_unlock(self);
+}
+
+void cepoch_unregister( struct cepoch_thread_t* thread )
+{
+	struct cepoch_thread_t** link;
+	struct cepoch_t* self;
+	size_t i;
+
+	self = thread->cdomain;
+	cepoch_synchronize(thread);
+
+	cepoch_lock(self);
+	for( link = &self->cthreads; *link != NULL; link = &(*link)->cnext ) {
+		if( *link == thread ) {
+			*link = thread->cnext;
+			break;
+		}
+	}
+	cepoch_unlock(self);
+
+	for( i = 0; i < 3; ++i ) {
+		free(thread->climbo[i].cobjects);
+		thread->climbo[i].cobjects = NULL;
+		thread->climbo[i].ccapacity = 0;
+	}
+}
+
+size_t cepoch_collect( struct cepoch_thread_t* thread )
+{
+	unsigned long epoch;
+	size_t destroyed, i;
+
+	epoch = cepoch_try_advance(thread->cdomain);
+	destroyed = 0;
+	for( i = 0; i < 3; ++i ) {
+		if( thread->climbo[i].ccount != 0 && cepoch_is_safe(epoch, thread->climbo[i].cepoch) ) {
+			destroyed += cepoch_limbo_flush(thread, &thread->climbo[i]);
+		}
+	}
+	return destroyed;
+}
+
+void cepoch_synchronize( struct cepoch_thread_t* thread )
+{
+	size_t i;
+
+	/* Destructors may retire more objects, so go until none are left. */
+	while( thread->cretired != 0 ) {
+		for( i = 0; i < 3; ++i ) {
+			if( thread->climbo[i].ccount != 0 ) {
+				cepoch_wait(thread->cdomain, thread->climbo[i].cepoch);
+				cepoch_limbo_flush(thread, &thread->climbo[i]);
+			}
+		}
+	}
+}
+
+int cdestroy_deferred( struct cepoch_thread_t* thread, void* object )
+{
+	struct cepoch_limbo_t* limbo;
+	unsigned long epoch;
+
+	/* The object was unlinked before this load, so any thread which can
+	 * still reach it announced this epoch or an earlier one.
+	 */
+	epoch = __atomic_load_n(&thread->cdomain->cepoch, __ATOMIC_SEQ_CST);
+
+	limbo = &thread->climbo[epoch % 3];
+	if( limbo->ccount != 0 && limbo->cepoch != epoch ) {
+		/* Left over from three or more epochs ago. */
+		cepoch_limbo_flush(thread, limbo);
+	}
+	limbo->cepoch = epoch;
+
+	if( limbo->ccount == limbo->ccapacity && !cepoch_limbo_grow(limbo) ) {
+		if( thread->cnest != 0 ) {
+			/* Waiting would wait on this thread. */
+			return 0;
+		}
+		cepoch_wait(thread->cdomain, epoch);
+		cdestroy(object);
+		return 1;
+	}
+	limbo->cobjects[limbo->ccount++] = object;
+	++thread->cretired;
+
+	if( thread->cretired >= CEPOCH_COLLECT_THRESHOLD ) {
+		cepoch_collect(thread);
+	}
+	return 1;
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+#ifndef CEPOCH_H_
+#define CEPOCH_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Number of objects a thread retires before it tries to destroy the ones
+ * which are safe to.
+ */
+#ifndef CEPOCH_COLLECT_THRESHOLD
+#define CEPOCH_COLLECT_THRESHOLD	64
+#endif
+
+/**
+ * @struct cepoch_t
+ * @brief
+ *	Epoch based reclamation of objects shared between threads.
+ * @details
+ *	Readers wrap every access to shared objects in cepoch_enter( ) and
+ *	cepoch_exit( ). A writer which unlinks an object from a shared structure
+ *	hands it to cdestroy_deferred( ) instead of cdestroy( ). The object is
+ *	destroyed once every reader which could still hold a reference to it
+ *	has left its critical section.
+ *	@code
+ *		// Reader
+ *		cepoch_enter(&thread);
+ *		shape = __atomic_load_n(&shared_shape, __ATOMIC_ACQUIRE);
+ *		area = shape_area(shape);
+ *		cepoch_exit(&thread);
+ *
+ *		// Writer
+ *		old = __atomic_exchange_n(&shared_shape, new, __ATOMIC_ACQ_REL);
+ *		cdestroy_deferred(&thread, old);
+ *	@endcode
+ *	The domain keeps a global epoch. Readers announce the epoch they entered
+ *	in, and the epoch advances only when every reader in a critical section
+ *	has announced the current one. An object retired in epoch e can't be
+ *	reached by any reader once the epoch reaches e + 2. Entering and exiting
+ *	a critical section costs a load, a store, and a fence, with no shared
+ *	writes, and retired objects are destroyed in batches with
+ *	cdestroy_batch( ).
+ *
+ *	Every thread using a domain registers a struct cepoch_thread_t with it.
+ */
+struct cepoch_thread_t;
+struct cepoch_t
+{
+    /* The global epoch.
+     */
+    unsigned long cepoch;
+
+    /* Registered threads, guarded by clock.
+     */
+    struct cepoch_thread_t* cthreads;
+    int                     clock;
+};
+
+/* Objects a thread retired during one epoch.
+ */
+struct cepoch_limbo_t
+{
+    unsigned long cepoch;
+    void**        cobjects;
+    size_t        ccount;
+    size_t        ccapacity;
+};
+
+/**
+ * @struct cepoch_thread_t
+ * @brief
+ *	A thread's registration with a struct cepoch_t.
+ * @details
+ *	Only the thread which registered it may use it.
+ */
+struct cepoch_thread_t
+{
+    struct cepoch_t*        cdomain;
+    struct cepoch_thread_t* cnext;
+
+    /* The announced epoch shifted left by one, with the low bit set while
+     * in a critical section.
+     */
+    unsigned long cstate;
+
+    /* Depth of nested critical sections.
+     */
+    unsigned int cnest;
+
+    /* Objects retired by this thread, in the last three epochs it retired
+     * objects in, and how many there are in total.
+     */
+    struct cepoch_limbo_t climbo[3];
+    size_t                cretired;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof cepoch_t
+ * @constructor
+ * @details
+ *	Constructor.
+ * @param self
+ *	The domain to construct.
+ */
+void cepoch_init( struct cepoch_t* self );
+
+/**
+ * @memberof cepoch_t
+ * @details
+ *	Destructor. Every thread must be unregistered first.
+ * @param self
+ *	The domain to destroy.
+ */
+void cepoch_destroy( struct cepoch_t* self );
+
+/**
+ * @memberof cepoch_t
+ * @details
+ *	Register the calling thread with a domain.
+ * @param self
+ *	The domain.
+ * @param thread
+ *	The thread's registration. It must stay valid until cepoch_unregister( ).
+ */
+void cepoch_register( struct cepoch_t* self, struct cepoch_thread_t* thread );
+
+/**
+ * @memberof cepoch_t
+ * @details
+ *	Unregister a thread. Objects it retired are destroyed first, which waits
+ *	for other threads to leave their critical sections. Must not be called
+ *	within a critical section.
+ * @param thread
+ *	The thread's registration.
+ */
+void cepoch_unregister( struct cepoch_thread_t* thread );
+
+/**
+ * @memberof cepoch_t
+ * @details
+ *	Enter a critical section. Shared objects read inside it won't be
+ *	destroyed until after the matching cepoch_exit( ). Critical sections nest.
+ * @param thread
+ *	The calling thread's registration.
+ */
+static inline void cepoch_enter( struct cepoch_thread_t* thread )
+{
+	unsigned long epoch;
+
+	if( thread->cnest++ != 0 ) {
+		return;
+	}
+	epoch = __atomic_load_n(&thread->cdomain->cepoch, __ATOMIC_RELAXED);
+	__atomic_store_n(&thread->cstate, (epoch << 1) | 1, __ATOMIC_RELAXED);
+
+	/* The announcement must be visible before any shared object is read. */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * @memberof cepoch_t
+ * @details
+ *	Exit a critical section.
+ * @param thread
+ *	The calling thread's registration.
+ */
+static inline void cepoch_exit( struct cepoch_thread_t* thread )
+{
+	if( --thread->cnest != 0 ) {
+		return;
+	}
+	/* Reads of shared objects happen before the epoch can advance past them. */
+	__atomic_store_n(&thread->cstate, thread->cstate & ~1UL, __ATOMIC_RELEASE);
+}
+
+/**
+ * @memberof cepoch_t
+ * @details
+ *	Destroy every object retired by a thread which is safe to destroy, after
+ *	trying to advance the epoch. cdestroy_deferred( ) does this every
+ *	CEPOCH_COLLECT_THRESHOLD objects.
+ * @param thread
+ *	The calling thread's registration.
+ * @returns
+ *	The number of objects destroyed.
+ */
+size_t cepoch_collect( struct cepoch_thread_t* thread );
+
+/**
+ * @memberof cepoch_t
+ * @details
+ *	Wait until every object retired by a thread is destroyed. Must not be
+ *	called within a critical section.
+ * @param thread
+ *	The calling thread's registration.
+ */
+void cepoch_synchronize( struct cepoch_thread_t* thread );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Destroy an object once no thread in a critical section of the domain can
+ *	hold a reference to it. The object must already be unreachable for
+ *	threads entering a critical section from now on. Like cdestroy( ),
+ *	param object can be a reference to any class instance / interface.
+ * @param thread
+ *	The calling thread's registration.
+ * @param object
+ *	The object to destroy.
+ * @returns
+ *	Non zero on success. Zero if memory to remember the object could not
+ *	be allocated while in a critical section, the object is not destroyed.
+ *	Outside a critical section, the object is then destroyed immediately
+ *	after waiting like cepoch_synchronize( ).
+ */
+int cdestroy_deferred( struct cepoch_thread_t* thread, void* object );
+
+
+#endif /* CEPOCH_H_ */
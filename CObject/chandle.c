@@ -0,0 +1,184 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "chandle.h"
+#include "cclass.h"
+#include <stdlib.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+#define CHANDLE_MIN_SLOTS	16
+#define CHANDLE_MAX_SLOTS	UINT32_MAX
+
+/* End of the free slot list.
+ */
+#define CHANDLE_NO_SLOT		UINT32_MAX
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+/* Make room for another slot. Live objects never outnumber slots, so their
+ * arrays grow with them.
+ */
+static int chandle_grow( struct chandle_table_t* self )
+{
+	struct chandle_slot_t* slots;
+	uint32_t* object_slots;
+	void** objects;
+	size_t capacity;
+
+	if( self->ccapacity == CHANDLE_MAX_SLOTS ) {
+		return 0;
+	}
+	capacity = (size_t) self->ccapacity * 2;
+	if( capacity > CHANDLE_MAX_SLOTS ) {
+		capacity = CHANDLE_MAX_SLOTS;
+	}
+
+	/* Arrays which grew are kept on failure, ccapacity is only what they
+	 * all have.
+	 */
+	slots = realloc(self->cslots, capacity * sizeof(*slots));
+	if( slots == NULL ) {
+		return 0;
+	}
+	self->cslots = slots;
+	objects = realloc(self->cobjects, capacity * sizeof(*objects));
+	if( objects == NULL ) {
+		return 0;
+	}
+	self->cobjects = objects;
+	object_slots = realloc(self->cobject_slots, capacity * sizeof(*object_slots));
+	if( object_slots == NULL ) {
+		return 0;
+	}
+	self->cobject_slots = object_slots;
+	self->ccapacity = (uint32_t) capacity;
+	return 1;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+int chandle_init( struct chandle_table_t* self )
+{
+	self->cslots = malloc(CHANDLE_MIN_SLOTS * sizeof(*self->cslots));
+	self->cobjects = malloc(CHANDLE_MIN_SLOTS * sizeof(*self->cobjects));
+	self->cobject_slots = malloc(CHANDLE_MIN_SLOTS * sizeof(*self->cobject_slots));
+	self->ccount = 0;
+	self->ccapacity = CHANDLE_MIN_SLOTS;
+	self->cfree = CHANDLE_NO_SLOT;
+	if( self->cslots == NULL || self->cobjects == NULL || self->cobject_slots == NULL ) {
+		chandle_destroy(self);
+		return 0;
+	}
+	self->cslots[0].cobject = NULL;
+	self->cslots[0].cgeneration = 0;
+	self->cslots[0].cindex = CHANDLE_NO_SLOT;
+	self->cslot_count = 1;
+	return 1;
+}
+
+void chandle_destroy( struct chandle_table_t* self )
+{
+	free(self->cslots);
+	free(self->cobjects);
+	free(self->cobject_slots);
+	self->cslots = NULL;
+	self->cobjects = NULL;
+	self->cobject_slots = NULL;
+	self->cslot_count = 0;
+	self->ccount = 0;
+	self->ccapacity = 0;
+	self->cfree = CHANDLE_NO_SLOT;
+}
+
+chandle_t chandle_insert( struct chandle_table_t* self, void* object )
+{
+	struct chandle_slot_t* slot;
+	uint32_t index;
+
+	if( self->cfree != CHANDLE_NO_SLOT ) {
+		index = self->cfree;
+		slot = &self->cslots[index];
+		self->cfree = slot->cindex;
+	}
+	else {
+		if( self->cslot_count == self->ccapacity && !chandle_grow(self) ) {
+			return CHANDLE_NULL;
+		}
+		index = self->cslot_count++;
+		slot = &self->cslots[index];
+		slot->cgeneration = 1;
+	}
+	slot->cobject = ccast(object);
+	slot->cindex = self->ccount;
+	self->cobjects[self->ccount] = slot->cobject;
+	self->cobject_slots[self->ccount] = index;
+	++self->ccount;
+	return (chandle_t) slot->cgeneration << 32 | index;
+}
+
+void* chandle_remove( struct chandle_table_t* self, chandle_t handle )
+{
+	struct chandle_slot_t* slot;
+	void* object;
+	uint32_t index, last;
+
+	object = chandle_get(self, handle);
+	if( object == NULL ) {
+		return NULL;
+	}
+	index = (uint32_t) handle;
+	slot = &self->cslots[index];
+
+	/* Keep live objects packed, with the last in the removed one's place.
+	 */
+	last = --self->ccount;
+	self->cobjects[slot->cindex] = self->cobjects[last];
+	self->cobject_slots[slot->cindex] = self->cobject_slots[last];
+	self->cslots[self->cobject_slots[last]].cindex = slot->cindex;
+
+	/* A generation which wrapped to zero would match handles from before,
+	 * and zero is the out of range slot's, so the slot is retired instead.
+	 */
+	slot->cobject = NULL;
+	if( ++slot->cgeneration != 0 ) {
+		slot->cindex = self->cfree;
+		self->cfree = index;
+	}
+	return object;
+}
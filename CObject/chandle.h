@@ -0,0 +1,215 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	A table of handles to objects, for references kept in long lived
+ *	indexes where a pointer to a destroyed object would go unnoticed. A
+ *	handle is a slot's index in its low 32 bits and the slot's generation
+ *	in its high 32 bits. Removing an object bumps its slot's generation, so
+ *	its handles stop resolving, even after the slot is reused:
+ *	@code
+ *		struct chandle_table_t shapes;
+ *		chandle_t handle;
+ *
+ *		chandle_init(&shapes);
+ *		handle = chandle_insert(&shapes, &rect);
+ *		...
+ *		rect = chandle_get(&shapes, handle);	(NULL once removed)
+ *		...
+ *		cdestroy(chandle_remove(&shapes, handle));
+ *		chandle_destroy(&shapes);
+ *	@endcode
+ *	chandle_get( ) is one load of a slot, holding the object and its
+ *	generation, and two compares. Live objects are also kept packed in an
+ *	array, in no particular order, to loop over with chandle_object_at( ).
+ *
+ *	A slot is retired when its generation would wrap, after 2^32 - 1
+ *	objects, so a stale handle never resolves to another object. The table
+ *	doesn't own its objects, they're removed before being destroyed. It
+ *	isn't thread safe.
+ */
+
+#ifndef CHANDLE_H_
+#define CHANDLE_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	A handle to an object in a struct chandle_table_t.
+ */
+typedef uint64_t chandle_t;
+
+/**
+ * @details
+ *	A handle which never resolves to an object.
+ */
+#define CHANDLE_NULL ((chandle_t) 0)
+
+/* A slot of a struct chandle_table_t. Slot zero is never used, handles
+ * with an index out of range look it up instead, and find generation zero,
+ * which no handle has.
+ */
+struct chandle_slot_t
+{
+    void*    cobject;
+    uint32_t cgeneration;
+
+    /* The object's index in cobjects, or the next free slot if the slot is
+     * free.
+     */
+    uint32_t cindex;
+};
+
+/**
+ * @struct chandle_table_t
+ * @details
+ *	A table of handles to objects. Members are read only.
+ */
+struct chandle_table_t
+{
+    struct chandle_slot_t* cslots;
+    uint32_t               cslot_count;
+    uint32_t               cfree;
+
+    /* Live objects, packed, and the slot of each.
+     */
+    void**                 cobjects;
+    uint32_t*              cobject_slots;
+    uint32_t               ccount;
+    uint32_t               ccapacity;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof chandle_table_t
+ * @details
+ *	Initialize an empty table.
+ * @returns
+ *	Non zero on success, zero if memory couldn't be allocated.
+ */
+int chandle_init( struct chandle_table_t* self );
+
+/**
+ * @memberof chandle_table_t
+ * @details
+ *	Free the table's memory. Its objects aren't destroyed.
+ */
+void chandle_destroy( struct chandle_table_t* self );
+
+/**
+ * @memberof chandle_table_t
+ * @details
+ *	Add an object to the table. An object can be added more than once,
+ *	with a handle for each.
+ * @param object
+ *	The object, or any of its interfaces.
+ * @returns
+ *	The object's handle, or CHANDLE_NULL if memory couldn't be allocated.
+ */
+chandle_t chandle_insert( struct chandle_table_t* self, void* object );
+
+/**
+ * @memberof chandle_table_t
+ * @details
+ *	Take an object out of the table. Its handle, and any copy of it, stops
+ *	resolving.
+ * @returns
+ *	The object, or NULL if the handle doesn't resolve.
+ */
+void* chandle_remove( struct chandle_table_t* self, chandle_t handle );
+
+/**
+ * @memberof chandle_table_t
+ * @details
+ *	The object a handle refers to.
+ * @param handle
+ *	Any handle, including CHANDLE_NULL, removed handles, and handles of
+ *	other tables.
+ * @returns
+ *	The object, not an interface, or NULL if it was removed.
+ */
+static inline void* chandle_get( const struct chandle_table_t* self, chandle_t handle )
+{
+	const struct chandle_slot_t* slot;
+	uint32_t index;
+
+	/* Branches, which are predicted, so callers use the object without
+	 * waiting on the checks, unlike with masks.
+	 */
+	index = (uint32_t) handle;
+	slot = &self->cslots[index < self->cslot_count ? index : 0];
+	return slot->cgeneration == (uint32_t) (handle >> 32) ? slot->cobject : NULL;
+}
+
+/**
+ * @memberof chandle_table_t
+ * @returns
+ *	The number of objects in the table.
+ */
+static inline size_t chandle_count( const struct chandle_table_t* self )
+{
+	return self->ccount;
+}
+
+/**
+ * @memberof chandle_table_t
+ * @details
+ *	An object in the table, to loop over all of them. Inserting or removing
+ *	objects reorders them.
+ * @param index
+ *	Less than chandle_count( ).
+ */
+static inline void* chandle_object_at( const struct chandle_table_t* self, size_t index )
+{
+	return self->cobjects[index];
+}
+
+/**
+ * @memberof chandle_table_t
+ * @details
+ *	The handle of the object chandle_object_at( ) returns for index.
+ */
+static inline chandle_t chandle_handle_at( const struct chandle_table_t* self, size_t index )
+{
+	uint32_t slot;
+
+	slot = self->cobject_slots[index];
+	return (chandle_t) self->cslots[slot].cgeneration << 32 | slot;
+}
+
+
+#endif /* CHANDLE_H_ */
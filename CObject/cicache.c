@@ -0,0 +1,128 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cicache.h"
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Every site which has missed, newest first.
+ */
+static struct cicache_t* cicache_sites;
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static void cicache_list( struct cicache_t* site )
+{
+	if( __atomic_exchange_n(&site->clisted, 1, __ATOMIC_ACQ_REL) ) {
+		return;
+	}
+	site->cnext = __atomic_load_n(&cicache_sites, __ATOMIC_RELAXED);
+	while( !__atomic_compare_exchange_n(&cicache_sites, &site->cnext, site, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED) ) {
+		continue;
+	}
+}
+
+static const char* cicache_state( const struct cicache_t* site )
+{
+	if( __atomic_load_n(&site->cmegamorphic, __ATOMIC_RELAXED) ) {
+		return "megamorphic";
+	}
+	return cicache_ways(site) > 1 ? "polymorphic" : "monomorphic";
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+cicache_target_ft cicache_resolve( struct cicache_t* site, const void* self, size_t offset )
+{
+	const void* key;
+	cicache_target_ft target;
+	unsigned int way;
+
+	key = (const void*) cclass_header_word(self);
+	for( way = 1; way < CICACHE_WAYS; ++way ) {
+		if( __atomic_load_n(&site->cvtables[way], __ATOMIC_RELAXED) == key ) {
+			target = __atomic_load_n(&site->ctargets[way], __ATOMIC_RELAXED);
+			if( target == NULL ) {
+				break;
+			}
+#ifdef CICACHE_STATS
+			__atomic_store_n(&site->chits, __atomic_load_n(&site->chits, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+#endif
+			return target;
+		}
+	}
+
+	target = *(const cicache_target_ft*) ((const char*) cclass_get_vtable((void*) self) + offset);
+	__atomic_store_n(&site->cmisses, __atomic_load_n(&site->cmisses, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+	cicache_list(site);
+
+	/* Claim a way, then publish the vtable once its method is written. Two
+	 * threads missing on one vtable at once can both claim a way for it.
+	 */
+	way = __atomic_load_n(&site->cways, __ATOMIC_RELAXED);
+	do {
+		if( way >= CICACHE_WAYS ) {
+			__atomic_store_n(&site->cmegamorphic, 1, __ATOMIC_RELAXED);
+			return target;
+		}
+	} while( !__atomic_compare_exchange_n(&site->cways, &way, way + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED) );
+	__atomic_store_n(&site->ctargets[way], target, __ATOMIC_RELAXED);
+	__atomic_store_n(&site->cvtables[way], key, __ATOMIC_RELEASE);
+	return target;
+}
+
+size_t cicache_dump( FILE* out )
+{
+	struct cicache_t* site;
+	size_t hits, misses, written;
+
+	written = 0;
+	for( site = __atomic_load_n(&cicache_sites, __ATOMIC_ACQUIRE); site != NULL; site = site->cnext ) {
+		hits = __atomic_load_n(&site->chits, __ATOMIC_RELAXED);
+		misses = __atomic_load_n(&site->cmisses, __ATOMIC_RELAXED);
+		fprintf(out, "%s: %s, %u ways, %zu misses", site->cname, cicache_state(site), cicache_ways(site), misses);
+#ifdef CICACHE_STATS
+		fprintf(out, ", %zu hits, %.2f%% hit rate", hits, hits + misses == 0 ? 0.0 : 100.0 * (double) hits / (double) (hits + misses));
+#else
+		(void) hits;
+#endif
+		fputc('\n', out);
+		++written;
+	}
+	return written;
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	Inline caches for virtual and interface call sites. A call site keeps a
+ *	struct cicache_t, which remembers the vtables it has seen and the method
+ *	each resolved to. The first vtable makes the site monomorphic, up to
+ *	CICACHE_WAYS make it polymorphic, and any more make it megamorphic,
+ *	where new vtables are resolved through the vtable like an uncached call.
+ *	@code
+ *		static struct cicache_t site = CICACHE_INIT("draw loop");
+ *
+ *		for( i = 0; i < count; ++i ) {
+ *			CICACHE_CALL(&site, struct drawable_vtable_t, draw, shapes[i], (shapes[i]));
+ *		}
+ *	@endcode
+ *	Sites are keyed on the raw cvtable pointer of the reference, so a hit
+ *	doesn't untag compact interfaces. CICACHE_CALL_DIRECT( ) also takes the
+ *	implementation the site is expected to resolve to, and calls it
+ *	directly when it does, which the compiler can inline.
+ *
+ *	Every site counts its misses, and, when built with CICACHE_STATS defined
+ *	(make CICACHE_STATS=1), its hits too. cicache_dump( ) writes the counts of
+ *	every site which has been called, to confirm hot loops are monomorphic.
+ *	Counts are updated without atomic read-modify-writes, so calls made at
+ *	the same time by different threads can be lost from them.
+ */
+
+#ifndef CICACHE_H_
+#define CICACHE_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cclass.h"
+#include <stddef.h>
+#include <stdio.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Vtables a site remembers before it's megamorphic.
+ */
+#ifndef CICACHE_WAYS
+#define CICACHE_WAYS	4
+#endif
+
+/* Resolved methods are kept as this type, and cast back to the method's
+ * type to be called.
+ */
+typedef void (*cicache_target_ft)( void );
+
+/**
+ * @struct cicache_t
+ * @details
+ *	A call site's cache. Initialize it with CICACHE_INIT( ). It must be
+ *	static, it's listed for cicache_dump( ) on its first miss and never
+ *	unlisted. A way is filled once and never replaced, so a hit never sees
+ *	another vtable's method.
+ */
+struct cicache_t
+{
+    const void*        cvtables[CICACHE_WAYS];
+    cicache_target_ft  ctargets[CICACHE_WAYS];
+
+    /* Ways claimed, and whether a vtable found them all claimed.
+     */
+    unsigned int       cways;
+    int                cmegamorphic;
+
+    size_t             chits;
+    size_t             cmisses;
+
+    /* For cicache_dump( ), sites are listed on their first miss.
+     */
+    const char*        cname;
+    int                clisted;
+    struct cicache_t*  cnext;
+};
+
+/**
+ * @details
+ *	Initializer for a struct cicache_t.
+ * @param name
+ *	The site's name in cicache_dump( ), a string literal.
+ */
+#define CICACHE_INIT( name )	{ { NULL }, { NULL }, 0, 0, 0, 0, (name), 0, NULL }
+
+/**
+ * @details
+ *	The method a site resolves for a reference, typed as the vtable's member.
+ * @param site
+ *	Pointer to the site's struct cicache_t.
+ * @param vtable_type
+ *	Type of the vtable holding the method, for example,
+ *	struct drawable_vtable_t.
+ * @param method
+ *	The method's member in vtable_type.
+ * @param self
+ *	The object or interface the method is called on.
+ */
+#define CICACHE_TARGET( site, vtable_type, method, self )				\
+	((__typeof__(((vtable_type*) 0)->method))					\
+	 cicache_lookup((site), (self), offsetof(vtable_type, method)))
+
+/**
+ * @details
+ *	Call a method through a site. self is evaluated twice.
+ * @param args
+ *	The method's arguments in parentheses, starting with self, like
+ *	(shape, 2).
+ */
+#define CICACHE_CALL( site, vtable_type, method, self, args )				\
+	(CICACHE_TARGET(site, vtable_type, method, self) args)
+
+/**
+ * @details
+ *	Call a method through a site, directly when it resolves to expected,
+ *	which the compiler can inline. Otherwise it's called through the vtable.
+ *	self is evaluated up to three times.
+ * @param expected
+ *	The implementation the site is expected to resolve to.
+ */
+#define CICACHE_CALL_DIRECT( site, vtable_type, method, self, expected, args )	\
+	(cicache_lookup((site), (self), offsetof(vtable_type, method))			\
+		== (cicache_target_ft) (expected)					\
+	 ? (expected) args								\
+	 : ((const vtable_type*) cclass_get_vtable(self))->method args)
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof cicache_t
+ * @details
+ *	Look a method up in a site's ways past the first, or resolve it on a
+ *	miss and remember it if a way is free. Called by cicache_lookup( ).
+ */
+cicache_target_ft cicache_resolve( struct cicache_t* site, const void* self, size_t offset );
+
+/**
+ * @memberof cicache_t
+ * @details
+ *	The method at offset in the vtable of self, from the site when it has
+ *	seen the vtable before. Use it through CICACHE_TARGET( ). Only the first
+ *	way is checked inline, so a monomorphic site's hit is two compares.
+ * @param site
+ *	The call site's cache.
+ * @param self
+ *	The object or interface the method is called on.
+ * @param offset
+ *	Offset of the method in the vtable.
+ * @returns
+ *	The method.
+ */
+static inline cicache_target_ft cicache_lookup( struct cicache_t* site, const void* self, size_t offset )
+{
+	cicache_target_ft target;
+
+	/* A way's method is only ever unset or final, so no ordering is needed,
+	 * a method which isn't visible yet is resolved by cicache_resolve( ).
+	 */
+	if( __builtin_expect(__atomic_load_n(&site->cvtables[0], __ATOMIC_RELAXED) == (const void*) cclass_header_word(self), 1) ) {
+		target = __atomic_load_n(&site->ctargets[0], __ATOMIC_RELAXED);
+		if( __builtin_expect(target != NULL, 1) ) {
+#ifdef CICACHE_STATS
+			__atomic_store_n(&site->chits, __atomic_load_n(&site->chits, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+#endif
+			return target;
+		}
+	}
+	return cicache_resolve(site, self, offset);
+}
+
+/**
+ * @memberof cicache_t
+ * @details
+ *	Vtables a site has remembered.
+ * @returns
+ *	1 for monomorphic, up to CICACHE_WAYS for polymorphic.
+ */
+static inline unsigned int cicache_ways( const struct cicache_t* site )
+{
+	unsigned int ways;
+
+	ways = __atomic_load_n(&site->cways, __ATOMIC_ACQUIRE);
+	return ways < CICACHE_WAYS ? ways : CICACHE_WAYS;
+}
+
+/**
+ * @details
+ *	Write the state and counts of every site which has been called, one line
+ *	per site. Hits are only counted with CICACHE_STATS.
+ * @param out
+ *	The stream to write to.
+ * @returns
+ *	The number of sites written.
+ */
+size_t cicache_dump( FILE* out );
+
+
+#endif /* CICACHE_H_ */
@@ -54,6 +54,69 @@ struct cinterface_t
     struct cclass_t cclass;
 };
 
+/**
+ * @struct cinterface_compact_t
+ * @ingroup Class
+ * @brief
+ *	Base compact interface.
+ * @details
+ *	Opt in alternative to struct cinterface_t. A compact interface is half the
+ *	size, it holds only a vtable pointer. The offset of the interface from the
+ *	top of the object is stored in the interface's vtable instead, so the
+ *	interface's vtable must have a struct cclass_compact_vtable_t as its first
+ *	member. Given,
+ *	@code
+ *		struct drawable_t
+ *		{
+ *			struct cinterface_compact_t interface;
+ *		};
+ *		struct drawable_vtable_t
+ *		{
+ *			struct cclass_compact_vtable_t CCompact_VTable;
+ *			void (*draw)( struct drawable_t* );
+ *		};
+ *		struct square_t
+ *		{
+ *			struct cobject_t cobject;
+ *			struct drawable_t drawable;
+ *		};
+ *	@endcode
+ *	square_t's vtable initializer sets the offset of its drawable_t with
+ *	CINTERFACE_COMPACT_VTABLE_INIT( ), and the constructor uses
+ *	cinterface_compact_init( ) instead of cinterface_init( ). ccast( ), cdestroy( ),
+ *	and cclass_get_vtable( ) work on compact interfaces like any other reference.
+ */
+struct cinterface_compact_t
+{
+    /* Must be the first member of this struct. Do not change.
+     */
+    struct cclass_compact_t cclass;
+};
+
+/**
+ * @details
+ *	Initializer for the struct cclass_compact_vtable_t at the top of a compact
+ *	interface's vtable. Since a subclass' object starts with its super class'
+ *	object, the offset set by a class is inherited unchanged by its subclasses.
+ *	@code
+ *		#define SQUARE_VTABLE_INIT							\
+ *			{									\
+ *				.cobject_vtable = COBJECT_VTABLE_INIT,				\
+ *				.drawable_vtable.CCompact_VTable =				\
+ *					CINTERFACE_COMPACT_VTABLE_INIT(struct square_t, drawable),	\
+ *				.drawable_vtable.draw = square_draw				\
+ *			}
+ *	@endcode
+ * @param type
+ *	The class implementing the interface.
+ * @param member
+ *	The interface's member in the class, may name a nested member.
+ */
+#define CINTERFACE_COMPACT_VTABLE_INIT( type, member )				\
+	{									\
+		.coffset = offsetof(type, member)				\
+	}
+
 
 /*
  * ==========================================================================
@@ -93,5 +156,30 @@ static inline void cinterface_init( void* self, void* iface, const void* vtable
 }
 
 
+/**
+ * @memberof cinterface_compact_t
+ * @details
+ *	This is the constructor for compact interfaces. It is used in place of
+ *	cinterface_init( ), with the same rules, for interfaces declared with a
+ *	struct cinterface_compact_t.
+ * @param self
+ *	This is a pointer to the object whose class is implementing the interface.
+ *	It is unused, the offset to the object is taken from param vtable. It's
+ *	kept so the call reads the same as cinterface_init( ).
+ * @param iface
+ *	This is a pointer to the compact interface instance within the class' declaration.
+ * @param vtable
+ *	This is a pointer to the interface's virtual table within the class' virtual
+ *	table. Its first member must be a struct cclass_compact_vtable_t whose offset
+ *	is the distance from param self to param iface.
+ */
+static inline void cinterface_compact_init( void* self, void* iface, const void* vtable )
+{
+	struct cclass_compact_t* iface_class = iface;
+
+	(void) self;
+	iface_class->cvtable = (const void*) (((uintptr_t) vtable) | CCLASS_TAG_COMPACT);
+}
+
 
 #endif /* INTERFACE_H_ */
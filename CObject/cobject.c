@@ -26,35 +26,152 @@
  * ==========================================================================
  */
 #include "cobject.h"
+#include "ccensus.h"
+#include "ctrace.h"
+#include <string.h>
 
 
 /*
  * ==========================================================================
- * -------------------Static Function Declarations --------------------------
+ * ---------------------------- Structures ----------------------------------
  * ==========================================================================
  */
-static void cobject_destructor( void* self_ );
+/* cdestroy_batch( ) works on chunks of this many objects at a time, and
+ * prefetches this many objects ahead of the one being read.
+ */
+#define CDESTROY_BATCH_CHUNK	64
+#define CDESTROY_BATCH_AHEAD	8
+
+#if defined(__GNUC__)
+#define CDESTROY_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CDESTROY_PREFETCH(address)
+#endif
+
+/* cnew_array( ) copies with memcpy( ) objects with at most this many
+ * croots, about this many bytes of them at a time.
+ */
+#define CNEW_ARRAY_ROOTS	16
+#define CNEW_ARRAY_CHUNK	4096
+
+/* Croots of copies are written as words, whatever the objects' fields are.
+ */
+typedef uintptr_t __attribute__((may_alias)) cobject_word_t;
+
+/* An object being destroyed by cdestroy_batch( ).
+ */
+struct cdestroy_entry_t
+{
+    struct cobject_t*              object;
+    const struct cobject_vtable_t* vtable;
+};
+
 
 /*
  * ==========================================================================
  * -------------------Static Function Definitions ---------------------------
  * ==========================================================================
  */
-static void cobject_destructor( void* self_ )
+/* Stable counting sort of entries into the buckets given for each entry.
+ */
+static void cdestroy_batch_group( const struct cdestroy_entry_t* entries,
+				  struct cdestroy_entry_t* grouped,
+				  const unsigned char* bucket,
+				  size_t buckets,
+				  size_t count )
 {
-	struct cobject_t* self;
+	size_t start[CDESTROY_BATCH_CHUNK];
+	size_t i;
 
-        self = ccast(self_);
-	if( self->cfree != NULL ) {
-		self->cfree(self);
+	for( i = 0; i < buckets; ++i ) {
+		start[i] = 0;
+	}
+	for( i = 0; i < count; ++i ) {
+		++start[bucket[i]];
+	}
+	for( i = 1; i < buckets; ++i ) {
+		start[i] += start[i-1];
+	}
+	for( i = count; i > 0; --i ) {
+		grouped[--start[bucket[i-1]]] = entries[i-1];
+	}
+}
+
+static void cdestroy_batch_chunk( void** objects, size_t count )
+{
+	struct cdestroy_entry_t        entries[CDESTROY_BATCH_CHUNK];
+	struct cdestroy_entry_t        grouped[CDESTROY_BATCH_CHUNK];
+	unsigned char                  bucket[CDESTROY_BATCH_CHUNK];
+	const struct cobject_vtable_t* vtables[CDESTROY_BATCH_CHUNK];
+	size_t                         buckets;
+	size_t                         i, j;
+
+	/* Resolve every reference to its object, prefetching references ahead. */
+	for( i = 0; i < count; ++i ) {
+		if( i + CDESTROY_BATCH_AHEAD < count ) {
+			CDESTROY_PREFETCH(objects[i + CDESTROY_BATCH_AHEAD]);
+		}
+		entries[i].object = ccast(objects[i]);
+	}
+
+	/* Read object headers, prefetching objects ahead, and bucket them by vtable. */
+	buckets = 0;
+	for( i = 0; i < count; ++i ) {
+		if( i + CDESTROY_BATCH_AHEAD < count ) {
+			CDESTROY_PREFETCH(entries[i + CDESTROY_BATCH_AHEAD].object);
+		}
+		entries[i].vtable = cclass_get_vtable(entries[i].object);
+#ifdef CCENSUS
+		ccensus_destruct(entries[i].vtable->cinfo);
+#endif
+
+		for( j = 0; j < buckets && vtables[j] != entries[i].vtable; ++j ) {
+			continue;
+		}
+		if( j == buckets ) {
+			vtables[buckets++] = entries[i].vtable;
+		}
+		bucket[i] = (unsigned char) j;
+	}
+	cdestroy_batch_group(entries, grouped, bucket, buckets, count);
+
+	/* Call each class' destructor over its run of objects. The chain calls
+	 * the free method, like it does for cdestroy( ), so a destructor which
+	 * doesn't chain to cobject_destructor( ) keeps its object either way.
+	 */
+	for( i = 0; i < count; ++i ) {
+#ifdef CTRACE
+		ctrace_record(CTRACE_PHASE_BEGIN, "destroy", grouped[i].vtable->cinfo->cname);
+#endif
+		grouped[i].vtable->cdestructor(grouped[i].object);
+#ifdef CTRACE
+		ctrace_record(CTRACE_PHASE_END, "destroy", grouped[i].vtable->cinfo->cname);
+#endif
 	}
 }
 
+
 /*
  * ==========================================================================
  * ----------------------- Function Definitions- ----------------------------
  * ==========================================================================
  */
+const struct cclass_info_t cobject_info =
+	CCLASS_INFO_INIT(struct cobject_t, "cobject_t", NULL, COBJECT_INFO_DISPLAY);
+
+void cobject_destructor( void* self_ )
+{
+	struct cobject_t* self;
+
+        self = ccast(self_);
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_INSTANT, "destroy", "cobject_destructor");
+#endif
+	if( self->cfree != NULL ) {
+		self->cfree(self);
+	}
+}
+
 void cdestroy( void* self_ )
 {
 	const struct cobject_vtable_t* vtable;
@@ -67,9 +184,36 @@ void cdestroy( void* self_ )
 
 	/* Get this objects vtable. */
 	vtable = cclass_get_vtable(self);
+#ifdef CCENSUS
+	ccensus_destruct(vtable->cinfo);
+#endif
 
 	/* Call the destructor. */
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_BEGIN, "destroy", vtable->cinfo->cname);
+	vtable->cdestructor(self);
+	ctrace_record(CTRACE_PHASE_END, "destroy", vtable->cinfo->cname);
+#else
 	 vtable->cdestructor(self);
+#endif
+}
+
+void cdestroy_batch( void** objects, size_t count )
+{
+	size_t chunk;
+
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_BEGIN, "destroy", "cdestroy_batch");
+#endif
+	while( count > 0 ) {
+		chunk = count < CDESTROY_BATCH_CHUNK ? count : CDESTROY_BATCH_CHUNK;
+		cdestroy_batch_chunk(objects, chunk);
+		objects += chunk;
+		count -= chunk;
+	}
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_END, "destroy", "cdestroy_batch");
+#endif
 }
 
 void cmalloc( void* self_, cobject_free_ft free_method )
@@ -80,23 +224,203 @@ void cmalloc( void* self_, cobject_free_ft free_method )
 	self->cfree = free_method;
 }
 
+void* cclone( void* self_, void* dst )
+{
+	const struct cobject_vtable_t* vtable;
+	struct cobject_t* self;
+
+	if( dst == NULL ) {
+		return NULL;
+	}
+	self = ccast(self_);
+	vtable = cclass_get_vtable(self);
+	if( vtable->cclone == NULL || !vtable->cclone(self, dst) ) {
+		return NULL;
+	}
+#ifdef CCENSUS
+	ccensus_construct(vtable->cinfo);
+#endif
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_INSTANT, "construct", "cclone");
+#endif
+	return dst;
+}
+
+/* Point a memcpy( ) of the prototype at itself, see cnew_array( ).
+ */
+static void cnew_array_rebase( const struct cobject_vtable_t* vtable, char* object, const size_t* roots, size_t root_count )
+{
+	cobject_word_t* to;
+	struct cobject_t* copy;
+	size_t i;
+
+	to = (cobject_word_t*) object;
+	for( i = 0; i < root_count; ++i ) {
+		to[roots[i]] = (uintptr_t) object;
+	}
+	copy = (struct cobject_t*) object;
+	copy->cfree = NULL;
+	copy->crefs = 1;
+#ifdef CCENSUS
+	ccensus_construct(vtable->cinfo);
+#else
+	(void) vtable;
+#endif
+}
+
+void cnew_array( cobject_construct_ft construct, void* buf, size_t count, cobject_construct_ft init, void* arg )
+{
+	const struct cobject_vtable_t* vtable;
+	const size_t* interfaces;
+	size_t roots[CNEW_ARRAY_ROOTS];
+	size_t root_count, size, chunk, i, j, n;
+	char* base;
+
+	if( count == 0 ) {
+		return;
+	}
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_BEGIN, "construct", "cnew_array");
+#endif
+	construct(buf, 0, arg);
+	vtable = cclass_get_object_vtable(buf);
+	size = vtable->cinfo->csize;
+	base = buf;
+
+	/* Find the croots to point at each copy once, from the class
+	 * descriptor, copies only differ from the prototype there, in cfree
+	 * and crefs, and by init.
+	 */
+	root_count = 0;
+	if( vtable->cclone == cobject_clone && (vtable->cflags & COBJECT_FLAG_COPYABLE) ) {
+		roots[root_count++] = offsetof(struct cclass_t, croot) / sizeof(cobject_word_t);
+		interfaces = vtable->cinfo->cinterfaces;
+		for( ; interfaces != NULL && *interfaces != 0 && root_count <= CNEW_ARRAY_ROOTS; ++interfaces ) {
+			if( cclass_header_word(base + *interfaces) & CCLASS_TAG_COMPACT ) {
+				continue;
+			}
+			if( root_count < CNEW_ARRAY_ROOTS ) {
+				roots[root_count] = (*interfaces + offsetof(struct cclass_t, croot)) / sizeof(cobject_word_t);
+			}
+			++root_count;
+		}
+	}
+	if( root_count == 0 || root_count > CNEW_ARRAY_ROOTS ) {
+		for( i = 1; i < count; ++i ) {
+			if( cclone(buf, base + i * size) == NULL ) {
+				construct(base + i * size, i, arg);
+			}
+		}
+		chunk = count;
+	}
+	else {
+		/* Copy the prototype into a first chunk of objects, then that
+		 * chunk into each of the rest with one memcpy( ), rebasing a
+		 * chunk's objects while it's in cache. The first chunk isn't
+		 * given to init until the end, since it's copied.
+		 */
+		chunk = CNEW_ARRAY_CHUNK / size;
+		chunk = chunk == 0 ? 1 : chunk > count ? count : chunk;
+		for( i = 1; i < chunk; ++i ) {
+			memcpy(base + i * size, buf, size);
+			cnew_array_rebase(vtable, base + i * size, roots, root_count);
+		}
+		for( i = chunk; i < count; i += n ) {
+			n = count - i < chunk ? count - i : chunk;
+			memcpy(base + i * size, buf, n * size);
+			for( j = 0; j < n; ++j ) {
+				cnew_array_rebase(vtable, base + (i + j) * size, roots, root_count);
+				if( init != NULL ) {
+					init(base + (i + j) * size, i + j, arg);
+				}
+			}
+		}
+	}
+	if( init != NULL ) {
+		for( i = 0; i < chunk; ++i ) {
+			init(base + i * size, i, arg);
+		}
+	}
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_END, "construct", "cnew_array");
+#endif
+}
+
+int cobject_clone( void* self, void* dst )
+{
+	const struct cobject_vtable_t* vtable;
+
+	vtable = cclass_get_object_vtable(self);
+	if( !(vtable->cflags & COBJECT_FLAG_COPYABLE) ) {
+		return 0;
+	}
+	cobject_copy(self, dst);
+	return 1;
+}
+
+void cobject_copy( void* self, void* dst_ )
+{
+	const struct cobject_vtable_t* vtable;
+	const struct cclass_info_t* info;
+	const size_t* interfaces;
+	struct cobject_t* dst;
+	char* header;
+
+	/* Only the croots of the object and of its interfaces, listed by its
+	 * class descriptor, point at the original. Compact interfaces are
+	 * found from the object with their vtable's offset, so need no change.
+	 */
+	vtable = cclass_get_object_vtable(self);
+	info = vtable->cinfo;
+	memcpy(dst_, self, info->csize);
+	dst = dst_;
+	dst->cclass.croot = dst;
+	for( interfaces = info->cinterfaces; interfaces != NULL && *interfaces != 0; ++interfaces ) {
+		header = (char*) dst + *interfaces;
+		if( !(cclass_header_word(header) & CCLASS_TAG_COMPACT) ) {
+			((struct cclass_t*) header)->croot = dst;
+		}
+	}
+	dst->cfree = NULL;
+	dst->crefs = 1;
+}
+
 const struct cobject_vtable_t* cobject_vtable( )
 {
-	static const struct cobject_vtable_t vtable =
-	{
-		.cdestructor = cobject_destructor
-	};
+	static const struct cobject_vtable_t vtable = COBJECT_VTABLE_INIT;
 	return &vtable;
 }
 
 void cobject_init( struct cobject_t* self )
 {
-	/* Map vtable.
+	/* Map vtable. Not with cclass_set_cvtable( ), there's no class to move
+	 * the object from yet.
          */
-	cclass_set_cvtable(self, cobject_vtable());
+	self->cclass.cvtable = cobject_vtable( );
 
 	/* Setup object data.
          */
 	self->cclass.croot = self;
 	self->cfree = NULL;
+	self->crefs = 1;
+	self->cflags = 0;
+#ifdef CCENSUS
+	ccensus_construct(&cobject_info);
+#endif
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_INSTANT, "construct", "cobject_init");
+#endif
+}
+
+void cobject_set_shared( void* self_, int shared )
+{
+	struct cobject_t* self;
+
+	self = ccast(self_);
+	if( shared ) {
+		self->cflags |= COBJECT_FLAG_SHARED;
+	}
+	else {
+		self->cflags &= ~COBJECT_FLAG_SHARED;
+	}
 }
@@ -39,6 +39,11 @@
  */
 typedef void (*cobject_free_ft)( void* );
 
+/* Method declaration of the constructor and initializer given to
+ * cnew_array( ), called with each object's index in the array.
+ */
+typedef void (*cobject_construct_ft)( void* object, size_t index, void* arg );
+
 /**
  * @struct cobject_t
  * @brief
@@ -60,8 +65,29 @@ struct cobject_t
      * and can be set by application code.
      */
     cobject_free_ft  cfree;
+
+    /* Reference count, one after construction, see cretain( ) and crelease( ).
+     */
+    unsigned int     crefs;
+
+    /* COBJECT_FLAG_* of this object, combined with its class' flags.
+     */
+    unsigned int     cflags;
 };
 
+/* Object / class flags.
+ * COBJECT_FLAG_SHARED: the reference count is updated atomically, so
+ *	references can be retained and released from any thread. Without it
+ *	the count is a plain integer, for objects confined to one thread.
+ */
+#define COBJECT_FLAG_SHARED	0x1u
+/* COBJECT_FLAG_COPYABLE: a class flag, its objects are copied by cclone( )
+ *	with memcpy( ), see cobject_copy( ). Subclasses inherit it with the
+ *	vtable initializer, one which owns memory or other resources must
+ *	clear it, or override cclone.
+ */
+#define COBJECT_FLAG_COPYABLE	0x2u
+
 
 /**
  * @struct cobject_vtable_t
@@ -77,8 +103,39 @@ struct cobject_vtable_t
     /* This is an objects destructor method.
      */
     void (*cdestructor)( void* );
+
+    /* The class' type descriptor. Every class overrides this in its
+     * vtable initializer with its own descriptor.
+     */
+    const struct cclass_info_t* cinfo;
+
+    /* COBJECT_FLAG_* every instance of the class has.
+     */
+    unsigned int cflags;
+
+    /* Copy the object into dst, see cclone( ). Returns zero if it can't be
+     * copied.
+     */
+    int (*cclone)( void* self, void* dst );
 };
 
+/* Initializer for struct cobject_vtable_t. Every class' vtable initializer
+ * starts with this, see CCLASS_VTABLE( ).
+ */
+#define COBJECT_VTABLE_INIT							\
+	{									\
+		.cdestructor = cobject_destructor,				\
+		.cinfo = &cobject_info,						\
+		.cflags = 0,							\
+		.cclone = cobject_clone						\
+	}
+
+/* Type descriptor of cobject_t, the root of every class hierarchy, and the
+ * start of every class' display list, see CCLASS_INFO_INIT( ).
+ */
+extern const struct cclass_info_t cobject_info;
+#define COBJECT_INFO_DISPLAY &cobject_info
+
 
 /*
  * ==========================================================================
@@ -109,6 +166,119 @@ void cmalloc( void* self, cobject_free_ft free_method );
  */
 void cdestroy( void* self );
 
+/**
+ * @memberof cobject_t
+ * @details
+ *	Destroy many objects at once. This has the same effect as calling cdestroy( )
+ *	on each object, but is faster for large collections of mixed classes.
+ *	Objects are grouped by class and each class' destructor is called over
+ *	its whole group, so the indirect call keeps the same target for a long
+ *	run. The memory free methods set with cmalloc( ) are called by the
+ *	chain, at the end of each object's destruction, as with cdestroy( ).
+ *	Destructors must not depend on other objects in the batch still being
+ *	allocated.
+ * @param objects
+ *	The objects to destroy. Like cdestroy( ), these can be references to any
+ *	class instance / interface. The array itself is not modified.
+ * @param count
+ *	The number of objects in the array.
+ */
+void cdestroy_batch( void** objects, size_t count );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	CObject's implementation of the destructor. It calls the memory free
+ *	method set with cmalloc( ), if there is one. Classes which override the
+ *	destructor call this through their Supers_* vtable reference. It is
+ *	exposed so that COBJECT_VTABLE_INIT can name it in static initializers.
+ * @param self
+ *	The object being destroyed.
+ */
+void cobject_destructor( void* self );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Copy an object into memory for another, without running constructors.
+ *	The copy is made by the class' cclone method, which, unless overridden,
+ *	is cobject_clone( ). Classes which own memory or other resources either
+ *	override it to copy them, or can't be cloned.
+ *	@code
+ *		copy = cclone(template, malloc(cobject_get_info(template)->csize));
+ *		cmalloc(copy, free);
+ *	@endcode
+ *	The copy has one reference, no free method, and the per object flags
+ *	of the original.
+ * @param self
+ *	A reference to any class instance / interface.
+ * @param dst
+ *	Memory for the copy, at least the class' size, aligned for it, which
+ *	doesn't overlap the original. May be NULL.
+ * @returns
+ *	The copy, or NULL if dst is NULL, or the object can't be cloned, which
+ *	includes a class whose vtable has no cclone method.
+ */
+void* cclone( void* self, void* dst );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Construct an array of objects of one class, one after another in buf.
+ *	Only the first is constructed, the rest are copies of it, so a class
+ *	whose constructor chains through supers and interfaces pays for that
+ *	once, not per object. Copies of classes which don't override cclone
+ *	are a memcpy( ) of the first, with the croots its class descriptor
+ *	lists pointed at each copy. Others are copied with cclone( ), or constructed if they
+ *	can't be cloned.
+ *	@code
+ *		rects = malloc(count * sizeof(*rects));
+ *		cnew_array(construct_rect, rects, count, set_rect_position, NULL);
+ *	@endcode
+ *	Objects are destroyed one at a time, or with cdestroy_batch( ), and
+ *	have no free method.
+ * @param construct
+ *	Called to construct the first object, with index zero.
+ * @param buf
+ *	Memory for count objects of the class construct makes.
+ * @param count
+ *	The number of objects to make.
+ * @param init
+ *	Called on every object to set what differs between them, or NULL. The
+ *	first is copied before init is called on it.
+ * @param arg
+ *	Passed to construct and init.
+ */
+void cnew_array( cobject_construct_ft construct, void* buf, size_t count, cobject_construct_ft init, void* arg );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	CObject's implementation of cclone. Objects of classes with
+ *	COBJECT_FLAG_COPYABLE are copied with cobject_copy( ), others aren't.
+ *	Classes which override cclone and don't have the flag call
+ *	cobject_copy( ) to start the copy, then copy what they own.
+ * @param self
+ *	The object, not an interface, like every cclone method is given.
+ * @returns
+ *	Non zero if the object was copied.
+ */
+int cobject_clone( void* self, void* dst );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Copy an object's memory, with the croot of the object and of each
+ *	interface its class descriptor lists pointed at the copy, and give the
+ *	copy one reference and no free method. Fields pointing into the
+ *	original, even at it, still do.
+ * @param self
+ *	The object, not an interface.
+ * @param dst
+ *	Memory for the copy.
+ */
+void cobject_copy( void* self, void* dst );
+
 /**
  * @memberof cobject_t
  * @details
@@ -132,5 +302,134 @@ const struct cobject_vtable_t* cobject_vtable( );
  */
 void cobject_init( struct cobject_t* self );
 
+/**
+ * @memberof cobject_t
+ * @details
+ *	Get the type descriptor of an object's class.
+ * @param self
+ *	A reference to any class instance / interface.
+ * @returns
+ *	The class' type descriptor.
+ */
+static inline const struct cclass_info_t* cobject_get_info( void* self )
+{
+	const struct cobject_vtable_t* vtable;
+
+	vtable = cclass_get_vtable(ccast(self));
+	return vtable->cinfo;
+}
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Check if an object is an instance of a class or one of its subclasses.
+ *	This takes constant time regardless of the depth of the class hierarchy.
+ *	@code
+ *		if( cinstanceof(shape, &square_info) ) {
+ *			struct square_t* square = ccast(shape);
+ *			...
+ *		}
+ *	@endcode
+ * @param self
+ *	A reference to any class instance / interface.
+ * @param info
+ *	The class' type descriptor.
+ * @returns
+ *	Non zero if param self is an instance of the class, zero otherwise.
+ */
+static inline int cinstanceof( void* self, const struct cclass_info_t* info )
+{
+	return cobject_get_info(self)->cdisplay[info->cdepth] == info;
+}
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Make an object's reference count atomic, or not. Objects are created
+ *	with a plain count unless their class has COBJECT_FLAG_SHARED. Call this
+ *	before the object is reachable from other threads.
+ * @param self
+ *	A reference to any class instance / interface.
+ * @param shared
+ *	Non zero to update the count atomically.
+ */
+void cobject_set_shared( void* self, int shared );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Check if an object's reference count is updated atomically.
+ * @param self
+ *	A reference to any class instance / interface.
+ * @returns
+ *	Non zero if the object or its class has COBJECT_FLAG_SHARED.
+ */
+static inline int cobject_is_shared( void* self_ )
+{
+	const struct cobject_vtable_t* vtable;
+	struct cobject_t* self;
+
+	self = ccast(self_);
+	vtable = cclass_get_vtable(self);
+	return ((self->cflags | vtable->cflags) & COBJECT_FLAG_SHARED) != 0;
+}
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Take a reference to an object. Objects start with one reference, owned
+ *	by whoever constructed them. Every cretain( ) must be paired with a
+ *	crelease( ).
+ * @param self
+ *	A reference to any class instance / interface.
+ * @returns
+ *	param self.
+ */
+static inline void* cretain( void* self_ )
+{
+	struct cobject_t* self;
+
+	self = ccast(self_);
+	if( cobject_is_shared(self) ) {
+		/* The caller already holds a reference, so nothing is ordered by this. */
+		__atomic_add_fetch(&self->crefs, 1, __ATOMIC_RELAXED);
+	}
+	else {
+		++self->crefs;
+	}
+	return self_;
+}
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Drop a reference to an object. Dropping the last reference destroys the
+ *	object with cdestroy( ).
+ * @param self
+ *	A reference to any class instance / interface.
+ * @returns
+ *	Non zero if the object was destroyed.
+ */
+static inline int crelease( void* self_ )
+{
+	struct cobject_t* self;
+
+	self = ccast(self_);
+	if( cobject_is_shared(self) ) {
+		/* Writes made through every other reference happen before the
+		 * destructor runs.
+		 */
+		if( __atomic_sub_fetch(&self->crefs, 1, __ATOMIC_RELEASE) != 0 ) {
+			return 0;
+		}
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	}
+	else if( --self->crefs != 0 ) {
+		return 0;
+	}
+	cdestroy(self);
+	return 1;
+}
+
 
 #endif /* COBJECT_H_ */
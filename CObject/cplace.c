@@ -0,0 +1,58 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cplace.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void* calloc_object( const struct cclass_info_t* info, size_t align )
+{
+	void* memory;
+	size_t size;
+
+	if( (align & (align - 1)) != 0 ) {
+		return NULL;
+	}
+	size = cplace_size(info, align);
+	align = cplace_align(info, align);
+
+	/* malloc( ) is already aligned for any standard type, and is cheaper.
+	 */
+	if( align <= CCLASS_ALIGNOF(max_align_t) ) {
+		return calloc(1, size);
+	}
+	memory = aligned_alloc(align, size);
+	if( memory != NULL ) {
+		memset(memory, 0, size);
+	}
+	return memory;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	Placement of objects in memory, driven by the size and alignment in
+ *	their class' struct cclass_info_t. cnew_in( ) constructs an object in a
+ *	caller's buffer after checking the buffer is aligned for the class, and
+ *	calloc_object( ) allocates zeroed memory sized and aligned for a class.
+ *	@code
+ *		void* memory;
+ *		struct counter_t* counter;
+ *
+ *		memory = calloc_object(&counter_Info, CCACHE_LINE);
+ *		counter = cnew_in(memory, counter_t, 0);
+ *		if( counter == NULL ) {
+ *			...
+ *		}
+ *		cmalloc(counter, free);
+ *	@endcode
+ *	Objects written by different cores should each have cache lines of
+ *	their own, or every write by one core takes the line away from the
+ *	others (false sharing). Allocating with an alignment of CCACHE_LINE
+ *	aligns the object to a line and pads it to a whole number of lines, so
+ *	nothing else is allocated in its last line. A class which is always
+ *	written concurrently can instead be declared CCACHE_ALIGNED, its
+ *	alignment is then in its descriptor and every allocation honours it.
+ */
+
+#ifndef CPLACE_H_
+#define CPLACE_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cclass.h"
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Size of a cache line, to avoid false sharing.
+ */
+#ifndef CCACHE_LINE
+#define CCACHE_LINE	64
+#endif
+
+/* Aligns a structure, or a member, to a cache line of its own:
+ *	struct counter_t { struct cobject_t cobject; size_t count; } CCACHE_ALIGNED;
+ */
+#define CCACHE_ALIGNED	__attribute__((aligned(CCACHE_LINE)))
+
+/**
+ * @details
+ *	Construct an object of a class in memory, if the memory is aligned for
+ *	the class. buf is evaluated twice.
+ *	@code
+ *		struct VTClassA* object = cnew_in(memory, VTClassA);
+ *	@endcode
+ * @param buf
+ *	Memory of at least cplace_size( ) bytes, or NULL.
+ * @param class
+ *	The class' name. Its constructor is new##class( ) and its descriptor is
+ *	class##_Info.
+ * @param ...
+ *	The constructor's arguments after self, if any.
+ * @returns
+ *	The constructed object, or NULL if buf is NULL or isn't aligned for the
+ *	class, in which case nothing is constructed.
+ */
+#define cnew_in( buf, class, ... )							\
+	(cplace_check((buf), &class##_Info)						\
+	 ? (new##class((struct class*) (buf), ##__VA_ARGS__), (struct class*) (buf))	\
+	 : (struct class*) NULL)
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	The alignment of a class' objects.
+ * @param info
+ *	The class' descriptor.
+ * @param align
+ *	A stricter alignment to use, a power of two like CCACHE_LINE, or zero
+ *	for the class' own.
+ * @returns
+ *	The larger of align and the class' alignment.
+ */
+static inline size_t cplace_align( const struct cclass_info_t* info, size_t align )
+{
+	return align > info->calign ? align : info->calign;
+}
+
+/**
+ * @details
+ *	The memory a class' object takes at an alignment, its size rounded up
+ *	to a multiple of the alignment. With CCACHE_LINE, that is the whole cache
+ *	lines it touches, and also the stride of an array of such objects.
+ * @param info
+ *	The class' descriptor.
+ * @param align
+ *	As for cplace_align( ).
+ */
+static inline size_t cplace_size( const struct cclass_info_t* info, size_t align )
+{
+	align = cplace_align(info, align);
+	return (info->csize + align - 1) & ~(align - 1);
+}
+
+/**
+ * @details
+ *	Check memory is aligned for a class. Used by cnew_in( ).
+ * @returns
+ *	Non zero if buf is not NULL and is aligned for the class.
+ */
+static inline int cplace_check( const void* buf, const struct cclass_info_t* info )
+{
+	return buf != NULL && ((uintptr_t) buf & (info->calign - 1)) == 0;
+}
+
+/**
+ * @details
+ *	Allocate zeroed memory for an object of a class, cplace_size( ) bytes
+ *	aligned to cplace_align( ). The object isn't constructed, use cnew_in( ),
+ *	and the memory is freed with free( ), for example with cmalloc(self, free).
+ * @param info
+ *	The class' descriptor.
+ * @param align
+ *	As for cplace_align( ), CCACHE_LINE for an object written concurrently.
+ * @returns
+ *	The memory, or NULL if it couldn't be allocated or align isn't a power
+ *	of two.
+ */
+void* calloc_object( const struct cclass_info_t* info, size_t align );
+
+
+#endif /* CPLACE_H_ */
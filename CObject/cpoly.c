@@ -0,0 +1,257 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cpoly.h"
+#include "cclass.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+#define CPOLY_MIN_SLOTS		16
+#define CPOLY_MIN_OBJECTS	8
+#define CPOLY_MIN_BUCKETS	4
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static size_t cpoly_hash( const void* object )
+{
+	uint64_t key;
+
+	/* Objects are at least pointer aligned, so the low bits carry nothing.
+	 */
+	key = (uint64_t) (uintptr_t) object;
+	key *= UINT64_C(0x9E3779B97F4A7C15);
+	return (size_t) (key >> 32);
+}
+
+/* The slot holding object, or the empty slot where it would go.
+ */
+static struct cpoly_slot_t* cpoly_find_slot( const struct cpoly_vector_t* self, const void* object )
+{
+	size_t i;
+
+	i = cpoly_hash(object) & self->cslot_mask;
+	while( self->cslots[i].cobject != NULL && self->cslots[i].cobject != object ) {
+		i = (i + 1) & self->cslot_mask;
+	}
+	return &self->cslots[i];
+}
+
+static int cpoly_grow_slots( struct cpoly_vector_t* self )
+{
+	struct cpoly_slot_t* old;
+	size_t old_count, i;
+
+	old = self->cslots;
+	old_count = old == NULL ? 0 : self->cslot_mask + 1;
+	self->cslots = calloc(old_count == 0 ? CPOLY_MIN_SLOTS : old_count * 2, sizeof(*self->cslots));
+	if( self->cslots == NULL ) {
+		self->cslots = old;
+		return 0;
+	}
+	self->cslot_mask = (old_count == 0 ? CPOLY_MIN_SLOTS : old_count * 2) - 1;
+	for( i = 0; i < old_count; ++i ) {
+		if( old[i].cobject != NULL ) {
+			*cpoly_find_slot(self, old[i].cobject) = old[i];
+		}
+	}
+	free(old);
+	return 1;
+}
+
+/* Empty a slot, shifting back the entries after it which probed past it, so
+ * lookups never need tombstones.
+ */
+static void cpoly_clear_slot( struct cpoly_vector_t* self, struct cpoly_slot_t* slot )
+{
+	size_t hole, i, home;
+
+	hole = (size_t) (slot - self->cslots);
+	i = hole;
+	for( ;; ) {
+		i = (i + 1) & self->cslot_mask;
+		if( self->cslots[i].cobject == NULL ) {
+			break;
+		}
+		home = cpoly_hash(self->cslots[i].cobject) & self->cslot_mask;
+		if( ((i - home) & self->cslot_mask) >= ((i - hole) & self->cslot_mask) ) {
+			self->cslots[hole] = self->cslots[i];
+			hole = i;
+		}
+	}
+	self->cslots[hole].cobject = NULL;
+}
+
+/* The bucket for a vtable, added if there isn't one. Returns the bucket's
+ * index, or cbucket_count when it couldn't be added.
+ */
+static size_t cpoly_find_bucket( struct cpoly_vector_t* self, const void* vtable )
+{
+	struct cpoly_bucket_t* buckets;
+	size_t i, capacity;
+
+	if( self->clast < self->cbucket_count && self->cbuckets[self->clast].cvtable == vtable ) {
+		return self->clast;
+	}
+	for( i = 0; i < self->cbucket_count; ++i ) {
+		if( self->cbuckets[i].cvtable == vtable ) {
+			self->clast = i;
+			return i;
+		}
+	}
+
+	if( self->cbucket_count == self->cbucket_capacity ) {
+		capacity = self->cbucket_capacity == 0 ? CPOLY_MIN_BUCKETS : self->cbucket_capacity * 2;
+		buckets = realloc(self->cbuckets, capacity * sizeof(*buckets));
+		if( buckets == NULL ) {
+			return self->cbucket_count;
+		}
+		self->cbuckets = buckets;
+		self->cbucket_capacity = capacity;
+	}
+	self->cbuckets[i].cvtable = vtable;
+	self->cbuckets[i].cobjects = NULL;
+	self->cbuckets[i].ccount = 0;
+	self->cbuckets[i].ccapacity = 0;
+	++self->cbucket_count;
+	self->clast = i;
+	return i;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void cpoly_init( struct cpoly_vector_t* self )
+{
+	self->cbuckets = NULL;
+	self->cbucket_count = 0;
+	self->cbucket_capacity = 0;
+	self->clast = 0;
+	self->cslots = NULL;
+	self->cslot_mask = 0;
+	self->ccount = 0;
+}
+
+void cpoly_destroy( struct cpoly_vector_t* self )
+{
+	size_t i;
+
+	for( i = 0; i < self->cbucket_count; ++i ) {
+		free(self->cbuckets[i].cobjects);
+	}
+	free(self->cbuckets);
+	free(self->cslots);
+	cpoly_init(self);
+}
+
+int cpoly_insert( struct cpoly_vector_t* self, void* object )
+{
+	struct cpoly_bucket_t* bucket;
+	struct cpoly_slot_t* slot;
+	void** objects;
+	size_t b, capacity;
+
+	object = ccast(object);
+	if( self->cslots == NULL || (self->ccount + 1) * 2 > self->cslot_mask + 1 ) {
+		if( !cpoly_grow_slots(self) ) {
+			return 0;
+		}
+	}
+	slot = cpoly_find_slot(self, object);
+	if( slot->cobject != NULL ) {
+		return 0;
+	}
+
+	b = cpoly_find_bucket(self, cclass_get_vtable(object));
+	if( b == self->cbucket_count ) {
+		return 0;
+	}
+	bucket = &self->cbuckets[b];
+	if( bucket->ccount == bucket->ccapacity ) {
+		capacity = bucket->ccapacity == 0 ? CPOLY_MIN_OBJECTS : bucket->ccapacity * 2;
+		objects = realloc(bucket->cobjects, capacity * sizeof(*objects));
+		if( objects == NULL ) {
+			return 0;
+		}
+		bucket->cobjects = objects;
+		bucket->ccapacity = capacity;
+	}
+
+	slot->cobject = object;
+	slot->cbucket = b;
+	slot->cindex = bucket->ccount;
+	bucket->cobjects[bucket->ccount++] = object;
+	++self->ccount;
+	return 1;
+}
+
+int cpoly_remove( struct cpoly_vector_t* self, void* object )
+{
+	struct cpoly_bucket_t* bucket;
+	struct cpoly_slot_t* slot;
+	void* last;
+
+	if( self->ccount == 0 ) {
+		return 0;
+	}
+	object = ccast(object);
+	slot = cpoly_find_slot(self, object);
+	if( slot->cobject == NULL ) {
+		return 0;
+	}
+
+	/* Move the bucket's last object into the removed one's place.
+	 */
+	bucket = &self->cbuckets[slot->cbucket];
+	last = bucket->cobjects[--bucket->ccount];
+	if( last != object ) {
+		bucket->cobjects[slot->cindex] = last;
+		cpoly_find_slot(self, last)->cindex = slot->cindex;
+	}
+	cpoly_clear_slot(self, slot);
+	--self->ccount;
+	return 1;
+}
+
+int cpoly_contains( const struct cpoly_vector_t* self, void* object )
+{
+	if( self->ccount == 0 ) {
+		return 0;
+	}
+	return cpoly_find_slot(self, ccast(object))->cobject != NULL;
+}
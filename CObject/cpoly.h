@@ -0,0 +1,200 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	A collection of references to objects of any class, kept in one bucket
+ *	per class. CPOLY_FOREACH( ) calls a method on every object bucket by
+ *	bucket, looking the method up once per bucket, so the target of the
+ *	indirect call only changes when the class does, instead of with every
+ *	object of an interleaved list.
+ *	@code
+ *		struct cpoly_vector_t shapes;
+ *
+ *		cpoly_init(&shapes);
+ *		cpoly_insert(&shapes, &circle);
+ *		cpoly_insert(&shapes, &square);
+ *		CPOLY_FOREACH(&shapes, struct shape_vtable_t, draw, struct shape_t, shape, (shape, canvas));
+ *		cpoly_remove(&shapes, &circle);
+ *		cpoly_destroy(&shapes);
+ *	@endcode
+ *	Insertion and removal are O(1) amortized, with an index from each object
+ *	to its place in its bucket. Finding a bucket is linear in the number of
+ *	classes, checking the last used bucket first. Removal moves the last
+ *	object of the bucket into the removed one's place, so order within a
+ *	bucket isn't kept.
+ *
+ *	The collection doesn't own its objects, they must stay alive while in it.
+ */
+
+#ifndef CPOLY_H_
+#define CPOLY_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/**
+ * @struct cpoly_bucket_t
+ * @details
+ *	The objects of one class in a struct cpoly_vector_t.
+ */
+struct cpoly_bucket_t
+{
+    const void* cvtable;
+    void**      cobjects;
+    size_t      ccount;
+    size_t      ccapacity;
+};
+
+/* An entry of the index from objects to their place in a bucket.
+ */
+struct cpoly_slot_t
+{
+    void*  cobject;
+    size_t cbucket;
+    size_t cindex;
+};
+
+/**
+ * @struct cpoly_vector_t
+ * @details
+ *	A collection of objects bucketed by class. Members are read only.
+ */
+struct cpoly_vector_t
+{
+    struct cpoly_bucket_t* cbuckets;
+    size_t                 cbucket_count;
+    size_t                 cbucket_capacity;
+    size_t                 clast;
+
+    /* Open addressed index of every object, at most half full.
+     */
+    struct cpoly_slot_t*   cslots;
+    size_t                 cslot_mask;
+    size_t                 ccount;
+};
+
+/**
+ * @details
+ *	Call a method on every object, bucket by bucket, looking it up once per
+ *	bucket. Return values are discarded. Objects must not be inserted or
+ *	removed by the method.
+ * @param vector
+ *	Pointer to the struct cpoly_vector_t.
+ * @param vtable_type
+ *	Type of a vtable every object's vtable starts with.
+ * @param method
+ *	The method's member in vtable_type, which may name a member of an
+ *	interface's vtable, like Drawable_VTable.draw.
+ * @param type
+ *	A class every object is an instance of.
+ * @param self
+ *	Name of the variable pointing to each object, for args.
+ * @param args
+ *	The method's arguments in parentheses, like (self, 2).
+ */
+#define CPOLY_FOREACH( vector, vtable_type, method, type, self, args )		\
+	do {										\
+		const struct cpoly_bucket_t* cpoly_bucket_;				\
+		size_t cpoly_i_;							\
+											\
+		for( cpoly_bucket_ = (vector)->cbuckets;				\
+		     cpoly_bucket_ < (vector)->cbuckets + (vector)->cbucket_count;	\
+		     ++cpoly_bucket_ ) {						\
+			__typeof__(((const vtable_type*) 0)->method) cpoly_method_ =	\
+				((const vtable_type*) cpoly_bucket_->cvtable)->method;	\
+											\
+			for( cpoly_i_ = 0; cpoly_i_ < cpoly_bucket_->ccount; ++cpoly_i_ ) { \
+				type* self = cpoly_bucket_->cobjects[cpoly_i_];		\
+				cpoly_method_ args;					\
+			}								\
+		}									\
+	} while( 0 )
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof cpoly_vector_t
+ * @details
+ *	Initialize an empty collection. Memory is allocated on first insertion.
+ */
+void cpoly_init( struct cpoly_vector_t* self );
+
+/**
+ * @memberof cpoly_vector_t
+ * @details
+ *	Free the collection's memory. Its objects aren't destroyed.
+ */
+void cpoly_destroy( struct cpoly_vector_t* self );
+
+/**
+ * @memberof cpoly_vector_t
+ * @details
+ *	Add an object to the bucket of its class.
+ * @param object
+ *	The object, or any of its interfaces.
+ * @returns
+ *	Non zero on success, zero if the object is already in the collection, or
+ *	memory couldn't be allocated.
+ */
+int cpoly_insert( struct cpoly_vector_t* self, void* object );
+
+/**
+ * @memberof cpoly_vector_t
+ * @details
+ *	Take an object out of the collection.
+ * @param object
+ *	The object, or any of its interfaces.
+ * @returns
+ *	Non zero if it was removed, zero if it isn't in the collection.
+ */
+int cpoly_remove( struct cpoly_vector_t* self, void* object );
+
+/**
+ * @memberof cpoly_vector_t
+ * @returns
+ *	Non zero if the object is in the collection.
+ */
+int cpoly_contains( const struct cpoly_vector_t* self, void* object );
+
+/**
+ * @memberof cpoly_vector_t
+ * @returns
+ *	The number of objects in the collection.
+ */
+static inline size_t cpoly_count( const struct cpoly_vector_t* self )
+{
+	return self->ccount;
+}
+
+
+#endif /* CPOLY_H_ */
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cpool.h"
+#include <stdlib.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Used to align slot headers and objects for any type.
+ */
+union cpool_align_t
+{
+    long double calign_ld;
+    long long   calign_ll;
+    void*       calign_p;
+    void      (*calign_f)( void );
+};
+
+/* A slab of memory holding ccount objects. The slab's slots follow this
+ * structure in memory.
+ */
+struct cpool_slab_t
+{
+    struct cpool_t*      cpool;
+    struct cpool_slab_t* cnext;
+
+    /* Number of slots in the slab, and how many are allocated.
+     */
+    size_t ccount;
+    size_t cused;
+};
+
+/* Precedes every object in a slab. It is never touched by the object, so
+ * the slab an object came from can always be found in O(1).
+ */
+union cpool_header_t
+{
+    struct cpool_slab_t* cslab;
+    union cpool_align_t  calign;
+};
+
+#define CPOOL_ALIGN		sizeof(union cpool_align_t)
+#define CPOOL_ROUND_UP(x)	((((x) + CPOOL_ALIGN - 1) / CPOOL_ALIGN) * CPOOL_ALIGN)
+#define CPOOL_SLAB_HEADER	CPOOL_ROUND_UP(sizeof(struct cpool_slab_t))
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static union cpool_header_t* cpool_header( void* object )
+{
+	return ((union cpool_header_t*) object) - 1;
+}
+
+static void* cpool_slot_object( struct cpool_t* self, struct cpool_slab_t* slab, size_t index )
+{
+	char* slot;
+
+	slot = ((char*) slab) + CPOOL_SLAB_HEADER + index * self->cslot_size;
+	return slot + sizeof(union cpool_header_t);
+}
+
+/* Allocate one more slab according to the growth policy and put all its
+ * objects on the free list.
+ */
+static int cpool_grow( struct cpool_t* self )
+{
+	struct cpool_slab_t* slab;
+	size_t count;
+	size_t i;
+
+	count = self->cnext_slab;
+	if( self->cconfig.cmax_objects != 0 ) {
+		if( self->cstats.ccapacity >= self->cconfig.cmax_objects ) {
+			return 0;
+		}
+		if( count > self->cconfig.cmax_objects - self->cstats.ccapacity ) {
+			count = self->cconfig.cmax_objects - self->cstats.ccapacity;
+		}
+	}
+
+	slab = malloc(CPOOL_SLAB_HEADER + count * self->cslot_size);
+	if( slab == NULL ) {
+		return 0;
+	}
+	slab->cpool = self;
+	slab->ccount = count;
+	slab->cused = 0;
+	slab->cnext = self->cslabs;
+	self->cslabs = slab;
+
+	/* Push in reverse so objects are handed out in address order. */
+	for( i = count; i > 0; --i ) {
+		void* object = cpool_slot_object(self, slab, i - 1);
+
+		cpool_header(object)->cslab = slab;
+		*(void**) object = self->cfree_list;
+		self->cfree_list = object;
+	}
+
+	self->cstats.cslabs += 1;
+	self->cstats.ccapacity += count;
+
+	/* Grow the next slab. */
+	if( self->cnext_slab < self->cconfig.cmax_slab ) {
+		self->cnext_slab *= self->cconfig.cgrowth;
+		if( self->cnext_slab > self->cconfig.cmax_slab ) {
+			self->cnext_slab = self->cconfig.cmax_slab;
+		}
+	}
+	return 1;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void cpool_init( struct cpool_t* self, size_t object_size, const struct cpool_config_t* config )
+{
+	static const struct cpool_config_t default_config = CPOOL_CONFIG_DEFAULT;
+
+	if( config == NULL ) {
+		config = &default_config;
+	}
+	self->cconfig = *config;
+
+	/* Sanitize the growth policy. */
+	if( self->cconfig.cinitial == 0 ) {
+		self->cconfig.cinitial = 1;
+	}
+	if( self->cconfig.cgrowth == 0 ) {
+		self->cconfig.cgrowth = 1;
+	}
+	if( self->cconfig.cmax_slab < self->cconfig.cinitial ) {
+		self->cconfig.cmax_slab = self->cconfig.cinitial;
+	}
+
+	/* Free objects hold the free list link, so must fit a pointer. */
+	if( object_size < sizeof(void*) ) {
+		object_size = sizeof(void*);
+	}
+	self->cslot_size = sizeof(union cpool_header_t) + CPOOL_ROUND_UP(object_size);
+	self->cnext_slab = self->cconfig.cinitial;
+
+	self->cslabs = NULL;
+	self->cfree_list = NULL;
+	self->cstats.callocs = 0;
+	self->cstats.cfailed = 0;
+	self->cstats.cfrees = 0;
+	self->cstats.clive = 0;
+	self->cstats.cpeak = 0;
+	self->cstats.cslabs = 0;
+	self->cstats.ccapacity = 0;
+}
+
+void cpool_destroy( struct cpool_t* self )
+{
+	struct cpool_slab_t* slab;
+
+	while( self->cslabs != NULL ) {
+		slab = self->cslabs;
+		self->cslabs = slab->cnext;
+		free(slab);
+	}
+	self->cfree_list = NULL;
+	self->cnext_slab = self->cconfig.cinitial;
+	self->cstats.cslabs = 0;
+	self->cstats.ccapacity = 0;
+	self->cstats.clive = 0;
+}
+
+void* cpool_alloc( struct cpool_t* self )
+{
+	void* object;
+
+	object = self->cfree_list;
+	if( object == NULL ) {
+		if( !cpool_grow(self) ) {
+			++self->cstats.cfailed;
+			return NULL;
+		}
+		object = self->cfree_list;
+	}
+	self->cfree_list = *(void**) object;
+	++cpool_header(object)->cslab->cused;
+
+	++self->cstats.callocs;
+	if( ++self->cstats.clive > self->cstats.cpeak ) {
+		self->cstats.cpeak = self->cstats.clive;
+	}
+	return object;
+}
+
+void cpool_free( void* object )
+{
+	struct cpool_slab_t* slab;
+	struct cpool_t*      self;
+
+	slab = cpool_header(object)->cslab;
+	self = slab->cpool;
+
+	*(void**) object = self->cfree_list;
+	self->cfree_list = object;
+	--slab->cused;
+
+	++self->cstats.cfrees;
+	--self->cstats.clive;
+}
+
+int cpool_reserve( struct cpool_t* self, size_t count )
+{
+	while( self->cstats.ccapacity - self->cstats.clive < count ) {
+		if( !cpool_grow(self) ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+size_t cpool_trim( struct cpool_t* self )
+{
+	struct cpool_slab_t** link;
+	struct cpool_slab_t*  slab;
+	void**                next;
+	void*                 object;
+	size_t                released;
+
+	/* Unlink objects in empty slabs from the free list. */
+	next = &self->cfree_list;
+	while( (object = *next) != NULL ) {
+		if( cpool_header(object)->cslab->cused == 0 ) {
+			*next = *(void**) object;
+		}
+		else {
+			next = (void**) object;
+		}
+	}
+
+	/* Then release the empty slabs. */
+	released = 0;
+	link = &self->cslabs;
+	while( (slab = *link) != NULL ) {
+		if( slab->cused == 0 ) {
+			*link = slab->cnext;
+			self->cstats.ccapacity -= slab->ccount;
+			--self->cstats.cslabs;
+			++released;
+			free(slab);
+		}
+		else {
+			link = &slab->cnext;
+		}
+	}
+
+	if( self->cslabs == NULL ) {
+		self->cnext_slab = self->cconfig.cinitial;
+	}
+	return released;
+}
+
+void cpool_stats( const struct cpool_t* self, struct cpool_stats_t* stats )
+{
+	*stats = self->cstats;
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+#ifndef CPOOL_H_
+#define CPOOL_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Default growth policy, see struct cpool_config_t.
+ */
+#define CPOOL_DEFAULT_INITIAL	64
+#define CPOOL_DEFAULT_GROWTH	2
+#define CPOOL_DEFAULT_MAX_SLAB	4096
+#define CPOOL_DEFAULT_MAX	0
+
+/* Static initializer for a struct cpool_config_t with the default growth policy.
+ */
+#define CPOOL_CONFIG_DEFAULT							\
+	{									\
+		.cinitial = CPOOL_DEFAULT_INITIAL,				\
+		.cgrowth = CPOOL_DEFAULT_GROWTH,				\
+		.cmax_slab = CPOOL_DEFAULT_MAX_SLAB,				\
+		.cmax_objects = CPOOL_DEFAULT_MAX				\
+	}
+
+/**
+ * @struct cpool_config_t
+ * @brief
+ *	Growth policy of a struct cpool_t.
+ * @details
+ *	A pool gets memory from malloc( ) one slab at a time. The first slab
+ *	holds cinitial objects, and every slab after that holds cgrowth times
+ *	as many as the previous one, up to cmax_slab objects.
+ */
+struct cpool_config_t
+{
+    /* Number of objects in the first slab.
+     */
+    size_t cinitial;
+
+    /* Each new slab is this many times larger than the previous slab.
+     */
+    size_t cgrowth;
+
+    /* Upper bound on the number of objects in one slab.
+     */
+    size_t cmax_slab;
+
+    /* Upper bound on the number of objects the pool will hold. Zero
+     * means no limit.
+     */
+    size_t cmax_objects;
+};
+
+/**
+ * @struct cpool_stats_t
+ * @brief
+ *	Statistics kept by a struct cpool_t.
+ */
+struct cpool_stats_t
+{
+    /* Successful calls to cpool_alloc( ).
+     */
+    size_t callocs;
+
+    /* Calls to cpool_alloc( ) which returned NULL.
+     */
+    size_t cfailed;
+
+    /* Calls to cpool_free( ).
+     */
+    size_t cfrees;
+
+    /* Objects currently allocated, and the most ever allocated at once.
+     */
+    size_t clive;
+    size_t cpeak;
+
+    /* Slabs currently held, and the number of objects they can hold.
+     */
+    size_t cslabs;
+    size_t ccapacity;
+};
+
+/**
+ * @struct cpool_t
+ * @brief
+ *	Fixed size object allocator.
+ * @details
+ *	A pool hands out memory for objects of one size, normally one pool per
+ *	class sized with the class' structure. Allocating and freeing are O(1)
+ *	pushes and pops on a free list, and memory is only returned to the system
+ *	by cpool_trim( ) and cpool_destroy( ).
+ *
+ *	cpool_free( ) has the declaration of a cobject_free_ft, so it can be given
+ *	directly to cmalloc( ). Destroying the object then returns its memory
+ *	to the pool it came from:
+ *	@code
+ *		static struct cpool_t point_pool;
+ *
+ *		cpool_init(&point_pool, sizeof(struct point_t), NULL);
+ *		...
+ *		struct point_t* point = cpool_alloc(&point_pool);
+ *		point_init(point);
+ *		cmalloc(point, cpool_free);
+ *		...
+ *		cdestroy(point);
+ *	@endcode
+ *
+ *	A pool does no locking. Use one pool per thread, or serialize access to
+ *	a shared pool, so that the hot path never contends on a lock.
+ */
+struct cpool_slab_t;
+struct cpool_t
+{
+    /* Size of each slot, including its header.
+     */
+    size_t cslot_size;
+
+    /* Number of objects to put in the next slab allocated.
+     */
+    size_t cnext_slab;
+
+    struct cpool_config_t cconfig;
+    struct cpool_stats_t  cstats;
+
+    /* All slabs held by the pool, and the list of free objects in them.
+     */
+    struct cpool_slab_t* cslabs;
+    void*                cfree_list;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof cpool_t
+ * @constructor
+ * @details
+ *	Constructor. No memory is allocated until the first call to cpool_alloc( )
+ *	or cpool_reserve( ).
+ * @param self
+ *	The pool to construct.
+ * @param object_size
+ *	Size of the objects in the pool, for example, sizeof(struct point_t).
+ * @param config
+ *	The pool's growth policy, or NULL for CPOOL_CONFIG_DEFAULT.
+ */
+void cpool_init( struct cpool_t* self, size_t object_size, const struct cpool_config_t* config );
+
+/**
+ * @memberof cpool_t
+ * @details
+ *	Free every slab held by the pool. All objects allocated from the pool
+ *	must have been destroyed before calling this.
+ * @param self
+ *	The pool to destroy.
+ */
+void cpool_destroy( struct cpool_t* self );
+
+/**
+ * @memberof cpool_t
+ * @details
+ *	Allocate memory for one object. The memory is suitably aligned for any
+ *	type and is not initialized.
+ * @param self
+ *	The pool to allocate from.
+ * @returns
+ *	Memory for one object, or NULL if the pool is at its cmax_objects limit
+ *	or malloc( ) failed.
+ */
+void* cpool_alloc( struct cpool_t* self );
+
+/**
+ * @memberof cpool_t
+ * @details
+ *	Return an object's memory to the pool it was allocated from. This has
+ *	the declaration of a cobject_free_ft, so it can be given to cmalloc( ).
+ * @param object
+ *	Memory returned by cpool_alloc( ).
+ */
+void cpool_free( void* object );
+
+/**
+ * @memberof cpool_t
+ * @details
+ *	Grow the pool until at least count objects can be allocated without
+ *	calling malloc( ).
+ * @param self
+ *	The pool to grow.
+ * @param count
+ *	The number of free objects wanted.
+ * @returns
+ *	Non zero on success, zero if the memory could not be allocated.
+ */
+int cpool_reserve( struct cpool_t* self, size_t count );
+
+/**
+ * @memberof cpool_t
+ * @details
+ *	Release every slab which has no allocated objects back to the system.
+ *	The growth policy restarts from cinitial if all slabs are released.
+ * @param self
+ *	The pool to trim.
+ * @returns
+ *	The number of slabs released.
+ */
+size_t cpool_trim( struct cpool_t* self );
+
+/**
+ * @memberof cpool_t
+ * @details
+ *	Get a copy of the pool's statistics.
+ * @param self
+ *	The pool.
+ * @param stats
+ *	Written with the pool's statistics.
+ */
+void cpool_stats( const struct cpool_t* self, struct cpool_stats_t* stats );
+
+
+#endif /* CPOOL_H_ */
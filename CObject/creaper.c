@@ -0,0 +1,341 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "creaper.h"
+#include "cobject.h"
+#include "cring.h"
+#include <stdlib.h>
+#include <sched.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Times a blocked caller retries before it sleeps.
+ */
+#define CREAPER_SPINS	64
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+/* The queue is a cring.h queue.
+ */
+static int creaper_enqueue( struct creaper_t* self, void* object )
+{
+	return cring_enqueue(&self->cenqueue, self->cslots, self->cmask, object);
+}
+
+static void* creaper_dequeue( struct creaper_t* self )
+{
+	return cring_dequeue(&self->cdequeue, self->cslots, self->cmask);
+}
+
+/* True when no slot is claimed by a producer and not yet dequeued.
+ */
+static int creaper_is_empty( struct creaper_t* self )
+{
+	return __atomic_load_n(&self->cenqueue, __ATOMIC_SEQ_CST) ==
+	       __atomic_load_n(&self->cdequeue, __ATOMIC_SEQ_CST);
+}
+
+static void creaper_wake( pthread_mutex_t* lock, pthread_cond_t* cond, int* waiting )
+{
+	/* Pairs with the waiter raising *waiting before it checks its condition,
+	 * one of the two always sees the other.
+	 */
+	if( __atomic_load_n(waiting, __ATOMIC_SEQ_CST) != 0 ) {
+		pthread_mutex_lock(lock);
+		pthread_cond_broadcast(cond);
+		pthread_mutex_unlock(lock);
+	}
+}
+
+/* Destroy one object taken off the queue, and wake anyone waiting for room
+ * or for the queue to drain.
+ */
+static void creaper_reap( struct creaper_t* self, void* object )
+{
+	cdestroy(object);
+	__atomic_add_fetch(&self->cstats.cdestroyed, 1, __ATOMIC_SEQ_CST);
+	creaper_wake(&self->clock, &self->cprogress, &self->cwaiters);
+}
+
+static void* creaper_thread( void* arg )
+{
+	struct creaper_t* self;
+	void* object;
+
+	self = arg;
+	for( ;; ) {
+		object = creaper_dequeue(self);
+		if( object != NULL ) {
+			creaper_reap(self, object);
+			continue;
+		}
+		if( !creaper_is_empty(self) ) {
+			/* A producer is between claiming a slot and writing it. */
+			sched_yield( );
+			continue;
+		}
+
+		pthread_mutex_lock(&self->clock);
+		__atomic_add_fetch(&self->csleepers, 1, __ATOMIC_SEQ_CST);
+		for( ;; ) {
+			/* Cleared before every look at the queue, so an object it
+			 * doesn't see is signaled for. Another reaper can empty the
+			 * queue between a wake up and the look, so clearing only
+			 * once awake would leave it set with everyone asleep.
+			 */
+			__atomic_store_n(&self->csignaled, 0, __ATOMIC_SEQ_CST);
+			if( !creaper_is_empty(self) || self->cstop ) {
+				break;
+			}
+			pthread_cond_wait(&self->cnot_empty, &self->clock);
+		}
+		__atomic_sub_fetch(&self->csleepers, 1, __ATOMIC_SEQ_CST);
+		if( self->cstop && creaper_is_empty(self) ) {
+			pthread_mutex_unlock(&self->clock);
+			break;
+		}
+		pthread_mutex_unlock(&self->clock);
+	}
+	return NULL;
+}
+
+static void creaper_update_peak( struct creaper_t* self )
+{
+	size_t depth, peak;
+
+	/* cdestroyed first, it never passes cenqueue. */
+	depth = __atomic_load_n(&self->cstats.cdestroyed, __ATOMIC_ACQUIRE);
+	depth = __atomic_load_n(&self->cenqueue, __ATOMIC_ACQUIRE) - depth;
+	peak = __atomic_load_n(&self->cstats.cpeak, __ATOMIC_RELAXED);
+	while( depth > peak ) {
+		if( __atomic_compare_exchange_n(&self->cstats.cpeak, &peak, depth, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ) {
+			break;
+		}
+	}
+}
+
+/* Wait for room in the queue, then enqueue.
+ */
+static void creaper_enqueue_blocking( struct creaper_t* self, void* object )
+{
+	int spins;
+
+	__atomic_add_fetch(&self->cstats.cblocked, 1, __ATOMIC_RELAXED);
+	for( spins = 0; spins < CREAPER_SPINS; ++spins ) {
+		sched_yield( );
+		if( creaper_enqueue(self, object) ) {
+			return;
+		}
+	}
+
+	pthread_mutex_lock(&self->clock);
+	__atomic_add_fetch(&self->cwaiters, 1, __ATOMIC_SEQ_CST);
+	while( !creaper_enqueue(self, object) ) {
+		pthread_cond_wait(&self->cprogress, &self->clock);
+	}
+	__atomic_sub_fetch(&self->cwaiters, 1, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&self->clock);
+}
+
+/* Stop and join the first param count reaper threads.
+ */
+static void creaper_stop( struct creaper_t* self, size_t count )
+{
+	size_t i;
+
+	pthread_mutex_lock(&self->clock);
+	self->cstop = 1;
+	pthread_cond_broadcast(&self->cnot_empty);
+	pthread_mutex_unlock(&self->clock);
+
+	for( i = 0; i < count; ++i ) {
+		pthread_join(self->cthreads[i], NULL);
+	}
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+int creaper_init( struct creaper_t* self, const struct creaper_config_t* config )
+{
+	static const struct creaper_config_t default_config = CREAPER_CONFIG_DEFAULT;
+	size_t capacity, i;
+
+	if( config == NULL ) {
+		config = &default_config;
+	}
+
+	capacity = 2;
+	while( capacity < config->ccapacity ) {
+		capacity <<= 1;
+	}
+
+	self->cslots = malloc(capacity * sizeof(*self->cslots));
+	self->cthreads = malloc((config->cthreads == 0 ? 1 : config->cthreads) * sizeof(*self->cthreads));
+	if( self->cslots == NULL || self->cthreads == NULL ) {
+		free(self->cslots);
+		free(self->cthreads);
+		return 0;
+	}
+	cring_init(self->cslots, capacity);
+	self->cmask = capacity - 1;
+	self->cpolicy = config->cpolicy;
+	self->cenqueue = 0;
+	self->cdequeue = 0;
+	self->csleepers = 0;
+	self->csignaled = 0;
+	self->cwaiters = 0;
+	self->cstop = 0;
+	self->cstats.cqueued = 0;
+	self->cstats.cdestroyed = 0;
+	self->cstats.cinline = 0;
+	self->cstats.cblocked = 0;
+	self->cstats.cdepth = 0;
+	self->cstats.cpeak = 0;
+
+	pthread_mutex_init(&self->clock, NULL);
+	pthread_cond_init(&self->cnot_empty, NULL);
+	pthread_cond_init(&self->cprogress, NULL);
+
+	self->cthread_count = config->cthreads;
+	for( i = 0; i < config->cthreads; ++i ) {
+		if( pthread_create(&self->cthreads[i], NULL, creaper_thread, self) != 0 ) {
+			creaper_stop(self, i);
+			pthread_cond_destroy(&self->cprogress);
+			pthread_cond_destroy(&self->cnot_empty);
+			pthread_mutex_destroy(&self->clock);
+			free(self->cslots);
+			free(self->cthreads);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+void creaper_destroy( struct creaper_t* self )
+{
+	creaper_drain(self);
+	creaper_stop(self, self->cthread_count);
+
+	pthread_cond_destroy(&self->cprogress);
+	pthread_cond_destroy(&self->cnot_empty);
+	pthread_mutex_destroy(&self->clock);
+	free(self->cslots);
+	free(self->cthreads);
+}
+
+void creaper_drain( struct creaper_t* self )
+{
+	size_t target;
+	void* object;
+
+	/* Objects queued from here on aren't waited for. cenqueue only moves
+	 * for objects which made it into the queue, an object about to be
+	 * destroyed inline because the queue is full is never waited for.
+	 */
+	target = __atomic_load_n(&self->cenqueue, __ATOMIC_SEQ_CST);
+
+	/* Help the reapers. */
+	while( (object = creaper_dequeue(self)) != NULL ) {
+		creaper_reap(self, object);
+	}
+
+	pthread_mutex_lock(&self->clock);
+	__atomic_add_fetch(&self->cwaiters, 1, __ATOMIC_SEQ_CST);
+	while( (long) (__atomic_load_n(&self->cstats.cdestroyed, __ATOMIC_SEQ_CST) - target) < 0 ) {
+		if( self->cthread_count == 0 ) {
+			/* Nobody else will destroy them. */
+			pthread_mutex_unlock(&self->clock);
+			while( (object = creaper_dequeue(self)) != NULL ) {
+				creaper_reap(self, object);
+			}
+			sched_yield( );
+			pthread_mutex_lock(&self->clock);
+			continue;
+		}
+		pthread_cond_wait(&self->cprogress, &self->clock);
+	}
+	__atomic_sub_fetch(&self->cwaiters, 1, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&self->clock);
+}
+
+void creaper_stats( struct creaper_t* self, struct creaper_stats_t* stats )
+{
+	stats->cdestroyed = __atomic_load_n(&self->cstats.cdestroyed, __ATOMIC_ACQUIRE);
+	stats->cqueued = __atomic_load_n(&self->cenqueue, __ATOMIC_ACQUIRE);
+	stats->cinline = __atomic_load_n(&self->cstats.cinline, __ATOMIC_RELAXED);
+	stats->cblocked = __atomic_load_n(&self->cstats.cblocked, __ATOMIC_RELAXED);
+	stats->cdepth = stats->cqueued - stats->cdestroyed;
+	stats->cpeak = __atomic_load_n(&self->cstats.cpeak, __ATOMIC_RELAXED);
+	if( stats->cpeak < stats->cdepth ) {
+		stats->cpeak = stats->cdepth;
+	}
+}
+
+int cdestroy_async( struct creaper_t* reaper, void* object )
+{
+	/* Counted by the enqueue itself, cenqueue moves once the object has a
+	 * slot, so nothing is counted which then doesn't make it into the queue.
+	 */
+	if( !creaper_enqueue(reaper, object) ) {
+		if( reaper->cpolicy == CREAPER_FULL_INLINE ) {
+			__atomic_add_fetch(&reaper->cstats.cinline, 1, __ATOMIC_RELAXED);
+			cdestroy(object);
+			return 0;
+		}
+		creaper_enqueue_blocking(reaper, object);
+	}
+	creaper_update_peak(reaper);
+
+	/* One wake up at a time. Idle reapers clear csignaled before every look
+	 * at the queue, so if it's already set, a reaper is yet to look, and
+	 * sees this object.
+	 *
+	 * Reapers count themselves in csleepers then look at cenqueue, this
+	 * moves cenqueue then looks at csleepers. The fence keeps the enqueue's
+	 * relaxed update from being seen after the load, so at least one side
+	 * sees the other.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if( __atomic_load_n(&reaper->csleepers, __ATOMIC_SEQ_CST) != 0 &&
+	    !__atomic_exchange_n(&reaper->csignaled, 1, __ATOMIC_SEQ_CST) ) {
+		pthread_mutex_lock(&reaper->clock);
+		pthread_cond_signal(&reaper->cnot_empty);
+		pthread_mutex_unlock(&reaper->clock);
+	}
+	return 1;
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+#ifndef CREAPER_H_
+#define CREAPER_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+#include <pthread.h>
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* What cdestroy_async( ) does when the queue is full.
+ * CREAPER_FULL_BLOCK: wait for a reaper to make room.
+ * CREAPER_FULL_INLINE: destroy the object on the calling thread.
+ */
+#define CREAPER_FULL_BLOCK	0
+#define CREAPER_FULL_INLINE	1
+
+/**
+ * @struct creaper_config_t
+ * @brief
+ *	Configuration of a struct creaper_t.
+ */
+struct creaper_config_t
+{
+    /* Objects the queue holds, rounded up to a power of two.
+     */
+    size_t ccapacity;
+
+    /* Number of reaper threads. With none, objects are only destroyed by
+     * creaper_drain( ), so the policy must be CREAPER_FULL_INLINE.
+     */
+    size_t cthreads;
+
+    /* CREAPER_FULL_BLOCK or CREAPER_FULL_INLINE.
+     */
+    int cpolicy;
+};
+
+/* One reaper thread, a queue of 1024 objects, and blocking when full.
+ */
+#define CREAPER_CONFIG_DEFAULT { 1024, 1, CREAPER_FULL_BLOCK }
+
+/**
+ * @struct creaper_stats_t
+ * @brief
+ *	Statistics of a struct creaper_t.
+ */
+struct creaper_stats_t
+{
+    /* Objects queued, objects destroyed from the queue, and objects
+     * destroyed by the caller because the queue was full. Objects queued is
+     * the queue's enqueue position, not a separate count.
+     */
+    size_t cqueued;
+    size_t cdestroyed;
+    size_t cinline;
+
+    /* Times a caller waited for room in the queue.
+     */
+    size_t cblocked;
+
+    /* Objects queued or being destroyed, now and at most.
+     */
+    size_t cdepth;
+    size_t cpeak;
+};
+
+/**
+ * @struct creaper_t
+ * @brief
+ *	Destroys objects on background threads.
+ * @details
+ *	cdestroy_async( ) puts an object on a bounded lock free queue and
+ *	returns. Reaper threads take objects off the queue and cdestroy( ) them,
+ *	running their destructor chain and memory free method off the caller's
+ *	thread.
+ *	@code
+ *		struct creaper_t reaper;
+ *
+ *		creaper_init(&reaper, NULL);
+ *		...
+ *		cdestroy_async(&reaper, request);
+ *		...
+ *		creaper_destroy(&reaper);
+ *	@endcode
+ *	Any number of threads can call cdestroy_async( ) at once. Objects given to
+ *	a reaper must not depend on the destroying thread, and are destroyed in
+ *	no particular order when there is more than one reaper thread.
+ */
+struct cring_cell_t;
+struct creaper_t
+{
+    struct cring_cell_t* cslots;
+    size_t               cmask;
+    int                  cpolicy;
+
+    /* Next slot to enqueue at and dequeue from, on their own cache lines.
+     */
+    size_t cenqueue __attribute__((aligned(64)));
+    size_t cdequeue __attribute__((aligned(64)));
+
+    /* Reaper threads.
+     */
+    pthread_t* cthreads __attribute__((aligned(64)));
+    size_t     cthread_count;
+
+    /* Idle reapers wait on cnot_empty, csignaled is set while a wake up is
+     * on its way to one. Callers waiting for room or for the queue to drain
+     * wait on cprogress. Both only when the lock free fast path can't
+     * proceed.
+     */
+    pthread_mutex_t clock;
+    pthread_cond_t  cnot_empty;
+    pthread_cond_t  cprogress;
+    int             csleepers;
+    int             csignaled;
+    int             cwaiters;
+    int             cstop;
+
+    /* Updated atomically.
+     */
+    struct creaper_stats_t cstats;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof creaper_t
+ * @constructor
+ * @details
+ *	Constructor. Starts the reaper threads.
+ * @param self
+ *	The reaper to construct.
+ * @param config
+ *	The reaper's configuration, or NULL for CREAPER_CONFIG_DEFAULT.
+ * @returns
+ *	Non zero on success, zero if memory or threads could not be allocated.
+ */
+int creaper_init( struct creaper_t* self, const struct creaper_config_t* config );
+
+/**
+ * @memberof creaper_t
+ * @details
+ *	Destroy every queued object, then stop the reaper threads and free the
+ *	queue.
+ * @param self
+ *	The reaper to destroy.
+ */
+void creaper_destroy( struct creaper_t* self );
+
+/**
+ * @memberof creaper_t
+ * @details
+ *	Wait until every object queued before the call is destroyed. The caller
+ *	destroys queued objects too, rather than only waiting on the reapers.
+ * @param self
+ *	The reaper.
+ */
+void creaper_drain( struct creaper_t* self );
+
+/**
+ * @memberof creaper_t
+ * @details
+ *	Get a snapshot of a reaper's statistics.
+ * @param self
+ *	The reaper.
+ * @param stats
+ *	Statistics are written here.
+ */
+void creaper_stats( struct creaper_t* self, struct creaper_stats_t* stats );
+
+/**
+ * @memberof cobject_t
+ * @details
+ *	Destroy an object on a reaper thread. Like cdestroy( ), param object can
+ *	be a reference to any class instance / interface. The caller must not use
+ *	the object after this call.
+ * @param reaper
+ *	The reaper to destroy the object.
+ * @param object
+ *	The object to destroy.
+ * @returns
+ *	Non zero if the object was queued, zero if it was destroyed by the
+ *	caller because the queue was full and the policy is CREAPER_FULL_INLINE.
+ */
+int cdestroy_async( struct creaper_t* reaper, void* object );
+
+
+#endif /* CREAPER_H_ */
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cregistry.h"
+#include "cobject.h"
+#include <string.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+const char* cregistry_vtables[CREGISTRY_CLASSES];
+size_t cregistry_sizes[CREGISTRY_CLASSES];
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+/* The registered class whose vtable holds size bytes at address, or
+ * CREGISTRY_CLASSES.
+ */
+static unsigned int cregistry_class_of( uintptr_t address, size_t size )
+{
+	unsigned int id;
+
+	for( id = 0; id < CREGISTRY_CLASSES; ++id ) {
+		if( cregistry_vtables[id] != NULL &&
+		    address >= (uintptr_t) cregistry_vtables[id] &&
+		    address + size <= (uintptr_t) cregistry_vtables[id] + cregistry_sizes[id] ) {
+			break;
+		}
+	}
+	return id;
+}
+
+/* Decode the header at header->coffset of an object.
+ */
+static int cregistry_decode( const char* root, size_t size, struct cregistry_header_t* header )
+{
+	uintptr_t word;
+
+	if( header->coffset > size - sizeof(word) ) {
+		return 0;
+	}
+	memcpy(&word, root + header->coffset, sizeof(word));
+	header->ccompact = (word & CCLASS_TAG_COMPACT) != 0;
+	if( header->ccompact ? header->coffset == 0 : header->coffset > size - 2 * sizeof(word) ) {
+		return 0;
+	}
+	if( word & CCLASS_TAG_SHARED ) {
+		header->cclass = (unsigned int) (word >> CCLASS_SHARED_SHIFT);
+		header->cvalue = word & CCLASS_SHARED_OFFSET;
+		return header->cclass < CREGISTRY_CLASSES && cregistry_vtables[header->cclass] != NULL;
+	}
+	word &= ~CCLASS_TAG_COMPACT;
+	header->cclass = cregistry_class_of(word, header->ccompact ? sizeof(struct cclass_compact_vtable_t) : 1);
+	if( header->cclass == CREGISTRY_CLASSES ) {
+		return 0;
+	}
+	header->cvalue = word - (uintptr_t) cregistry_vtables[header->cclass];
+	return 1;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+int cregistry_register( unsigned int id, const void* vtable, size_t size )
+{
+	if( id >= CREGISTRY_CLASSES ||
+	    (cregistry_vtables[id] != NULL && cregistry_vtables[id] != (const char*) vtable) ) {
+		return 0;
+	}
+	cregistry_vtables[id] = vtable;
+	cregistry_sizes[id] = size;
+	return 1;
+}
+
+int cregistry_headers( void* object, cregistry_header_ft visit, void* arg )
+{
+	const struct cclass_info_t* info;
+	struct cregistry_header_t header;
+	const size_t* interfaces;
+
+	info = cobject_get_info(object);
+	interfaces = info->cinterfaces;
+	header.coffset = 0;
+	for( ;; ) {
+		if( !cregistry_decode(object, info->csize, &header) ||
+		    (visit != NULL && !visit(&header, arg)) ) {
+			return 0;
+		}
+		if( interfaces == NULL || *interfaces == 0 ) {
+			return 1;
+		}
+		header.coffset = *interfaces++;
+	}
+}
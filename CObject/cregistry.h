@@ -0,0 +1,171 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	Class IDs, for objects stored where vtable addresses don't mean
+ *	anything, in a snapshot file (csnap.h) or in memory shared with other
+ *	processes (cshm.h). Each class is given an ID, the same in every
+ *	program, and its vtable is registered under the ID at startup:
+ *	@code
+ *		CREGISTRY_REGISTER(1, Rect);
+ *		CREGISTRY_REGISTER(2, Square);
+ *	@endcode
+ *	An object's headers are then walked with cregistry_headers( ), which
+ *	gives each header's offset in the object, and its vtable as a class ID
+ *	and an offset into that class' vtable. Headers are found through the
+ *	object's class descriptor, its own at offset zero and its interfaces'
+ *	at the offsets given to CCLASS_INFO_INIT_INTERFACES( ), never by
+ *	guessing from the object's contents.
+ */
+
+#ifndef CREGISTRY_H_
+#define CREGISTRY_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Class IDs are below CREGISTRY_CLASSES.
+ */
+#ifndef CREGISTRY_CLASSES
+#define CREGISTRY_CLASSES	256
+#endif
+
+/**
+ * @details
+ *	Register a class' vtable under an ID, with the class' vtable key
+ *	function and vtable structure, for example, Rect_VTable_Key( ) and
+ *	struct Rect_VTable.
+ * @param id
+ *	The class' ID.
+ * @param class
+ *	The class' name.
+ */
+#define CREGISTRY_REGISTER( id, class )						\
+	cregistry_register((id), class##_VTable_Key( ), sizeof(struct class##_VTable))
+
+/**
+ * @struct cregistry_header_t
+ * @details
+ *	A header of an object, given by cregistry_headers( ).
+ */
+struct cregistry_header_t
+{
+    /* Offset in bytes of the header from the top of the object.
+     */
+    size_t       coffset;
+
+    /* The class whose vtable the header points into, and the offset in
+     * bytes into that vtable.
+     */
+    unsigned int cclass;
+    size_t       cvalue;
+
+    /* Non zero for a compact interface, whose header has no croot.
+     */
+    int          ccompact;
+};
+
+/**
+ * @details
+ *	Called by cregistry_headers( ) for each header of an object.
+ * @returns
+ *	Non zero to carry on, zero to stop.
+ */
+typedef int (*cregistry_header_ft)( const struct cregistry_header_t* header, void* arg );
+
+/* Every registered class' vtable and the size of its vtable structure,
+ * by ID. Read only, use cregistry_register( ).
+ */
+extern const char* cregistry_vtables[CREGISTRY_CLASSES];
+extern size_t cregistry_sizes[CREGISTRY_CLASSES];
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	Register a class' vtable under an ID. Use CREGISTRY_REGISTER( ).
+ *	Classes are registered at startup, before their objects are walked.
+ * @param id
+ *	The class' ID, below CREGISTRY_CLASSES.
+ * @param vtable
+ *	The class' vtable.
+ * @param size
+ *	Size of the class' vtable structure, which holds its interfaces'
+ *	vtables.
+ * @returns
+ *	Non zero on success, zero if the ID is out of range or taken by another
+ *	vtable.
+ */
+int cregistry_register( unsigned int id, const void* vtable, size_t size );
+
+/**
+ * @details
+ *	Walk an object's headers, its own first and then its interfaces', as
+ *	its class descriptor lists them. Headers already shared by
+ *	cshm_share( ) give the class ID and offset they hold.
+ * @param object
+ *	Top of the object, see ccast( ).
+ * @param visit
+ *	Called with each header, may be NULL to only check every header's
+ *	vtable is registered.
+ * @returns
+ *	Non zero if every header's vtable is registered and visit returned non
+ *	zero for each.
+ */
+int cregistry_headers( void* object, cregistry_header_ft visit, void* arg );
+
+/**
+ * @details
+ *	The address an offset into a class' vtable stands for.
+ * @param id
+ *	The class' ID.
+ * @param value
+ *	Offset into the class' vtable.
+ * @param size
+ *	Number of bytes needed at the address.
+ * @returns
+ *	The address, or NULL if the class isn't registered or the offset is
+ *	outside its vtable.
+ */
+static inline const char* cregistry_vtable( unsigned int id, size_t value, size_t size )
+{
+	if( id >= CREGISTRY_CLASSES || cregistry_vtables[id] == NULL ||
+	    value > cregistry_sizes[id] || size > cregistry_sizes[id] - value ) {
+		return NULL;
+	}
+	return cregistry_vtables[id] + value;
+}
+
+
+#endif /* CREGISTRY_H_ */
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	Bounded multi producer multi consumer queue of pointers, shared by the
+ *	reaper's queue (creaper.c) and the thread cache's depots (ctcache.c).
+ *	Internal, not included by any public header.
+ *
+ *	The queue is an array of cells, a power of two of them, and an enqueue
+ *	and a dequeue position kept by its owner, so it can put them on their
+ *	own cache lines. Positions are claimed with a compare and swap, and a
+ *	cell's sequence number publishes its contents: it's ready to be written
+ *	when equal to the enqueue position, and to be read when one past the
+ *	dequeue position.
+ */
+
+#ifndef CRING_H_
+#define CRING_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/**
+ * @struct cring_cell_t
+ * @details
+ *	A queue cell.
+ */
+struct cring_cell_t
+{
+    size_t cseq;
+    void*  cvalue;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	Make every cell ready for the first lap of writes. The positions start
+ *	at zero.
+ * @param cells
+ *	The queue's cells.
+ * @param capacity
+ *	Number of cells, a power of two.
+ */
+static inline void cring_init( struct cring_cell_t* cells, size_t capacity )
+{
+	size_t i;
+
+	for( i = 0; i < capacity; ++i ) {
+		__atomic_store_n(&cells[i].cseq, i, __ATOMIC_RELAXED);
+		cells[i].cvalue = NULL;
+	}
+}
+
+/**
+ * @details
+ *	Put a value at the back of the queue. The enqueue position only moves
+ *	once the value has a cell.
+ * @param enqueue
+ *	The queue's enqueue position.
+ * @param cells
+ *	The queue's cells.
+ * @param mask
+ *	Number of cells less one.
+ * @returns
+ *	Non zero on success, zero if the queue is full.
+ */
+static inline int cring_enqueue( size_t* enqueue, struct cring_cell_t* cells, size_t mask, void* value )
+{
+	struct cring_cell_t* cell;
+	size_t pos, seq;
+	long diff;
+
+	pos = __atomic_load_n(enqueue, __ATOMIC_RELAXED);
+	for( ;; ) {
+		cell = &cells[pos & mask];
+		seq = __atomic_load_n(&cell->cseq, __ATOMIC_ACQUIRE);
+		diff = (long) seq - (long) pos;
+		if( diff == 0 ) {
+			if( __atomic_compare_exchange_n(enqueue, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ) {
+				break;
+			}
+		}
+		else if( diff < 0 ) {
+			/* Full. */
+			return 0;
+		}
+		else {
+			pos = __atomic_load_n(enqueue, __ATOMIC_RELAXED);
+		}
+	}
+	cell->cvalue = value;
+	__atomic_store_n(&cell->cseq, pos + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/**
+ * @details
+ *	Take the value at the front of the queue.
+ * @param dequeue
+ *	The queue's dequeue position.
+ * @param cells
+ *	The queue's cells.
+ * @param mask
+ *	Number of cells less one.
+ * @returns
+ *	The value, or NULL if the queue is empty or its front cell is claimed
+ *	but not yet written.
+ */
+static inline void* cring_dequeue( size_t* dequeue, struct cring_cell_t* cells, size_t mask )
+{
+	struct cring_cell_t* cell;
+	size_t pos, seq;
+	void* value;
+	long diff;
+
+	pos = __atomic_load_n(dequeue, __ATOMIC_RELAXED);
+	for( ;; ) {
+		cell = &cells[pos & mask];
+		seq = __atomic_load_n(&cell->cseq, __ATOMIC_ACQUIRE);
+		diff = (long) seq - (long) (pos + 1);
+		if( diff == 0 ) {
+			if( __atomic_compare_exchange_n(dequeue, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ) {
+				break;
+			}
+		}
+		else if( diff < 0 ) {
+			/* Empty, or the next cell is claimed but not yet written. */
+			return NULL;
+		}
+		else {
+			pos = __atomic_load_n(dequeue, __ATOMIC_RELAXED);
+		}
+	}
+	value = cell->cvalue;
+	__atomic_store_n(&cell->cseq, pos + mask + 1, __ATOMIC_RELEASE);
+	return value;
+}
+
+
+#endif /* CRING_H_ */
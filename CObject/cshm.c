@@ -0,0 +1,325 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cshm.h"
+#include "cobject.h"
+#include "cregistry.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+#define CSHM_MAGIC	"CSHM\0\0\0\0"
+#define CSHM_VERSION	1
+
+/* Blocks are this aligned, and found by their offset over this in the free
+ * lists, so a segment is at most 2^32 times this.
+ */
+#define CSHM_ALIGN	16
+#define CSHM_MAX_SEGMENT	((uint64_t) CSHM_ALIGN << 32)
+
+/* A free list's head is the offset of its first block over CSHM_ALIGN, in
+ * the low half, and a count of changes to it in the high half.
+ */
+#define CSHM_HEAD_OFFSET	((uint64_t) 0xFFFFFFFF)
+#define CSHM_HEAD_COUNT		((uint64_t) 1 << 32)
+
+/* Older kernels take the address as a hint, which is checked.
+ */
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0
+#endif
+
+/* Start of the segment.
+ */
+struct cshm_segment_t
+{
+    char     cmagic[8];
+    uint32_t cversion;
+    uint32_t cpointer_size;
+    uint64_t csize;
+    uint64_t cbase;
+
+    /* Offset of the unused part of the segment, and of the root object.
+     */
+    uint64_t ctop;
+    uint64_t croot;
+
+    uint64_t cfree[CSHM_SIZES];
+};
+
+/* In front of every block. A free block's first word is the offset of the
+ * next in its list, over CSHM_ALIGN.
+ */
+struct cshm_block_t
+{
+    uint64_t coffset;
+    uint64_t csize;
+};
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static size_t cshm_first_block( void )
+{
+	return (sizeof(struct cshm_segment_t) + CSHM_ALIGN - 1) / CSHM_ALIGN * CSHM_ALIGN;
+}
+
+/* The power of two size which holds size bytes.
+ */
+static unsigned int cshm_size_class( size_t size )
+{
+	unsigned int class;
+
+	for( class = 0; class < CSHM_SIZES && ((size_t) CSHM_MIN_SIZE << class) < size; ++class ) {
+		continue;
+	}
+	return class;
+}
+
+#ifdef CSHM
+/* Whether a header's offset into its vtable fits a shared header.
+ */
+static int cshm_check( const struct cregistry_header_t* header, void* arg )
+{
+	(void) arg;
+	return header->cvalue <= CCLASS_SHARED_OFFSET;
+}
+
+/* Write a header as its class ID and offset into the class' vtable.
+ */
+static int cshm_tag( const struct cregistry_header_t* header, void* root )
+{
+	uintptr_t word;
+
+	word = ((uintptr_t) header->cclass << CCLASS_SHARED_SHIFT) | header->cvalue | CCLASS_TAG_SHARED;
+	if( header->ccompact ) {
+		word |= CCLASS_TAG_COMPACT;
+	}
+	memcpy((char*) root + header->coffset, &word, sizeof(word));
+	return 1;
+}
+#endif
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+int cshm_create( struct cshm_t* self, const char* name, size_t size )
+{
+	struct cshm_segment_t* segment;
+	void* map;
+	int fd;
+
+	self->csegment = NULL;
+	self->csize = 0;
+	if( size < cshm_first_block( ) || (uint64_t) size > CSHM_MAX_SEGMENT ) {
+		return 0;
+	}
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if( fd < 0 ) {
+		return 0;
+	}
+	if( ftruncate(fd, (off_t) size) != 0 ) {
+		close(fd);
+		shm_unlink(name);
+		return 0;
+	}
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if( map == MAP_FAILED ) {
+		shm_unlink(name);
+		return 0;
+	}
+
+	/* The object starts zeroed, so the free lists are empty. */
+	segment = map;
+	segment->cversion = CSHM_VERSION;
+	segment->cpointer_size = sizeof(void*);
+	segment->csize = size;
+	segment->cbase = (uintptr_t) map;
+	segment->ctop = cshm_first_block( );
+	segment->croot = 0;
+	memcpy(segment->cmagic, CSHM_MAGIC, sizeof(segment->cmagic));
+	self->csegment = segment;
+	self->csize = size;
+	return 1;
+}
+
+int cshm_open( struct cshm_t* self, const char* name )
+{
+	struct cshm_segment_t header;
+	struct stat status;
+	void* map;
+	int fd;
+
+	self->csegment = NULL;
+	self->csize = 0;
+	fd = shm_open(name, O_RDWR, 0);
+	if( fd < 0 ) {
+		return 0;
+	}
+	if( fstat(fd, &status) != 0 ||
+	    pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header) ||
+	    memcmp(header.cmagic, CSHM_MAGIC, sizeof(header.cmagic)) != 0 ||
+	    header.cversion != CSHM_VERSION ||
+	    header.cpointer_size != sizeof(void*) ||
+	    header.csize != (uint64_t) status.st_size ) {
+		close(fd);
+		return 0;
+	}
+	map = mmap((void*) (uintptr_t) header.cbase, header.csize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+	close(fd);
+	if( map == MAP_FAILED ) {
+		return 0;
+	}
+	if( (uintptr_t) map != header.cbase ) {
+		munmap(map, header.csize);
+		return 0;
+	}
+	self->csegment = map;
+	self->csize = header.csize;
+	return 1;
+}
+
+void cshm_close( struct cshm_t* self )
+{
+	if( self->csegment != NULL ) {
+		munmap(self->csegment, self->csize);
+	}
+	self->csegment = NULL;
+	self->csize = 0;
+}
+
+int cshm_unlink( const char* name )
+{
+	return shm_unlink(name) == 0;
+}
+
+void* cshm_alloc( struct cshm_t* self, size_t size )
+{
+	struct cshm_segment_t* segment;
+	struct cshm_block_t* block;
+	uint64_t head, next, top, end;
+	unsigned int class;
+
+	segment = self->csegment;
+	class = cshm_size_class(size);
+	if( class >= CSHM_SIZES ) {
+		return NULL;
+	}
+
+	/* A freed block, the count in the head fails the exchange if the
+	 * block was taken and given back in between.
+	 */
+	head = __atomic_load_n(&segment->cfree[class], __ATOMIC_ACQUIRE);
+	while( (head & CSHM_HEAD_OFFSET) != 0 ) {
+		block = (struct cshm_block_t*) ((char*) segment + (head & CSHM_HEAD_OFFSET) * CSHM_ALIGN);
+		next = __atomic_load_n((uint64_t*) (block + 1), __ATOMIC_RELAXED);
+		if( __atomic_compare_exchange_n(&segment->cfree[class], &head, (head & ~CSHM_HEAD_OFFSET) + CSHM_HEAD_COUNT + next,
+						1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) ) {
+			return block + 1;
+		}
+	}
+
+	/* Or a new one. */
+	top = __atomic_load_n(&segment->ctop, __ATOMIC_RELAXED);
+	do {
+		end = top + sizeof(*block) + ((uint64_t) CSHM_MIN_SIZE << class);
+		if( end > segment->csize ) {
+			return NULL;
+		}
+	} while( !__atomic_compare_exchange_n(&segment->ctop, &top, end, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED) );
+	block = (struct cshm_block_t*) ((char*) segment + top);
+	block->coffset = top;
+	block->csize = class;
+	return block + 1;
+}
+
+void cshm_free( void* block_ )
+{
+	struct cshm_segment_t* segment;
+	struct cshm_block_t* block;
+	uint64_t head, self;
+
+	if( block_ == NULL ) {
+		return;
+	}
+	block = (struct cshm_block_t*) block_ - 1;
+	segment = (struct cshm_segment_t*) ((char*) block - block->coffset);
+	self = block->coffset / CSHM_ALIGN;
+
+	head = __atomic_load_n(&segment->cfree[block->csize], __ATOMIC_RELAXED);
+	do {
+		__atomic_store_n((uint64_t*) block_, head & CSHM_HEAD_OFFSET, __ATOMIC_RELAXED);
+	} while( !__atomic_compare_exchange_n(&segment->cfree[block->csize], &head, (head & ~CSHM_HEAD_OFFSET) + CSHM_HEAD_COUNT + self,
+					      1, __ATOMIC_RELEASE, __ATOMIC_RELAXED) );
+}
+
+int cshm_share( void* object )
+{
+#ifdef CSHM
+	char* root;
+
+	root = ccast(object);
+	if( !cregistry_headers(root, cshm_check, NULL) ) {
+		return 0;
+	}
+	cregistry_headers(root, cshm_tag, root);
+	((struct cobject_t*) root)->cfree = NULL;
+	return 1;
+#else
+	(void) object;
+	return 0;
+#endif
+}
+
+void cshm_set_root( struct cshm_t* self, void* object )
+{
+	uint64_t offset;
+
+	offset = object == NULL ? 0 : (uint64_t) ((char*) object - (char*) self->csegment);
+	__atomic_store_n(&self->csegment->croot, offset, __ATOMIC_RELEASE);
+}
+
+void* cshm_root( struct cshm_t* self )
+{
+	uint64_t offset;
+
+	offset = __atomic_load_n(&self->csegment->croot, __ATOMIC_ACQUIRE);
+	return offset == 0 ? NULL : (char*) self->csegment + offset;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	A heap of objects in POSIX shared memory, which several processes map
+ *	and read the same objects from, instead of each building a copy.
+ *
+ *	The segment is mapped at the same address in every process, so croot,
+ *	and pointers between objects in the heap, are the same everywhere.
+ *	Vtable addresses aren't, so objects in the heap are shared with
+ *	cshm_share( ), which writes their headers as a class ID and an offset
+ *	into that class' vtable, tagged with CCLASS_TAG_SHARED. Builds with CSHM
+ *	defined (make CSHM=1) resolve them in cclass_get_vtable( ) and ccast( ),
+ *	through the vtables registered under each ID in the calling process,
+ *	see cregistry.h. Every process must register the classes it uses under
+ *	the same IDs:
+ *	@code
+ *		CREGISTRY_REGISTER(1, Rect);
+ *
+ *		cshm_create(&heap, "/shapes", 64 << 20);
+ *		rect = cnew_in(cshm_alloc(&heap, sizeof(struct Rect)), Rect, 3, 4);
+ *		cshm_share(rect);
+ *		cshm_set_root(&heap, rect);
+ *	@endcode
+ *	and in the other processes:
+ *	@code
+ *		CREGISTRY_REGISTER(1, Rect);
+ *
+ *		cshm_open(&heap, "/shapes");
+ *		area = Rect_area(cshm_root(&heap));
+ *	@endcode
+ *	Method wrappers which read the vtable pointer themselves, instead of
+ *	with cclass_get_vtable( ) or cclass_get_object_vtable( ), can't call
+ *	methods of shared objects.
+ *
+ *	Memory is allocated in the segment without locks, by any process. Each
+ *	power of two size has a free list, a stack kept as offsets into the
+ *	segment with a generation count against ABA, and new blocks are taken
+ *	from the end of the used part of the segment. Freed blocks are only
+ *	reused for their own size.
+ *
+ *	A shared object has no free method, since function addresses differ
+ *	between processes too. Destroy it with cdestroy( ), then give it back
+ *	with cshm_free( ).
+ */
+
+#ifndef CSHM_H_
+#define CSHM_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Smallest block, and the number of power of two sizes.
+ */
+#define CSHM_MIN_SIZE	16
+#define CSHM_SIZES	32
+
+struct cshm_segment_t;
+
+/**
+ * @struct cshm_t
+ * @details
+ *	A process' mapping of a shared heap. Members are read only.
+ */
+struct cshm_t
+{
+    struct cshm_segment_t* csegment;
+    size_t                 csize;
+};
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof cshm_t
+ * @details
+ *	Create a shared memory object and map it as an empty heap.
+ * @param name
+ *	Name of the shared memory object, like "/shapes", see shm_open( ). It
+ *	must not exist.
+ * @param size
+ *	Size of the segment in bytes.
+ * @returns
+ *	Non zero on success, zero on failure.
+ */
+int cshm_create( struct cshm_t* self, const char* name, size_t size );
+
+/**
+ * @memberof cshm_t
+ * @details
+ *	Map a heap made by cshm_create( ), at the address it has in the process
+ *	which made it.
+ * @returns
+ *	Non zero on success, zero if it doesn't exist, isn't a heap, or the
+ *	address is taken in this process.
+ */
+int cshm_open( struct cshm_t* self, const char* name );
+
+/**
+ * @memberof cshm_t
+ * @details
+ *	Unmap the heap. The shared memory object lives on until cshm_unlink( ).
+ */
+void cshm_close( struct cshm_t* self );
+
+/**
+ * @details
+ *	Remove a shared memory object's name, see shm_unlink( ). Processes
+ *	which have it mapped keep it.
+ * @returns
+ *	Non zero on success, zero on failure.
+ */
+int cshm_unlink( const char* name );
+
+/**
+ * @memberof cshm_t
+ * @details
+ *	Allocate a block in the heap. It's aligned for any type.
+ * @returns
+ *	The block, or NULL if the segment is full.
+ */
+void* cshm_alloc( struct cshm_t* self, size_t size );
+
+/**
+ * @details
+ *	Give back a block from cshm_alloc( ), in any process.
+ * @param block
+ *	The block, or NULL.
+ */
+void cshm_free( void* block );
+
+/**
+ * @details
+ *	Write the headers of an object, and every interface it implements, in
+ *	the form every process can use. Headers are found with
+ *	cregistry_headers( ), from the object's class descriptor. Its free method is cleared. Only objects
+ *	in a shared heap should be shared.
+ * @param object
+ *	The object, or any of its interfaces.
+ * @returns
+ *	Non zero on success, zero if a class of the object isn't registered, in
+ *	which case the object is unchanged, or the library wasn't built with CSHM
+ *	defined.
+ */
+int cshm_share( void* object );
+
+/**
+ * @memberof cshm_t
+ * @details
+ *	Set the object other processes find with cshm_root( ).
+ * @param object
+ *	An object in the heap, or NULL.
+ */
+void cshm_set_root( struct cshm_t* self, void* object );
+
+/**
+ * @memberof cshm_t
+ * @returns
+ *	The object set with cshm_set_root( ), or NULL.
+ */
+void* cshm_root( struct cshm_t* self );
+
+
+#endif /* CSHM_H_ */
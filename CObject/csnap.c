@@ -0,0 +1,759 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "csnap.h"
+#include "cobject.h"
+#include "cregistry.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+#define CSNAP_MAGIC	"CSNAP\0\0\0"
+#define CSNAP_VERSION	1
+
+/* The image starts on a page boundary, so objects in the mapping are
+ * aligned like they were in the file.
+ */
+#define CSNAP_PAGE	4096
+
+/* The file starts with this, followed by the object, template, header and
+ * pointer tables, and the image of the objects.
+ */
+struct csnap_file_t
+{
+    char     cmagic[8];
+    uint32_t cversion;
+    uint32_t cpointer_size;
+    uint64_t cobject_count;
+    uint64_t ctemplate_count;
+    uint64_t cheader_count;
+    uint64_t cpointer_count;
+    uint64_t cimage_offset;
+    uint64_t cimage_size;
+};
+
+/* An object in the image, its template, and its range of the pointer
+ * table.
+ */
+struct csnap_object_t
+{
+    uint64_t coffset;
+    uint64_t cfirst_pointer;
+    uint32_t cpointer_count;
+    uint32_t ctemplate;
+};
+
+/* A range of the header table, shared by objects with the same headers.
+ */
+struct csnap_template_t
+{
+    uint32_t cfirst;
+    uint32_t ccount;
+};
+
+/* Kinds of header word.
+ */
+#define CSNAP_HEADER_VTABLE	1
+#define CSNAP_HEADER_COMPACT	2
+#define CSNAP_HEADER_ROOT	3
+
+/* A header word coffset bytes into an object, set to cvalue bytes into the
+ * vtable of class cclass, or to the object for CSNAP_HEADER_ROOT.
+ */
+struct csnap_header_t
+{
+    uint32_t coffset;
+    uint32_t ckind;
+    uint32_t cclass;
+    uint32_t cvalue;
+};
+
+/* A pointer field at coffset in the image, set to cvalue bytes into it.
+ */
+struct csnap_pointer_t
+{
+    uint64_t coffset;
+    uint64_t cvalue;
+};
+
+/* A pointer field being written, with the object it belongs to.
+ */
+struct csnap_pending_t
+{
+    size_t                 cobject;
+    struct csnap_pointer_t cpointer;
+};
+
+/* Objects and their place in the image while a snapshot is written.
+ */
+struct csnap_layout_t
+{
+    char*    caddress;
+    size_t   csize;
+    size_t   coffset;
+    uint32_t ctemplate;
+};
+
+/* Everything csnap_write( ) builds, freed together.
+ */
+struct csnap_build_t
+{
+    struct csnap_layout_t*   clayouts;
+    struct csnap_layout_t**  csorted;
+    struct csnap_template_t* ctemplates;
+    size_t                   ctemplate_count;
+    size_t                   ctemplate_capacity;
+    struct csnap_header_t*   cheaders;
+    size_t                   cheader_count;
+    size_t                   cheader_capacity;
+    struct csnap_pending_t*  cpending;
+    size_t                   cpending_count;
+    size_t                   cpending_capacity;
+    char*                    cimage;
+    size_t                   cimage_size;
+
+    /* Template last used by each class, tried first.
+     */
+    uint32_t                 clast[CREGISTRY_CLASSES];
+};
+
+/* States of an object of a lazily loaded snapshot.
+ */
+#define CSNAP_UNFIXED	0
+#define CSNAP_FIXING	1
+#define CSNAP_FIXED	2
+#define CSNAP_FAILED	3
+
+/* An object whose headers are being emitted, and its class.
+ */
+struct csnap_emit_t
+{
+    struct csnap_build_t*  cbuild;
+    struct csnap_layout_t* clayout;
+    unsigned int           cclass;
+};
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static int csnap_grow( void* array, size_t* capacity, size_t count, size_t size )
+{
+	void* grown;
+	size_t new_capacity;
+
+	if( count < *capacity ) {
+		return 1;
+	}
+	new_capacity = *capacity == 0 ? 16 : *capacity * 2;
+	grown = realloc(*(void**) array, new_capacity * size);
+	if( grown == NULL ) {
+		return 0;
+	}
+	*(void**) array = grown;
+	*capacity = new_capacity;
+	return 1;
+}
+
+static int csnap_compare_address( const void* a_, const void* b_ )
+{
+	const struct csnap_layout_t* const* a = a_;
+	const struct csnap_layout_t* const* b = b_;
+
+	return (*a)->caddress < (*b)->caddress ? -1 : (*a)->caddress > (*b)->caddress;
+}
+
+static int csnap_compare_pending( const void* a_, const void* b_ )
+{
+	const struct csnap_pending_t* a = a_;
+	const struct csnap_pending_t* b = b_;
+
+	if( a->cobject != b->cobject ) {
+		return a->cobject < b->cobject ? -1 : 1;
+	}
+	return a->cpointer.coffset < b->cpointer.coffset ? -1 : a->cpointer.coffset > b->cpointer.coffset;
+}
+
+/* The object holding an address, from objects sorted by address.
+ */
+static struct csnap_layout_t* csnap_find( struct csnap_layout_t** sorted, size_t count, const void* address )
+{
+	size_t low, high, mid;
+
+	low = 0;
+	high = count;
+	while( low < high ) {
+		mid = low + (high - low) / 2;
+		if( (const char*) address < sorted[mid]->caddress ) {
+			high = mid;
+		}
+		else if( (const char*) address >= sorted[mid]->caddress + sorted[mid]->csize ) {
+			low = mid + 1;
+		}
+		else {
+			return sorted[mid];
+		}
+	}
+	return NULL;
+}
+
+static int csnap_emit_header( struct csnap_build_t* build, size_t offset, uint32_t kind, uint32_t class, uintptr_t value )
+{
+	struct csnap_header_t* header;
+
+	if( !csnap_grow(&build->cheaders, &build->cheader_capacity, build->cheader_count, sizeof(*build->cheaders)) ) {
+		return 0;
+	}
+	header = &build->cheaders[build->cheader_count++];
+	header->coffset = (uint32_t) offset;
+	header->ckind = kind;
+	header->cclass = class;
+	header->cvalue = (uint32_t) value;
+	return 1;
+}
+
+/* Append a header to the header table, and zero it in the image, it's
+ * written on load.
+ */
+static int csnap_emit_word( const struct cregistry_header_t* header, void* arg )
+{
+	struct csnap_emit_t* emit = arg;
+	struct csnap_build_t* build;
+	size_t words;
+
+	build = emit->cbuild;
+	if( header->cvalue > UINT32_MAX ) {
+		return 0;
+	}
+	if( header->coffset == 0 ) {
+		emit->cclass = header->cclass;
+	}
+	if( header->ccompact ) {
+		words = 1;
+		if( !csnap_emit_header(build, header->coffset, CSNAP_HEADER_COMPACT, header->cclass, header->cvalue) ) {
+			return 0;
+		}
+	}
+	else {
+		words = 2;
+		if( !csnap_emit_header(build, header->coffset, CSNAP_HEADER_VTABLE, header->cclass, header->cvalue) ||
+		    !csnap_emit_header(build, header->coffset + sizeof(void*), CSNAP_HEADER_ROOT, 0, 0) ) {
+			return 0;
+		}
+	}
+	memset(build->cimage + emit->clayout->coffset + header->coffset, 0, words * sizeof(void*));
+	return 1;
+}
+
+/* Append the headers of an object, from its class descriptor, to the
+ * header table, and find the template they make.
+ */
+static int csnap_emit_template( struct csnap_build_t* build, size_t object )
+{
+	const struct csnap_template_t* template;
+	struct csnap_layout_t* layout;
+	struct csnap_emit_t emit;
+	unsigned int object_class;
+	size_t first, count;
+	uint32_t t;
+
+	layout = &build->clayouts[object];
+	first = build->cheader_count;
+	emit.cbuild = build;
+	emit.clayout = layout;
+	if( !cregistry_headers(layout->caddress, csnap_emit_word, &emit) ) {
+		return 0;
+	}
+	object_class = emit.cclass;
+	count = build->cheader_count - first;
+
+	/* Objects of a class nearly always share its last template. */
+	for( t = build->clast[object_class]; t < build->ctemplate_count; ++t ) {
+		template = &build->ctemplates[t];
+		if( template->ccount == count &&
+		    memcmp(&build->cheaders[template->cfirst], &build->cheaders[first], count * sizeof(*build->cheaders)) == 0 ) {
+			build->cheader_count = first;
+			layout->ctemplate = t;
+			return 1;
+		}
+	}
+	for( t = 0; t < build->clast[object_class] && t < build->ctemplate_count; ++t ) {
+		template = &build->ctemplates[t];
+		if( template->ccount == count &&
+		    memcmp(&build->cheaders[template->cfirst], &build->cheaders[first], count * sizeof(*build->cheaders)) == 0 ) {
+			build->cheader_count = first;
+			build->clast[object_class] = t;
+			layout->ctemplate = t;
+			return 1;
+		}
+	}
+
+	if( !csnap_grow(&build->ctemplates, &build->ctemplate_capacity, build->ctemplate_count, sizeof(*build->ctemplates)) ) {
+		return 0;
+	}
+	build->ctemplates[build->ctemplate_count].cfirst = (uint32_t) first;
+	build->ctemplates[build->ctemplate_count].ccount = (uint32_t) count;
+	build->clast[object_class] = (uint32_t) build->ctemplate_count;
+	layout->ctemplate = (uint32_t) build->ctemplate_count++;
+	return 1;
+}
+
+static int csnap_emit_field( struct csnap_build_t* build, size_t count, void** field )
+{
+	struct csnap_layout_t* owner;
+	struct csnap_layout_t* target;
+	struct csnap_pending_t* pending;
+	size_t offset;
+	void* pointer;
+
+	owner = csnap_find(build->csorted, count, field);
+	if( owner == NULL || (const char*) (field + 1) > owner->caddress + owner->csize ) {
+		return 0;
+	}
+	offset = owner->coffset + (size_t) ((char*) field - owner->caddress);
+	memset(build->cimage + offset, 0, sizeof(void*));
+	pointer = *field;
+	if( pointer == NULL ) {
+		return 1;
+	}
+	target = csnap_find(build->csorted, count, pointer);
+	if( target == NULL ) {
+		return 0;
+	}
+
+	if( !csnap_grow(&build->cpending, &build->cpending_capacity, build->cpending_count, sizeof(*build->cpending)) ) {
+		return 0;
+	}
+	pending = &build->cpending[build->cpending_count++];
+	pending->cobject = (size_t) (owner - build->clayouts);
+	pending->cpointer.coffset = offset;
+	pending->cpointer.cvalue = target->coffset + (size_t) ((char*) pointer - target->caddress);
+	return 1;
+}
+
+static int csnap_write_file( struct csnap_build_t* build, size_t count, const char* path )
+{
+	static const char padding[CSNAP_PAGE];
+	struct csnap_file_t header;
+	struct csnap_object_t object;
+	size_t i, j, written;
+	FILE* file;
+	int ok;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.cmagic, CSNAP_MAGIC, sizeof(header.cmagic));
+	header.cversion = CSNAP_VERSION;
+	header.cpointer_size = sizeof(void*);
+	header.cobject_count = count;
+	header.ctemplate_count = build->ctemplate_count;
+	header.cheader_count = build->cheader_count;
+	header.cpointer_count = build->cpending_count;
+	written = sizeof(header) +
+		  count * sizeof(struct csnap_object_t) +
+		  build->ctemplate_count * sizeof(struct csnap_template_t) +
+		  build->cheader_count * sizeof(struct csnap_header_t) +
+		  build->cpending_count * sizeof(struct csnap_pointer_t);
+	header.cimage_offset = (written + CSNAP_PAGE - 1) / CSNAP_PAGE * CSNAP_PAGE;
+	header.cimage_size = build->cimage_size;
+
+	file = fopen(path, "wb");
+	if( file == NULL ) {
+		return 0;
+	}
+	ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+	/* Pointers are sorted by object, each object's are a range. */
+	for( i = 0, j = 0; ok && i < count; ++i ) {
+		object.coffset = build->clayouts[i].coffset;
+		object.ctemplate = build->clayouts[i].ctemplate;
+		object.cfirst_pointer = j;
+		while( j < build->cpending_count && build->cpending[j].cobject == i ) {
+			++j;
+		}
+		object.cpointer_count = (uint32_t) (j - object.cfirst_pointer);
+		ok = fwrite(&object, sizeof(object), 1, file) == 1;
+	}
+	if( ok && build->ctemplate_count > 0 ) {
+		ok = fwrite(build->ctemplates, sizeof(*build->ctemplates), build->ctemplate_count, file) == build->ctemplate_count;
+	}
+	if( ok && build->cheader_count > 0 ) {
+		ok = fwrite(build->cheaders, sizeof(*build->cheaders), build->cheader_count, file) == build->cheader_count;
+	}
+	for( i = 0; ok && i < build->cpending_count; ++i ) {
+		ok = fwrite(&build->cpending[i].cpointer, sizeof(struct csnap_pointer_t), 1, file) == 1;
+	}
+	if( ok && written < header.cimage_offset ) {
+		ok = fwrite(padding, header.cimage_offset - written, 1, file) == 1;
+	}
+	if( ok && build->cimage_size > 0 ) {
+		ok = fwrite(build->cimage, build->cimage_size, 1, file) == 1;
+	}
+	if( fclose(file) != 0 ) {
+		ok = 0;
+	}
+	return ok;
+}
+
+/* Write the addresses of an object's headers and pointer fields.
+ */
+static int csnap_fix( struct csnap_t* self, size_t index )
+{
+	const struct csnap_object_t* object;
+	const struct csnap_template_t* template;
+	const struct csnap_header_t* header;
+	const struct csnap_pointer_t* pointer;
+	const char* vtable;
+	uintptr_t address;
+	char* base;
+	uint32_t i;
+
+	object = &self->cobjects[index];
+	if( object->ctemplate >= self->ctemplate_count || object->coffset >= self->cimage_size ||
+	    object->cfirst_pointer > self->cpointer_count || object->cpointer_count > self->cpointer_count - object->cfirst_pointer ) {
+		return 0;
+	}
+	template = &self->ctemplates[object->ctemplate];
+	base = self->cimage + object->coffset;
+
+	for( i = 0; i < template->ccount; ++i ) {
+		header = &self->cheaders[template->cfirst + i];
+		if( header->coffset > self->cimage_size - object->coffset - sizeof(void*) ) {
+			return 0;
+		}
+		if( header->ckind == CSNAP_HEADER_ROOT ) {
+			address = (uintptr_t) base;
+		}
+		else {
+			vtable = cregistry_vtable(header->cclass, header->cvalue,
+						  header->ckind == CSNAP_HEADER_COMPACT ? sizeof(struct cclass_compact_vtable_t) : 1);
+			if( vtable == NULL ) {
+				return 0;
+			}
+			address = (uintptr_t) vtable;
+			if( header->ckind == CSNAP_HEADER_COMPACT ) {
+				address |= CCLASS_TAG_COMPACT;
+			}
+		}
+		*(uintptr_t*) (base + header->coffset) = address;
+	}
+
+	for( i = 0; i < object->cpointer_count; ++i ) {
+		pointer = &self->cpointers[object->cfirst_pointer + i];
+		if( pointer->cvalue >= self->cimage_size || pointer->coffset > self->cimage_size - sizeof(void*) ) {
+			return 0;
+		}
+		*(uintptr_t*) (self->cimage + pointer->coffset) = (uintptr_t) (self->cimage + pointer->cvalue);
+	}
+	return 1;
+}
+
+/* Fix up an object of a lazily loaded snapshot once, waiting for another
+ * thread which is fixing it.
+ */
+static int csnap_fix_once( struct csnap_t* self, size_t index )
+{
+	unsigned char state;
+
+	state = __atomic_load_n(&self->cstates[index], __ATOMIC_ACQUIRE);
+	while( state != CSNAP_FIXED ) {
+		if( state == CSNAP_FAILED ) {
+			return 0;
+		}
+		if( state == CSNAP_UNFIXED &&
+		    __atomic_compare_exchange_n(&self->cstates[index], &state, CSNAP_FIXING, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) ) {
+			state = csnap_fix(self, index) ? CSNAP_FIXED : CSNAP_FAILED;
+			__atomic_store_n(&self->cstates[index], state, __ATOMIC_RELEASE);
+			continue;
+		}
+		sched_yield( );
+		state = __atomic_load_n(&self->cstates[index], __ATOMIC_ACQUIRE);
+	}
+	return 1;
+}
+
+/* Check the tables of a mapped file fit before its image, and templates'
+ * ranges of the header table. Objects are checked as they're fixed up.
+ */
+static int csnap_check( struct csnap_t* self, const struct csnap_file_t* header )
+{
+	uint64_t i, tables;
+
+	if( self->cmap_size < sizeof(*header) ||
+	    memcmp(header->cmagic, CSNAP_MAGIC, sizeof(header->cmagic)) != 0 ||
+	    header->cversion != CSNAP_VERSION ||
+	    header->cpointer_size != sizeof(void*) ||
+	    header->cobject_count > self->cmap_size || header->ctemplate_count > self->cmap_size ||
+	    header->cheader_count > self->cmap_size || header->cpointer_count > self->cmap_size ) {
+		return 0;
+	}
+	tables = sizeof(*header) +
+		 header->cobject_count * sizeof(struct csnap_object_t) +
+		 header->ctemplate_count * sizeof(struct csnap_template_t) +
+		 header->cheader_count * sizeof(struct csnap_header_t) +
+		 header->cpointer_count * sizeof(struct csnap_pointer_t);
+	if( tables > header->cimage_offset || header->cimage_offset % CSNAP_PAGE != 0 ||
+	    header->cimage_offset > self->cmap_size || header->cimage_size > self->cmap_size - header->cimage_offset ||
+	    header->cimage_size < sizeof(void*) ) {
+		return 0;
+	}
+
+	self->cobjects = (const struct csnap_object_t*) (header + 1);
+	self->cobject_count = header->cobject_count;
+	self->ctemplates = (const struct csnap_template_t*) (self->cobjects + self->cobject_count);
+	self->ctemplate_count = header->ctemplate_count;
+	self->cheaders = (const struct csnap_header_t*) (self->ctemplates + self->ctemplate_count);
+	self->cheader_count = header->cheader_count;
+	self->cpointers = (const struct csnap_pointer_t*) (self->cheaders + self->cheader_count);
+	self->cpointer_count = header->cpointer_count;
+	self->cimage = (char*) self->cmap + header->cimage_offset;
+	self->cimage_size = header->cimage_size;
+
+	for( i = 0; i < self->ctemplate_count; ++i ) {
+		if( self->ctemplates[i].cfirst > self->cheader_count ||
+		    self->ctemplates[i].ccount > self->cheader_count - self->ctemplates[i].cfirst ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void csnap_writer_init( struct csnap_writer_t* self )
+{
+	self->cobjects = NULL;
+	self->cobject_count = 0;
+	self->cobject_capacity = 0;
+	self->cfields = NULL;
+	self->cfield_count = 0;
+	self->cfield_capacity = 0;
+}
+
+void csnap_writer_destroy( struct csnap_writer_t* self )
+{
+	free(self->cobjects);
+	free(self->cfields);
+	csnap_writer_init(self);
+}
+
+int csnap_add( struct csnap_writer_t* self, void* object )
+{
+	if( !csnap_grow(&self->cobjects, &self->cobject_capacity, self->cobject_count, sizeof(*self->cobjects)) ) {
+		return 0;
+	}
+	self->cobjects[self->cobject_count++] = ccast(object);
+	return 1;
+}
+
+int csnap_pointer( struct csnap_writer_t* self, void** field )
+{
+	if( !csnap_grow(&self->cfields, &self->cfield_capacity, self->cfield_count, sizeof(*self->cfields)) ) {
+		return 0;
+	}
+	self->cfields[self->cfield_count++] = field;
+	return 1;
+}
+
+int csnap_write( struct csnap_writer_t* self, const char* path )
+{
+	const struct cclass_info_t* info;
+	struct csnap_build_t* build;
+	size_t i, count, offset, align;
+	int ok;
+
+	build = calloc(1, sizeof(*build));
+	if( build == NULL ) {
+		return 0;
+	}
+	count = self->cobject_count;
+	build->clayouts = malloc((count + 1) * sizeof(*build->clayouts));
+	build->csorted = malloc((count + 1) * sizeof(*build->csorted));
+	ok = count > 0 && build->clayouts != NULL && build->csorted != NULL;
+
+	/* Lay objects out in the order they were added. */
+	for( i = 0, offset = 0; ok && i < count; ++i ) {
+		info = cobject_get_info(self->cobjects[i]);
+		align = info->calign < sizeof(void*) ? sizeof(void*) : info->calign;
+		offset = (offset + align - 1) / align * align;
+		build->clayouts[i].caddress = self->cobjects[i];
+		build->clayouts[i].csize = info->csize;
+		build->clayouts[i].coffset = offset;
+		build->csorted[i] = &build->clayouts[i];
+		offset += info->csize;
+	}
+	build->cimage_size = offset;
+
+	if( ok ) {
+		qsort(build->csorted, count, sizeof(*build->csorted), csnap_compare_address);
+		for( i = 1; i < count; ++i ) {
+			if( build->csorted[i - 1]->caddress + build->csorted[i - 1]->csize > build->csorted[i]->caddress ) {
+				ok = 0;
+			}
+		}
+	}
+	if( ok ) {
+		build->cimage = malloc(build->cimage_size);
+		ok = build->cimage != NULL;
+	}
+	if( ok ) {
+		memset(build->cimage, 0, build->cimage_size);
+	}
+	for( i = 0; ok && i < count; ++i ) {
+		memcpy(build->cimage + build->clayouts[i].coffset, build->clayouts[i].caddress, build->clayouts[i].csize);
+		memset(build->cimage + build->clayouts[i].coffset + offsetof(struct cobject_t, cfree), 0, sizeof(cobject_free_ft));
+		ok = csnap_emit_template(build, i);
+	}
+	for( i = 0; ok && i < self->cfield_count; ++i ) {
+		ok = csnap_emit_field(build, count, self->cfields[i]);
+	}
+	if( ok ) {
+		qsort(build->cpending, build->cpending_count, sizeof(*build->cpending), csnap_compare_pending);
+		ok = csnap_write_file(build, count, path);
+	}
+
+	free(build->clayouts);
+	free(build->csorted);
+	free(build->ctemplates);
+	free(build->cheaders);
+	free(build->cpending);
+	free(build->cimage);
+	free(build);
+	return ok;
+}
+
+int csnap_open( struct csnap_t* self, const char* path, int flags )
+{
+	struct stat status;
+	size_t i;
+	int fd;
+
+	memset(self, 0, sizeof(*self));
+	fd = open(path, O_RDONLY);
+	if( fd < 0 ) {
+		return 0;
+	}
+	if( fstat(fd, &status) != 0 || status.st_size <= 0 ) {
+		close(fd);
+		return 0;
+	}
+	self->cmap_size = (size_t) status.st_size;
+	self->cmap = mmap(NULL, self->cmap_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if( self->cmap == MAP_FAILED ) {
+		self->cmap = NULL;
+		return 0;
+	}
+	if( !csnap_check(self, self->cmap) ) {
+		csnap_close(self);
+		return 0;
+	}
+
+	if( flags & CSNAP_LAZY ) {
+		self->cstates = calloc(self->cobject_count + 1, sizeof(*self->cstates));
+		if( self->cstates == NULL ) {
+			csnap_close(self);
+			return 0;
+		}
+		return 1;
+	}
+	for( i = 0; i < self->cobject_count; ++i ) {
+		if( !csnap_fix(self, i) ) {
+			csnap_close(self);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+void csnap_close( struct csnap_t* self )
+{
+	if( self->cmap != NULL ) {
+		munmap(self->cmap, self->cmap_size);
+	}
+	free(self->cstates);
+	memset(self, 0, sizeof(*self));
+}
+
+void* csnap_object( struct csnap_t* self, size_t index )
+{
+	if( index >= self->cobject_count ) {
+		return NULL;
+	}
+	if( self->cstates != NULL && !csnap_fix_once(self, index) ) {
+		return NULL;
+	}
+	return self->cimage + self->cobjects[index].coffset;
+}
+
+void* csnap_resolve( struct csnap_t* self, void* reference )
+{
+	size_t low, high, mid, offset;
+
+	if( (char*) reference < self->cimage || (char*) reference >= self->cimage + self->cimage_size ) {
+		return NULL;
+	}
+	if( self->cstates == NULL ) {
+		return reference;
+	}
+
+	/* Objects are laid out in order, find the last starting at or before
+	 * the reference.
+	 */
+	offset = (size_t) ((char*) reference - self->cimage);
+	low = 0;
+	high = self->cobject_count;
+	while( high - low > 1 ) {
+		mid = low + (high - low) / 2;
+		if( self->cobjects[mid].coffset <= offset ) {
+			low = mid;
+		}
+		else {
+			high = mid;
+		}
+	}
+	if( !csnap_fix_once(self, low) ) {
+		return NULL;
+	}
+	return reference;
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	Snapshots of object graphs, written to a file once and memory mapped at
+ *	startup instead of being rebuilt.
+ *
+ *	Vtable pointers and croot are absolute addresses, so an object can't be
+ *	written to a file as is. Every class in a snapshot is given an ID, the
+ *	same in the program writing snapshots and the programs loading them,
+ *	and its vtable is registered under the ID, see cregistry.h:
+ *	@code
+ *		CREGISTRY_REGISTER(1, Rect);
+ *		CREGISTRY_REGISTER(2, Square);
+ *	@endcode
+ *	A snapshot is written from objects added to a struct csnap_writer_t, in
+ *	any memory. Vtable pointers, including those of interfaces, are written
+ *	as a class ID and an offset into the class' vtable, and croot and the
+ *	pointer fields named with csnap_pointer( ) as offsets into the snapshot.
+ *	Pointer fields can only point into objects of the same snapshot.
+ *	@code
+ *		csnap_writer_init(&writer);
+ *		csnap_add(&writer, &list_head);
+ *		csnap_add(&writer, &node);
+ *		csnap_pointer(&writer, (void**) &list_head.first);
+ *		csnap_write(&writer, "graph.snap");
+ *		csnap_writer_destroy(&writer);
+ *	@endcode
+ *	Objects whose headers are laid out alike, normally those of one class,
+ *	share a template of header fix ups, so an object's entry in the file is
+ *	its offset, its template, and the fix ups of its pointer fields.
+ *	Loading maps the file copy on write and writes the addresses back, all
+ *	at once with CSNAP_EAGER, in one linear pass over the objects, or
+ *	one object at a time with CSNAP_LAZY, when it's first asked for with
+ *	csnap_object( ) or csnap_resolve( ). With CSNAP_LAZY, a pointer read from
+ *	an object must be given to csnap_resolve( ) before its target is used.
+ *	@code
+ *		csnap_open(&snap, "graph.snap", CSNAP_EAGER);
+ *		head = csnap_object(&snap, 0);
+ *	@endcode
+ *	Headers are found with cregistry_headers( ), through each object's class
+ *	descriptor, so a class with interfaces must list them with
+ *	CCLASS_INFO_INIT_INTERFACES( ). Other words are written as they are,
+ *	even if they happen to hold a vtable or the object's address. Objects
+ *	loaded from a snapshot have no free method, and aren't destroyed, the
+ *	memory is released with csnap_close( ). The file is only meant to be
+ *	loaded by a build of the program with the same structure layouts.
+ */
+
+#ifndef CSNAP_H_
+#define CSNAP_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Flags of csnap_open( ).
+ */
+#define CSNAP_EAGER	0
+#define CSNAP_LAZY	1
+
+/**
+ * @struct csnap_writer_t
+ * @details
+ *	The objects and pointer fields of a snapshot being written.
+ */
+struct csnap_writer_t
+{
+    void**  cobjects;
+    size_t  cobject_count;
+    size_t  cobject_capacity;
+
+    void*** cfields;
+    size_t  cfield_count;
+    size_t  cfield_capacity;
+};
+
+struct csnap_object_t;
+struct csnap_template_t;
+struct csnap_header_t;
+struct csnap_pointer_t;
+
+/**
+ * @struct csnap_t
+ * @details
+ *	A loaded snapshot. Members are read only.
+ */
+struct csnap_t
+{
+    void*                          cmap;
+    size_t                         cmap_size;
+    char*                          cimage;
+    size_t                         cimage_size;
+    const struct csnap_object_t*   cobjects;
+    size_t                         cobject_count;
+    const struct csnap_template_t* ctemplates;
+    size_t                         ctemplate_count;
+    const struct csnap_header_t*   cheaders;
+    size_t                         cheader_count;
+    const struct csnap_pointer_t*  cpointers;
+    size_t                         cpointer_count;
+
+    /* With CSNAP_LAZY, whether each object has been fixed up.
+     */
+    unsigned char*                 cstates;
+};
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof csnap_writer_t
+ * @details
+ *	Initialize a writer with no objects.
+ */
+void csnap_writer_init( struct csnap_writer_t* self );
+
+/**
+ * @memberof csnap_writer_t
+ * @details
+ *	Free the writer's memory. Its objects are untouched.
+ */
+void csnap_writer_destroy( struct csnap_writer_t* self );
+
+/**
+ * @memberof csnap_writer_t
+ * @details
+ *	Add an object to the snapshot. Objects are numbered in the order they
+ *	are added, for csnap_object( ).
+ * @param object
+ *	The object, which must stay alive until the snapshot is written.
+ * @returns
+ *	Non zero on success, zero if memory couldn't be allocated.
+ */
+int csnap_add( struct csnap_writer_t* self, void* object );
+
+/**
+ * @memberof csnap_writer_t
+ * @details
+ *	Name a pointer field of an added object, which points into an added
+ *	object or is NULL.
+ * @param field
+ *	Address of the field.
+ * @returns
+ *	Non zero on success, zero if memory couldn't be allocated.
+ */
+int csnap_pointer( struct csnap_writer_t* self, void** field );
+
+/**
+ * @memberof csnap_writer_t
+ * @details
+ *	Write the snapshot to a file.
+ * @param path
+ *	The file, which is replaced.
+ * @returns
+ *	Non zero on success. Zero if an object's class, or one of its
+ *	interfaces', isn't registered, a pointer field is outside the objects or
+ *	points outside them, objects overlap, or the file couldn't be written.
+ */
+int csnap_write( struct csnap_writer_t* self, const char* path );
+
+/**
+ * @memberof csnap_t
+ * @details
+ *	Map a snapshot into memory.
+ * @param path
+ *	The snapshot's file.
+ * @param flags
+ *	CSNAP_EAGER to fix up every object now, or CSNAP_LAZY to fix them up
+ *	as they are asked for.
+ * @returns
+ *	Non zero on success. Zero if the file couldn't be mapped, isn't a
+ *	snapshot of this build, or, with CSNAP_EAGER, holds a class which isn't
+ *	registered.
+ */
+int csnap_open( struct csnap_t* self, const char* path, int flags );
+
+/**
+ * @memberof csnap_t
+ * @details
+ *	Unmap a snapshot. Its objects can't be used after this.
+ */
+void csnap_close( struct csnap_t* self );
+
+/**
+ * @memberof csnap_t
+ * @details
+ *	An object of the snapshot, fixed up if it hasn't been yet.
+ * @param index
+ *	The object's number, in the order they were added to the writer.
+ * @returns
+ *	The object, or NULL if there's no such object, or its class isn't
+ *	registered.
+ */
+void* csnap_object( struct csnap_t* self, size_t index );
+
+/**
+ * @memberof csnap_t
+ * @details
+ *	Fix up the object a pointer points into, if it hasn't been yet. Only
+ *	needed with CSNAP_LAZY, for pointers read from the snapshot's objects.
+ * @param reference
+ *	A pointer into the snapshot.
+ * @returns
+ *	reference, or NULL if it isn't in the snapshot, or its object's class
+ *	isn't registered.
+ */
+void* csnap_resolve( struct csnap_t* self, void* reference );
+
+/**
+ * @memberof csnap_t
+ * @returns
+ *	The number of objects in the snapshot.
+ */
+static inline size_t csnap_count( const struct csnap_t* self )
+{
+	return self->cobject_count;
+}
+
+
+#endif /* CSNAP_H_ */
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "ctcache.h"
+#include "cclass.h"
+#include "cring.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* In front of every block, keeping what follows aligned like malloc( )'s.
+ * Large blocks have a size class of CTCACHE_CLASSES.
+ */
+struct ctcache_header_t
+{
+    size_t cclass;
+} __attribute__((aligned(CCLASS_ALIGNOF(max_align_t))));
+
+/* A thread's free lists, linked through the first word of each block.
+ */
+struct ctcache_local_t
+{
+    void*        clists[CTCACHE_CLASSES];
+    unsigned int ccounts[CTCACHE_CLASSES];
+
+    /* Whether the lists are given to the depot when the thread exits.
+     */
+    int          cregistered;
+};
+
+/* A size class' batches, a cring.h queue.
+ */
+struct ctcache_depot_t
+{
+    size_t              cenqueue __attribute__((aligned(64)));
+    size_t              cdequeue __attribute__((aligned(64)));
+    struct cring_cell_t cslots[CTCACHE_DEPOT] __attribute__((aligned(64)));
+};
+
+static struct ctcache_depot_t ctcache_depots[CTCACHE_CLASSES];
+static __thread struct ctcache_local_t ctcache_local;
+static pthread_key_t  ctcache_key;
+static pthread_once_t ctcache_once = PTHREAD_ONCE_INIT;
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static struct ctcache_header_t* ctcache_header( void* memory )
+{
+	return (struct ctcache_header_t*) memory - 1;
+}
+
+static void** ctcache_next( void* block )
+{
+	return (void**) block;
+}
+
+static int ctcache_depot_put( struct ctcache_depot_t* depot, void* batch )
+{
+	return cring_enqueue(&depot->cenqueue, depot->cslots, CTCACHE_DEPOT - 1, batch);
+}
+
+static void* ctcache_depot_take( struct ctcache_depot_t* depot )
+{
+	return cring_dequeue(&depot->cdequeue, depot->cslots, CTCACHE_DEPOT - 1);
+}
+
+static void ctcache_free_list( void* block )
+{
+	void* next;
+
+	for( ; block != NULL; block = next ) {
+		next = *ctcache_next(block);
+		free(ctcache_header(block));
+	}
+}
+
+/* Take the first CTCACHE_BATCH blocks off a thread's list, and give them to
+ * the depot, or free them if it's full.
+ */
+static void ctcache_give_batch( struct ctcache_local_t* local, size_t class )
+{
+	void* batch;
+	void* last;
+	unsigned int i;
+
+	batch = local->clists[class];
+	last = batch;
+	for( i = 1; i < CTCACHE_BATCH; ++i ) {
+		last = *ctcache_next(last);
+	}
+	local->clists[class] = *ctcache_next(last);
+	local->ccounts[class] -= CTCACHE_BATCH;
+	*ctcache_next(last) = NULL;
+
+	if( !ctcache_depot_put(&ctcache_depots[class], batch) ) {
+		ctcache_free_list(batch);
+	}
+}
+
+static void ctcache_flush_local( struct ctcache_local_t* local )
+{
+	size_t class;
+
+	for( class = 0; class < CTCACHE_CLASSES; ++class ) {
+		while( local->ccounts[class] >= CTCACHE_BATCH ) {
+			ctcache_give_batch(local, class);
+		}
+		ctcache_free_list(local->clists[class]);
+		local->clists[class] = NULL;
+		local->ccounts[class] = 0;
+	}
+}
+
+static void ctcache_release( void* arg )
+{
+	struct ctcache_local_t* local = arg;
+
+	ctcache_flush_local(local);
+	local->cregistered = 0;
+}
+
+static void ctcache_init( void )
+{
+	size_t class;
+
+	pthread_key_create(&ctcache_key, ctcache_release);
+	for( class = 0; class < CTCACHE_CLASSES; ++class ) {
+		cring_init(ctcache_depots[class].cslots, CTCACHE_DEPOT);
+	}
+}
+
+/* Flush the calling thread's lists when it exits.
+ */
+static void ctcache_register( struct ctcache_local_t* local )
+{
+	pthread_once(&ctcache_once, ctcache_init);
+	pthread_setspecific(ctcache_key, local);
+	local->cregistered = 1;
+}
+
+/* The calling thread's list for a size class is empty, refill it from the
+ * depot or allocate a new block.
+ */
+static void* ctcache_refill( struct ctcache_local_t* local, size_t class )
+{
+	struct ctcache_header_t* header;
+	void* batch;
+
+	if( !local->cregistered ) {
+		ctcache_register(local);
+	}
+	batch = ctcache_depot_take(&ctcache_depots[class]);
+	if( batch != NULL ) {
+		local->clists[class] = *ctcache_next(batch);
+		local->ccounts[class] = CTCACHE_BATCH - 1;
+		return batch;
+	}
+
+	header = malloc(sizeof(*header) + (class + 1) * CTCACHE_QUANTUM);
+	if( header == NULL ) {
+		return NULL;
+	}
+	header->cclass = class;
+	return header + 1;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void* ctcache_alloc( size_t size )
+{
+	struct ctcache_local_t* local;
+	struct ctcache_header_t* header;
+	size_t class;
+	void* block;
+
+	if( __builtin_expect(size > CTCACHE_MAX_SIZE, 0) ) {
+		header = malloc(sizeof(*header) + size);
+		if( header == NULL ) {
+			return NULL;
+		}
+		header->cclass = CTCACHE_CLASSES;
+		return header + 1;
+	}
+
+	class = size == 0 ? 0 : (size - 1) / CTCACHE_QUANTUM;
+	local = &ctcache_local;
+	block = local->clists[class];
+	if( __builtin_expect(block == NULL, 0) ) {
+		return ctcache_refill(local, class);
+	}
+	local->clists[class] = *ctcache_next(block);
+	--local->ccounts[class];
+	return block;
+}
+
+void ctcache_free( void* memory )
+{
+	struct ctcache_local_t* local;
+	size_t class;
+
+	if( memory == NULL ) {
+		return;
+	}
+	class = ctcache_header(memory)->cclass;
+	if( __builtin_expect(class == CTCACHE_CLASSES, 0) ) {
+		free(ctcache_header(memory));
+		return;
+	}
+
+	local = &ctcache_local;
+	if( __builtin_expect(!local->cregistered, 0) ) {
+		ctcache_register(local);
+	}
+	*ctcache_next(memory) = local->clists[class];
+	local->clists[class] = memory;
+	if( __builtin_expect(++local->ccounts[class] >= 2 * CTCACHE_BATCH, 0) ) {
+		ctcache_give_batch(local, class);
+	}
+}
+
+void ctcache_flush( void )
+{
+	ctcache_flush_local(&ctcache_local);
+}
+
+size_t ctcache_cached( void )
+{
+	size_t class, cached;
+
+	cached = 0;
+	for( class = 0; class < CTCACHE_CLASSES; ++class ) {
+		cached += ctcache_local.ccounts[class];
+	}
+	return cached;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	A thread caching allocator for objects. Each thread keeps a free list
+ *	per size class, so allocating and freeing are a pop and a push on memory
+ *	no other thread touches. Free lists trade memory with each other in
+ *	batches of CTCACHE_BATCH blocks through a lock free depot: a thread whose
+ *	list for a size class runs dry takes a batch, and one whose list grows
+ *	past two batches gives one back.
+ *
+ *	ctcache_free( ) has the declaration of a cobject_free_ft, so it can be
+ *	given directly to cmalloc( ):
+ *	@code
+ *		struct point_t* point = ctcache_alloc(sizeof(struct point_t));
+ *		newPoint(point);
+ *		cmalloc(point, ctcache_free);
+ *		...
+ *		cdestroy(point);
+ *	@endcode
+ *	Memory can be freed by any thread, not only the one which allocated it.
+ *	It goes to the freeing thread's list, and back to the depot from there,
+ *	so a producer thread allocating objects which consumer threads destroy
+ *	gets its memory back a batch at a time. Lists are given to the depot
+ *	when their thread exits.
+ *
+ *	Blocks come from malloc( ), with a header holding their size class, and
+ *	go back to it when the depot is full. Requests larger than
+ *	CTCACHE_MAX_SIZE are passed straight to malloc( ) and free( ).
+ */
+
+#ifndef CTCACHE_H_
+#define CTCACHE_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Size classes are multiples of CTCACHE_QUANTUM, up to CTCACHE_MAX_SIZE.
+ */
+#define CTCACHE_QUANTUM		16
+#ifndef CTCACHE_MAX_SIZE
+#define CTCACHE_MAX_SIZE	1024
+#endif
+#define CTCACHE_CLASSES		(CTCACHE_MAX_SIZE / CTCACHE_QUANTUM)
+
+/* Blocks moved between a thread and the depot at once.
+ */
+#ifndef CTCACHE_BATCH
+#define CTCACHE_BATCH		32
+#endif
+
+/* Batches the depot holds per size class, a power of two.
+ */
+#ifndef CTCACHE_DEPOT
+#define CTCACHE_DEPOT		64
+#endif
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	Allocate memory for an object, from the calling thread's cache when it
+ *	has a block of the size class. The memory is aligned like malloc( )'s
+ *	and is not initialized.
+ * @param size
+ *	Size of the object, for example, sizeof(struct point_t).
+ * @returns
+ *	The memory, or NULL if malloc( ) failed.
+ */
+void* ctcache_alloc( size_t size );
+
+/**
+ * @details
+ *	Return memory from ctcache_alloc( ) to the calling thread's cache. Any
+ *	thread can free any block. This has the declaration of a cobject_free_ft,
+ *	so it can be given to cmalloc( ).
+ * @param memory
+ *	Memory returned by ctcache_alloc( ), or NULL.
+ */
+void ctcache_free( void* memory );
+
+/**
+ * @details
+ *	Give every block cached by the calling thread to the depot, as happens
+ *	when the thread exits. Blocks which don't make a full batch, or which
+ *	don't fit in the depot, are freed.
+ */
+void ctcache_flush( void );
+
+/**
+ * @details
+ *	The number of blocks cached by the calling thread, in every size class.
+ */
+size_t ctcache_cached( void );
+
+
+#endif /* CTCACHE_H_ */
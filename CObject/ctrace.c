@@ -0,0 +1,305 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "ctrace.h"
+#include "cobject.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Fields are written by the ring's thread and read by ctrace_export( ),
+ * always with atomic loads and stores.
+ */
+struct ctrace_event_t
+{
+    uint64_t    ctime;
+    const char* cname;
+    const char* ccategory;
+    char        cphase;
+
+    /* The recording thread, rings are passed from exited threads to new.
+     */
+    unsigned int ctid;
+};
+
+/* A thread's events. Rings of exited threads are kept, events included,
+ * and taken over by new threads.
+ */
+struct ctrace_ring_t
+{
+    struct ctrace_event_t cevents[CTRACE_EVENTS];
+
+    /* Events ever recorded, and started to be recorded. The next is written
+     * at chead % CTRACE_EVENTS.
+     */
+    size_t                chead;
+    size_t                cclaimed;
+    unsigned int          ctid;
+    struct ctrace_ring_t* cnext;
+    int                   cowned;
+};
+
+static int                          ctrace_enabled;
+static struct ctrace_ring_t*        ctrace_rings;
+static unsigned int                 ctrace_tids;
+static __thread struct ctrace_ring_t* ctrace_local;
+static pthread_key_t                ctrace_key;
+static pthread_once_t               ctrace_once = PTHREAD_ONCE_INIT;
+
+/* Time stamp counter and monotonic clock when tracing first started, to
+ * convert time stamps to microseconds.
+ */
+static uint64_t ctrace_origin_ticks;
+static uint64_t ctrace_origin_ns;
+static int      ctrace_origin_set;
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static uint64_t ctrace_clock_ns( void )
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+/* The CPU's time stamp counter, or nanoseconds where there isn't one.
+ */
+static uint64_t ctrace_ticks( void )
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc( );
+#else
+	return ctrace_clock_ns( );
+#endif
+}
+
+/* Let another thread take an exiting thread's ring.
+ */
+static void ctrace_release( void* arg )
+{
+	struct ctrace_ring_t* ring = arg;
+
+	ctrace_local = NULL;
+	__atomic_store_n(&ring->cowned, 0, __ATOMIC_RELEASE);
+}
+
+static void ctrace_key_init( void )
+{
+	pthread_key_create(&ctrace_key, ctrace_release);
+}
+
+static struct ctrace_ring_t* ctrace_ring( void )
+{
+	struct ctrace_ring_t* ring;
+	int owned;
+
+	if( ctrace_local != NULL ) {
+		return ctrace_local;
+	}
+	pthread_once(&ctrace_once, ctrace_key_init);
+
+	for( ring = __atomic_load_n(&ctrace_rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->cnext ) {
+		owned = 0;
+		if( __atomic_compare_exchange_n(&ring->cowned, &owned, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ) {
+			break;
+		}
+	}
+	if( ring == NULL ) {
+		ring = calloc(1, sizeof(*ring));
+		if( ring == NULL ) {
+			return NULL;
+		}
+		ring->cowned = 1;
+		ring->cnext = __atomic_load_n(&ctrace_rings, __ATOMIC_RELAXED);
+		while( !__atomic_compare_exchange_n(&ctrace_rings, &ring->cnext, ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED) ) {
+			continue;
+		}
+	}
+	ring->ctid = __atomic_add_fetch(&ctrace_tids, 1, __ATOMIC_RELAXED);
+	pthread_setspecific(ctrace_key, ring);
+	ctrace_local = ring;
+	return ring;
+}
+
+/* Write a string as a JSON string.
+ */
+static void ctrace_write_string( FILE* out, const char* string )
+{
+	fputc('"', out);
+	for( ; *string != '\0'; ++string ) {
+		if( *string == '"' || *string == '\\' ) {
+			fputc('\\', out);
+		}
+		fputc(*string, out);
+	}
+	fputc('"', out);
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+void ctrace_start( void )
+{
+	if( !ctrace_origin_set ) {
+		ctrace_origin_ns = ctrace_clock_ns( );
+		ctrace_origin_ticks = ctrace_ticks( );
+		ctrace_origin_set = 1;
+	}
+	__atomic_store_n(&ctrace_enabled, 1, __ATOMIC_RELEASE);
+}
+
+void ctrace_stop( void )
+{
+	__atomic_store_n(&ctrace_enabled, 0, __ATOMIC_RELEASE);
+}
+
+void ctrace_reset( void )
+{
+	struct ctrace_ring_t* ring;
+
+	for( ring = __atomic_load_n(&ctrace_rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->cnext ) {
+		__atomic_store_n(&ring->chead, 0, __ATOMIC_RELEASE);
+		__atomic_store_n(&ring->cclaimed, 0, __ATOMIC_RELEASE);
+	}
+	ctrace_origin_set = 0;
+}
+
+void ctrace_record( char phase, const char* category, const char* name )
+{
+	struct ctrace_ring_t* ring;
+	struct ctrace_event_t* event;
+	size_t head;
+
+	if( !__atomic_load_n(&ctrace_enabled, __ATOMIC_RELAXED) ) {
+		return;
+	}
+	ring = ctrace_ring( );
+	if( ring == NULL ) {
+		return;
+	}
+
+	head = ring->chead;
+	event = &ring->cevents[head & (CTRACE_EVENTS - 1)];
+
+	/* An exporter which reads any of this event sees it claimed, so it
+	 * knows the slot may be changing.
+	 */
+	__atomic_store_n(&ring->cclaimed, head + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&event->ctime, ctrace_ticks( ), __ATOMIC_RELAXED);
+	__atomic_store_n(&event->cname, name, __ATOMIC_RELAXED);
+	__atomic_store_n(&event->ccategory, category, __ATOMIC_RELAXED);
+	__atomic_store_n(&event->cphase, phase, __ATOMIC_RELAXED);
+	__atomic_store_n(&event->ctid, ring->ctid, __ATOMIC_RELAXED);
+	__atomic_store_n(&ring->chead, head + 1, __ATOMIC_RELEASE);
+}
+
+void ctrace_vtable( void* self, const void* vtable )
+{
+	/* Interfaces point back to their object. */
+	if( ((struct cclass_t*) self)->croot != self ) {
+		return;
+	}
+	ctrace_record(CTRACE_PHASE_INSTANT, "construct", ((const struct cobject_vtable_t*) vtable)->cinfo->cname);
+}
+
+size_t ctrace_export( FILE* out )
+{
+	struct ctrace_ring_t* ring;
+	struct ctrace_event_t event;
+	size_t head, first, i, written;
+	uint64_t ticks, ns;
+	double us_per_tick;
+	long pid;
+
+	/* Calibrate time stamps against the clock, over at least a millisecond. */
+	if( !ctrace_origin_set ) {
+		ctrace_origin_ns = ctrace_clock_ns( );
+		ctrace_origin_ticks = ctrace_ticks( );
+		ctrace_origin_set = 1;
+	}
+	do {
+		ns = ctrace_clock_ns( );
+		ticks = ctrace_ticks( );
+	} while( ns - ctrace_origin_ns < 1000000u );
+	us_per_tick = (double) (ns - ctrace_origin_ns) / 1000.0 / (double) (ticks - ctrace_origin_ticks);
+
+	pid = (long) getpid( );
+	written = 0;
+	fprintf(out, "{\n  \"displayTimeUnit\": \"ns\",\n  \"traceEvents\": [");
+	for( ring = __atomic_load_n(&ctrace_rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->cnext ) {
+		head = __atomic_load_n(&ring->chead, __ATOMIC_ACQUIRE);
+		first = head > CTRACE_EVENTS ? head - CTRACE_EVENTS : 0;
+		for( i = first; i < head; ++i ) {
+			const struct ctrace_event_t* slot = &ring->cevents[i & (CTRACE_EVENTS - 1)];
+
+			event.ctime = __atomic_load_n(&slot->ctime, __ATOMIC_RELAXED);
+			event.cname = __atomic_load_n(&slot->cname, __ATOMIC_RELAXED);
+			event.ccategory = __atomic_load_n(&slot->ccategory, __ATOMIC_RELAXED);
+			event.cphase = __atomic_load_n(&slot->cphase, __ATOMIC_RELAXED);
+			event.ctid = __atomic_load_n(&slot->ctid, __ATOMIC_RELAXED);
+
+			/* Skip it if the ring's thread has started overwriting it. */
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if( __atomic_load_n(&ring->cclaimed, __ATOMIC_RELAXED) > i + CTRACE_EVENTS ) {
+				continue;
+			}
+
+			fprintf(out, "%s\n    { \"name\": ", written == 0 ? "" : ",");
+			ctrace_write_string(out, event.cname);
+			fprintf(out, ", \"cat\": ");
+			ctrace_write_string(out, event.ccategory);
+			fprintf(out, ", \"ph\": \"%c\", ", event.cphase);
+			if( event.cphase == CTRACE_PHASE_INSTANT ) {
+				fprintf(out, "\"s\": \"t\", ");
+			}
+			fprintf(out, "\"ts\": %.3f, \"pid\": %ld, \"tid\": %u }",
+				(double) (int64_t) (event.ctime - ctrace_origin_ticks) * us_per_tick, pid, event.ctid);
+			++written;
+		}
+	}
+	fprintf(out, "\n  ]\n}\n");
+	return written;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	A timeline of object operations. When the library, and all code using
+ *	it, is compiled with CTRACE defined (make CTRACE=1), and tracing is
+ *	started with ctrace_start( ), events are recorded for:
+ *		* cobject_init( ), the start of every constructor chain.
+ *		* cclass_set_cvtable( ), as each class in a constructor chain maps
+ *		  its vtable, named after the class.
+ *		* Constructors which use CTRACE_CONSTRUCT_BEGIN( ) and
+ *		  CTRACE_CONSTRUCT_END( ), as a span from entry to exit, which
+ *		  every constructor cgen generates does.
+ *		* cdestroy( ) and cdestroy_batch( ), as a span named after the
+ *		  class, with cobject_destructor( ) marking the last step of the
+ *		  destructor chain.
+ *	With CTRACE_CALLS also defined, method wrappers which use CTRACE_CALL( )
+ *	record each call. Code can add its own spans with CTRACE_BEGIN( ) and
+ *	CTRACE_END( ). Without CTRACE, all of these compile to nothing.
+ *
+ *	Each thread records into its own ring of the last CTRACE_EVENTS events,
+ *	with no locks or shared writes, timestamped with the CPU's time stamp
+ *	counter. A ring is kept after its thread exits, its events still
+ *	exported, until a new thread takes it over. There are as many rings, of
+ *	CTRACE_EVENTS * 32 bytes, as the most threads recording at once.
+ *	ctrace_export( ) writes every ring as Chrome trace event JSON, which
+ *	chrome://tracing and Perfetto open.
+ *	@code
+ *		ctrace_start( );
+ *		...
+ *		ctrace_stop( );
+ *		ctrace_export(file);
+ *	@endcode
+ */
+
+#ifndef CTRACE_H_
+#define CTRACE_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/* Events kept per thread. Must be a power of two. Older events are
+ * overwritten.
+ */
+#ifndef CTRACE_EVENTS
+#define CTRACE_EVENTS	4096
+#endif
+
+/* Event phases, as named by the Chrome trace event format.
+ */
+#define CTRACE_PHASE_BEGIN	'B'
+#define CTRACE_PHASE_END	'E'
+#define CTRACE_PHASE_INSTANT	'i'
+
+/* Tracing hooks, see the file's description.
+ */
+#ifdef CTRACE
+#define CTRACE_BEGIN( name )	ctrace_record(CTRACE_PHASE_BEGIN, "user", (name))
+#define CTRACE_END( name )	ctrace_record(CTRACE_PHASE_END, "user", (name))
+#define CTRACE_INSTANT( name )	ctrace_record(CTRACE_PHASE_INSTANT, "user", (name))
+#define CTRACE_CONSTRUCT_BEGIN( name )	ctrace_record(CTRACE_PHASE_BEGIN, "construct", (name))
+#define CTRACE_CONSTRUCT_END( name )	ctrace_record(CTRACE_PHASE_END, "construct", (name))
+#else
+#define CTRACE_BEGIN( name )	((void) 0)
+#define CTRACE_END( name )	((void) 0)
+#define CTRACE_INSTANT( name )	((void) 0)
+#define CTRACE_CONSTRUCT_BEGIN( name )	((void) 0)
+#define CTRACE_CONSTRUCT_END( name )	((void) 0)
+#endif
+
+#if defined(CTRACE) && defined(CTRACE_CALLS)
+#define CTRACE_CALL( )		ctrace_record(CTRACE_PHASE_INSTANT, "call", __func__)
+#else
+#define CTRACE_CALL( )		((void) 0)
+#endif
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	Start recording events, on every thread.
+ */
+void ctrace_start( void );
+
+/**
+ * @details
+ *	Stop recording events. Recorded events are kept.
+ */
+void ctrace_stop( void );
+
+/**
+ * @details
+ *	Forget every recorded event. No thread may be recording.
+ */
+void ctrace_reset( void );
+
+/**
+ * @details
+ *	Record an event on the calling thread's ring, if tracing is started.
+ *	Names and categories are not copied, they must outlive the trace.
+ * @param phase
+ *	CTRACE_PHASE_BEGIN, CTRACE_PHASE_END or CTRACE_PHASE_INSTANT.
+ * @param category
+ *	The event's category.
+ * @param name
+ *	The event's name. An end event must have the name of its begin event.
+ */
+void ctrace_record( char phase, const char* category, const char* name );
+
+/**
+ * @details
+ *	Record the class of an object mapping its vtable. Called by
+ *	cclass_set_cvtable( ), it ignores interfaces.
+ * @param self
+ *	The object or interface.
+ * @param vtable
+ *	Its new vtable.
+ */
+void ctrace_vtable( void* self, const void* vtable );
+
+/**
+ * @details
+ *	Write every thread's recorded events as Chrome trace event JSON. Threads
+ *	may keep recording while this runs, events they overwrite are left out.
+ * @param out
+ *	The stream to write to.
+ * @returns
+ *	The number of events written.
+ */
+size_t ctrace_export( FILE* out );
+
+
+#endif /* CTRACE_H_ */
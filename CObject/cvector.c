@@ -0,0 +1,125 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include "cvector.h"
+#include "cobject.h"
+#include "ccensus.h"
+#include "ctrace.h"
+#include <stdlib.h>
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+/* Destroy every object. Objects of one class all run the same destructor,
+ * and cobject_destructor( ) would only call a free method, which they don't
+ * have, so it's skipped.
+ */
+static void cvector_destroy_objects( struct cvector_t* self )
+{
+	const struct cobject_vtable_t* vtable;
+	size_t i;
+
+	if( self->ccount == 0 ) {
+		return;
+	}
+	vtable = self->cvtable;
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_BEGIN, "destroy", "cvector");
+#endif
+	if( vtable->cdestructor != cobject_destructor ) {
+		for( i = 0; i < self->ccount; ++i ) {
+			vtable->cdestructor(cvector_at(self, i));
+		}
+	}
+#ifdef CCENSUS
+	for( i = 0; i < self->ccount; ++i ) {
+		ccensus_destruct(vtable->cinfo);
+	}
+#endif
+#ifdef CTRACE
+	ctrace_record(CTRACE_PHASE_END, "destroy", "cvector");
+#endif
+	self->ccount = 0;
+	self->cvtable = NULL;
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+int cvector_init( struct cvector_t* self, size_t size, size_t capacity )
+{
+	self->csize = size;
+	self->ccount = 0;
+	self->ccapacity = capacity;
+	self->cvtable = NULL;
+	if( capacity != 0 && size > (size_t) -1 / capacity ) {
+		self->cdata = NULL;
+		return 0;
+	}
+	self->cdata = malloc(capacity == 0 ? 1 : size * capacity);
+	return self->cdata != NULL;
+}
+
+void cvector_destroy( struct cvector_t* self )
+{
+	cvector_destroy_objects(self);
+	free(self->cdata);
+	self->cdata = NULL;
+	self->ccapacity = 0;
+}
+
+void cvector_clear( struct cvector_t* self )
+{
+	cvector_destroy_objects(self);
+}
+
+size_t cvector_emplace( struct cvector_t* self, size_t count, cvector_construct_ft construct, void* arg )
+{
+	const void* vtable;
+	void* object;
+	size_t added;
+
+	for( added = 0; added < count && self->ccount < self->ccapacity; ++added ) {
+		object = cvector_at(self, self->ccount);
+		construct(object, self->ccount, arg);
+		vtable = cclass_get_vtable(object);
+		if( self->cvtable == NULL ) {
+			self->cvtable = vtable;
+		}
+		else if( vtable != self->cvtable ) {
+			cdestroy(object);
+			break;
+		}
+		++self->ccount;
+	}
+	return added;
+}
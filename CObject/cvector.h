@@ -0,0 +1,218 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	A vector of objects of one class. Objects are constructed in place, one
+ *	after another in a single block of memory, and the vector keeps their
+ *	class' vtable. A method is looked up in that vtable once, with
+ *	CVECTOR_METHOD( ), and called on every object in a linear scan:
+ *	@code
+ *		struct cvector_t shapes;
+ *		struct rect_t* rect;
+ *		int (*area)( struct rect_t* );
+ *
+ *		cvector_init(&shapes, sizeof(struct rect_t), 1000000);
+ *		cvector_emplace(&shapes, 1000000, construct_rect, NULL);
+ *
+ *		area = CVECTOR_METHOD(&shapes, struct rect_vtable_t, area);
+ *		CVECTOR_FOR_EACH(&shapes, struct rect_t, rect) {
+ *			total += area(rect);
+ *		}
+ *		cvector_destroy(&shapes);
+ *	@endcode
+ *	References to the objects are plain pointers, from cvector_at( ), which
+ *	work with every method wrapper, cast, and interface.
+ *
+ *	Each object still has its own struct cobject_t and interface headers,
+ *	since methods read their object's vtable and fields from fixed offsets in
+ *	it. What the vector saves is a pointer, allocation, and vtable load per
+ *	object. The block is allocated once and never grows, because objects and
+ *	their interfaces point to themselves, so they can't be moved.
+ */
+
+#ifndef CVECTOR_H_
+#define CVECTOR_H_
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <stddef.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+/**
+ * @details
+ *	Constructs an object for cvector_emplace( ).
+ * @param object
+ *	Memory for the object, the size the vector was made with.
+ * @param index
+ *	The object's index in the vector.
+ * @param arg
+ *	The argument given to cvector_emplace( ).
+ */
+typedef void (*cvector_construct_ft)( void* object, size_t index, void* arg );
+
+/**
+ * @struct cvector_t
+ * @details
+ *	A vector of objects of one class. Members are read only.
+ */
+struct cvector_t
+{
+    char*       cdata;
+    size_t      csize;
+    size_t      ccount;
+    size_t      ccapacity;
+
+    /* Vtable of every object, NULL until the first is constructed.
+     */
+    const void* cvtable;
+};
+
+/**
+ * @details
+ *	A method, looked up once in the vtable of a vector's objects, typed as
+ *	the vtable's member. The vector must not be empty.
+ * @param vector
+ *	Pointer to the struct cvector_t.
+ * @param vtable_type
+ *	Type of the objects' vtable, or of an ancestor's.
+ * @param method
+ *	The method's member in vtable_type, which may name a member of an
+ *	interface's vtable, like Drawable_VTable.draw.
+ */
+#define CVECTOR_METHOD( vector, vtable_type, method )					\
+	(((const vtable_type*) (vector)->cvtable)->method)
+
+/**
+ * @details
+ *	Loop over every object in a vector, in order, with self pointing to each.
+ * @param type
+ *	The objects' type, or any of its super classes'.
+ */
+#define CVECTOR_FOR_EACH( vector, type, self )						\
+	for( (self) = (type*) (vector)->cdata;						\
+	     (char*) (self) < (vector)->cdata + (vector)->ccount * (vector)->csize;	\
+	     (self) = (type*) ((char*) (self) + (vector)->csize) )
+
+/**
+ * @details
+ *	Call a method on every object in a vector, looking it up once. Return
+ *	values are discarded.
+ * @param args
+ *	The method's arguments in parentheses, with self naming the object,
+ *	like (self, 2).
+ */
+#define CVECTOR_APPLY( vector, vtable_type, method, type, self, args )		\
+	do {										\
+		if( (vector)->ccount > 0 ) {						\
+			__typeof__(CVECTOR_METHOD(vector, vtable_type, method)) cvector_method_ = \
+				CVECTOR_METHOD(vector, vtable_type, method);		\
+			type* self;							\
+											\
+			CVECTOR_FOR_EACH(vector, type, self) {				\
+				cvector_method_ args;					\
+			}								\
+		}									\
+	} while( 0 )
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Declarations ----------------------------
+ * ==========================================================================
+ */
+/**
+ * @memberof cvector_t
+ * @details
+ *	Initialize an empty vector, and allocate room for all its objects.
+ * @param size
+ *	Size of the objects' class, for example, sizeof(struct rect_t).
+ * @param capacity
+ *	The most objects the vector will hold.
+ * @returns
+ *	Non zero on success, zero if the memory couldn't be allocated.
+ */
+int cvector_init( struct cvector_t* self, size_t size, size_t capacity );
+
+/**
+ * @memberof cvector_t
+ * @details
+ *	Destroy every object, with their destructor looked up once, and free
+ *	the vector's memory. Objects must not have a free method, see cmalloc( ),
+ *	the vector owns their memory.
+ */
+void cvector_destroy( struct cvector_t* self );
+
+/**
+ * @memberof cvector_t
+ * @details
+ *	Destroy every object, like cvector_destroy( ), but keep the memory so the
+ *	vector can be filled again, with objects of any class.
+ */
+void cvector_clear( struct cvector_t* self );
+
+/**
+ * @memberof cvector_t
+ * @details
+ *	Construct objects at the end of the vector. Stops when the vector is full,
+ *	or when an object's class isn't the class of the vector's other objects,
+ *	in which case that object is destroyed.
+ * @param count
+ *	The number of objects to construct.
+ * @param construct
+ *	Called to construct each object.
+ * @param arg
+ *	Passed to construct.
+ * @returns
+ *	The number of objects added.
+ */
+size_t cvector_emplace( struct cvector_t* self, size_t count, cvector_construct_ft construct, void* arg );
+
+/**
+ * @memberof cvector_t
+ * @details
+ *	A reference to an object in the vector. It stays valid until the vector
+ *	is cleared or destroyed.
+ * @param index
+ *	The object's index, less than cvector_count( ).
+ */
+static inline void* cvector_at( const struct cvector_t* self, size_t index )
+{
+	return self->cdata + index * self->csize;
+}
+
+/**
+ * @memberof cvector_t
+ * @returns
+ *	The number of objects in the vector.
+ */
+static inline size_t cvector_count( const struct cvector_t* self )
+{
+	return self->ccount;
+}
+
+
+#endif /* CVECTOR_H_ */
@@ -0,0 +1,1113 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * Micro benchmarks for CObject. Results are printed as JSON, one record per
+ * operation, variant, and hierarchy depth, with the average cost of one
+ * operation in nanoseconds:
+ *
+ *	{
+ *	  "iterations": 2000128,
+ *	  "results": [
+ *	    { "group": "virtual", "variant": "cobject", "depth": 1, "ns_per_op": 1.52 },
+ *	    ...
+ *	  ]
+ *	}
+ *
+ * Every group in bench.h is run by three variants: "cobject", "direct" (plain
+ * C function calls, the floor), and "cpp" (C++ virtual methods). Each result
+ * is the fastest of BENCH_REPEATS runs, after one warm up run.
+ *
+ * The "arena" group is the cost per object of building a request's worth of
+ * objects then tearing them down, with malloc( ), cmalloc( ) and cdestroy( )
+ * on each object ("cdestroy"), or with one carena_reset( ) ("carena").
+ *
+ * The "refcount" group is the cost of a cretain( ) and crelease( ) pair, per
+ * thread, with 1 to BENCH_THREADS_MAX threads each running the pair on its
+ * own plain object ("plain"), its own shared object ("atomic"), or all on
+ * the same shared object ("contended"). These records have "threads" in
+ * place of "depth".
+ *
+ * The "reaper" group is the time the destroying thread spends per object,
+ * tearing down objects with a three deep destructor chain with cdestroy( )
+ * ("cdestroy") or handing them to a reaper thread with cdestroy_async( )
+ * ("cdestroy_async"). Draining the reaper isn't timed.
+ *
+ * The "icache" group is the cost of a monomorphic interface style call,
+ * through the vtable ("vtable"), through an inline cache with
+ * CICACHE_CALL( ) ("cicache"), and with CICACHE_CALL_DIRECT( ) given the
+ * implementation the site resolves to ("cicache_direct").
+ *
+ * The "vector" group is the cost per object of a virtual call on each of
+ * BENCH_VECTOR_OBJECTS objects of one class, allocated one by one and called
+ * through an array of pointers ("pointers"), or constructed in a cvector_t
+ * with the method looked up once ("cvector").
+ *
+ * The "poly" group is the cost per object of a virtual call on each of
+ * BENCH_POLY_OBJECTS objects of two classes in random order, called through
+ * an array of pointers ("interleaved"), or bucket by bucket from a
+ * cpoly_vector_t with the method looked up once per bucket ("cpoly").
+ *
+ * The "tcache" group is the cost of allocating and freeing an object, per
+ * thread, with 1 to BENCH_THREADS_MAX threads each allocating BENCH_BATCH
+ * objects then freeing them, with malloc( ) and free( ) ("malloc") or
+ * ctcache_alloc( ) and ctcache_free( ) ("ctcache"). These records have
+ * "threads" in place of "depth".
+ *
+ * The "snapshot" group is the cost per object of getting BENCH_SNAP_OBJECTS
+ * objects ready to use, by allocating and constructing each ("construct"),
+ * or by loading a snapshot of them with CSNAP_EAGER ("csnap_eager") or
+ * CSNAP_LAZY ("csnap_lazy"), which fixes up none until they're used.
+ *
+ * The "clone" group is the cost of making an object from scratch in reused
+ * memory and destroying it, by running its constructor ("construct") or by
+ * copying a template of it with cclone( ) ("cclone"), and per object of
+ * making BENCH_VECTOR_OBJECTS objects in one block, by running each one's
+ * constructor ("construct_array") or with cnew_array( ) ("cnew_array").
+ * Destroying them isn't timed.
+ *
+ * The "handle" group is the cost per object of a virtual call on each of
+ * the "vector" group's BENCH_VECTOR_OBJECTS allocated objects, through an
+ * array of pointers ("pointers") or an array of handles resolved with
+ * chandle_get( ) ("chandle").
+ *
+ * The "shm" group is the cost of allocating and freeing a block with
+ * malloc( ) and free( ) ("malloc") or in a shared memory heap with
+ * cshm_alloc( ) and cshm_free( ) ("cshm"), and, when built with CSHM=1, of a
+ * virtual call on each of BENCH_SHM_OBJECTS objects in the heap, before
+ * ("private_call") and after ("shared_call") they're shared with
+ * cshm_share( ).
+ *
+ * The only argument is the number of iterations of each operation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include "bench.h"
+#include <test_classes/destructor_test_classes.h>
+#include <carena.h>
+#include <creaper.h>
+#include <cicache.h>
+#include <cvector.h>
+#include <chandle.h>
+#include <cpoly.h>
+#include <ctcache.h>
+#include <cregistry.h>
+#include <csnap.h>
+#include <cshm.h>
+#include <unistd.h>
+#include <test_classes/generated_test_classes.h>
+
+#define BENCH_ITERATIONS 2000000UL
+#define BENCH_REPEATS 3
+#define BENCH_THREADS_MAX 8
+
+volatile int bench_sink;
+
+static const char* const bench_group_names[BENCH_GROUPS] =
+{
+	[BENCH_VIRTUAL] = "virtual",
+	[BENCH_SUPER] = "super",
+	[BENCH_INTERFACE] = "interface",
+	[BENCH_CAST] = "cast",
+	[BENCH_CONSTRUCT] = "construct",
+	[BENCH_DESTROY] = "destroy"
+};
+
+static const struct bench_variant_t* const bench_variants[] =
+{
+	&bench_cobject,
+	&bench_direct,
+	&bench_cpp
+};
+
+static int bench_first_result = 1;
+
+double bench_now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/* Warm up then return the fastest run, in nanoseconds per iteration. */
+static double bench_measure( bench_loop_ft loop, unsigned long iterations )
+{
+	double best, elapsed;
+	int i;
+
+	loop(iterations / 8 < BENCH_BATCH ? BENCH_BATCH : iterations / 8 / BENCH_BATCH * BENCH_BATCH);
+	best = loop(iterations);
+	for( i = 1; i < BENCH_REPEATS; ++i ) {
+		elapsed = loop(iterations);
+		if( elapsed < best ) {
+			best = elapsed;
+		}
+	}
+	return best / iterations;
+}
+
+static void bench_report( const char* group, const char* variant, int depth, double ns_per_op )
+{
+	printf("%s\n    { \"group\": \"%s\", \"variant\": \"%s\", \"depth\": %d, \"ns_per_op\": %.3f }",
+	       bench_first_result ? "" : ",", group, variant, depth, ns_per_op);
+	bench_first_result = 0;
+	fflush(stdout);
+}
+
+static void bench_report_threads( const char* group, const char* variant, int threads, double ns_per_op )
+{
+	printf("%s\n    { \"group\": \"%s\", \"variant\": \"%s\", \"threads\": %d, \"ns_per_op\": %.3f }",
+	       bench_first_result ? "" : ",", group, variant, threads, ns_per_op);
+	bench_first_result = 0;
+	fflush(stdout);
+}
+
+/****************************************************************************/
+/* Reference counting							    */
+/****************************************************************************/
+/* Each thread's own object, on its own cache line. */
+struct bench_refcount_object_t
+{
+	struct DTClassA object;
+	char pad[64 - sizeof(struct DTClassA) % 64];
+} __attribute__((aligned(64)));
+
+struct bench_refcount_thread_t
+{
+	pthread_barrier_t* barrier;
+	void* object;
+	unsigned long iterations;
+	double elapsed;
+};
+
+static void* bench_refcount_thread( void* arg_ )
+{
+	struct bench_refcount_thread_t* arg = arg_;
+	unsigned long i;
+	double start;
+
+	pthread_barrier_wait(arg->barrier);
+	start = bench_now_ns( );
+	for( i = 0; i < arg->iterations; ++i ) {
+		cretain(arg->object);
+		crelease(arg->object);
+	}
+	arg->elapsed = bench_now_ns( ) - start;
+	return NULL;
+}
+
+/* Returns the slowest thread's time per pair. */
+static double bench_refcount( int threads, int shared, int contended, unsigned long iterations )
+{
+	static struct bench_refcount_object_t objects[BENCH_THREADS_MAX];
+	struct bench_refcount_thread_t args[BENCH_THREADS_MAX];
+	pthread_t ids[BENCH_THREADS_MAX];
+	pthread_barrier_t barrier;
+	double best = 0, slowest;
+	int i, repeat, var;
+
+	for( repeat = 0; repeat < BENCH_REPEATS; ++repeat ) {
+		pthread_barrier_init(&barrier, NULL, threads);
+		for( i = 0; i < threads; ++i ) {
+			newDTClassA(&objects[i].object, &var);
+			cobject_set_shared(&objects[i].object, shared);
+			args[i].barrier = &barrier;
+			args[i].object = contended ? &objects[0].object : &objects[i].object;
+			args[i].iterations = iterations;
+			pthread_create(&ids[i], NULL, bench_refcount_thread, &args[i]);
+		}
+		slowest = 0;
+		for( i = 0; i < threads; ++i ) {
+			pthread_join(ids[i], NULL);
+			if( args[i].elapsed > slowest ) {
+				slowest = args[i].elapsed;
+			}
+		}
+		pthread_barrier_destroy(&barrier);
+		if( repeat == 0 || slowest < best ) {
+			best = slowest;
+		}
+	}
+	return best / iterations;
+}
+
+static void bench_refcounts( unsigned long iterations )
+{
+	int threads;
+
+	for( threads = 1; threads <= BENCH_THREADS_MAX; threads *= 2 ) {
+		bench_report_threads("refcount", "plain", threads, bench_refcount(threads, 0, 0, iterations));
+	}
+	for( threads = 1; threads <= BENCH_THREADS_MAX; threads *= 2 ) {
+		bench_report_threads("refcount", "atomic", threads, bench_refcount(threads, 1, 0, iterations));
+	}
+	for( threads = 1; threads <= BENCH_THREADS_MAX; threads *= 2 ) {
+		bench_report_threads("refcount", "contended", threads, bench_refcount(threads, 1, 1, iterations));
+	}
+}
+
+/****************************************************************************/
+/* Arena								    */
+/****************************************************************************/
+/* Half the objects have a destructor to run, half don't. */
+static double bench_arena_cdestroy( unsigned long iterations )
+{
+	struct DTClassC* objects[BENCH_BATCH];
+	unsigned long round;
+	size_t i;
+	double start;
+	int var;
+
+	start = bench_now_ns( );
+	for( round = 0; round < iterations; round += BENCH_BATCH ) {
+		for( i = 0; i < BENCH_BATCH; i += 2 ) {
+			objects[i] = malloc(sizeof(struct DTClassC));
+			newDTClassC(objects[i], &var);
+			cmalloc(objects[i], free);
+			objects[i+1] = malloc(sizeof(struct DTClassB));
+			newDTClassB((struct DTClassB*) objects[i+1], &var);
+			cmalloc(objects[i+1], free);
+		}
+		for( i = 0; i < BENCH_BATCH; ++i ) {
+			cdestroy(objects[i]);
+		}
+	}
+	return bench_now_ns( ) - start;
+}
+
+static double bench_arena_carena( unsigned long iterations )
+{
+	struct carena_t arena;
+	unsigned long round;
+	size_t i;
+	double start, end;
+	int var;
+
+	carena_init(&arena, 0);
+	start = bench_now_ns( );
+	for( round = 0; round < iterations; round += BENCH_BATCH ) {
+		for( i = 0; i < BENCH_BATCH; i += 2 ) {
+			newDTClassC(carena_alloc(&arena, sizeof(struct DTClassC)), &var);
+			newDTClassB(carena_alloc(&arena, sizeof(struct DTClassB)), &var);
+		}
+		carena_reset(&arena);
+	}
+	end = bench_now_ns( );
+	carena_destroy(&arena);
+	return end - start;
+}
+
+/****************************************************************************/
+/* Reaper								    */
+/****************************************************************************/
+static double bench_reaper( unsigned long iterations, struct creaper_t* reaper )
+{
+	struct DTClassE* objects[BENCH_BATCH];
+	unsigned long round;
+	size_t i;
+	double start, elapsed;
+	int var;
+
+	elapsed = 0;
+	for( round = 0; round < iterations; round += BENCH_BATCH ) {
+		for( i = 0; i < BENCH_BATCH; ++i ) {
+			objects[i] = malloc(sizeof(struct DTClassE));
+			newDTClassE(objects[i], &var);
+			cmalloc(objects[i], free);
+		}
+		start = bench_now_ns( );
+		for( i = 0; i < BENCH_BATCH; ++i ) {
+			if( reaper == NULL ) {
+				cdestroy(objects[i]);
+			}
+			else {
+				cdestroy_async(reaper, objects[i]);
+			}
+		}
+		elapsed += bench_now_ns( ) - start;
+		if( reaper != NULL ) {
+			creaper_drain(reaper);
+		}
+	}
+	return elapsed;
+}
+
+static struct creaper_t bench_reaper_instance;
+
+static double bench_reaper_cdestroy( unsigned long iterations )
+{
+	return bench_reaper(iterations, NULL);
+}
+
+static double bench_reaper_async( unsigned long iterations )
+{
+	return bench_reaper(iterations, &bench_reaper_instance);
+}
+
+/****************************************************************************/
+/* Inline caches							    */
+/****************************************************************************/
+struct bench_icache_vtable_t
+{
+	int (*get)( struct cclass_t* self );
+};
+
+struct bench_icache_object_t
+{
+	struct cclass_t cclass;
+	int value;
+};
+
+static int bench_icache_get( struct cclass_t* self )
+{
+	return ((struct bench_icache_object_t*) self)->value;
+}
+
+static const struct bench_icache_vtable_t bench_icache_vtable = { bench_icache_get };
+
+static struct bench_icache_object_t bench_icache_objects[BENCH_BATCH];
+
+static void bench_icache_init( void )
+{
+	size_t i;
+
+	for( i = 0; i < BENCH_BATCH; ++i ) {
+		bench_icache_objects[i].cclass.cvtable = &bench_icache_vtable;
+		bench_icache_objects[i].cclass.croot = &bench_icache_objects[i];
+		bench_icache_objects[i].value = (int) i;
+	}
+}
+
+static double bench_icache_vtable_call( unsigned long iterations )
+{
+	struct cclass_t* self;
+	unsigned long round;
+	size_t i;
+	double start;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	for( round = 0; round < iterations; round += BENCH_BATCH ) {
+		for( i = 0; i < BENCH_BATCH; ++i ) {
+			self = &bench_icache_objects[i].cclass;
+			sum += ((const struct bench_icache_vtable_t*) cclass_get_vtable(self))->get(self);
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+static double bench_icache_cached( unsigned long iterations )
+{
+	static struct cicache_t site = CICACHE_INIT("bench icache cicache");
+	struct cclass_t* self;
+	unsigned long round;
+	size_t i;
+	double start;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	for( round = 0; round < iterations; round += BENCH_BATCH ) {
+		for( i = 0; i < BENCH_BATCH; ++i ) {
+			self = &bench_icache_objects[i].cclass;
+			sum += CICACHE_CALL(&site, struct bench_icache_vtable_t, get, self, (self));
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+static double bench_icache_direct( unsigned long iterations )
+{
+	static struct cicache_t site = CICACHE_INIT("bench icache cicache_direct");
+	struct cclass_t* self;
+	unsigned long round;
+	size_t i;
+	double start;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	for( round = 0; round < iterations; round += BENCH_BATCH ) {
+		for( i = 0; i < BENCH_BATCH; ++i ) {
+			self = &bench_icache_objects[i].cclass;
+			sum += CICACHE_CALL_DIRECT(&site, struct bench_icache_vtable_t, get, self, bench_icache_get, (self));
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+/****************************************************************************/
+/* Vectors								    */
+/****************************************************************************/
+#define BENCH_VECTOR_OBJECTS 100000
+
+static struct GTRect* bench_vector_pointers[BENCH_VECTOR_OBJECTS];
+static struct cvector_t bench_vector;
+
+static void bench_vector_construct( void* object, size_t index, void* arg )
+{
+	struct GTRect* rect = object;
+
+	(void) arg;
+	newGTRect(rect);
+	rect->width = (int) index;
+	rect->height = 1;
+	rect->destroyed = NULL;
+}
+
+static int bench_vector_init( void )
+{
+	size_t i;
+
+	if( !cvector_init(&bench_vector, sizeof(struct GTRect), BENCH_VECTOR_OBJECTS) ) {
+		return 0;
+	}
+	cvector_emplace(&bench_vector, BENCH_VECTOR_OBJECTS, bench_vector_construct, NULL);
+	for( i = 0; i < BENCH_VECTOR_OBJECTS; ++i ) {
+		bench_vector_pointers[i] = malloc(sizeof(struct GTRect));
+		if( bench_vector_pointers[i] == NULL ) {
+			abort( );
+		}
+		bench_vector_construct(bench_vector_pointers[i], i, NULL);
+		cmalloc(bench_vector_pointers[i], free);
+	}
+	return 1;
+}
+
+static void bench_vector_destroy( void )
+{
+	size_t i;
+
+	for( i = 0; i < BENCH_VECTOR_OBJECTS; ++i ) {
+		cdestroy(bench_vector_pointers[i]);
+	}
+	cvector_destroy(&bench_vector);
+}
+
+static double bench_vector_pointer_loop( unsigned long iterations )
+{
+	unsigned long done;
+	size_t i;
+	double start;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; ) {
+		for( i = 0; i < BENCH_VECTOR_OBJECTS && done < iterations; ++i, ++done ) {
+			sum += GTRect_perimeter(bench_vector_pointers[i]);
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+static double bench_vector_loop( unsigned long iterations )
+{
+	int (*perimeter)( struct GTRect* );
+	struct GTRect* rect;
+	unsigned long done;
+	double start;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	perimeter = CVECTOR_METHOD(&bench_vector, struct GTRect_VTable, perimeter);
+	for( done = 0; done < iterations; ) {
+		CVECTOR_FOR_EACH(&bench_vector, struct GTRect, rect) {
+			if( done++ == iterations ) {
+				break;
+			}
+			sum += perimeter(rect);
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+/****************************************************************************/
+/* Handles								    */
+/****************************************************************************/
+static struct chandle_table_t bench_handle_table;
+static chandle_t bench_handles[BENCH_VECTOR_OBJECTS];
+
+/* Handles to the vector group's allocated objects. */
+static int bench_handle_init( void )
+{
+	size_t i;
+
+	if( !chandle_init(&bench_handle_table) ) {
+		return 0;
+	}
+	for( i = 0; i < BENCH_VECTOR_OBJECTS; ++i ) {
+		bench_handles[i] = chandle_insert(&bench_handle_table, bench_vector_pointers[i]);
+		if( bench_handles[i] == CHANDLE_NULL ) {
+			chandle_destroy(&bench_handle_table);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static double bench_handle_loop( unsigned long iterations )
+{
+	unsigned long done;
+	size_t i;
+	double start;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; ) {
+		for( i = 0; i < BENCH_VECTOR_OBJECTS && done < iterations; ++i, ++done ) {
+			sum += GTRect_perimeter(chandle_get(&bench_handle_table, bench_handles[i]));
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+/****************************************************************************/
+/* Polymorphic collections						    */
+/****************************************************************************/
+#define BENCH_POLY_OBJECTS 100000
+
+static struct GTSquare bench_poly_objects[BENCH_POLY_OBJECTS];
+static struct GTRect* bench_poly_pointers[BENCH_POLY_OBJECTS];
+static struct cpoly_vector_t bench_poly;
+
+static int bench_poly_init( void )
+{
+	unsigned int seed;
+	size_t i;
+
+	cpoly_init(&bench_poly);
+	seed = 1;
+	for( i = 0; i < BENCH_POLY_OBJECTS; ++i ) {
+		/* Rects and squares, in an order the branch predictor can't learn. */
+		seed = seed * 1103515245u + 12345u;
+		if( (seed >> 16) & 1 ) {
+			newGTSquare(&bench_poly_objects[i]);
+		}
+		else {
+			newGTRect(&bench_poly_objects[i].gtRect);
+		}
+		bench_poly_objects[i].gtRect.width = (int) i;
+		bench_poly_objects[i].gtRect.height = 1;
+		bench_poly_objects[i].gtRect.destroyed = NULL;
+		bench_poly_pointers[i] = &bench_poly_objects[i].gtRect;
+		if( !cpoly_insert(&bench_poly, bench_poly_pointers[i]) ) {
+			cpoly_destroy(&bench_poly);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void bench_poly_destroy( void )
+{
+	size_t i;
+
+	cpoly_destroy(&bench_poly);
+	for( i = 0; i < BENCH_POLY_OBJECTS; ++i ) {
+		cdestroy(bench_poly_pointers[i]);
+	}
+}
+
+static double bench_poly_interleaved_loop( unsigned long iterations )
+{
+	unsigned long done;
+	size_t i;
+	double start;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; ) {
+		for( i = 0; i < BENCH_POLY_OBJECTS && done < iterations; ++i, ++done ) {
+			sum += GTRect_perimeter(bench_poly_pointers[i]);
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+static double bench_poly_loop( unsigned long iterations )
+{
+	const struct cpoly_bucket_t* bucket;
+	int (*perimeter)( struct GTRect* );
+	unsigned long done;
+	size_t i;
+	double start;
+	int sum;
+
+	/* What CPOLY_FOREACH( ) does, keeping the results. */
+	sum = 0;
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; ) {
+		for( bucket = bench_poly.cbuckets; bucket < bench_poly.cbuckets + bench_poly.cbucket_count; ++bucket ) {
+			perimeter = ((const struct GTRect_VTable*) bucket->cvtable)->perimeter;
+			for( i = 0; i < bucket->ccount && done < iterations; ++i, ++done ) {
+				sum += perimeter(bucket->cobjects[i]);
+			}
+		}
+	}
+	bench_sink = sum;
+	return bench_now_ns( ) - start;
+}
+
+/****************************************************************************/
+/* Thread caching allocator						    */
+/****************************************************************************/
+struct bench_tcache_thread_t
+{
+	pthread_barrier_t* barrier;
+	int cached;
+	unsigned long iterations;
+	double elapsed;
+};
+
+static void* bench_tcache_thread( void* arg_ )
+{
+	struct bench_tcache_thread_t* arg = arg_;
+	void* objects[BENCH_BATCH];
+	unsigned long done;
+	double start;
+	int i;
+
+	pthread_barrier_wait(arg->barrier);
+	start = bench_now_ns( );
+	for( done = 0; done < arg->iterations; done += BENCH_BATCH ) {
+		if( arg->cached ) {
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				objects[i] = ctcache_alloc(sizeof(struct DTClassA));
+			}
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				ctcache_free(objects[i]);
+			}
+		}
+		else {
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				objects[i] = malloc(sizeof(struct DTClassA));
+			}
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				free(objects[i]);
+			}
+		}
+	}
+	arg->elapsed = bench_now_ns( ) - start;
+	return NULL;
+}
+
+/* Returns the slowest thread's time per allocation and free. */
+static double bench_tcache( int threads, int cached, unsigned long iterations )
+{
+	struct bench_tcache_thread_t args[BENCH_THREADS_MAX];
+	pthread_t ids[BENCH_THREADS_MAX];
+	pthread_barrier_t barrier;
+	double best = 0, slowest;
+	int i, repeat;
+
+	for( repeat = 0; repeat < BENCH_REPEATS; ++repeat ) {
+		pthread_barrier_init(&barrier, NULL, threads);
+		for( i = 0; i < threads; ++i ) {
+			args[i].barrier = &barrier;
+			args[i].cached = cached;
+			args[i].iterations = iterations;
+			pthread_create(&ids[i], NULL, bench_tcache_thread, &args[i]);
+		}
+		slowest = 0;
+		for( i = 0; i < threads; ++i ) {
+			pthread_join(ids[i], NULL);
+			if( args[i].elapsed > slowest ) {
+				slowest = args[i].elapsed;
+			}
+		}
+		pthread_barrier_destroy(&barrier);
+		if( repeat == 0 || slowest < best ) {
+			best = slowest;
+		}
+	}
+	return best / iterations;
+}
+
+static void bench_tcaches( unsigned long iterations )
+{
+	int threads;
+
+	for( threads = 1; threads <= BENCH_THREADS_MAX; threads *= 2 ) {
+		bench_report_threads("tcache", "malloc", threads, bench_tcache(threads, 0, iterations));
+	}
+	for( threads = 1; threads <= BENCH_THREADS_MAX; threads *= 2 ) {
+		bench_report_threads("tcache", "ctcache", threads, bench_tcache(threads, 1, iterations));
+	}
+}
+
+/****************************************************************************/
+/* Snapshots								    */
+/****************************************************************************/
+#define BENCH_SNAP_OBJECTS 100000
+
+static char bench_snap_path[] = "/tmp/bench_snapXXXXXX";
+
+static int bench_snap_init( void )
+{
+	struct csnap_writer_t writer;
+	struct GTRect* rects;
+	size_t i;
+	int fd, ok;
+
+	CREGISTRY_REGISTER(1, GTRect);
+	fd = mkstemp(bench_snap_path);
+	if( fd < 0 ) {
+		return 0;
+	}
+	close(fd);
+	rects = malloc(BENCH_SNAP_OBJECTS * sizeof(*rects));
+	if( rects == NULL ) {
+		return 0;
+	}
+	csnap_writer_init(&writer);
+	for( i = 0, ok = 1; ok && i < BENCH_SNAP_OBJECTS; ++i ) {
+		bench_vector_construct(&rects[i], i, NULL);
+		ok = csnap_add(&writer, &rects[i]);
+	}
+	ok = ok && csnap_write(&writer, bench_snap_path);
+	csnap_writer_destroy(&writer);
+	free(rects);
+	return ok;
+}
+
+static double bench_snap_construct( unsigned long iterations )
+{
+	struct GTRect* rect;
+	unsigned long done;
+	double start;
+
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; ++done ) {
+		rect = malloc(sizeof(*rect));
+		if( rect == NULL ) {
+			abort( );
+		}
+		bench_vector_construct(rect, done, NULL);
+		cmalloc(rect, free);
+		bench_sink = GTRect_perimeter(rect);
+		cdestroy(rect);
+	}
+	return bench_now_ns( ) - start;
+}
+
+static double bench_snap_load( unsigned long iterations, int flags )
+{
+	struct csnap_t snap;
+	unsigned long done;
+	double start;
+
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; done += BENCH_SNAP_OBJECTS ) {
+		if( !csnap_open(&snap, bench_snap_path, flags) ) {
+			abort( );
+		}
+		bench_sink = GTRect_perimeter(csnap_object(&snap, 0));
+		csnap_close(&snap);
+	}
+	return (bench_now_ns( ) - start) * iterations / done;
+}
+
+static double bench_snap_eager( unsigned long iterations )
+{
+	return bench_snap_load(iterations, CSNAP_EAGER);
+}
+
+static double bench_snap_lazy( unsigned long iterations )
+{
+	return bench_snap_load(iterations, CSNAP_LAZY);
+}
+
+/****************************************************************************/
+/* Cloning								    */
+/****************************************************************************/
+static struct GTRect bench_clone_array[BENCH_VECTOR_OBJECTS];
+
+static void bench_clone_size( void* object, size_t index, void* arg )
+{
+	(void) arg;
+	((struct GTRect*) object)->width = (int) index;
+}
+
+static double bench_clone_loop( unsigned long iterations, int clone )
+{
+	struct GTRect template;
+	struct GTRect rect;
+	unsigned long done;
+	double start;
+	int sum;
+
+	bench_vector_construct(&template, 3, NULL);
+	sum = 0;
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; ++done ) {
+		if( clone ) {
+			cclone(&template, &rect);
+		}
+		else {
+			bench_vector_construct(&rect, 3, NULL);
+		}
+		sum += GTRect_perimeter(&rect);
+		cdestroy(&rect);
+	}
+	bench_sink = sum;
+	cdestroy(&template);
+	return bench_now_ns( ) - start;
+}
+
+static double bench_clone_array_loop( unsigned long iterations, int clone )
+{
+	unsigned long done;
+	double start, elapsed;
+	size_t count, i;
+	int sum;
+
+	sum = 0;
+	elapsed = 0;
+	for( done = 0; done < iterations; done += count ) {
+		count = iterations - done < BENCH_VECTOR_OBJECTS ? iterations - done : BENCH_VECTOR_OBJECTS;
+		start = bench_now_ns( );
+		if( clone ) {
+			cnew_array(bench_vector_construct, bench_clone_array, count, bench_clone_size, NULL);
+		}
+		else {
+			for( i = 0; i < count; ++i ) {
+				bench_vector_construct(&bench_clone_array[i], i, NULL);
+			}
+		}
+		elapsed += bench_now_ns( ) - start;
+		sum += GTRect_perimeter(&bench_clone_array[count - 1]);
+		for( i = 0; i < count; ++i ) {
+			cdestroy(&bench_clone_array[i]);
+		}
+	}
+	bench_sink = sum;
+	return elapsed;
+}
+
+static double bench_clone_construct( unsigned long iterations )
+{
+	return bench_clone_loop(iterations, 0);
+}
+
+static double bench_clone_cclone( unsigned long iterations )
+{
+	return bench_clone_loop(iterations, 1);
+}
+
+static double bench_clone_construct_array( unsigned long iterations )
+{
+	return bench_clone_array_loop(iterations, 0);
+}
+
+static double bench_clone_cnew_array( unsigned long iterations )
+{
+	return bench_clone_array_loop(iterations, 1);
+}
+
+/****************************************************************************/
+/* Shared memory heaps							    */
+/****************************************************************************/
+#define BENCH_SHM_OBJECTS 1000
+#define BENCH_SHM_SIZE (4 << 20)
+
+static char bench_shm_name[64];
+static struct cshm_t bench_shm;
+static struct GTRect* bench_shm_rects[BENCH_SHM_OBJECTS];
+
+static int bench_shm_init( void )
+{
+	size_t i;
+
+	CREGISTRY_REGISTER(1, GTRect);
+	snprintf(bench_shm_name, sizeof(bench_shm_name), "/bench_shm_%ld", (long) getpid( ));
+	if( !cshm_create(&bench_shm, bench_shm_name, BENCH_SHM_SIZE) ) {
+		return 0;
+	}
+	for( i = 0; i < BENCH_SHM_OBJECTS; ++i ) {
+		bench_shm_rects[i] = cshm_alloc(&bench_shm, sizeof(struct GTRect));
+		if( bench_shm_rects[i] == NULL ) {
+			abort( );
+		}
+		bench_vector_construct(bench_shm_rects[i], i, NULL);
+	}
+	return 1;
+}
+
+static void bench_shm_destroy( void )
+{
+	cshm_close(&bench_shm);
+	cshm_unlink(bench_shm_name);
+}
+
+static double bench_shm_alloc( unsigned long iterations, int shared )
+{
+	void* blocks[BENCH_BATCH];
+	unsigned long done;
+	double start;
+	int i;
+
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; done += BENCH_BATCH ) {
+		if( shared ) {
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				blocks[i] = cshm_alloc(&bench_shm, sizeof(struct GTRect));
+			}
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				cshm_free(blocks[i]);
+			}
+		}
+		else {
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				blocks[i] = malloc(sizeof(struct GTRect));
+			}
+			for( i = 0; i < BENCH_BATCH; ++i ) {
+				free(blocks[i]);
+			}
+		}
+	}
+	return bench_now_ns( ) - start;
+}
+
+static double bench_shm_malloc( unsigned long iterations )
+{
+	return bench_shm_alloc(iterations, 0);
+}
+
+static double bench_shm_cshm( unsigned long iterations )
+{
+	return bench_shm_alloc(iterations, 1);
+}
+
+#ifdef CSHM
+static double bench_shm_call( unsigned long iterations )
+{
+	unsigned long done;
+	double start;
+	size_t i;
+	int sum;
+
+	sum = 0;
+	start = bench_now_ns( );
+	for( done = 0; done < iterations; done += BENCH_SHM_OBJECTS ) {
+		for( i = 0; i < BENCH_SHM_OBJECTS; ++i ) {
+			sum += GTRect_perimeter(bench_shm_rects[i]);
+		}
+	}
+	bench_sink = sum;
+	return (bench_now_ns( ) - start) * iterations / done;
+}
+#endif
+
+int main( int argc, char** argv )
+{
+	unsigned long iterations;
+	size_t variant;
+	int group, depth;
+#ifdef CSHM
+	size_t i;
+#endif
+
+	iterations = BENCH_ITERATIONS;
+	if( argc > 1 ) {
+		iterations = strtoul(argv[1], NULL, 0);
+	}
+	iterations = (iterations + BENCH_BATCH - 1) / BENCH_BATCH * BENCH_BATCH;
+	if( iterations == 0 ) {
+		iterations = BENCH_BATCH;
+	}
+
+	printf("{\n  \"iterations\": %lu,\n  \"results\": [", iterations);
+	for( group = 0; group < BENCH_GROUPS; ++group ) {
+		for( variant = 0; variant < sizeof(bench_variants) / sizeof(bench_variants[0]); ++variant ) {
+			for( depth = 1; depth <= BENCH_DEPTH_MAX; ++depth ) {
+				bench_loop_ft loop = bench_variants[variant]->cloops[group][depth - 1];
+
+				if( loop != NULL ) {
+					bench_report(bench_group_names[group], bench_variants[variant]->cname, depth,
+						     bench_measure(loop, iterations));
+				}
+			}
+		}
+	}
+	bench_report("arena", "cdestroy", 0, bench_measure(bench_arena_cdestroy, iterations));
+	bench_report("arena", "carena", 0, bench_measure(bench_arena_carena, iterations));
+	bench_refcounts(iterations);
+	bench_report("reaper", "cdestroy", 0, bench_measure(bench_reaper_cdestroy, iterations));
+	if( creaper_init(&bench_reaper_instance, NULL) ) {
+		bench_report("reaper", "cdestroy_async", 0, bench_measure(bench_reaper_async, iterations));
+		creaper_destroy(&bench_reaper_instance);
+	}
+	bench_icache_init( );
+	bench_report("icache", "vtable", 0, bench_measure(bench_icache_vtable_call, iterations));
+	bench_report("icache", "cicache", 0, bench_measure(bench_icache_cached, iterations));
+	bench_report("icache", "cicache_direct", 0, bench_measure(bench_icache_direct, iterations));
+	if( bench_vector_init( ) ) {
+		bench_report("vector", "pointers", 0, bench_measure(bench_vector_pointer_loop, iterations));
+		bench_report("vector", "cvector", 0, bench_measure(bench_vector_loop, iterations));
+		if( bench_handle_init( ) ) {
+			bench_report("handle", "pointers", 0, bench_measure(bench_vector_pointer_loop, iterations));
+			bench_report("handle", "chandle", 0, bench_measure(bench_handle_loop, iterations));
+			chandle_destroy(&bench_handle_table);
+		}
+		bench_vector_destroy( );
+	}
+	if( bench_poly_init( ) ) {
+		bench_report("poly", "interleaved", 0, bench_measure(bench_poly_interleaved_loop, iterations));
+		bench_report("poly", "cpoly", 0, bench_measure(bench_poly_loop, iterations));
+		bench_poly_destroy( );
+	}
+	bench_tcaches(iterations);
+	if( bench_snap_init( ) ) {
+		bench_report("snapshot", "construct", 0, bench_measure(bench_snap_construct, iterations));
+		bench_report("snapshot", "csnap_eager", 0, bench_measure(bench_snap_eager, iterations));
+		bench_report("snapshot", "csnap_lazy", 0, bench_measure(bench_snap_lazy, iterations));
+		unlink(bench_snap_path);
+	}
+	bench_report("clone", "construct", 0, bench_measure(bench_clone_construct, iterations));
+	bench_report("clone", "cclone", 0, bench_measure(bench_clone_cclone, iterations));
+	bench_report("clone", "construct_array", 0, bench_measure(bench_clone_construct_array, iterations));
+	bench_report("clone", "cnew_array", 0, bench_measure(bench_clone_cnew_array, iterations));
+	if( bench_shm_init( ) ) {
+		bench_report("shm", "malloc", 0, bench_measure(bench_shm_malloc, iterations));
+		bench_report("shm", "cshm", 0, bench_measure(bench_shm_cshm, iterations));
+#ifdef CSHM
+		bench_report("shm", "private_call", 0, bench_measure(bench_shm_call, iterations));
+		for( i = 0; i < BENCH_SHM_OBJECTS; ++i ) {
+			cshm_share(bench_shm_rects[i]);
+		}
+		bench_report("shm", "shared_call", 0, bench_measure(bench_shm_call, iterations));
+#endif
+		bench_shm_destroy( );
+	}
+	printf("\n  ]\n}\n");
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * Shared by the benchmark variants. Each variant, CObject, plain C calls,
+ * and C++ virtual calls, implements the same operations at the same depths,
+ * so their results line up next to each other.
+ */
+#ifndef BENCH_BENCH_H_
+#define BENCH_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Deepest hierarchy benchmarked. */
+#define BENCH_DEPTH_MAX 8
+
+/* Objects constructed, untimed, before timing their destruction. Iteration
+ * counts are always a multiple of this.
+ */
+#define BENCH_BATCH 256
+
+/* Hide where a pointer came from, so the compiler can neither devirtualize
+ * nor fold calls made through it.
+ */
+#define BENCH_HIDE( p ) __asm__ volatile( "" : "+r" (p) )
+
+/* Operations benchmarked. Each is run at hierarchy depths 1 through
+ * BENCH_DEPTH_MAX, or as deep as its classes go.
+ */
+enum bench_group_t
+{
+	BENCH_VIRTUAL,		/* Call a virtual method overridden at every depth. */
+	BENCH_SUPER,		/* Call a method which calls its super's, at every depth. */
+	BENCH_INTERFACE,	/* Call a nested interface's method, which calls its super's. */
+	BENCH_CAST,		/* Get an object from a nested interface reference. */
+	BENCH_CONSTRUCT,	/* Construct an object. */
+	BENCH_DESTROY,		/* Destroy an object. */
+	BENCH_GROUPS
+};
+
+/* Run an operation iterations times, returning the nanoseconds spent doing it. */
+typedef double (*bench_loop_ft)( unsigned long iterations );
+
+/* One implementation of every group, indexed by group then depth - 1. NULL
+ * where the variant doesn't go that deep.
+ */
+struct bench_variant_t
+{
+	const char*   cname;
+	bench_loop_ft cloops[BENCH_GROUPS][BENCH_DEPTH_MAX];
+};
+
+extern const struct bench_variant_t bench_cobject;
+extern const struct bench_variant_t bench_direct;
+extern const struct bench_variant_t bench_cpp;
+
+/* Monotonic time in nanoseconds. */
+double bench_now_ns( void );
+
+/* Results are stored here so the work producing them isn't optimized away. */
+extern volatile int bench_sink;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_BENCH_H_ */
@@ -0,0 +1,431 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+
+#include "bench_classes.h"
+
+/****************************************************************************/
+/* Class 1								    */
+/****************************************************************************/
+static int bClass1Value( struct BClass1* self )
+{
+	(void) self;
+	return 1;
+}
+
+static int bClass1Chain( struct BClass1* self )
+{
+	return self->value1;
+}
+
+static void bClass1Destroy( void* self_ )
+{
+	struct BClass1* self = ccast(self_);
+
+	*self->destroyed += 1;
+	cobject_destructor(self);
+}
+
+const struct cclass_info_t BClass1_Info =
+	CCLASS_INFO_INIT(struct BClass1, "BClass1", &cobject_info, B_CLASS1_INFO_DISPLAY);
+
+#define B_CLASS1_VTABLE_INIT						\
+	{								\
+		.CObject_VTable = COBJECT_VTABLE_INIT,			\
+		.CObject_VTable.cdestructor = bClass1Destroy,		\
+		.CObject_VTable.cinfo = &BClass1_Info,			\
+		.value = bClass1Value,					\
+		.chain = bClass1Chain					\
+	}
+CCLASS_VTABLE(struct BClass1_VTable, bClass1_VTable, B_CLASS1_VTABLE_INIT);
+
+const struct BClass1_VTable* BClass1_VTable_Key( )
+{
+	return &bClass1_VTable;
+}
+
+void newBClass1( struct BClass1* self, int* destroyed )
+{
+	cobject_init(&self->cobject);
+	cclass_set_cvtable(self, BClass1_VTable_Key( ));
+	self->value1 = 1;
+	self->destroyed = destroyed;
+}
+
+/****************************************************************************/
+/* Class 2								    */
+/****************************************************************************/
+static int bClass2Value( struct BClass1* self )
+{
+	(void) self;
+	return 2;
+}
+
+static int bClass2Chain( struct BClass1* self_ )
+{
+	struct BClass2* self = ccast(self_);
+	const struct BClass2_VTable* vtable = cclass_get_vtable(self);
+
+	return self->value2 + vtable->Supers_BClass1_VTable->chain(self_);
+}
+
+static void bClass2Destroy( void* self_ )
+{
+	struct BClass2* self = ccast(self_);
+	const struct BClass2_VTable* vtable = cclass_get_vtable(self);
+
+	*self->classSuper.destroyed += 2;
+	vtable->Supers_BClass1_VTable->CObject_VTable.cdestructor(self);
+}
+
+const struct cclass_info_t BClass2_Info =
+	CCLASS_INFO_INIT(struct BClass2, "BClass2", &BClass1_Info, B_CLASS2_INFO_DISPLAY);
+
+#define B_CLASS2_VTABLE_INIT						\
+	{								\
+		.BClass1_VTable = B_CLASS1_VTABLE_INIT,		\
+		.BClass1_VTable.CObject_VTable.cdestructor = bClass2Destroy,	\
+		.BClass1_VTable.CObject_VTable.cinfo = &BClass2_Info,	\
+		.BClass1_VTable.value = bClass2Value,			\
+		.BClass1_VTable.chain = bClass2Chain,			\
+		.Supers_BClass1_VTable = &bClass1_VTable		\
+	}
+CCLASS_VTABLE(struct BClass2_VTable, bClass2_VTable, B_CLASS2_VTABLE_INIT);
+
+const struct BClass2_VTable* BClass2_VTable_Key( )
+{
+	return &bClass2_VTable;
+}
+
+void newBClass2( struct BClass2* self, int* destroyed )
+{
+	newBClass1(&self->classSuper, destroyed);
+	cclass_set_cvtable(self, BClass2_VTable_Key( ));
+	self->value2 = 2;
+}
+
+/****************************************************************************/
+/* Class 3								    */
+/****************************************************************************/
+static int bClass3Value( struct BClass1* self )
+{
+	(void) self;
+	return 3;
+}
+
+static int bClass3Chain( struct BClass1* self_ )
+{
+	struct BClass3* self = ccast(self_);
+	const struct BClass3_VTable* vtable = cclass_get_vtable(self);
+
+	return self->value3 + vtable->Supers_BClass2_VTable->BClass1_VTable.chain(self_);
+}
+
+static void bClass3Destroy( void* self_ )
+{
+	struct BClass3* self = ccast(self_);
+	const struct BClass3_VTable* vtable = cclass_get_vtable(self);
+
+	*self->classSuper.classSuper.destroyed += 3;
+	vtable->Supers_BClass2_VTable->BClass1_VTable.CObject_VTable.cdestructor(self);
+}
+
+const struct cclass_info_t BClass3_Info =
+	CCLASS_INFO_INIT(struct BClass3, "BClass3", &BClass2_Info, B_CLASS3_INFO_DISPLAY);
+
+#define B_CLASS3_VTABLE_INIT						\
+	{								\
+		.BClass2_VTable = B_CLASS2_VTABLE_INIT,		\
+		.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor = bClass3Destroy,	\
+		.BClass2_VTable.BClass1_VTable.CObject_VTable.cinfo = &BClass3_Info,	\
+		.BClass2_VTable.BClass1_VTable.value = bClass3Value,			\
+		.BClass2_VTable.BClass1_VTable.chain = bClass3Chain,			\
+		.Supers_BClass2_VTable = &bClass2_VTable		\
+	}
+CCLASS_VTABLE(struct BClass3_VTable, bClass3_VTable, B_CLASS3_VTABLE_INIT);
+
+const struct BClass3_VTable* BClass3_VTable_Key( )
+{
+	return &bClass3_VTable;
+}
+
+void newBClass3( struct BClass3* self, int* destroyed )
+{
+	newBClass2(&self->classSuper, destroyed);
+	cclass_set_cvtable(self, BClass3_VTable_Key( ));
+	self->value3 = 3;
+}
+
+/****************************************************************************/
+/* Class 4								    */
+/****************************************************************************/
+static int bClass4Value( struct BClass1* self )
+{
+	(void) self;
+	return 4;
+}
+
+static int bClass4Chain( struct BClass1* self_ )
+{
+	struct BClass4* self = ccast(self_);
+	const struct BClass4_VTable* vtable = cclass_get_vtable(self);
+
+	return self->value4 + vtable->Supers_BClass3_VTable->BClass2_VTable.BClass1_VTable.chain(self_);
+}
+
+static void bClass4Destroy( void* self_ )
+{
+	struct BClass4* self = ccast(self_);
+	const struct BClass4_VTable* vtable = cclass_get_vtable(self);
+
+	*self->classSuper.classSuper.classSuper.destroyed += 4;
+	vtable->Supers_BClass3_VTable->BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor(self);
+}
+
+const struct cclass_info_t BClass4_Info =
+	CCLASS_INFO_INIT(struct BClass4, "BClass4", &BClass3_Info, B_CLASS4_INFO_DISPLAY);
+
+#define B_CLASS4_VTABLE_INIT						\
+	{								\
+		.BClass3_VTable = B_CLASS3_VTABLE_INIT,		\
+		.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor = bClass4Destroy,	\
+		.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cinfo = &BClass4_Info,	\
+		.BClass3_VTable.BClass2_VTable.BClass1_VTable.value = bClass4Value,			\
+		.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain = bClass4Chain,			\
+		.Supers_BClass3_VTable = &bClass3_VTable		\
+	}
+CCLASS_VTABLE(struct BClass4_VTable, bClass4_VTable, B_CLASS4_VTABLE_INIT);
+
+const struct BClass4_VTable* BClass4_VTable_Key( )
+{
+	return &bClass4_VTable;
+}
+
+void newBClass4( struct BClass4* self, int* destroyed )
+{
+	newBClass3(&self->classSuper, destroyed);
+	cclass_set_cvtable(self, BClass4_VTable_Key( ));
+	self->value4 = 4;
+}
+
+/****************************************************************************/
+/* Class 5								    */
+/****************************************************************************/
+static int bClass5Value( struct BClass1* self )
+{
+	(void) self;
+	return 5;
+}
+
+static int bClass5Chain( struct BClass1* self_ )
+{
+	struct BClass5* self = ccast(self_);
+	const struct BClass5_VTable* vtable = cclass_get_vtable(self);
+
+	return self->value5 + vtable->Supers_BClass4_VTable->BClass3_VTable.BClass2_VTable.BClass1_VTable.chain(self_);
+}
+
+static void bClass5Destroy( void* self_ )
+{
+	struct BClass5* self = ccast(self_);
+	const struct BClass5_VTable* vtable = cclass_get_vtable(self);
+
+	*self->classSuper.classSuper.classSuper.classSuper.destroyed += 5;
+	vtable->Supers_BClass4_VTable->BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor(self);
+}
+
+const struct cclass_info_t BClass5_Info =
+	CCLASS_INFO_INIT(struct BClass5, "BClass5", &BClass4_Info, B_CLASS5_INFO_DISPLAY);
+
+#define B_CLASS5_VTABLE_INIT						\
+	{								\
+		.BClass4_VTable = B_CLASS4_VTABLE_INIT,		\
+		.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor = bClass5Destroy,	\
+		.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cinfo = &BClass5_Info,	\
+		.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.value = bClass5Value,			\
+		.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain = bClass5Chain,			\
+		.Supers_BClass4_VTable = &bClass4_VTable		\
+	}
+CCLASS_VTABLE(struct BClass5_VTable, bClass5_VTable, B_CLASS5_VTABLE_INIT);
+
+const struct BClass5_VTable* BClass5_VTable_Key( )
+{
+	return &bClass5_VTable;
+}
+
+void newBClass5( struct BClass5* self, int* destroyed )
+{
+	newBClass4(&self->classSuper, destroyed);
+	cclass_set_cvtable(self, BClass5_VTable_Key( ));
+	self->value5 = 5;
+}
+
+/****************************************************************************/
+/* Class 6								    */
+/****************************************************************************/
+static int bClass6Value( struct BClass1* self )
+{
+	(void) self;
+	return 6;
+}
+
+static int bClass6Chain( struct BClass1* self_ )
+{
+	struct BClass6* self = ccast(self_);
+	const struct BClass6_VTable* vtable = cclass_get_vtable(self);
+
+	return self->value6 + vtable->Supers_BClass5_VTable->BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain(self_);
+}
+
+static void bClass6Destroy( void* self_ )
+{
+	struct BClass6* self = ccast(self_);
+	const struct BClass6_VTable* vtable = cclass_get_vtable(self);
+
+	*self->classSuper.classSuper.classSuper.classSuper.classSuper.destroyed += 6;
+	vtable->Supers_BClass5_VTable->BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor(self);
+}
+
+const struct cclass_info_t BClass6_Info =
+	CCLASS_INFO_INIT(struct BClass6, "BClass6", &BClass5_Info, B_CLASS6_INFO_DISPLAY);
+
+#define B_CLASS6_VTABLE_INIT						\
+	{								\
+		.BClass5_VTable = B_CLASS5_VTABLE_INIT,		\
+		.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor = bClass6Destroy,	\
+		.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cinfo = &BClass6_Info,	\
+		.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.value = bClass6Value,			\
+		.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain = bClass6Chain,			\
+		.Supers_BClass5_VTable = &bClass5_VTable		\
+	}
+CCLASS_VTABLE(struct BClass6_VTable, bClass6_VTable, B_CLASS6_VTABLE_INIT);
+
+const struct BClass6_VTable* BClass6_VTable_Key( )
+{
+	return &bClass6_VTable;
+}
+
+void newBClass6( struct BClass6* self, int* destroyed )
+{
+	newBClass5(&self->classSuper, destroyed);
+	cclass_set_cvtable(self, BClass6_VTable_Key( ));
+	self->value6 = 6;
+}
+
+/****************************************************************************/
+/* Class 7								    */
+/****************************************************************************/
+static int bClass7Value( struct BClass1* self )
+{
+	(void) self;
+	return 7;
+}
+
+static int bClass7Chain( struct BClass1* self_ )
+{
+	struct BClass7* self = ccast(self_);
+	const struct BClass7_VTable* vtable = cclass_get_vtable(self);
+
+	return self->value7 + vtable->Supers_BClass6_VTable->BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain(self_);
+}
+
+static void bClass7Destroy( void* self_ )
+{
+	struct BClass7* self = ccast(self_);
+	const struct BClass7_VTable* vtable = cclass_get_vtable(self);
+
+	*self->classSuper.classSuper.classSuper.classSuper.classSuper.classSuper.destroyed += 7;
+	vtable->Supers_BClass6_VTable->BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor(self);
+}
+
+const struct cclass_info_t BClass7_Info =
+	CCLASS_INFO_INIT(struct BClass7, "BClass7", &BClass6_Info, B_CLASS7_INFO_DISPLAY);
+
+#define B_CLASS7_VTABLE_INIT						\
+	{								\
+		.BClass6_VTable = B_CLASS6_VTABLE_INIT,		\
+		.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor = bClass7Destroy,	\
+		.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cinfo = &BClass7_Info,	\
+		.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.value = bClass7Value,			\
+		.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain = bClass7Chain,			\
+		.Supers_BClass6_VTable = &bClass6_VTable		\
+	}
+CCLASS_VTABLE(struct BClass7_VTable, bClass7_VTable, B_CLASS7_VTABLE_INIT);
+
+const struct BClass7_VTable* BClass7_VTable_Key( )
+{
+	return &bClass7_VTable;
+}
+
+void newBClass7( struct BClass7* self, int* destroyed )
+{
+	newBClass6(&self->classSuper, destroyed);
+	cclass_set_cvtable(self, BClass7_VTable_Key( ));
+	self->value7 = 7;
+}
+
+/****************************************************************************/
+/* Class 8								    */
+/****************************************************************************/
+static int bClass8Value( struct BClass1* self )
+{
+	(void) self;
+	return 8;
+}
+
+static int bClass8Chain( struct BClass1* self_ )
+{
+	struct BClass8* self = ccast(self_);
+	const struct BClass8_VTable* vtable = cclass_get_vtable(self);
+
+	return self->value8 + vtable->Supers_BClass7_VTable->BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain(self_);
+}
+
+static void bClass8Destroy( void* self_ )
+{
+	struct BClass8* self = ccast(self_);
+	const struct BClass8_VTable* vtable = cclass_get_vtable(self);
+
+	*self->classSuper.classSuper.classSuper.classSuper.classSuper.classSuper.classSuper.destroyed += 8;
+	vtable->Supers_BClass7_VTable->BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor(self);
+}
+
+const struct cclass_info_t BClass8_Info =
+	CCLASS_INFO_INIT(struct BClass8, "BClass8", &BClass7_Info, B_CLASS8_INFO_DISPLAY);
+
+#define B_CLASS8_VTABLE_INIT						\
+	{								\
+		.BClass7_VTable = B_CLASS7_VTABLE_INIT,		\
+		.BClass7_VTable.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cdestructor = bClass8Destroy,	\
+		.BClass7_VTable.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.CObject_VTable.cinfo = &BClass8_Info,	\
+		.BClass7_VTable.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.value = bClass8Value,			\
+		.BClass7_VTable.BClass6_VTable.BClass5_VTable.BClass4_VTable.BClass3_VTable.BClass2_VTable.BClass1_VTable.chain = bClass8Chain,			\
+		.Supers_BClass7_VTable = &bClass7_VTable		\
+	}
+CCLASS_VTABLE(struct BClass8_VTable, bClass8_VTable, B_CLASS8_VTABLE_INIT);
+
+const struct BClass8_VTable* BClass8_VTable_Key( )
+{
+	return &bClass8_VTable;
+}
+
+void newBClass8( struct BClass8* self, int* destroyed )
+{
+	newBClass7(&self->classSuper, destroyed);
+	cclass_set_cvtable(self, BClass8_VTable_Key( ));
+	self->value8 = 8;
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * A hierarchy of classes eight deep for benchmarks, BClass1 inherits from
+ * cobject_t and BClassN inherits from BClassN-1. Every class overrides:
+ *
+ *	value( ): returns the class' depth without calling its super.
+ *
+ *	chain( ): returns the sum of the class' depth and its super's chain( ),
+ *	through the Supers_ vtable, so one call makes a call per level.
+ *
+ *	The destructor: adds the class' depth to the object's counter then calls
+ *	its super's destructor.
+ */
+#ifndef BENCH_BENCH_CLASSES_H_
+#define BENCH_BENCH_CLASSES_H_
+
+#include <cobject.h>
+
+/****************************************************************************/
+/* Class 1								    */
+/****************************************************************************/
+struct BClass1
+{
+	struct cobject_t cobject;
+
+	int value1;
+	int* destroyed;
+};
+
+struct BClass1_VTable
+{
+	struct cobject_vtable_t CObject_VTable;
+
+	int (*value)( struct BClass1* );
+	int (*chain)( struct BClass1* );
+};
+
+extern const struct cclass_info_t BClass1_Info;
+#define B_CLASS1_INFO_DISPLAY COBJECT_INFO_DISPLAY, &BClass1_Info
+const struct BClass1_VTable* BClass1_VTable_Key( );
+void newBClass1( struct BClass1*, int* );
+
+static inline int BClass1_Value( struct BClass1* self )
+{
+	return ((const struct BClass1_VTable*) cclass_get_vtable(self))->value(self);
+}
+
+static inline int BClass1_Chain( struct BClass1* self )
+{
+	return ((const struct BClass1_VTable*) cclass_get_vtable(self))->chain(self);
+}
+
+/****************************************************************************/
+/* Class 2								    */
+/****************************************************************************/
+struct BClass2
+{
+	struct BClass1 classSuper;
+
+	int value2;
+};
+
+struct BClass2_VTable
+{
+	struct BClass1_VTable BClass1_VTable;
+	const struct BClass1_VTable* Supers_BClass1_VTable;
+};
+
+extern const struct cclass_info_t BClass2_Info;
+#define B_CLASS2_INFO_DISPLAY B_CLASS1_INFO_DISPLAY, &BClass2_Info
+const struct BClass2_VTable* BClass2_VTable_Key( );
+void newBClass2( struct BClass2*, int* );
+
+/****************************************************************************/
+/* Class 3								    */
+/****************************************************************************/
+struct BClass3
+{
+	struct BClass2 classSuper;
+
+	int value3;
+};
+
+struct BClass3_VTable
+{
+	struct BClass2_VTable BClass2_VTable;
+	const struct BClass2_VTable* Supers_BClass2_VTable;
+};
+
+extern const struct cclass_info_t BClass3_Info;
+#define B_CLASS3_INFO_DISPLAY B_CLASS2_INFO_DISPLAY, &BClass3_Info
+const struct BClass3_VTable* BClass3_VTable_Key( );
+void newBClass3( struct BClass3*, int* );
+
+/****************************************************************************/
+/* Class 4								    */
+/****************************************************************************/
+struct BClass4
+{
+	struct BClass3 classSuper;
+
+	int value4;
+};
+
+struct BClass4_VTable
+{
+	struct BClass3_VTable BClass3_VTable;
+	const struct BClass3_VTable* Supers_BClass3_VTable;
+};
+
+extern const struct cclass_info_t BClass4_Info;
+#define B_CLASS4_INFO_DISPLAY B_CLASS3_INFO_DISPLAY, &BClass4_Info
+const struct BClass4_VTable* BClass4_VTable_Key( );
+void newBClass4( struct BClass4*, int* );
+
+/****************************************************************************/
+/* Class 5								    */
+/****************************************************************************/
+struct BClass5
+{
+	struct BClass4 classSuper;
+
+	int value5;
+};
+
+struct BClass5_VTable
+{
+	struct BClass4_VTable BClass4_VTable;
+	const struct BClass4_VTable* Supers_BClass4_VTable;
+};
+
+extern const struct cclass_info_t BClass5_Info;
+#define B_CLASS5_INFO_DISPLAY B_CLASS4_INFO_DISPLAY, &BClass5_Info
+const struct BClass5_VTable* BClass5_VTable_Key( );
+void newBClass5( struct BClass5*, int* );
+
+/****************************************************************************/
+/* Class 6								    */
+/****************************************************************************/
+struct BClass6
+{
+	struct BClass5 classSuper;
+
+	int value6;
+};
+
+struct BClass6_VTable
+{
+	struct BClass5_VTable BClass5_VTable;
+	const struct BClass5_VTable* Supers_BClass5_VTable;
+};
+
+extern const struct cclass_info_t BClass6_Info;
+#define B_CLASS6_INFO_DISPLAY B_CLASS5_INFO_DISPLAY, &BClass6_Info
+const struct BClass6_VTable* BClass6_VTable_Key( );
+void newBClass6( struct BClass6*, int* );
+
+/****************************************************************************/
+/* Class 7								    */
+/****************************************************************************/
+struct BClass7
+{
+	struct BClass6 classSuper;
+
+	int value7;
+};
+
+struct BClass7_VTable
+{
+	struct BClass6_VTable BClass6_VTable;
+	const struct BClass6_VTable* Supers_BClass6_VTable;
+};
+
+extern const struct cclass_info_t BClass7_Info;
+#define B_CLASS7_INFO_DISPLAY B_CLASS6_INFO_DISPLAY, &BClass7_Info
+const struct BClass7_VTable* BClass7_VTable_Key( );
+void newBClass7( struct BClass7*, int* );
+
+/****************************************************************************/
+/* Class 8								    */
+/****************************************************************************/
+struct BClass8
+{
+	struct BClass7 classSuper;
+
+	int value8;
+};
+
+struct BClass8_VTable
+{
+	struct BClass7_VTable BClass7_VTable;
+	const struct BClass7_VTable* Supers_BClass7_VTable;
+};
+
+extern const struct cclass_info_t BClass8_Info;
+#define B_CLASS8_INFO_DISPLAY B_CLASS7_INFO_DISPLAY, &BClass8_Info
+const struct BClass8_VTable* BClass8_VTable_Key( );
+void newBClass8( struct BClass8*, int* );
+
+
+#endif /* BENCH_BENCH_CLASSES_H_ */
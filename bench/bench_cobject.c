@@ -0,0 +1,218 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * The CObject variant of the benchmarks. Virtual and super calls, and
+ * construction and destruction, use the BClass hierarchy. Interface calls and
+ * casts go through ITInterface0 nested in ITInterface1 of ITClassA to C.
+ */
+
+#include "bench.h"
+#include "bench_classes.h"
+#include <test_classes/interface_test_classes.h>
+
+/****************************************************************************/
+/* Class hierarchy							    */
+/****************************************************************************/
+#define BENCH_COBJECT_LOOPS( N )						\
+static double bench_virtual_##N( unsigned long iterations )			\
+{										\
+	struct BClass##N object;						\
+	struct BClass1* ref;							\
+	unsigned long i;							\
+	double start, end;							\
+	int destroyed, sum = 0;							\
+										\
+	newBClass##N(&object, &destroyed);					\
+	ref = (struct BClass1*) &object;					\
+	BENCH_HIDE(ref);							\
+	start = bench_now_ns( );						\
+	for( i = 0; i < iterations; ++i ) {					\
+		sum += BClass1_Value(ref);					\
+	}									\
+	end = bench_now_ns( );							\
+	bench_sink = sum;							\
+	return end - start;							\
+}										\
+										\
+static double bench_super_##N( unsigned long iterations )			\
+{										\
+	struct BClass##N object;						\
+	struct BClass1* ref;							\
+	unsigned long i;							\
+	double start, end;							\
+	int destroyed, sum = 0;							\
+										\
+	newBClass##N(&object, &destroyed);					\
+	ref = (struct BClass1*) &object;					\
+	BENCH_HIDE(ref);							\
+	start = bench_now_ns( );						\
+	for( i = 0; i < iterations; ++i ) {					\
+		sum += BClass1_Chain(ref);					\
+	}									\
+	end = bench_now_ns( );							\
+	bench_sink = sum;							\
+	return end - start;							\
+}										\
+										\
+static double bench_construct_##N( unsigned long iterations )			\
+{										\
+	struct BClass##N object;						\
+	unsigned long i;							\
+	double start, end;							\
+	int destroyed;								\
+										\
+	start = bench_now_ns( );						\
+	for( i = 0; i < iterations; ++i ) {					\
+		newBClass##N(&object, &destroyed);				\
+	}									\
+	end = bench_now_ns( );							\
+	return end - start;							\
+}										\
+										\
+static double bench_destroy_##N( unsigned long iterations )			\
+{										\
+	static struct BClass##N objects[BENCH_BATCH];				\
+	unsigned long i, j;							\
+	double start, elapsed = 0;						\
+	int destroyed = 0;							\
+										\
+	for( i = 0; i < iterations; i += BENCH_BATCH ) {			\
+		for( j = 0; j < BENCH_BATCH; ++j ) {				\
+			newBClass##N(&objects[j], &destroyed);			\
+		}								\
+		start = bench_now_ns( );					\
+		for( j = 0; j < BENCH_BATCH; ++j ) {				\
+			cdestroy(&objects[j]);					\
+		}								\
+		elapsed += bench_now_ns( ) - start;				\
+	}									\
+	bench_sink = destroyed;							\
+	return elapsed;								\
+}
+
+BENCH_COBJECT_LOOPS(1)
+BENCH_COBJECT_LOOPS(2)
+BENCH_COBJECT_LOOPS(3)
+BENCH_COBJECT_LOOPS(4)
+BENCH_COBJECT_LOOPS(5)
+BENCH_COBJECT_LOOPS(6)
+BENCH_COBJECT_LOOPS(7)
+BENCH_COBJECT_LOOPS(8)
+
+
+/****************************************************************************/
+/* Interfaces								    */
+/****************************************************************************/
+static double bench_interface( struct ITInterface0* ref, unsigned long iterations )
+{
+	unsigned long i;
+	double start, end;
+	int sum = 0;
+
+	BENCH_HIDE(ref);
+	start = bench_now_ns( );
+	for( i = 0; i < iterations; ++i ) {
+		sum += ITInterface0_Method0(ref);
+	}
+	end = bench_now_ns( );
+	bench_sink = sum;
+	return end - start;
+}
+
+static double bench_cast( struct ITInterface0* ref, unsigned long iterations )
+{
+	unsigned long i;
+	double start, end;
+	void* object;
+
+	start = bench_now_ns( );
+	for( i = 0; i < iterations; ++i ) {
+		BENCH_HIDE(ref);
+		object = ccast(ref);
+		BENCH_HIDE(object);
+	}
+	end = bench_now_ns( );
+	return end - start;
+}
+
+static double bench_interface_1( unsigned long iterations )
+{
+	struct ITClassA object;
+
+	newITClassA(&object);
+	return bench_interface(&object.itInterface1.itInterface0, iterations);
+}
+
+static double bench_interface_2( unsigned long iterations )
+{
+	struct ITClassB object;
+
+	newITClassB(&object);
+	return bench_interface(&object.classA.itInterface1.itInterface0, iterations);
+}
+
+static double bench_interface_3( unsigned long iterations )
+{
+	struct ITClassC object;
+
+	newITClassC(&object);
+	return bench_interface(&object.classB.classA.itInterface1.itInterface0, iterations);
+}
+
+static double bench_cast_1( unsigned long iterations )
+{
+	struct ITClassA object;
+
+	newITClassA(&object);
+	return bench_cast(&object.itInterface1.itInterface0, iterations);
+}
+
+static double bench_cast_2( unsigned long iterations )
+{
+	struct ITClassB object;
+
+	newITClassB(&object);
+	return bench_cast(&object.classA.itInterface1.itInterface0, iterations);
+}
+
+static double bench_cast_3( unsigned long iterations )
+{
+	struct ITClassC object;
+
+	newITClassC(&object);
+	return bench_cast(&object.classB.classA.itInterface1.itInterface0, iterations);
+}
+
+
+/****************************************************************************/
+/* Variant								    */
+/****************************************************************************/
+#define BENCH_DEPTHS( name )							\
+	{ name##_1, name##_2, name##_3, name##_4, name##_5, name##_6, name##_7, name##_8 }
+
+const struct bench_variant_t bench_cobject =
+{
+	.cname = "cobject",
+	.cloops = {
+		[BENCH_VIRTUAL] = BENCH_DEPTHS(bench_virtual),
+		[BENCH_SUPER] = BENCH_DEPTHS(bench_super),
+		[BENCH_INTERFACE] = { bench_interface_1, bench_interface_2, bench_interface_3 },
+		[BENCH_CAST] = { bench_cast_1, bench_cast_2, bench_cast_3 },
+		[BENCH_CONSTRUCT] = BENCH_DEPTHS(bench_construct),
+		[BENCH_DESTROY] = BENCH_DEPTHS(bench_destroy)
+	}
+};
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * The C++ variant of the benchmarks, what the compiler does with the same
+ * classes written as C++ classes with virtual methods. BClass<N> mirrors the
+ * BClass hierarchy, and ITClassA to C mirror the interface test classes,
+ * with interfaces as abstract bases. Super calls are qualified calls to the
+ * base's method, and a cast from an interface is dynamic_cast<void*>( ).
+ */
+
+#include "bench.h"
+#include <new>
+
+namespace {
+
+/****************************************************************************/
+/* Class hierarchy							    */
+/****************************************************************************/
+template<int N> struct BClass;
+
+template<> struct BClass<0>
+{
+	int* destroyed;
+
+	BClass( int* destroyed_ ) : destroyed(destroyed_) { }
+	virtual ~BClass( ) { }
+	virtual int value( ) { return 0; }
+	virtual int chain( ) { return 0; }
+};
+
+template<int N> struct BClass : BClass<N - 1>
+{
+	int valueN;
+
+	BClass( int* destroyed_ ) : BClass<N - 1>(destroyed_), valueN(N) { }
+	virtual ~BClass( ) { *this->destroyed += N; }
+	virtual int value( ) { return N; }
+	virtual int chain( ) { return valueN + BClass<N - 1>::chain( ); }
+};
+
+template<int N> double bench_virtual( unsigned long iterations )
+{
+	int destroyed;
+	BClass<N> object(&destroyed);
+	BClass<0>* ref = &object;
+	int sum = 0;
+
+	BENCH_HIDE(ref);
+	double start = bench_now_ns( );
+	for( unsigned long i = 0; i < iterations; ++i ) {
+		sum += ref->value( );
+	}
+	double end = bench_now_ns( );
+	bench_sink = sum;
+	return end - start;
+}
+
+template<int N> double bench_super( unsigned long iterations )
+{
+	int destroyed;
+	BClass<N> object(&destroyed);
+	BClass<0>* ref = &object;
+	int sum = 0;
+
+	BENCH_HIDE(ref);
+	double start = bench_now_ns( );
+	for( unsigned long i = 0; i < iterations; ++i ) {
+		sum += ref->chain( );
+	}
+	double end = bench_now_ns( );
+	bench_sink = sum;
+	return end - start;
+}
+
+template<int N> double bench_construct( unsigned long iterations )
+{
+	static char storage[sizeof(BClass<N>)] __attribute__((aligned(16)));
+	int destroyed;
+
+	double start = bench_now_ns( );
+	for( unsigned long i = 0; i < iterations; ++i ) {
+		void* memory = storage;
+
+		BENCH_HIDE(memory);
+		BClass<N>* object = new (memory) BClass<N>(&destroyed);
+		BENCH_HIDE(object);
+	}
+	double end = bench_now_ns( );
+	return end - start;
+}
+
+template<int N> double bench_destroy( unsigned long iterations )
+{
+	static char storage[BENCH_BATCH][sizeof(BClass<N>)] __attribute__((aligned(16)));
+	BClass<0>* objects[BENCH_BATCH];
+	double elapsed = 0;
+	int destroyed = 0;
+
+	for( unsigned long i = 0; i < iterations; i += BENCH_BATCH ) {
+		for( unsigned long j = 0; j < BENCH_BATCH; ++j ) {
+			objects[j] = new (storage[j]) BClass<N>(&destroyed);
+			BENCH_HIDE(objects[j]);
+		}
+		double start = bench_now_ns( );
+		for( unsigned long j = 0; j < BENCH_BATCH; ++j ) {
+			objects[j]->~BClass<0>( );
+		}
+		elapsed += bench_now_ns( ) - start;
+	}
+	bench_sink = destroyed;
+	return elapsed;
+}
+
+
+/****************************************************************************/
+/* Interfaces								    */
+/****************************************************************************/
+struct ITInterface0
+{
+	virtual int i0method0( ) = 0;
+	virtual int i0method1( ) = 0;
+protected:
+	~ITInterface0( ) { }
+};
+
+struct ITInterface1 : ITInterface0
+{
+	virtual int i1method0( ) = 0;
+protected:
+	~ITInterface1( ) { }
+};
+
+struct ITInterface2
+{
+	virtual int i2method0( ) = 0;
+	virtual int i2method1( ) = 0;
+protected:
+	~ITInterface2( ) { }
+};
+
+struct ITClassA : BClass<0>, ITInterface2, ITInterface1
+{
+	ITClassA( ) : BClass<0>(0) { }
+	virtual int i0method0( ) { return 1; }
+	virtual int i0method1( ) { return 2; }
+	virtual int i2method0( ) { return 3; }
+	virtual int i2method1( ) { return 4; }
+	virtual int i1method0( ) { return 5; }
+};
+
+struct ITClassB : ITClassA
+{
+	virtual int i0method0( ) { return 6 + ITClassA::i0method0( ); }
+	virtual int i0method1( ) { return 7; }
+	virtual int i2method0( ) { return 8 + ITClassA::i2method0( ); }
+	virtual int i2method1( ) { return 9; }
+};
+
+struct ITClassC : ITClassB
+{
+	virtual int i0method0( ) { return 10 + ITClassB::i0method0( ); }
+	virtual int i2method0( ) { return 11 + ITClassB::i2method0( ); }
+	virtual int i1method0( ) { return 12 + ITClassB::i1method0( ); }
+};
+
+template<class T> double bench_interface( unsigned long iterations )
+{
+	T object;
+	ITInterface0* ref = &object;
+	int sum = 0;
+
+	BENCH_HIDE(ref);
+	double start = bench_now_ns( );
+	for( unsigned long i = 0; i < iterations; ++i ) {
+		sum += ref->i0method0( );
+	}
+	double end = bench_now_ns( );
+	bench_sink = sum;
+	return end - start;
+}
+
+template<class T> double bench_cast( unsigned long iterations )
+{
+	T object;
+	ITInterface0* ref = &object;
+
+	double start = bench_now_ns( );
+	for( unsigned long i = 0; i < iterations; ++i ) {
+		BENCH_HIDE(ref);
+		void* root = dynamic_cast<void*>(ref);
+		BENCH_HIDE(root);
+	}
+	double end = bench_now_ns( );
+	return end - start;
+}
+
+}
+
+
+/****************************************************************************/
+/* Variant								    */
+/****************************************************************************/
+#define BENCH_DEPTHS( name )							\
+	{ name<1>, name<2>, name<3>, name<4>, name<5>, name<6>, name<7>, name<8> }
+
+extern "C" const struct bench_variant_t bench_cpp =
+{
+	"cpp",
+	{
+		BENCH_DEPTHS(bench_virtual),
+		BENCH_DEPTHS(bench_super),
+		{ bench_interface<ITClassA>, bench_interface<ITClassB>, bench_interface<ITClassC>, 0, 0, 0, 0, 0 },
+		{ bench_cast<ITClassA>, bench_cast<ITClassB>, bench_cast<ITClassC>, 0, 0, 0, 0, 0 },
+		BENCH_DEPTHS(bench_construct),
+		BENCH_DEPTHS(bench_destroy)
+	}
+};
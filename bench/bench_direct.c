@@ -0,0 +1,267 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * The direct call variant of the benchmarks, the floor the other variants are
+ * measured against. Structures nest like the BClass hierarchy, but every
+ * call is a direct call to a function the compiler can't inline or analyze,
+ * and there are no vtables. A virtual call becomes one call, a super call
+ * chain, constructor, or destructor becomes a chain of one call per level,
+ * and a cast from an interface becomes subtracting a constant offset.
+ */
+
+#include "bench.h"
+#include <test_classes/interface_test_classes.h>
+#include <stddef.h>
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define BENCH_DIRECT __attribute__((noipa))
+#else
+#define BENCH_DIRECT __attribute__((noinline))
+#endif
+
+/****************************************************************************/
+/* Structures								    */
+/****************************************************************************/
+struct bench_direct_1
+{
+	int value1;
+	int* destroyed;
+};
+
+#define BENCH_DIRECT_STRUCT( N, P )						\
+struct bench_direct_##N								\
+{										\
+	struct bench_direct_##P super;						\
+	int value##N;								\
+};
+
+BENCH_DIRECT_STRUCT(2, 1)
+BENCH_DIRECT_STRUCT(3, 2)
+BENCH_DIRECT_STRUCT(4, 3)
+BENCH_DIRECT_STRUCT(5, 4)
+BENCH_DIRECT_STRUCT(6, 5)
+BENCH_DIRECT_STRUCT(7, 6)
+BENCH_DIRECT_STRUCT(8, 7)
+
+
+/****************************************************************************/
+/* Methods								    */
+/****************************************************************************/
+BENCH_DIRECT static int bench_direct_value( void* self )
+{
+	(void) self;
+	return 1;
+}
+
+BENCH_DIRECT static int bench_direct_chain_1( struct bench_direct_1* self )
+{
+	return self->value1;
+}
+
+BENCH_DIRECT static void bench_direct_init_1( struct bench_direct_1* self, int* destroyed )
+{
+	self->value1 = 1;
+	self->destroyed = destroyed;
+}
+
+BENCH_DIRECT static void bench_direct_fini_1( struct bench_direct_1* self )
+{
+	*self->destroyed += 1;
+}
+
+#define BENCH_DIRECT_METHODS( N, P )						\
+BENCH_DIRECT static int bench_direct_chain_##N( struct bench_direct_##N* self )	\
+{										\
+	return self->value##N + bench_direct_chain_##P(&self->super);		\
+}										\
+										\
+BENCH_DIRECT static void bench_direct_init_##N( struct bench_direct_##N* self, int* destroyed ) \
+{										\
+	bench_direct_init_##P(&self->super, destroyed);				\
+	self->value##N = N;							\
+}										\
+										\
+BENCH_DIRECT static void bench_direct_fini_##N( struct bench_direct_##N* self )	\
+{										\
+	struct bench_direct_1* base = (struct bench_direct_1*) self;		\
+										\
+	*base->destroyed += N;							\
+	bench_direct_fini_##P(&self->super);					\
+}
+
+BENCH_DIRECT_METHODS(2, 1)
+BENCH_DIRECT_METHODS(3, 2)
+BENCH_DIRECT_METHODS(4, 3)
+BENCH_DIRECT_METHODS(5, 4)
+BENCH_DIRECT_METHODS(6, 5)
+BENCH_DIRECT_METHODS(7, 6)
+BENCH_DIRECT_METHODS(8, 7)
+
+
+/****************************************************************************/
+/* Loops								    */
+/****************************************************************************/
+#define BENCH_DIRECT_LOOPS( N )							\
+static double bench_virtual_##N( unsigned long iterations )			\
+{										\
+	struct bench_direct_##N object;						\
+	void* ref;								\
+	unsigned long i;							\
+	double start, end;							\
+	int destroyed, sum = 0;							\
+										\
+	bench_direct_init_##N(&object, &destroyed);				\
+	ref = &object;								\
+	BENCH_HIDE(ref);							\
+	start = bench_now_ns( );						\
+	for( i = 0; i < iterations; ++i ) {					\
+		sum += bench_direct_value(ref);					\
+	}									\
+	end = bench_now_ns( );							\
+	bench_sink = sum;							\
+	return end - start;							\
+}										\
+										\
+static double bench_super_##N( unsigned long iterations )			\
+{										\
+	struct bench_direct_##N object;						\
+	struct bench_direct_##N* ref;						\
+	unsigned long i;							\
+	double start, end;							\
+	int destroyed, sum = 0;							\
+										\
+	bench_direct_init_##N(&object, &destroyed);				\
+	ref = &object;								\
+	BENCH_HIDE(ref);							\
+	start = bench_now_ns( );						\
+	for( i = 0; i < iterations; ++i ) {					\
+		sum += bench_direct_chain_##N(ref);				\
+	}									\
+	end = bench_now_ns( );							\
+	bench_sink = sum;							\
+	return end - start;							\
+}										\
+										\
+static double bench_construct_##N( unsigned long iterations )			\
+{										\
+	struct bench_direct_##N object;						\
+	unsigned long i;							\
+	double start, end;							\
+	int destroyed;								\
+										\
+	start = bench_now_ns( );						\
+	for( i = 0; i < iterations; ++i ) {					\
+		bench_direct_init_##N(&object, &destroyed);			\
+	}									\
+	end = bench_now_ns( );							\
+	return end - start;							\
+}										\
+										\
+static double bench_destroy_##N( unsigned long iterations )			\
+{										\
+	static struct bench_direct_##N objects[BENCH_BATCH];			\
+	unsigned long i, j;							\
+	double start, elapsed = 0;						\
+	int destroyed = 0;							\
+										\
+	for( i = 0; i < iterations; i += BENCH_BATCH ) {			\
+		for( j = 0; j < BENCH_BATCH; ++j ) {				\
+			bench_direct_init_##N(&objects[j], &destroyed);		\
+		}								\
+		start = bench_now_ns( );					\
+		for( j = 0; j < BENCH_BATCH; ++j ) {				\
+			bench_direct_fini_##N(&objects[j]);			\
+		}								\
+		elapsed += bench_now_ns( ) - start;				\
+	}									\
+	bench_sink = destroyed;							\
+	return elapsed;								\
+}
+
+BENCH_DIRECT_LOOPS(1)
+BENCH_DIRECT_LOOPS(2)
+BENCH_DIRECT_LOOPS(3)
+BENCH_DIRECT_LOOPS(4)
+BENCH_DIRECT_LOOPS(5)
+BENCH_DIRECT_LOOPS(6)
+BENCH_DIRECT_LOOPS(7)
+BENCH_DIRECT_LOOPS(8)
+
+
+/****************************************************************************/
+/* Interfaces								    */
+/****************************************************************************/
+/* An interface method calling its super's at each depth is the same chain of
+ * direct calls as a super call.
+ */
+#define bench_interface_1 bench_super_1
+#define bench_interface_2 bench_super_2
+#define bench_interface_3 bench_super_3
+
+static double bench_cast( size_t offset, unsigned long iterations )
+{
+	struct ITClassC object;
+	unsigned long i;
+	double start, end;
+	char* ref;
+	void* root;
+
+	ref = ((char*) &object) + offset;
+	start = bench_now_ns( );
+	for( i = 0; i < iterations; ++i ) {
+		BENCH_HIDE(ref);
+		root = ref - offset;
+		BENCH_HIDE(root);
+	}
+	end = bench_now_ns( );
+	return end - start;
+}
+
+static double bench_cast_1( unsigned long iterations )
+{
+	return bench_cast(offsetof(struct ITClassA, itInterface1.itInterface0), iterations);
+}
+
+static double bench_cast_2( unsigned long iterations )
+{
+	return bench_cast(offsetof(struct ITClassB, classA.itInterface1.itInterface0), iterations);
+}
+
+static double bench_cast_3( unsigned long iterations )
+{
+	return bench_cast(offsetof(struct ITClassC, classB.classA.itInterface1.itInterface0), iterations);
+}
+
+
+/****************************************************************************/
+/* Variant								    */
+/****************************************************************************/
+#define BENCH_DEPTHS( name )							\
+	{ name##_1, name##_2, name##_3, name##_4, name##_5, name##_6, name##_7, name##_8 }
+
+const struct bench_variant_t bench_direct =
+{
+	.cname = "direct",
+	.cloops = {
+		[BENCH_VIRTUAL] = BENCH_DEPTHS(bench_virtual),
+		[BENCH_SUPER] = BENCH_DEPTHS(bench_super),
+		[BENCH_INTERFACE] = { bench_interface_1, bench_interface_2, bench_interface_3 },
+		[BENCH_CAST] = { bench_cast_1, bench_cast_2, bench_cast_3 },
+		[BENCH_CONSTRUCT] = BENCH_DEPTHS(bench_construct),
+		[BENCH_DESTROY] = BENCH_DEPTHS(bench_destroy)
+	}
+};
@@ -0,0 +1,1065 @@
+/*
+ * Copyright 2019 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ */
+/**
+ * @file
+ * @details
+ *	Class generator. Reads a description of classes and interfaces and
+ *	writes the boilerplate CObject needs for them, in the fastest dispatch
+ *	form the library has:
+ *		* Vtables built at compile time with CCLASS_VTABLE( ), and a class
+ *		  descriptor, X_Info, for RTTI.
+ *		* Interfaces are compact, see struct cinterface_compact_t.
+ *		* Method wrappers are always inlined, take restrict self pointers,
+ *		  and read a class' vtable with cclass_get_object_vtable( ), which
+ *		  skips cclass_get_vtable( )'s compact tag check.
+ *		* Super calls, X_super_method( ), call the ancestor's implementation
+ *		  directly instead of through a Supers_ vtable.
+ *	Usage:
+ *	@code
+ *		cgen shapes.cdef shapes
+ *	@endcode
+ *	writes shapes.h and shapes.c. Method bodies are written by hand, in
+ *	another file, as functions named X_method_impl( ) which the generated
+ *	header declares.
+ *
+ *	A description is a list of blocks, blank lines and # comments are
+ *	ignored:
+ *	@code
+ *		interface Shape
+ *			method int area( )
+ *			method void scale( int factor )
+ *		end
+ *
+ *		class Rect implements Shape
+ *			field int width
+ *			field int height
+ *			method int perimeter( )
+ *		end
+ *
+ *		class Square extends Rect
+ *			override area
+ *			destructor
+ *		end
+ *	@endcode
+ *	A class extends cobject unless it names a class earlier in the file, and
+ *	implements every method of its interfaces. An override replaces an
+ *	inherited method, destructor gives the class a destructor, and copyable
+ *	lets cclone( ) copy its objects with memcpy( ), for classes whose super
+ *	class is copyable too. Subclasses are only copyable if they say so.
+ *	Interfaces can't inherit interfaces, and parameters can't be function
+ *	pointers.
+ *
+ *	For each class, the header has struct X, struct X_VTable, X_Info,
+ *	X_VTable_Key( ), the constructor newX( ), which takes no arguments
+ *	besides the object and is traced as a span, see ctrace.h, a wrapper X_method( ) for each method the class
+ *	declares, and X_super_method( ) for each method it overrides.
+ */
+
+/*
+ * ==========================================================================
+ * ------------------------------ Includes ----------------------------------
+ * ==========================================================================
+ */
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * ==========================================================================
+ * ---------------------------- Structures ----------------------------------
+ * ==========================================================================
+ */
+#define CGEN_TYPES	64
+#define CGEN_METHODS	32
+#define CGEN_FIELDS	32
+#define CGEN_IFACES	8
+#define CGEN_NAME	64
+#define CGEN_TEXT	256
+#define CGEN_LINE	512
+
+struct cgen_method_t
+{
+    char cret[CGEN_NAME];
+    char cname[CGEN_NAME];
+
+    /* Parameters after self, each as ", type name" and ", name".
+     */
+    char cparams[CGEN_TEXT];
+    char cargs[CGEN_TEXT];
+};
+
+struct cgen_type_t
+{
+    int                   cinterface;
+    char                  cname[CGEN_NAME];
+    char                  cmacro[CGEN_NAME];
+    char                  cmember[CGEN_NAME];
+
+    /* NULL when the super class is cobject.
+     */
+    struct cgen_type_t*   csuper;
+    struct cgen_type_t*   cifaces[CGEN_IFACES];
+    size_t                ciface_count;
+    char                  cfields[CGEN_FIELDS][CGEN_TEXT];
+    size_t                cfield_count;
+    struct cgen_method_t  cmethods[CGEN_METHODS];
+    size_t                cmethod_count;
+    char                  coverrides[CGEN_METHODS][CGEN_NAME];
+    size_t                coverride_count;
+    int                   cdestructor;
+    int                   ccopyable;
+};
+
+static struct cgen_type_t cgen_types[CGEN_TYPES];
+static size_t             cgen_type_count;
+static const char*        cgen_input;
+static int                cgen_line;
+
+
+/*
+ * ==========================================================================
+ * -------------------Static Function Definitions ---------------------------
+ * ==========================================================================
+ */
+static void cgen_error( const char* format, ... )
+{
+	va_list args;
+
+	fprintf(stderr, "%s:%d: ", cgen_input, cgen_line);
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+	exit(EXIT_FAILURE);
+}
+
+static void cgen_copy( char* dest, const char* src, size_t length, size_t size )
+{
+	if( length >= size ) {
+		cgen_error("'%.*s' is too long", (int) length, src);
+	}
+	memcpy(dest, src, length);
+	dest[length] = '\0';
+}
+
+static void cgen_append( char* dest, size_t size, const char* src )
+{
+	size_t length;
+
+	length = strlen(dest);
+	if( length + strlen(src) >= size ) {
+		cgen_error("'%s' is too long", src);
+	}
+	strcpy(dest + length, src);
+}
+
+static char* cgen_trim( char* text )
+{
+	char* end;
+
+	while( isspace((unsigned char) *text) ) {
+		++text;
+	}
+	end = text + strlen(text);
+	while( end > text && isspace((unsigned char) end[-1]) ) {
+		--end;
+	}
+	*end = '\0';
+	return text;
+}
+
+static int cgen_is_identifier( const char* text )
+{
+	if( !isalpha((unsigned char) *text) && *text != '_' ) {
+		return 0;
+	}
+	for( ; *text != '\0'; ++text ) {
+		if( !isalnum((unsigned char) *text) && *text != '_' ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Split the next word off of text.
+ */
+static char* cgen_word( char** text )
+{
+	char* word;
+
+	word = *text;
+	while( **text != '\0' && !isspace((unsigned char) **text) ) {
+		++*text;
+	}
+	if( **text != '\0' ) {
+		*(*text)++ = '\0';
+		*text = cgen_trim(*text);
+	}
+	return word;
+}
+
+/* Shape to SHAPE, GTRect to GT_RECT, ClassA to CLASS_A.
+ */
+static void cgen_macro_name( char* dest, const char* name )
+{
+	size_t i, j;
+
+	for( i = 0, j = 0; name[i] != '\0' && j + 2 < CGEN_NAME; ++i ) {
+		if( i > 0 && isupper((unsigned char) name[i]) &&
+		    (islower((unsigned char) name[i-1]) ||
+		     (isupper((unsigned char) name[i-1]) && islower((unsigned char) name[i+1]))) ) {
+			dest[j++] = '_';
+		}
+		dest[j++] = (char) toupper((unsigned char) name[i]);
+	}
+	dest[j] = '\0';
+}
+
+/* Shape to shape, GTRect to gtRect, as the repository names members.
+ */
+static void cgen_member_name( char* dest, const char* name )
+{
+	size_t upper, i;
+
+	strcpy(dest, name);
+	for( upper = 0; isupper((unsigned char) dest[upper]); ++upper ) {
+		continue;
+	}
+	if( upper > 1 && islower((unsigned char) dest[upper]) ) {
+		--upper;
+	}
+	for( i = 0; i < upper || i == 0; ++i ) {
+		dest[i] = (char) tolower((unsigned char) dest[i]);
+	}
+}
+
+static struct cgen_type_t* cgen_find_type( const char* name )
+{
+	size_t i;
+
+	for( i = 0; i < cgen_type_count; ++i ) {
+		if( strcmp(cgen_types[i].cname, name) == 0 ) {
+			return &cgen_types[i];
+		}
+	}
+	return NULL;
+}
+
+static const struct cgen_method_t* cgen_own_method( const struct cgen_type_t* type, const char* name )
+{
+	size_t i;
+
+	for( i = 0; i < type->cmethod_count; ++i ) {
+		if( strcmp(type->cmethods[i].cname, name) == 0 ) {
+			return &type->cmethods[i];
+		}
+	}
+	return NULL;
+}
+
+/* Find the vtable slot of a method in a class. Gives the class or interface
+ * which declares the method, and the class which added it to the vtable.
+ */
+static const struct cgen_method_t* cgen_find_slot( const struct cgen_type_t* cls,
+						   const char* name,
+						   const struct cgen_type_t** owner,
+						   const struct cgen_type_t** adder )
+{
+	const struct cgen_method_t* method;
+	size_t i;
+
+	for( ; cls != NULL; cls = cls->csuper ) {
+		method = cgen_own_method(cls, name);
+		if( method != NULL ) {
+			*owner = *adder = cls;
+			return method;
+		}
+		for( i = 0; i < cls->ciface_count; ++i ) {
+			method = cgen_own_method(cls->cifaces[i], name);
+			if( method != NULL ) {
+				*owner = cls->cifaces[i];
+				*adder = cls;
+				return method;
+			}
+		}
+	}
+	return NULL;
+}
+
+/* Whether a class gives its own implementation of a method.
+ */
+static int cgen_defines( const struct cgen_type_t* cls, const char* name )
+{
+	size_t i;
+
+	if( cgen_own_method(cls, name) != NULL ) {
+		return 1;
+	}
+	for( i = 0; i < cls->ciface_count; ++i ) {
+		if( cgen_own_method(cls->cifaces[i], name) != NULL ) {
+			return 1;
+		}
+	}
+	for( i = 0; i < cls->coverride_count; ++i ) {
+		if( strcmp(cls->coverrides[i], name) == 0 ) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* The nearest class, from cls up, implementing a method, or NULL.
+ */
+static const struct cgen_type_t* cgen_implementer( const struct cgen_type_t* cls, const char* name )
+{
+	for( ; cls != NULL; cls = cls->csuper ) {
+		if( cgen_defines(cls, name) ) {
+			return cls;
+		}
+	}
+	return NULL;
+}
+
+static const struct cgen_type_t* cgen_destructor_implementer( const struct cgen_type_t* cls )
+{
+	for( ; cls != NULL; cls = cls->csuper ) {
+		if( cls->cdestructor ) {
+			return cls;
+		}
+	}
+	return NULL;
+}
+
+/* The nearest class, from cls up, with interfaces, or NULL.
+ */
+static const struct cgen_type_t* cgen_interface_owner( const struct cgen_type_t* cls )
+{
+	for( ; cls != NULL; cls = cls->csuper ) {
+		if( cls->ciface_count > 0 ) {
+			return cls;
+		}
+	}
+	return NULL;
+}
+
+/* Member path from a class to an ancestor in it, like "rect.cobject.", or
+ * "" for the class itself. NULL is cobject.
+ */
+static void cgen_object_path( char* dest, const struct cgen_type_t* cls, const struct cgen_type_t* ancestor )
+{
+	dest[0] = '\0';
+	for( ; cls != ancestor; cls = cls->csuper ) {
+		cgen_append(dest, CGEN_TEXT, cls->csuper == NULL ? "cobject" : cls->csuper->cmember);
+		cgen_append(dest, CGEN_TEXT, ".");
+		if( cls->csuper == NULL ) {
+			break;
+		}
+	}
+}
+
+/* Member path from a class' vtable to an ancestor's vtable in it, like
+ * "Rect_VTable.CObject_VTable.", or "" for the class itself.
+ */
+static void cgen_vtable_path( char* dest, const struct cgen_type_t* cls, const struct cgen_type_t* ancestor )
+{
+	dest[0] = '\0';
+	for( ; cls != ancestor; cls = cls->csuper ) {
+		cgen_append(dest, CGEN_TEXT, cls->csuper == NULL ? "CObject" : cls->csuper->cname);
+		cgen_append(dest, CGEN_TEXT, "_VTable.");
+		if( cls->csuper == NULL ) {
+			break;
+		}
+	}
+}
+
+/* Reference to an ancestor's object within self, for calling its methods.
+ */
+static void cgen_object_ref( char* dest, const struct cgen_type_t* cls, const struct cgen_type_t* ancestor )
+{
+	char path[CGEN_TEXT];
+
+	cgen_object_path(path, cls, ancestor);
+	if( path[0] == '\0' ) {
+		strcpy(dest, "self");
+		return;
+	}
+	path[strlen(path) - 1] = '\0';
+	strcpy(dest, "&self->");
+	cgen_append(dest, CGEN_TEXT, path);
+}
+
+static const char* cgen_return( const struct cgen_method_t* method )
+{
+	return strcmp(method->cret, "void") == 0 ? "" : "return ";
+}
+
+/* Parse "int area( int a, char* b )".
+ */
+static void cgen_parse_method( struct cgen_method_t* method, char* text )
+{
+	char* open;
+	char* close;
+	char* name;
+	char* param;
+	char* next;
+	char* end;
+
+	open = strchr(text, '(');
+	close = strrchr(text, ')');
+	if( open == NULL || close == NULL || close < open || *cgen_trim(close + 1) != '\0' ) {
+		cgen_error("expected 'method <return type> <name>( <parameters> )'");
+	}
+	*open = '\0';
+	*close = '\0';
+
+	text = cgen_trim(text);
+	for( name = text + strlen(text); name > text && (isalnum((unsigned char) name[-1]) || name[-1] == '_'); --name ) {
+		continue;
+	}
+	if( name == text || !cgen_is_identifier(name) ) {
+		cgen_error("expected a return type and method name");
+	}
+	cgen_copy(method->cname, name, strlen(name), CGEN_NAME);
+	*name = '\0';
+	text = cgen_trim(text);
+	cgen_copy(method->cret, text, strlen(text), CGEN_NAME);
+
+	method->cparams[0] = '\0';
+	method->cargs[0] = '\0';
+	param = cgen_trim(open + 1);
+	if( *param == '\0' || strcmp(param, "void") == 0 ) {
+		return;
+	}
+	for( ; param != NULL; param = next ) {
+		next = strchr(param, ',');
+		if( next != NULL ) {
+			*next++ = '\0';
+		}
+		param = cgen_trim(param);
+		for( end = param + strlen(param); end > param && (isalnum((unsigned char) end[-1]) || end[-1] == '_'); --end ) {
+			continue;
+		}
+		if( end == param || !cgen_is_identifier(end) ) {
+			cgen_error("parameter '%s' needs a type and name", param);
+		}
+		cgen_append(method->cparams, CGEN_TEXT, ", ");
+		cgen_append(method->cparams, CGEN_TEXT, param);
+		cgen_append(method->cargs, CGEN_TEXT, ", ");
+		cgen_append(method->cargs, CGEN_TEXT, end);
+	}
+}
+
+static struct cgen_type_t* cgen_new_type( const char* name, int interface )
+{
+	struct cgen_type_t* type;
+
+	if( !cgen_is_identifier(name) ) {
+		cgen_error("'%s' is not a name", name);
+	}
+	if( cgen_find_type(name) != NULL ) {
+		cgen_error("'%s' is already defined", name);
+	}
+	if( cgen_type_count == CGEN_TYPES ) {
+		cgen_error("too many classes and interfaces");
+	}
+	type = &cgen_types[cgen_type_count++];
+	type->cinterface = interface;
+	cgen_copy(type->cname, name, strlen(name), CGEN_NAME);
+	cgen_macro_name(type->cmacro, name);
+	cgen_member_name(type->cmember, name);
+	return type;
+}
+
+/* Parse "class Name [extends Super] [implements I, J]".
+ */
+static struct cgen_type_t* cgen_parse_class( char* text )
+{
+	struct cgen_type_t* type;
+	struct cgen_type_t* iface;
+	const struct cgen_type_t* owner;
+	const struct cgen_type_t* adder;
+	char* word;
+	size_t i;
+
+	type = cgen_new_type(cgen_word(&text), 0);
+	word = cgen_word(&text);
+	if( strcmp(word, "extends") == 0 ) {
+		word = cgen_word(&text);
+		if( strcmp(word, "cobject") != 0 ) {
+			type->csuper = cgen_find_type(word);
+			if( type->csuper == NULL || type->csuper->cinterface ) {
+				cgen_error("'%s' is not a class defined before '%s'", word, type->cname);
+			}
+		}
+		word = cgen_word(&text);
+	}
+	if( strcmp(word, "implements") == 0 ) {
+		for( word = strtok(text, ", \t"); word != NULL; word = strtok(NULL, ", \t") ) {
+			iface = cgen_find_type(word);
+			if( iface == NULL || !iface->cinterface ) {
+				cgen_error("'%s' is not an interface defined before '%s'", word, type->cname);
+			}
+			if( type->ciface_count == CGEN_IFACES ) {
+				cgen_error("'%s' implements too many interfaces", type->cname);
+			}
+			for( i = 0; i < iface->cmethod_count; ++i ) {
+				if( cgen_find_slot(type, iface->cmethods[i].cname, &owner, &adder) != NULL ) {
+					cgen_error("'%s' of '%s' is already a method of '%s'", iface->cmethods[i].cname, iface->cname, type->cname);
+				}
+			}
+			type->cifaces[type->ciface_count++] = iface;
+		}
+	}
+	else if( *word != '\0' ) {
+		cgen_error("expected 'extends' or 'implements', not '%s'", word);
+	}
+	return type;
+}
+
+/* Parse the line of a class or interface block. Returns zero at its end.
+ */
+static int cgen_parse_member( struct cgen_type_t* type, char* text )
+{
+	struct cgen_method_t* method;
+	const struct cgen_type_t* owner;
+	const struct cgen_type_t* adder;
+	char* word;
+	size_t length;
+
+	word = cgen_word(&text);
+	if( strcmp(word, "end") == 0 ) {
+		return 0;
+	}
+	if( strcmp(word, "method") == 0 ) {
+		if( type->cmethod_count == CGEN_METHODS ) {
+			cgen_error("'%s' has too many methods", type->cname);
+		}
+		method = &type->cmethods[type->cmethod_count];
+		cgen_parse_method(method, text);
+		if( (!type->cinterface && cgen_find_slot(type, method->cname, &owner, &adder) != NULL) ||
+		    (type->cinterface && cgen_own_method(type, method->cname) != NULL) ) {
+			cgen_error("'%s' is already a method of '%s', use override", method->cname, type->cname);
+		}
+		++type->cmethod_count;
+		return 1;
+	}
+	if( type->cinterface ) {
+		cgen_error("interfaces only have methods, not '%s'", word);
+	}
+	if( strcmp(word, "field") == 0 ) {
+		if( type->cfield_count == CGEN_FIELDS ) {
+			cgen_error("'%s' has too many fields", type->cname);
+		}
+		length = strlen(text);
+		if( length > 0 && text[length - 1] == ';' ) {
+			--length;
+		}
+		if( length == 0 ) {
+			cgen_error("expected 'field <declaration>'");
+		}
+		cgen_copy(type->cfields[type->cfield_count++], text, length, CGEN_TEXT);
+	}
+	else if( strcmp(word, "override") == 0 ) {
+		if( type->csuper == NULL || cgen_find_slot(type->csuper, text, &owner, &adder) == NULL ) {
+			cgen_error("'%s' doesn't inherit a method '%s'", type->cname, text);
+		}
+		if( cgen_defines(type, text) ) {
+			cgen_error("'%s' already implements '%s'", type->cname, text);
+		}
+		if( type->coverride_count == CGEN_METHODS ) {
+			cgen_error("'%s' has too many overrides", type->cname);
+		}
+		cgen_copy(type->coverrides[type->coverride_count++], text, strlen(text), CGEN_NAME);
+	}
+	else if( strcmp(word, "destructor") == 0 && *text == '\0' ) {
+		type->cdestructor = 1;
+	}
+	else if( strcmp(word, "copyable") == 0 && *text == '\0' ) {
+		if( type->csuper != NULL && !type->csuper->ccopyable ) {
+			cgen_error("'%s' can't be copyable, '%s' isn't", type->cname, type->csuper->cname);
+		}
+		type->ccopyable = 1;
+	}
+	else {
+		cgen_error("expected 'field', 'method', 'override', 'destructor', 'copyable' or 'end'");
+	}
+	return 1;
+}
+
+static void cgen_parse( FILE* in )
+{
+	char buffer[CGEN_LINE];
+	struct cgen_type_t* type;
+	char* text;
+	char* word;
+
+	type = NULL;
+	while( fgets(buffer, sizeof(buffer), in) != NULL ) {
+		++cgen_line;
+		if( strchr(buffer, '\n') == NULL && !feof(in) ) {
+			cgen_error("line is too long");
+		}
+		text = strchr(buffer, '#');
+		if( text != NULL ) {
+			*text = '\0';
+		}
+		text = cgen_trim(buffer);
+		if( *text == '\0' ) {
+			continue;
+		}
+
+		if( type != NULL ) {
+			if( !cgen_parse_member(type, text) ) {
+				type = NULL;
+			}
+			continue;
+		}
+		word = cgen_word(&text);
+		if( strcmp(word, "interface") == 0 ) {
+			type = cgen_new_type(cgen_word(&text), 1);
+			if( *text != '\0' ) {
+				cgen_error("interfaces can't inherit, '%s'", text);
+			}
+		}
+		else if( strcmp(word, "class") == 0 ) {
+			type = cgen_parse_class(text);
+		}
+		else {
+			cgen_error("expected 'class' or 'interface', not '%s'", word);
+		}
+	}
+	if( type != NULL ) {
+		cgen_error("'%s' is missing its 'end'", type->cname);
+	}
+}
+
+/* Write a line of a macro, ending in a line continuation.
+ */
+static void cgen_macro_line( FILE* out, const char* format, ... )
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(out, format, args);
+	va_end(args);
+	fprintf(out, "\t\\\n");
+}
+
+static void cgen_banner( FILE* out, const char* kind, const char* name )
+{
+	fprintf(out, "/************************************************************************/\n");
+	fprintf(out, "/* %s %s */\n", kind, name);
+	fprintf(out, "/************************************************************************/\n");
+}
+
+static void cgen_header_interface( FILE* out, const struct cgen_type_t* type )
+{
+	const struct cgen_method_t* method;
+	size_t i;
+
+	cgen_banner(out, "Interface", type->cname);
+	fprintf(out, "struct %s\n{\n", type->cname);
+	fprintf(out, "\t/* Must be first member of a compact interface. */\n");
+	fprintf(out, "\tstruct cinterface_compact_t interface;\n};\n\n");
+
+	fprintf(out, "struct %s_VTable\n{\n", type->cname);
+	fprintf(out, "\t/* Must be first member of a compact interface's vtable. */\n");
+	fprintf(out, "\tstruct cclass_compact_vtable_t CCompact_VTable;\n\n");
+	for( i = 0; i < type->cmethod_count; ++i ) {
+		method = &type->cmethods[i];
+		fprintf(out, "\t%s (*%s)( struct %s* self%s );\n", method->cret, method->cname, type->cname, method->cparams);
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "/* Wrappers for calling interface methods. */\n");
+	for( i = 0; i < type->cmethod_count; ++i ) {
+		method = &type->cmethods[i];
+		fprintf(out, "CGEN_INLINE %s %s_%s( struct %s* restrict self%s )\n{\n", method->cret, type->cname, method->cname, type->cname, method->cparams);
+		fprintf(out, "\tCTRACE_CALL( );\n");
+		fprintf(out, "\t%s((const struct %s_VTable*) cclass_get_vtable(self))->%s(self%s);\n}\n\n",
+			cgen_return(method), type->cname, method->cname, method->cargs);
+	}
+	fprintf(out, "\n");
+}
+
+static void cgen_header_class( FILE* out, const struct cgen_type_t* type )
+{
+	const struct cgen_type_t* owner;
+	const struct cgen_type_t* adder;
+	const struct cgen_type_t* ancestor;
+	const struct cgen_method_t* method;
+	char ref[CGEN_TEXT];
+	const char* sep;
+	size_t i, j;
+
+	cgen_banner(out, "Class", type->cname);
+	fprintf(out, "struct %s\n{\n", type->cname);
+	fprintf(out, "\t/* Super class must be first member of the class declaration. */\n");
+	if( type->csuper == NULL ) {
+		fprintf(out, "\tstruct cobject_t cobject;\n");
+	}
+	else {
+		fprintf(out, "\tstruct %s %s;\n", type->csuper->cname, type->csuper->cmember);
+	}
+	if( type->ciface_count > 0 ) {
+		fprintf(out, "\n\t/* Implemented interfaces. */\n");
+	}
+	for( i = 0; i < type->ciface_count; ++i ) {
+		fprintf(out, "\tstruct %s %s;\n", type->cifaces[i]->cname, type->cifaces[i]->cmember);
+	}
+	if( type->cfield_count > 0 ) {
+		fprintf(out, "\n");
+	}
+	for( i = 0; i < type->cfield_count; ++i ) {
+		fprintf(out, "\t%s;\n", type->cfields[i]);
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "struct %s_VTable\n{\n", type->cname);
+	fprintf(out, "\t/* Copy of the super class' vtable must be first. */\n");
+	if( type->csuper == NULL ) {
+		fprintf(out, "\tstruct cobject_vtable_t CObject_VTable;\n");
+	}
+	else {
+		fprintf(out, "\tstruct %s_VTable %s_VTable;\n", type->csuper->cname, type->csuper->cname);
+	}
+	for( i = 0; i < type->ciface_count; ++i ) {
+		fprintf(out, "\tstruct %s_VTable %s_VTable;\n", type->cifaces[i]->cname, type->cifaces[i]->cname);
+	}
+	if( type->cmethod_count > 0 ) {
+		fprintf(out, "\n");
+	}
+	for( i = 0; i < type->cmethod_count; ++i ) {
+		method = &type->cmethods[i];
+		fprintf(out, "\t%s (*%s)( struct %s* self%s );\n", method->cret, method->cname, type->cname, method->cparams);
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "/* This class' type descriptor, and its display list%s for subclasses. */\n",
+		cgen_interface_owner(type) != NULL ? " and interfaces" : "");
+	fprintf(out, "extern const struct cclass_info_t %s_Info;\n", type->cname);
+	fprintf(out, "#define %s_INFO_DISPLAY %s_INFO_DISPLAY, &%s_Info\n", type->cmacro,
+		type->csuper == NULL ? "COBJECT" : type->csuper->cmacro, type->cname);
+	if( cgen_interface_owner(type) != NULL ) {
+		/* The super object is at the top, so its interfaces keep their offsets. */
+		fprintf(out, "#define %s_INFO_INTERFACES", type->cmacro);
+		sep = " ";
+		if( cgen_interface_owner(type->csuper) != NULL ) {
+			fprintf(out, " %s_INFO_INTERFACES", type->csuper->cmacro);
+			sep = ", ";
+		}
+		for( i = 0; i < type->ciface_count; ++i ) {
+			fprintf(out, "%soffsetof(struct %s, %s)", sep, type->cname, type->cifaces[i]->cmember);
+			sep = ", ";
+		}
+		fprintf(out, "\n");
+	}
+	fprintf(out, "/* Function to get the reference to this class' vtable. */\n");
+	fprintf(out, "const struct %s_VTable* %s_VTable_Key( void );\n", type->cname, type->cname);
+	fprintf(out, "/* Constructor. */\n");
+	fprintf(out, "void new%s( struct %s* self );\n\n", type->cname, type->cname);
+
+	fprintf(out, "/* Implementations, written by hand. */\n");
+	for( i = 0; i < type->cmethod_count; ++i ) {
+		method = &type->cmethods[i];
+		fprintf(out, "CGEN_HOT %s %s_%s_impl( struct %s* self%s );\n", method->cret, type->cname, method->cname, type->cname, method->cparams);
+	}
+	for( i = 0; i < type->ciface_count; ++i ) {
+		for( j = 0; j < type->cifaces[i]->cmethod_count; ++j ) {
+			method = &type->cifaces[i]->cmethods[j];
+			fprintf(out, "CGEN_HOT %s %s_%s_impl( struct %s* self%s );\n", method->cret, type->cname, method->cname, type->cname, method->cparams);
+		}
+	}
+	for( i = 0; i < type->coverride_count; ++i ) {
+		method = cgen_find_slot(type, type->coverrides[i], &owner, &adder);
+		fprintf(out, "CGEN_HOT %s %s_%s_impl( struct %s* self%s );\n", method->cret, type->cname, method->cname, type->cname, method->cparams);
+	}
+	if( type->cdestructor ) {
+		fprintf(out, "void %s_destructor_impl( struct %s* self );\n", type->cname, type->cname);
+	}
+	fprintf(out, "\n");
+
+	if( type->cmethod_count > 0 ) {
+		fprintf(out, "/* Wrappers for calling virtual methods. An object's vtable is never\n");
+		fprintf(out, " * tagged compact, so it's read with cclass_get_object_vtable( ).\n */\n");
+	}
+	for( i = 0; i < type->cmethod_count; ++i ) {
+		method = &type->cmethods[i];
+		fprintf(out, "CGEN_INLINE %s %s_%s( struct %s* restrict self%s )\n{\n", method->cret, type->cname, method->cname, type->cname, method->cparams);
+		fprintf(out, "\tCTRACE_CALL( );\n");
+		fprintf(out, "\t%s((const struct %s_VTable*) cclass_get_object_vtable(self))->%s(self%s);\n}\n\n",
+			cgen_return(method), type->cname, method->cname, method->cargs);
+	}
+
+	/* Super calls, for every method this class gives an implementation of
+	 * which replaces an ancestor's.
+	 */
+	for( i = 0; i < type->coverride_count; ++i ) {
+		method = cgen_find_slot(type, type->coverrides[i], &owner, &adder);
+		ancestor = cgen_implementer(type->csuper, method->cname);
+		cgen_object_ref(ref, type, ancestor);
+		fprintf(out, "/* Call %s's implementation directly. */\n", ancestor->cname);
+		fprintf(out, "CGEN_INLINE %s %s_super_%s( struct %s* restrict self%s )\n{\n", method->cret, type->cname, method->cname, type->cname, method->cparams);
+		fprintf(out, "\t%s%s_%s_impl(%s%s);\n}\n\n", cgen_return(method), ancestor->cname, method->cname, ref, method->cargs);
+	}
+	if( type->cdestructor ) {
+		ancestor = cgen_destructor_implementer(type->csuper);
+		fprintf(out, "/* Call the super class' destructor directly. */\n");
+		fprintf(out, "CGEN_INLINE void %s_super_destructor( struct %s* restrict self )\n{\n", type->cname, type->cname);
+		if( ancestor == NULL ) {
+			fprintf(out, "\tcobject_destructor(self);\n}\n\n");
+		}
+		else {
+			cgen_object_ref(ref, type, ancestor);
+			fprintf(out, "\t%s_destructor_impl(%s);\n}\n\n", ancestor->cname, ref);
+		}
+	}
+	fprintf(out, "\n");
+}
+
+/* Write the thunk putting a class' implementation of a method in its vtable,
+ * and the designator for the slot into slots. A method the class declares
+ * itself has the implementation's type, so it needs no thunk.
+ */
+static void cgen_source_slot( FILE* out, const struct cgen_type_t* type, const char* name, char* slots )
+{
+	const struct cgen_type_t* owner;
+	const struct cgen_type_t* adder;
+	const struct cgen_method_t* method;
+	char path[CGEN_TEXT];
+
+	method = cgen_find_slot(type, name, &owner, &adder);
+	if( owner != type ) {
+		fprintf(out, "static %s %s_%s_thunk( struct %s* self%s )\n{\n", method->cret, type->cname, name, owner->cname, method->cparams);
+	}
+	if( owner->cinterface ) {
+		/* The interface is at the same offset in every subclass. */
+		cgen_object_path(path, type, adder);
+		fprintf(out, "\t%s%s_%s_impl((struct %s*) ((char*) self - offsetof(struct %s, %s%s))%s);\n}\n\n",
+			cgen_return(method), type->cname, name, type->cname, type->cname, path, owner->cmember, method->cargs);
+	}
+	else if( owner != type ) {
+		fprintf(out, "\t%s%s_%s_impl((struct %s*) self%s);\n}\n\n",
+			cgen_return(method), type->cname, name, type->cname, method->cargs);
+	}
+
+	cgen_vtable_path(path, type, adder);
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, "\t\t.");
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, path);
+	if( owner->cinterface ) {
+		cgen_append(slots, CGEN_TEXT * CGEN_METHODS, owner->cname);
+		cgen_append(slots, CGEN_TEXT * CGEN_METHODS, "_VTable.");
+	}
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, name);
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, " = ");
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, type->cname);
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, "_");
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, name);
+	cgen_append(slots, CGEN_TEXT * CGEN_METHODS, owner == type ? "_impl,\t\\\n" : "_thunk,\t\\\n");
+}
+
+static void cgen_source_class( FILE* out, const struct cgen_type_t* type )
+{
+	static char slots[CGEN_TEXT * CGEN_METHODS];
+	const struct cgen_type_t* ancestor;
+	char vtable[CGEN_NAME + 8];
+	char path[CGEN_TEXT];
+	char cobject[CGEN_TEXT];
+	size_t i, j;
+
+	cgen_banner(out, "Class", type->cname);
+	slots[0] = '\0';
+	for( i = 0; i < type->cmethod_count; ++i ) {
+		cgen_source_slot(out, type, type->cmethods[i].cname, slots);
+	}
+	for( i = 0; i < type->ciface_count; ++i ) {
+		for( j = 0; j < type->cifaces[i]->cmethod_count; ++j ) {
+			cgen_source_slot(out, type, type->cifaces[i]->cmethods[j].cname, slots);
+		}
+	}
+	for( i = 0; i < type->coverride_count; ++i ) {
+		cgen_source_slot(out, type, type->coverrides[i], slots);
+	}
+	if( type->cdestructor ) {
+		fprintf(out, "static void %s_destructor_thunk( void* self )\n{\n", type->cname);
+		fprintf(out, "\t%s_destructor_impl(self);\n}\n\n", type->cname);
+	}
+
+	fprintf(out, "const struct cclass_info_t %s_Info =\n", type->cname);
+	if( cgen_interface_owner(type) == NULL ) {
+		fprintf(out, "\tCCLASS_INFO_INIT(struct %s, \"%s\", &%s%s, %s_INFO_DISPLAY);\n\n", type->cname, type->cname,
+			type->csuper == NULL ? "cobject" : type->csuper->cname, type->csuper == NULL ? "_info" : "_Info", type->cmacro);
+	}
+	else {
+		fprintf(out, "\tCCLASS_INFO_INIT_INTERFACES(struct %s, \"%s\", &%s%s,\n", type->cname, type->cname,
+			type->csuper == NULL ? "cobject" : type->csuper->cname, type->csuper == NULL ? "_info" : "_Info");
+		fprintf(out, "\t\tCCLASS_INTERFACES(%s_INFO_INTERFACES), %s_INFO_DISPLAY);\n\n", type->cmacro, type->cmacro);
+	}
+
+	/* Start with the super's vtable, then fill in this class' slots. */
+	cgen_vtable_path(cobject, type, NULL);
+	fprintf(out, "#define %s_VTABLE_INIT\t\\\n", type->cmacro);
+	cgen_macro_line(out, "\t{");
+	if( type->csuper == NULL ) {
+		cgen_macro_line(out, "\t\t.CObject_VTable = COBJECT_VTABLE_INIT,");
+	}
+	else {
+		cgen_macro_line(out, "\t\t.%s_VTable = %s_VTABLE_INIT,", type->csuper->cname, type->csuper->cmacro);
+	}
+	cgen_macro_line(out, "\t\t.%scinfo = &%s_Info,", cobject, type->cname);
+	if( type->cdestructor ) {
+		cgen_macro_line(out, "\t\t.%scdestructor = %s_destructor_thunk,", cobject, type->cname);
+	}
+	if( type->ccopyable != (type->csuper != NULL && type->csuper->ccopyable) ) {
+		cgen_macro_line(out, "\t\t.%scflags = %s,", cobject, type->ccopyable ? "COBJECT_FLAG_COPYABLE" : "0");
+	}
+	for( i = 0; i < type->ciface_count; ++i ) {
+		cgen_macro_line(out, "\t\t.%s_VTable.CCompact_VTable = CINTERFACE_COMPACT_VTABLE_INIT(struct %s, %s),",
+			type->cifaces[i]->cname, type->cname, type->cifaces[i]->cmember);
+	}
+	fputs(slots, out);
+	fprintf(out, "\t}\n");
+	snprintf(vtable, sizeof(vtable), "%s_VTable", type->cmember);
+	fprintf(out, "CCLASS_VTABLE(struct %s_VTable, %s, %s_VTABLE_INIT);\n\n", type->cname, vtable, type->cmacro);
+
+	fprintf(out, "const struct %s_VTable* %s_VTable_Key( void )\n{\n", type->cname, type->cname);
+	fprintf(out, "\treturn &%s;\n}\n\n", vtable);
+
+	fprintf(out, "void new%s( struct %s* self )\n{\n", type->cname, type->cname);
+	fprintf(out, "\tCTRACE_CONSTRUCT_BEGIN(\"%s\");\n", type->cname);
+	if( type->csuper == NULL ) {
+		fprintf(out, "\tcobject_init(&self->cobject);\n");
+	}
+	else {
+		fprintf(out, "\tnew%s(&self->%s);\n", type->csuper->cname, type->csuper->cmember);
+	}
+	fprintf(out, "\tcclass_set_cvtable(self, &%s);\n", vtable);
+	for( ancestor = type; ancestor != NULL; ancestor = ancestor->csuper ) {
+		for( i = 0; i < ancestor->ciface_count; ++i ) {
+			cgen_object_path(path, type, ancestor);
+			fprintf(out, "\tcinterface_compact_init(self, &self->%s%s, ", path, ancestor->cifaces[i]->cmember);
+			cgen_vtable_path(path, type, ancestor);
+			fprintf(out, "&%s.%s%s_VTable);\n", vtable, path, ancestor->cifaces[i]->cname);
+		}
+	}
+	fprintf(out, "\tCTRACE_CONSTRUCT_END(\"%s\");\n", type->cname);
+	fprintf(out, "}\n\n\n");
+}
+
+static FILE* cgen_open( const char* base, const char* extension, char* path, size_t size )
+{
+	FILE* out;
+
+	if( (size_t) snprintf(path, size, "%s%s", base, extension) >= size ) {
+		fprintf(stderr, "cgen: '%s' is too long\n", base);
+		exit(EXIT_FAILURE);
+	}
+	out = fopen(path, "w");
+	if( out == NULL ) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	return out;
+}
+
+static void cgen_close( FILE* out, const char* path )
+{
+	if( ferror(out) || fclose(out) != 0 ) {
+		fprintf(stderr, "cgen: failed to write '%s'\n", path);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void cgen_write( const char* base )
+{
+	char path[CGEN_LINE];
+	char guard[CGEN_LINE];
+	const char* name;
+	const char* input;
+	FILE* out;
+	size_t i;
+
+	input = strrchr(cgen_input, '/');
+	input = input == NULL ? cgen_input : input + 1;
+
+	name = strrchr(base, '/');
+	name = name == NULL ? base : name + 1;
+	for( i = 0; name[i] != '\0' && i + 4 < sizeof(guard); ++i ) {
+		guard[i] = isalnum((unsigned char) name[i]) ? (char) toupper((unsigned char) name[i]) : '_';
+	}
+	strcpy(guard + i, "_H_");
+
+	out = cgen_open(base, ".h", path, sizeof(path));
+	fprintf(out, "/*\n * Generated by cgen from %s, don't edit.\n */\n", input);
+	fprintf(out, "#ifndef %s\n#define %s\n\n", guard, guard);
+	fprintf(out, "#include <cinterface.h>\n#include <cobject.h>\n#include <ctrace.h>\n#include <stddef.h>\n\n");
+	fprintf(out, "#ifndef CGEN_INLINE\n#if defined(__GNUC__)\n");
+	fprintf(out, "#define CGEN_INLINE static inline __attribute__((always_inline))\n");
+	fprintf(out, "#define CGEN_HOT __attribute__((hot))\n");
+	fprintf(out, "#else\n#define CGEN_INLINE static inline\n#define CGEN_HOT\n#endif\n#endif\n\n\n");
+	for( i = 0; i < cgen_type_count; ++i ) {
+		if( cgen_types[i].cinterface ) {
+			cgen_header_interface(out, &cgen_types[i]);
+		}
+		else {
+			cgen_header_class(out, &cgen_types[i]);
+		}
+	}
+	fprintf(out, "#endif /* %s */\n", guard);
+	cgen_close(out, path);
+
+	out = cgen_open(base, ".c", path, sizeof(path));
+	fprintf(out, "/*\n * Generated by cgen from %s, don't edit.\n */\n", input);
+	fprintf(out, "#include \"%s.h\"\n\n", name);
+	for( i = 0; i < cgen_type_count; ++i ) {
+		if( !cgen_types[i].cinterface ) {
+			cgen_source_class(out, &cgen_types[i]);
+		}
+	}
+	cgen_close(out, path);
+}
+
+
+/*
+ * ==========================================================================
+ * ----------------------- Function Definitions- ----------------------------
+ * ==========================================================================
+ */
+int main( int argc, char** argv )
+{
+	FILE* in;
+
+	if( argc != 3 ) {
+		fprintf(stderr, "usage: %s <description> <output base name>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	cgen_input = argv[1];
+	in = fopen(cgen_input, "r");
+	if( in == NULL ) {
+		perror(cgen_input);
+		return EXIT_FAILURE;
+	}
+	cgen_parse(in);
+	fclose(in);
+
+	cgen_write(argv[2]);
+	return EXIT_SUCCESS;
+}
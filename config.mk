@@ -0,0 +1,27 @@
+# Build options shared by every Makefile, given on the command line, like
+# make CCENSUS=1.
+
+# Build with CCENSUS=1 to count objects by class, see CObject/ccensus.h.
+ifdef CCENSUS
+CFLAGS += -DCCENSUS
+endif
+
+# Build with CTRACE=1 to trace object operations, and CTRACE_CALLS=1 to
+# trace method calls too, see CObject/ctrace.h.
+ifdef CTRACE
+CFLAGS += -DCTRACE
+endif
+ifdef CTRACE_CALLS
+CFLAGS += -DCTRACE_CALLS
+endif
+
+# Build with CICACHE_STATS=1 to count inline cache hits, see CObject/cicache.h.
+ifdef CICACHE_STATS
+CFLAGS += -DCICACHE_STATS
+endif
+
+# Build with CSHM=1 to call methods of objects in shared memory heaps, see
+# CObject/cshm.h.
+ifdef CSHM
+CFLAGS += -DCSHM
+endif
@@ -22,6 +22,25 @@
 extern TEST_SUITE(destructor_suite);
 extern TEST_SUITE(virtual_suite);
 extern TEST_SUITE(interface_suite);
+extern TEST_SUITE(pool_suite);
+extern TEST_SUITE(arena_suite);
+extern TEST_SUITE(rtti_suite);
+extern TEST_SUITE(refcount_suite);
+extern TEST_SUITE(epoch_suite);
+extern TEST_SUITE(reaper_suite);
+extern TEST_SUITE(census_suite);
+extern TEST_SUITE(trace_suite);
+extern TEST_SUITE(generated_suite);
+extern TEST_SUITE(icache_suite);
+extern TEST_SUITE(vector_suite);
+extern TEST_SUITE(poly_suite);
+extern TEST_SUITE(place_suite);
+extern TEST_SUITE(tcache_suite);
+extern TEST_SUITE(snap_suite);
+extern TEST_SUITE(shm_suite);
+extern TEST_SUITE(clone_suite);
+extern TEST_SUITE(handle_suite);
+extern BENCH_SUITE(dispatch_bench);
 
 int main( int argc, char** argv )
 {
@@ -29,6 +48,25 @@ int main( int argc, char** argv )
 	RUN_TEST_SUITE(destructor_suite);
 	RUN_TEST_SUITE(virtual_suite);
 	RUN_TEST_SUITE(interface_suite);
+	RUN_TEST_SUITE(pool_suite);
+	RUN_TEST_SUITE(arena_suite);
+	RUN_TEST_SUITE(rtti_suite);
+	RUN_TEST_SUITE(refcount_suite);
+	RUN_TEST_SUITE(epoch_suite);
+	RUN_TEST_SUITE(reaper_suite);
+	RUN_TEST_SUITE(census_suite);
+	RUN_TEST_SUITE(trace_suite);
+	RUN_TEST_SUITE(generated_suite);
+	RUN_TEST_SUITE(icache_suite);
+	RUN_TEST_SUITE(vector_suite);
+	RUN_TEST_SUITE(poly_suite);
+	RUN_TEST_SUITE(place_suite);
+	RUN_TEST_SUITE(tcache_suite);
+	RUN_TEST_SUITE(snap_suite);
+	RUN_TEST_SUITE(shm_suite);
+	RUN_TEST_SUITE(clone_suite);
+	RUN_TEST_SUITE(handle_suite);
+	RUN_BENCH_SUITE(dispatch_bench);
 	PRINT_DIAG( );
 	return 0;
 }
@@ -23,16 +23,21 @@
 /****************************************************************************/
 /* Class A																	*/
 /****************************************************************************/
-const struct DTClassA_VTable* DTClassA_VTable_Key( )
-{
-	/* Only one vtable for all instances of DTClassB. */
-	static struct DTClassA_VTable vtable;
+const struct cclass_info_t DTClassA_Info =
+	CCLASS_INFO_INIT(struct DTClassA, "DTClassA", &cobject_info, DT_CLASSA_INFO_DISPLAY);
 
-	/* Not changing the super's vtable, so just copy it in. */
-	vtable.CObject_VTable = *cobject_vtable( );
+/* Not changing the super's vtable, so just copy it in. */
+#define DT_CLASSA_VTABLE_INIT				\
+	{						\
+		.CObject_VTable = COBJECT_VTABLE_INIT,	\
+		.CObject_VTable.cinfo = &DTClassA_Info	\
+	}
+CCLASS_VTABLE(struct DTClassA_VTable, dtClassA_VTable, DT_CLASSA_VTABLE_INIT);
 
-	/* Return pointer. */
-	return &vtable;
+const struct DTClassA_VTable* DTClassA_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &dtClassA_VTable;
 }
 void newDTClassA( struct DTClassA* self, int* testVar )
 {
@@ -51,16 +56,21 @@ void newDTClassA( struct DTClassA* self, int* testVar )
 /****************************************************************************/
 /* Class B																	*/
 /****************************************************************************/
-const struct DTClassB_VTable* DTClassB_VTable_Key( )
-{
-	/* Only one vtable for all instances of DTClassB. */
-	static struct DTClassB_VTable vtable;
+const struct cclass_info_t DTClassB_Info =
+	CCLASS_INFO_INIT(struct DTClassB, "DTClassB", &DTClassA_Info, DT_CLASSB_INFO_DISPLAY);
 
-	/* Not changing super's vtable, so just copy it. */
-	vtable.DTClassA_VTable = *DTClassA_VTable_Key( );
+/* Not changing the super's vtable, so just copy it in. */
+#define DT_CLASSB_VTABLE_INIT					\
+	{							\
+		.DTClassA_VTable = DT_CLASSA_VTABLE_INIT,	\
+		.DTClassA_VTable.CObject_VTable.cinfo = &DTClassB_Info	\
+	}
+CCLASS_VTABLE(struct DTClassB_VTable, dtClassB_VTable, DT_CLASSB_VTABLE_INIT);
 
-	/* return pointer. */
-	return &vtable;
+const struct DTClassB_VTable* DTClassB_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &dtClassB_VTable;
 }
 void newDTClassB( struct DTClassB* self, int* testVar )
 {
@@ -91,24 +101,25 @@ static void dtClassCDestroy( void* self_ )
 	dest(self);
 }
 
-const struct DTClassC_VTable* DTClassC_VTable_Key( )
-{
-	/* Only one vtable for all instances of DTClassB. */
-	static struct DTClassC_VTable vtable;
-
-	/* Going to override destructor, but before we do that, */
-	/* Start with a clean copy of super's vtable. */
-	vtable.DTClassA_VTable = *DTClassA_VTable_Key( );
+const struct cclass_info_t DTClassC_Info =
+	CCLASS_INFO_INIT(struct DTClassC, "DTClassC", &DTClassA_Info, DT_CLASSC_INFO_DISPLAY);
 
-	/* Override destructor. */
-	vtable.DTClassA_VTable.CObject_VTable.cdestructor = dtClassCDestroy;
-
-	/* Since we need to call the super's destructor in our destructor, */
-	/* keep a reference to the super's vtable. */
-	vtable.Supers_DTClassA_VTable = DTClassA_VTable_Key( );
+/* Start with the super's vtable and override the destructor. Since we need to
+ * call the super's destructor in our destructor, keep a reference to its vtable.
+ */
+#define DT_CLASSC_VTABLE_INIT							\
+	{									\
+		.DTClassA_VTable = DT_CLASSA_VTABLE_INIT,			\
+		.DTClassA_VTable.CObject_VTable.cdestructor = dtClassCDestroy,	\
+		.Supers_DTClassA_VTable = &dtClassA_VTable,			\
+		.DTClassA_VTable.CObject_VTable.cinfo = &DTClassC_Info	\
+	}
+CCLASS_VTABLE(struct DTClassC_VTable, dtClassC_VTable, DT_CLASSC_VTABLE_INIT);
 
-	/* Return pointer. */
-	return &vtable;
+const struct DTClassC_VTable* DTClassC_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &dtClassC_VTable;
 }
 void newDTClassC( struct DTClassC* self, int* testVar )
 {
@@ -135,24 +146,25 @@ static void dtClassDDestroy( void* self_ )
 	((struct DTClassD_VTable*) cclass_get_vtable(self))->Supers_DTClassB_VTable->DTClassA_VTable.CObject_VTable.cdestructor(self);
 }
 
-const struct DTClassD_VTable* DTClassD_VTable_Key( )
-{
-	/* Only one vtable for all instances of DTClassB. */
-	static struct DTClassD_VTable vtable;
-
-	/* Going to override destructor, but before we do that, */
-	/* Start with a clean copy of super's vtable. */
-	vtable.DTClassB_VTable = *DTClassB_VTable_Key( );
-
-	/* Override destructor. */
-	vtable.DTClassB_VTable.DTClassA_VTable.CObject_VTable.cdestructor = dtClassDDestroy;
+const struct cclass_info_t DTClassD_Info =
+	CCLASS_INFO_INIT(struct DTClassD, "DTClassD", &DTClassB_Info, DT_CLASSD_INFO_DISPLAY);
 
-	/* Since we need to call the super's destructor in our destructor, */
-	/* keep a reference to the super's vtable. */
-	vtable.Supers_DTClassB_VTable = DTClassB_VTable_Key( );
+/* Start with the super's vtable and override the destructor. Since we need to
+ * call the super's destructor in our destructor, keep a reference to its vtable.
+ */
+#define DT_CLASSD_VTABLE_INIT									\
+	{											\
+		.DTClassB_VTable = DT_CLASSB_VTABLE_INIT,					\
+		.DTClassB_VTable.DTClassA_VTable.CObject_VTable.cdestructor = dtClassDDestroy,	\
+		.Supers_DTClassB_VTable = &dtClassB_VTable,					\
+		.DTClassB_VTable.DTClassA_VTable.CObject_VTable.cinfo = &DTClassD_Info	\
+	}
+CCLASS_VTABLE(struct DTClassD_VTable, dtClassD_VTable, DT_CLASSD_VTABLE_INIT);
 
-	/* Return pointer. */
-	return &vtable;
+const struct DTClassD_VTable* DTClassD_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &dtClassD_VTable;
 }
 
 void newDTClassD( struct DTClassD* self, int* testVar )
@@ -180,31 +192,63 @@ static void dtClassEDestroy( void* self_ )
 	((struct DTClassE_VTable*) cclass_get_vtable(self))->Supers_DTClassC_VTable->DTClassA_VTable.CObject_VTable.cdestructor(self);
 }
 
+const struct cclass_info_t DTClassE_Info =
+	CCLASS_INFO_INIT(struct DTClassE, "DTClassE", &DTClassC_Info, DT_CLASSE_INFO_DISPLAY);
+
+/* Start with the super's vtable and override the destructor. Since we need to
+ * call the super's destructor in our destructor, keep a reference to its vtable.
+ */
+#define DT_CLASSE_VTABLE_INIT									\
+	{											\
+		.DTClassC_VTable = DT_CLASSC_VTABLE_INIT,					\
+		.DTClassC_VTable.DTClassA_VTable.CObject_VTable.cdestructor = dtClassEDestroy,	\
+		.Supers_DTClassC_VTable = &dtClassC_VTable,					\
+		.DTClassC_VTable.DTClassA_VTable.CObject_VTable.cinfo = &DTClassE_Info	\
+	}
+CCLASS_VTABLE(struct DTClassE_VTable, dtClassE_VTable, DT_CLASSE_VTABLE_INIT);
+
 const struct DTClassE_VTable* DTClassE_VTable_Key( )
 {
-	/* Only one vtable for all instances of DTClassB. */
-	static struct DTClassE_VTable vtable;
+	/* Built at compile time, shared by every instance of this class. */
+	return &dtClassE_VTable;
+}
 
-	/* Going to override destructor, but before we do that, */
-	/* Start with a clean copy of super's vtable. */
-	vtable.DTClassC_VTable = *DTClassC_VTable_Key( );
+void newDTClassE( struct DTClassE* self, int* testVar )
+{
+	/* Call super's constructor. */
+	newDTClassC(&self->dtClassC, testVar);
 
 	/* Override destructor. */
-	((struct cobject_vtable_t*) &vtable)->cdestructor = dtClassEDestroy;
+	cclass_set_cvtable(self, DTClassE_VTable_Key( ));
+}
 
-	/* Since we need to call the super's destructor in our destructor, */
-	/* keep a reference to the super's vtable. */
-	vtable.Supers_DTClassC_VTable = DTClassC_VTable_Key( );
 
-	/* Return pointer. */
-	return &vtable;
+/****************************************************************************/
+/* Class F																	*/
+/****************************************************************************/
+const struct cclass_info_t DTClassF_Info =
+	CCLASS_INFO_INIT(struct DTClassF, "DTClassF", &DTClassC_Info, DT_CLASSF_INFO_DISPLAY);
+
+/* Keep the super's destructor, but every instance is shared between threads. */
+#define DT_CLASSF_VTABLE_INIT									\
+	{											\
+		.DTClassC_VTable = DT_CLASSC_VTABLE_INIT,					\
+		.DTClassC_VTable.DTClassA_VTable.CObject_VTable.cinfo = &DTClassF_Info,	\
+		.DTClassC_VTable.DTClassA_VTable.CObject_VTable.cflags = COBJECT_FLAG_SHARED	\
+	}
+CCLASS_VTABLE(struct DTClassF_VTable, dtClassF_VTable, DT_CLASSF_VTABLE_INIT);
+
+const struct DTClassF_VTable* DTClassF_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &dtClassF_VTable;
 }
 
-void newDTClassE( struct DTClassE* self, int* testVar )
+void newDTClassF( struct DTClassF* self, int* testVar )
 {
 	/* Call super's constructor. */
 	newDTClassC(&self->dtClassC, testVar);
 
-	/* Override destructor. */
-	cclass_set_cvtable(self, DTClassE_VTable_Key( ));
+	/* Map vtable. */
+	cclass_set_cvtable(self, DTClassF_VTable_Key( ));
 }
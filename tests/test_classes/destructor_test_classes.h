@@ -26,6 +26,8 @@
  * 		Destructor calls are correctly cascaded when D overrides destructor from B. (D->B->A).
  *
  * 		Destructor calls are correctly cascaded when E overrides destructor in C. (E->C->A).
+ *
+ *		Reference counts of every instance of F are atomic, since F's class is shared. (F->C->A).
  */
 #ifndef TESTS_TEST_CLASSES_H_
 #define TESTS_TEST_CLASSES_H_
@@ -108,20 +110,47 @@ struct DTClassE_VTable
 	const struct DTClassC_VTable* Supers_DTClassC_VTable;
 };
 
+/****************************************************************************/
+/* Test class F																*/
+/****************************************************************************/
+struct DTClassF_VTable;
+struct DTClassF
+{
+	struct DTClassC dtClassC;
+};
+struct DTClassF_VTable
+{
+	struct DTClassC_VTable DTClassC_VTable;
+};
+
 
 /****************************************************************************/
 /* Constructors																*/
 /****************************************************************************/
+extern const struct cclass_info_t DTClassA_Info;
+#define DT_CLASSA_INFO_DISPLAY COBJECT_INFO_DISPLAY, &DTClassA_Info
 extern const struct DTClassA_VTable* DTClassA_VTable_Key( );
 extern void newDTClassA( struct DTClassA*, int* );
+extern const struct cclass_info_t DTClassB_Info;
+#define DT_CLASSB_INFO_DISPLAY DT_CLASSA_INFO_DISPLAY, &DTClassB_Info
 extern const struct DTClassB_VTable* DTClassB_VTable_Key( );
 extern void newDTClassB( struct DTClassB*, int* );
+extern const struct cclass_info_t DTClassC_Info;
+#define DT_CLASSC_INFO_DISPLAY DT_CLASSA_INFO_DISPLAY, &DTClassC_Info
 extern const struct DTClassC_VTable* DTClassC_VTable_Key( );
 extern void newDTClassC( struct DTClassC*, int* );
+extern const struct cclass_info_t DTClassD_Info;
+#define DT_CLASSD_INFO_DISPLAY DT_CLASSB_INFO_DISPLAY, &DTClassD_Info
 extern const struct DTClassD_VTable* DTClassD_VTable_Key( );
 extern void newDTClassD( struct DTClassD*, int* );
+extern const struct cclass_info_t DTClassE_Info;
+#define DT_CLASSE_INFO_DISPLAY DT_CLASSC_INFO_DISPLAY, &DTClassE_Info
 extern const struct DTClassE_VTable* DTClassE_VTable_Key( );
 extern void newDTClassE( struct DTClassE*, int* );
+extern const struct cclass_info_t DTClassF_Info;
+#define DT_CLASSF_INFO_DISPLAY DT_CLASSC_INFO_DISPLAY, &DTClassF_Info
+extern const struct DTClassF_VTable* DTClassF_VTable_Key( );
+extern void newDTClassF( struct DTClassF*, int* );
 
 
 #endif /* TESTS_TEST_CLASSES_H_ */
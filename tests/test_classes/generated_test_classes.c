@@ -0,0 +1,104 @@
+/*
+ * Generated by cgen from generated_test_classes.cdef, don't edit.
+ */
+#include "generated_test_classes.h"
+
+/************************************************************************/
+/* Class GTRect */
+/************************************************************************/
+static int GTRect_area_thunk( struct GTShape* self )
+{
+	return GTRect_area_impl((struct GTRect*) ((char*) self - offsetof(struct GTRect, gtShape)));
+}
+
+static void GTRect_scale_thunk( struct GTShape* self, int factor )
+{
+	GTRect_scale_impl((struct GTRect*) ((char*) self - offsetof(struct GTRect, gtShape)), factor);
+}
+
+static void GTRect_destructor_thunk( void* self )
+{
+	GTRect_destructor_impl(self);
+}
+
+const struct cclass_info_t GTRect_Info =
+	CCLASS_INFO_INIT_INTERFACES(struct GTRect, "GTRect", &cobject_info,
+		CCLASS_INTERFACES(GT_RECT_INFO_INTERFACES), GT_RECT_INFO_DISPLAY);
+
+#define GT_RECT_VTABLE_INIT	\
+	{	\
+		.CObject_VTable = COBJECT_VTABLE_INIT,	\
+		.CObject_VTable.cinfo = &GTRect_Info,	\
+		.CObject_VTable.cdestructor = GTRect_destructor_thunk,	\
+		.CObject_VTable.cflags = COBJECT_FLAG_COPYABLE,	\
+		.GTShape_VTable.CCompact_VTable = CINTERFACE_COMPACT_VTABLE_INIT(struct GTRect, gtShape),	\
+		.perimeter = GTRect_perimeter_impl,	\
+		.GTShape_VTable.area = GTRect_area_thunk,	\
+		.GTShape_VTable.scale = GTRect_scale_thunk,	\
+	}
+CCLASS_VTABLE(struct GTRect_VTable, gtRect_VTable, GT_RECT_VTABLE_INIT);
+
+const struct GTRect_VTable* GTRect_VTable_Key( void )
+{
+	return &gtRect_VTable;
+}
+
+void newGTRect( struct GTRect* self )
+{
+	CTRACE_CONSTRUCT_BEGIN("GTRect");
+	cobject_init(&self->cobject);
+	cclass_set_cvtable(self, &gtRect_VTable);
+	cinterface_compact_init(self, &self->gtShape, &gtRect_VTable.GTShape_VTable);
+	CTRACE_CONSTRUCT_END("GTRect");
+}
+
+
+/************************************************************************/
+/* Class GTSquare */
+/************************************************************************/
+static int GTSquare_area_thunk( struct GTShape* self )
+{
+	return GTSquare_area_impl((struct GTSquare*) ((char*) self - offsetof(struct GTSquare, gtRect.gtShape)));
+}
+
+static int GTSquare_perimeter_thunk( struct GTRect* self )
+{
+	return GTSquare_perimeter_impl((struct GTSquare*) self);
+}
+
+static void GTSquare_destructor_thunk( void* self )
+{
+	GTSquare_destructor_impl(self);
+}
+
+const struct cclass_info_t GTSquare_Info =
+	CCLASS_INFO_INIT_INTERFACES(struct GTSquare, "GTSquare", &GTRect_Info,
+		CCLASS_INTERFACES(GT_SQUARE_INFO_INTERFACES), GT_SQUARE_INFO_DISPLAY);
+
+#define GT_SQUARE_VTABLE_INIT	\
+	{	\
+		.GTRect_VTable = GT_RECT_VTABLE_INIT,	\
+		.GTRect_VTable.CObject_VTable.cinfo = &GTSquare_Info,	\
+		.GTRect_VTable.CObject_VTable.cdestructor = GTSquare_destructor_thunk,	\
+		.GTRect_VTable.CObject_VTable.cflags = 0,	\
+		.side = GTSquare_side_impl,	\
+		.GTRect_VTable.GTShape_VTable.area = GTSquare_area_thunk,	\
+		.GTRect_VTable.perimeter = GTSquare_perimeter_thunk,	\
+	}
+CCLASS_VTABLE(struct GTSquare_VTable, gtSquare_VTable, GT_SQUARE_VTABLE_INIT);
+
+const struct GTSquare_VTable* GTSquare_VTable_Key( void )
+{
+	return &gtSquare_VTable;
+}
+
+void newGTSquare( struct GTSquare* self )
+{
+	CTRACE_CONSTRUCT_BEGIN("GTSquare");
+	newGTRect(&self->gtRect);
+	cclass_set_cvtable(self, &gtSquare_VTable);
+	cinterface_compact_init(self, &self->gtRect.gtShape, &gtSquare_VTable.GTRect_VTable.GTShape_VTable);
+	CTRACE_CONSTRUCT_END("GTSquare");
+}
+
+
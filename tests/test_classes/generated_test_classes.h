@@ -0,0 +1,171 @@
+/*
+ * Generated by cgen from generated_test_classes.cdef, don't edit.
+ */
+#ifndef GENERATED_TEST_CLASSES_H_
+#define GENERATED_TEST_CLASSES_H_
+
+#include <cinterface.h>
+#include <cobject.h>
+#include <ctrace.h>
+#include <stddef.h>
+
+#ifndef CGEN_INLINE
+#if defined(__GNUC__)
+#define CGEN_INLINE static inline __attribute__((always_inline))
+#define CGEN_HOT __attribute__((hot))
+#else
+#define CGEN_INLINE static inline
+#define CGEN_HOT
+#endif
+#endif
+
+
+/************************************************************************/
+/* Interface GTShape */
+/************************************************************************/
+struct GTShape
+{
+	/* Must be first member of a compact interface. */
+	struct cinterface_compact_t interface;
+};
+
+struct GTShape_VTable
+{
+	/* Must be first member of a compact interface's vtable. */
+	struct cclass_compact_vtable_t CCompact_VTable;
+
+	int (*area)( struct GTShape* self );
+	void (*scale)( struct GTShape* self, int factor );
+};
+
+/* Wrappers for calling interface methods. */
+CGEN_INLINE int GTShape_area( struct GTShape* restrict self )
+{
+	CTRACE_CALL( );
+	return ((const struct GTShape_VTable*) cclass_get_vtable(self))->area(self);
+}
+
+CGEN_INLINE void GTShape_scale( struct GTShape* restrict self, int factor )
+{
+	CTRACE_CALL( );
+	((const struct GTShape_VTable*) cclass_get_vtable(self))->scale(self, factor);
+}
+
+
+/************************************************************************/
+/* Class GTRect */
+/************************************************************************/
+struct GTRect
+{
+	/* Super class must be first member of the class declaration. */
+	struct cobject_t cobject;
+
+	/* Implemented interfaces. */
+	struct GTShape gtShape;
+
+	int width;
+	int height;
+	int* destroyed;
+};
+
+struct GTRect_VTable
+{
+	/* Copy of the super class' vtable must be first. */
+	struct cobject_vtable_t CObject_VTable;
+	struct GTShape_VTable GTShape_VTable;
+
+	int (*perimeter)( struct GTRect* self );
+};
+
+/* This class' type descriptor, and its display list and interfaces for subclasses. */
+extern const struct cclass_info_t GTRect_Info;
+#define GT_RECT_INFO_DISPLAY COBJECT_INFO_DISPLAY, &GTRect_Info
+#define GT_RECT_INFO_INTERFACES offsetof(struct GTRect, gtShape)
+/* Function to get the reference to this class' vtable. */
+const struct GTRect_VTable* GTRect_VTable_Key( void );
+/* Constructor. */
+void newGTRect( struct GTRect* self );
+
+/* Implementations, written by hand. */
+CGEN_HOT int GTRect_perimeter_impl( struct GTRect* self );
+CGEN_HOT int GTRect_area_impl( struct GTRect* self );
+CGEN_HOT void GTRect_scale_impl( struct GTRect* self, int factor );
+void GTRect_destructor_impl( struct GTRect* self );
+
+/* Wrappers for calling virtual methods. An object's vtable is never
+ * tagged compact, so it's read with cclass_get_object_vtable( ).
+ */
+CGEN_INLINE int GTRect_perimeter( struct GTRect* restrict self )
+{
+	CTRACE_CALL( );
+	return ((const struct GTRect_VTable*) cclass_get_object_vtable(self))->perimeter(self);
+}
+
+/* Call the super class' destructor directly. */
+CGEN_INLINE void GTRect_super_destructor( struct GTRect* restrict self )
+{
+	cobject_destructor(self);
+}
+
+
+/************************************************************************/
+/* Class GTSquare */
+/************************************************************************/
+struct GTSquare
+{
+	/* Super class must be first member of the class declaration. */
+	struct GTRect gtRect;
+};
+
+struct GTSquare_VTable
+{
+	/* Copy of the super class' vtable must be first. */
+	struct GTRect_VTable GTRect_VTable;
+
+	int (*side)( struct GTSquare* self );
+};
+
+/* This class' type descriptor, and its display list and interfaces for subclasses. */
+extern const struct cclass_info_t GTSquare_Info;
+#define GT_SQUARE_INFO_DISPLAY GT_RECT_INFO_DISPLAY, &GTSquare_Info
+#define GT_SQUARE_INFO_INTERFACES GT_RECT_INFO_INTERFACES
+/* Function to get the reference to this class' vtable. */
+const struct GTSquare_VTable* GTSquare_VTable_Key( void );
+/* Constructor. */
+void newGTSquare( struct GTSquare* self );
+
+/* Implementations, written by hand. */
+CGEN_HOT int GTSquare_side_impl( struct GTSquare* self );
+CGEN_HOT int GTSquare_area_impl( struct GTSquare* self );
+CGEN_HOT int GTSquare_perimeter_impl( struct GTSquare* self );
+void GTSquare_destructor_impl( struct GTSquare* self );
+
+/* Wrappers for calling virtual methods. An object's vtable is never
+ * tagged compact, so it's read with cclass_get_object_vtable( ).
+ */
+CGEN_INLINE int GTSquare_side( struct GTSquare* restrict self )
+{
+	CTRACE_CALL( );
+	return ((const struct GTSquare_VTable*) cclass_get_object_vtable(self))->side(self);
+}
+
+/* Call GTRect's implementation directly. */
+CGEN_INLINE int GTSquare_super_area( struct GTSquare* restrict self )
+{
+	return GTRect_area_impl(&self->gtRect);
+}
+
+/* Call GTRect's implementation directly. */
+CGEN_INLINE int GTSquare_super_perimeter( struct GTSquare* restrict self )
+{
+	return GTRect_perimeter_impl(&self->gtRect);
+}
+
+/* Call the super class' destructor directly. */
+CGEN_INLINE void GTSquare_super_destructor( struct GTSquare* restrict self )
+{
+	GTRect_destructor_impl(&self->gtRect);
+}
+
+
+#endif /* GENERATED_TEST_CLASSES_H_ */
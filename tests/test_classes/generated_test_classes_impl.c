@@ -0,0 +1,77 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * Methods of the classes generated from generated_test_classes.cdef.
+ */
+
+#include "generated_test_classes.h"
+
+/************************************************************************/
+/* Class GTRect								*/
+/************************************************************************/
+int GTRect_perimeter_impl( struct GTRect* self )
+{
+	return 2 * (self->width + self->height);
+}
+
+int GTRect_area_impl( struct GTRect* self )
+{
+	return self->width * self->height;
+}
+
+void GTRect_scale_impl( struct GTRect* self, int factor )
+{
+	self->width *= factor;
+	self->height *= factor;
+}
+
+void GTRect_destructor_impl( struct GTRect* self )
+{
+	if( self->destroyed != NULL ) {
+		*self->destroyed += 1;
+	}
+	GTRect_super_destructor(self);
+}
+
+
+/************************************************************************/
+/* Class GTSquare							*/
+/************************************************************************/
+int GTSquare_side_impl( struct GTSquare* self )
+{
+	return self->gtRect.width;
+}
+
+/* Overrides add 1000 to GTRect's result, so tests can see both ran.
+ */
+int GTSquare_area_impl( struct GTSquare* self )
+{
+	return 1000 + GTSquare_super_area(self);
+}
+
+int GTSquare_perimeter_impl( struct GTSquare* self )
+{
+	return 1000 + GTSquare_super_perimeter(self);
+}
+
+void GTSquare_destructor_impl( struct GTSquare* self )
+{
+	if( self->gtRect.destroyed != NULL ) {
+		*self->gtRect.destroyed += 10;
+	}
+	GTSquare_super_destructor(self);
+}
@@ -58,25 +58,27 @@ static int ITInterface2_ClassA_Method1( struct ITInterface2* self_ )
 	return IT_CLASSA_I2_METHOD1;
 }
 
+const struct cclass_info_t ITClassA_Info =
+	CCLASS_INFO_INIT_INTERFACES(struct ITClassA, "ITClassA", &cobject_info,
+		CCLASS_INTERFACES(IT_CLASSA_INFO_INTERFACES), IT_CLASSA_INFO_DISPLAY);
+
+/* Start with the super's vtable and implement the interface methods. */
+#define IT_CLASSA_VTABLE_INIT										\
+	{												\
+		.CObject_VTable = COBJECT_VTABLE_INIT,							\
+		.ITInterface1_VTable.ITInterface0_VTable.i0method0 = ITInterface0_ClassA_Method0,	\
+		.ITInterface1_VTable.ITInterface0_VTable.i0method1 = ITInterface0_ClassA_Method1,	\
+		.ITInterface1_VTable.i1method0 = ITInterface1_ClassA_Method0,				\
+		.ITInterface2_VTable.i2method0 = ITInterface2_ClassA_Method0,				\
+		.ITInterface2_VTable.i2method1 = ITInterface2_ClassA_Method1,				\
+		.CObject_VTable.cinfo = &ITClassA_Info	\
+	}
+CCLASS_VTABLE(struct ITClassA_VTable, itClassA_VTable, IT_CLASSA_VTABLE_INIT);
+
 const struct ITClassA_VTable* ITClassA_VTable_Key( )
 {
-	/* Only need one of these for every instance of this class. */
-	static struct ITClassA_VTable vtable;
-
-	/* Get a copy of super's vtable. */
-	vtable.CObject_VTable = *cobject_vtable( );
-
-	/* Implement interface methods. */
-	vtable.ITInterface1_VTable.ITInterface0_VTable.i0method0 = ITInterface0_ClassA_Method0;
-	vtable.ITInterface1_VTable.ITInterface0_VTable.i0method1 = ITInterface0_ClassA_Method1;
-
-	vtable.ITInterface1_VTable.i1method0 = ITInterface1_ClassA_Method0;
-
-	vtable.ITInterface2_VTable.i2method0 = ITInterface2_ClassA_Method0;
-	vtable.ITInterface2_VTable.i2method1 = ITInterface2_ClassA_Method1;
-
-	/* Return pointer. */
-	return &vtable;
+	/* Built at compile time, shared by every instance of this class. */
+	return &itClassA_VTable;
 }
 
 /* Constructor. */
@@ -135,26 +137,29 @@ static int ITInterface2_ClassB_Method1( struct ITInterface2* self_ )
 	return IT_CLASSB_I2_METHOD1;
 }
 
-const struct ITClassB_VTable* ITClassB_VTable_Key( )
-{
-	/* Only need one of these for every instance of this class. */
-	static struct ITClassB_VTable vtable;
-
-	/* Get a copy of super's vtable for this class. */
-	vtable.ITClassA_VTable = *ITClassA_VTable_Key( );
+const struct cclass_info_t ITClassB_Info =
+	CCLASS_INFO_INIT_INTERFACES(struct ITClassB, "ITClassB", &ITClassA_Info,
+		CCLASS_INTERFACES(IT_CLASSB_INFO_INTERFACES), IT_CLASSB_INFO_DISPLAY);
 
-	/* Override these methods. */
-	vtable.ITClassA_VTable.ITInterface1_VTable.ITInterface0_VTable.i0method0 = ITInterface0_ClassB_Method0;
-	vtable.ITClassA_VTable.ITInterface1_VTable.ITInterface0_VTable.i0method1 = ITInterface0_ClassB_Method1;
-
-	vtable.ITClassA_VTable.ITInterface2_VTable.i2method0 = ITInterface2_ClassB_Method0;
-	vtable.ITClassA_VTable.ITInterface2_VTable.i2method1 = ITInterface2_ClassB_Method1;
-
-	/* Keep a reference to the super's implementation of certain methods. */
-	vtable.Supers_ITClassA_VTable = ITClassA_VTable_Key( );
+/* Start with the super's vtable, override these methods, and keep a reference
+ * to the super's implementation of them.
+ */
+#define IT_CLASSB_VTABLE_INIT												\
+	{														\
+		.ITClassA_VTable = IT_CLASSA_VTABLE_INIT,								\
+		.ITClassA_VTable.ITInterface1_VTable.ITInterface0_VTable.i0method0 = ITInterface0_ClassB_Method0,	\
+		.ITClassA_VTable.ITInterface1_VTable.ITInterface0_VTable.i0method1 = ITInterface0_ClassB_Method1,	\
+		.ITClassA_VTable.ITInterface2_VTable.i2method0 = ITInterface2_ClassB_Method0,				\
+		.ITClassA_VTable.ITInterface2_VTable.i2method1 = ITInterface2_ClassB_Method1,				\
+		.Supers_ITClassA_VTable = &itClassA_VTable,								\
+		.ITClassA_VTable.CObject_VTable.cinfo = &ITClassB_Info	\
+	}
+CCLASS_VTABLE(struct ITClassB_VTable, itClassB_VTable, IT_CLASSB_VTABLE_INIT);
 
-	/* Return pointer. */
-	return &vtable;
+const struct ITClassB_VTable* ITClassB_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &itClassB_VTable;
 }
 
 void newITClassB( struct ITClassB* self )
@@ -205,24 +210,28 @@ static int ITInterface2_ClassC_Method0( struct ITInterface2* self_ )
 	return IT_CLASSC_I2_METHOD0 + ((struct ITClassC_VTable*) cclass_get_vtable(self))->Supers_ITClassB_VTable->ITClassA_VTable.ITInterface2_VTable.i2method0(&self->classB.classA.itInterface2);
 }
 
-const struct ITClassC_VTable* ITClassC_VTable_Key( )
-{
-	/* Only need one of these for every instance of this class. */
-	static struct ITClassC_VTable vtable;
-
-	/* Get copy of supers vtable. */
-	vtable.ITClassB_VTable = *ITClassB_VTable_Key( );
-	
-	/* Override these methods. */
-	vtable.ITClassB_VTable.ITClassA_VTable.ITInterface1_VTable.ITInterface0_VTable.i0method0 = ITInterface0_ClassC_Method0;
-	vtable.ITClassB_VTable.ITClassA_VTable.ITInterface1_VTable.i1method0 = ITInterface1_ClassC_Method0;
-	vtable.ITClassB_VTable.ITClassA_VTable.ITInterface2_VTable.i2method0 = ITInterface2_ClassC_Method0;
+const struct cclass_info_t ITClassC_Info =
+	CCLASS_INFO_INIT_INTERFACES(struct ITClassC, "ITClassC", &ITClassB_Info,
+		CCLASS_INTERFACES(IT_CLASSC_INFO_INTERFACES), IT_CLASSC_INFO_DISPLAY);
 
-	/* Keep reference to super's vtable. */
-	vtable.Supers_ITClassB_VTable = ITClassB_VTable_Key( );
+/* Start with the super's vtable, override these methods, and keep a reference
+ * to the super's implementation of them.
+ */
+#define IT_CLASSC_VTABLE_INIT														\
+	{																\
+		.ITClassB_VTable = IT_CLASSB_VTABLE_INIT,										\
+		.ITClassB_VTable.ITClassA_VTable.ITInterface1_VTable.ITInterface0_VTable.i0method0 = ITInterface0_ClassC_Method0,	\
+		.ITClassB_VTable.ITClassA_VTable.ITInterface1_VTable.i1method0 = ITInterface1_ClassC_Method0,				\
+		.ITClassB_VTable.ITClassA_VTable.ITInterface2_VTable.i2method0 = ITInterface2_ClassC_Method0,				\
+		.Supers_ITClassB_VTable = &itClassB_VTable,										\
+		.ITClassB_VTable.ITClassA_VTable.CObject_VTable.cinfo = &ITClassC_Info	\
+	}
+CCLASS_VTABLE(struct ITClassC_VTable, itClassC_VTable, IT_CLASSC_VTABLE_INIT);
 
-	/* Return pointer. */
-	return &vtable;
+const struct ITClassC_VTable* ITClassC_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &itClassC_VTable;
 }
 
 void newITClassC( struct ITClassC* self )
@@ -239,3 +248,121 @@ void newITClassC( struct ITClassC* self )
 	/* Must be second thing done in constructor. */
 	cclass_set_cvtable(self, ITClassC_VTable_Key( ));
 }
+
+
+/************************************************************************/
+/* Compact class A							*/
+/************************************************************************/
+/* Implementation of inherited compact interface method. */
+static int ITCompactInterface0_CompactA_Method0( struct ITCompactInterface0* self_ )
+{
+	(void)self_;
+	return IT_COMPACTA_CI0_METHOD0;
+}
+
+/* Implementation of inherited compact interface method. */
+static int ITCompactInterface1_CompactA_Method0( struct ITCompactInterface1* self_ )
+{
+	(void)self_;
+	return IT_COMPACTA_CI1_METHOD0;
+}
+
+const struct cclass_info_t ITCompactClassA_Info =
+	CCLASS_INFO_INIT_INTERFACES(struct ITCompactClassA, "ITCompactClassA", &cobject_info,
+		CCLASS_INTERFACES(IT_COMPACTA_INFO_INTERFACES), IT_COMPACTA_INFO_DISPLAY);
+
+/* Start with the super's vtable, give the offset of each compact interface,
+ * and implement the interface methods.
+ */
+#define IT_COMPACTA_VTABLE_INIT												\
+	{															\
+		.CObject_VTable = COBJECT_VTABLE_INIT,										\
+		.ITCompactInterface1_VTable.CCompact_VTable =									\
+			CINTERFACE_COMPACT_VTABLE_INIT(struct ITCompactClassA, itCompactInterface1),				\
+		.ITCompactInterface1_VTable.ITCompactInterface0_VTable.CCompact_VTable =					\
+			CINTERFACE_COMPACT_VTABLE_INIT(struct ITCompactClassA, itCompactInterface1.itCompactInterface0),	\
+		.ITCompactInterface1_VTable.ITCompactInterface0_VTable.ci0method0 = ITCompactInterface0_CompactA_Method0,	\
+		.ITCompactInterface1_VTable.ci1method0 = ITCompactInterface1_CompactA_Method0,					\
+		.CObject_VTable.cinfo = &ITCompactClassA_Info	\
+	}
+CCLASS_VTABLE(struct ITCompactClassA_VTable, itCompactClassA_VTable, IT_COMPACTA_VTABLE_INIT);
+
+const struct ITCompactClassA_VTable* ITCompactClassA_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &itCompactClassA_VTable;
+}
+
+void newITCompactClassA( struct ITCompactClassA* self )
+{
+	/* Construct super class. */
+	cobject_init(&self->cobject);
+
+	/* Map vtable. */
+	cclass_set_cvtable(self, ITCompactClassA_VTable_Key( ));
+
+	/* Construct inherited compact interfaces. */
+	cinterface_compact_init(self, &self->itCompactInterface1, &ITCompactClassA_VTable_Key( )->ITCompactInterface1_VTable);
+	cinterface_compact_init(self, &self->itCompactInterface1.itCompactInterface0, &ITCompactClassA_VTable_Key( )->ITCompactInterface1_VTable.ITCompactInterface0_VTable);
+}
+
+
+/************************************************************************/
+/* Compact class B							*/
+/************************************************************************/
+/* Override this inherited method. */
+static int ITCompactInterface0_CompactB_Method0( struct ITCompactInterface0* self_ )
+{
+	/* This is ITCompactClassB's implementation, cast object to that type. */
+	struct ITCompactClassB* self = ccast(self_);
+
+	/* Return sum of this macro plus value returned by super's implementation. */
+	return IT_COMPACTB_CI0_METHOD0 + ((struct ITCompactClassB_VTable*) cclass_get_vtable(self))->Supers_ITCompactClassA_VTable->ITCompactInterface1_VTable.ITCompactInterface0_VTable.ci0method0(&self->classA.itCompactInterface1.itCompactInterface0);
+}
+
+/* Override this inherited method. */
+static int ITCompactInterface1_CompactB_Method0( struct ITCompactInterface1* self_ )
+{
+	/* This is ITCompactClassB's implementation, cast object to that type. */
+	struct ITCompactClassB* self = ccast(self_);
+
+	/* Return sum of this macro plus value returned by super's implementation. */
+	return IT_COMPACTB_CI1_METHOD0 + ((struct ITCompactClassB_VTable*) cclass_get_vtable(self))->Supers_ITCompactClassA_VTable->ITCompactInterface1_VTable.ci1method0(&self->classA.itCompactInterface1);
+}
+
+const struct cclass_info_t ITCompactClassB_Info =
+	CCLASS_INFO_INIT_INTERFACES(struct ITCompactClassB, "ITCompactClassB", &ITCompactClassA_Info,
+		CCLASS_INTERFACES(IT_COMPACTB_INFO_INTERFACES), IT_COMPACTB_INFO_DISPLAY);
+
+/* Start with the super's vtable, which already has the offsets of the compact
+ * interfaces, override these methods, and keep a reference to the super's
+ * implementation of them.
+ */
+#define IT_COMPACTB_VTABLE_INIT																\
+	{																		\
+		.ITCompactClassA_VTable = IT_COMPACTA_VTABLE_INIT,													\
+		.ITCompactClassA_VTable.ITCompactInterface1_VTable.ITCompactInterface0_VTable.ci0method0 = ITCompactInterface0_CompactB_Method0,	\
+		.ITCompactClassA_VTable.ITCompactInterface1_VTable.ci1method0 = ITCompactInterface1_CompactB_Method0,					\
+		.Supers_ITCompactClassA_VTable = &itCompactClassA_VTable,										\
+		.ITCompactClassA_VTable.CObject_VTable.cinfo = &ITCompactClassB_Info	\
+	}
+CCLASS_VTABLE(struct ITCompactClassB_VTable, itCompactClassB_VTable, IT_COMPACTB_VTABLE_INIT);
+
+const struct ITCompactClassB_VTable* ITCompactClassB_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &itCompactClassB_VTable;
+}
+
+void newITCompactClassB( struct ITCompactClassB* self )
+{
+	/* Construct super class. */
+	newITCompactClassA(&self->classA);
+
+	/* Relink compact interfaces to this class' vtable. */
+	cinterface_compact_init(self, &self->classA.itCompactInterface1, &ITCompactClassB_VTable_Key( )->ITCompactClassA_VTable.ITCompactInterface1_VTable);
+	cinterface_compact_init(self, &self->classA.itCompactInterface1.itCompactInterface0, &ITCompactClassB_VTable_Key( )->ITCompactClassA_VTable.ITCompactInterface1_VTable.ITCompactInterface0_VTable);
+
+	/* Map vtable. */
+	cclass_set_cvtable(self, ITCompactClassB_VTable_Key( ));
+}
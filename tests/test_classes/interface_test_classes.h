@@ -37,12 +37,18 @@
  * 			* Can override i0method0
  * 			* Can override i2method0
  * 			* Can override i1method0
+ *
+ * 		Implementing and overriding methods of compact interfaces, where compact
+ * 		interface 1 inherits from compact interface 0. (CompactB->CompactA->CI1->CI0).
+ * 			* Can implement ci0method0 and ci1method0
+ * 			* Can override ci0method0 and ci1method0
  */
 #ifndef TESTS_TEST_CLASSES_INTERFACE_TEST_CLASSES_H_
 #define TESTS_TEST_CLASSES_INTERFACE_TEST_CLASSES_H_
 
 #include <cinterface.h>
 #include <cobject.h>
+#include <ctrace.h>
 
 #define IT_CLASSA_I0_METHOD0 1
 #define IT_CLASSA_I0_METHOD1 2
@@ -59,6 +65,11 @@
 #define IT_CLASSC_I1_METHOD0 12
 #define IT_CLASSC_I2_METHOD0 11
 
+#define IT_COMPACTA_CI0_METHOD0 13
+#define IT_COMPACTA_CI1_METHOD0 14
+#define IT_COMPACTB_CI0_METHOD0 15
+#define IT_COMPACTB_CI1_METHOD0 16
+
 /************************************************************************/
 /* Interface 0								*/
 /************************************************************************/
@@ -78,12 +89,14 @@ struct ITInterface0_VTable
 /* Wrapper for calling interface method. */
 static inline int ITInterface0_Method0( struct ITInterface0* self )
 {
+	CTRACE_CALL( );
 	return ((struct ITInterface0_VTable*) cclass_get_vtable(self))->i0method0(self);
 }
 
 /* Wrapper for calling interface method. */
 static inline int ITInterface0_Method1( struct ITInterface0* self )
 {
+	CTRACE_CALL( );
 	return ((struct ITInterface0_VTable*) cclass_get_vtable(self))->i0method1(self);
 }
 
@@ -113,6 +126,7 @@ struct ITInterface1_VTable
 /* Wrapper for calling interface method. */
 static inline int ITInterface1_Method0( struct ITInterface1* self )
 {
+	CTRACE_CALL( );
 	return ((struct ITInterface1_VTable*) cclass_get_vtable(self))->i1method0(self);
 }
 
@@ -136,12 +150,14 @@ struct ITInterface2_VTable
 /* Wrapper for calling interface method. */
 static inline int ITInterface2_Method0( struct ITInterface2* self )
 {
+	CTRACE_CALL( );
 	return ((struct ITInterface2_VTable*) cclass_get_vtable(self))->i2method0(self);
 }
 
 /* Wrapper for calling interface method. */
 static inline int ITInterface2_Method1( struct ITInterface2* self )
 {
+	CTRACE_CALL( );
 	return ((struct ITInterface2_VTable*) cclass_get_vtable(self))->i2method1(self);
 }
 
@@ -171,6 +187,12 @@ struct ITClassA_VTable
 	struct ITInterface2_VTable ITInterface2_VTable;
 };
 
+/* This class' type descriptor, and its display list and interfaces for subclasses. */
+extern const struct cclass_info_t ITClassA_Info;
+#define IT_CLASSA_INFO_DISPLAY COBJECT_INFO_DISPLAY, &ITClassA_Info
+#define IT_CLASSA_INFO_INTERFACES offsetof(struct ITClassA, itInterface2),	\
+	offsetof(struct ITClassA, itInterface1),				\
+	offsetof(struct ITClassA, itInterface1.itInterface0)
 /* Function to get the reference to this class' vtable. */
 const struct ITClassA_VTable* ITClassA_VTable_Key( );
 /* Constructor. */
@@ -198,6 +220,10 @@ struct ITClassB_VTable
 	const struct ITClassA_VTable* Supers_ITClassA_VTable;
 };
 
+/* This class' type descriptor, and its display list and interfaces for subclasses. */
+extern const struct cclass_info_t ITClassB_Info;
+#define IT_CLASSB_INFO_DISPLAY IT_CLASSA_INFO_DISPLAY, &ITClassB_Info
+#define IT_CLASSB_INFO_INTERFACES IT_CLASSA_INFO_INTERFACES
 /* Used to get a reference to this class' vtable. */
 const struct ITClassB_VTable* ITClassB_VTable_Key( );	
 /* Constructor. */
@@ -225,9 +251,120 @@ struct ITClassC_VTable
 	const struct ITClassB_VTable* Supers_ITClassB_VTable;
 };
 
+/* This class' type descriptor, and its display list and interfaces for subclasses. */
+extern const struct cclass_info_t ITClassC_Info;
+#define IT_CLASSC_INFO_DISPLAY IT_CLASSB_INFO_DISPLAY, &ITClassC_Info
+#define IT_CLASSC_INFO_INTERFACES IT_CLASSB_INFO_INTERFACES
 /* Used to get a reference to this class' vtable. */
 const struct ITClassC_VTable* ITClassC_VTable_Key( );
 /* Constructor. */
 void newITClassC( struct ITClassC* );
 
+
+/************************************************************************/
+/* Compact interface 0							*/
+/************************************************************************/
+struct ITCompactInterface0
+{
+	/* Must be first member of a compact interface. */
+	struct cinterface_compact_t interface;
+};
+
+struct ITCompactInterface0_VTable
+{
+	/* Must be first member of a compact interface's vtable. */
+	struct cclass_compact_vtable_t CCompact_VTable;
+
+	int (*ci0method0)( struct ITCompactInterface0* );
+};
+
+/* Wrapper for calling interface method. */
+static inline int ITCompactInterface0_Method0( struct ITCompactInterface0* self )
+{
+	CTRACE_CALL( );
+	return ((struct ITCompactInterface0_VTable*) cclass_get_vtable(self))->ci0method0(self);
+}
+
+
+/************************************************************************/
+/* Compact interface 1							*/
+/************************************************************************/
+struct ITCompactInterface1
+{
+	/* Must be first member of a compact interface. */
+	struct cinterface_compact_t interface;
+
+	/* Inherit from compact interface 0. */
+	struct ITCompactInterface0 itCompactInterface0;
+};
+
+struct ITCompactInterface1_VTable
+{
+	/* Must be first member of a compact interface's vtable. */
+	struct cclass_compact_vtable_t CCompact_VTable;
+
+	/* Must include all super interface's vtable in this */
+	/* interfaces vtable. */
+	struct ITCompactInterface0_VTable ITCompactInterface0_VTable;
+
+	int (*ci1method0)( struct ITCompactInterface1* );
+};
+
+/* Wrapper for calling interface method. */
+static inline int ITCompactInterface1_Method0( struct ITCompactInterface1* self )
+{
+	CTRACE_CALL( );
+	return ((struct ITCompactInterface1_VTable*) cclass_get_vtable(self))->ci1method0(self);
+}
+
+
+/************************************************************************/
+/* Compact class A							*/
+/************************************************************************/
+struct ITCompactClassA
+{
+	/* Super class must be first member of the class declaration. */
+	struct cobject_t cobject;
+
+	/* Inherit from this compact interface. */
+	struct ITCompactInterface1 itCompactInterface1;
+};
+
+struct ITCompactClassA_VTable
+{
+	struct cobject_vtable_t CObject_VTable;
+	struct ITCompactInterface1_VTable ITCompactInterface1_VTable;
+};
+
+/* This class' type descriptor, and its display list and interfaces for subclasses. */
+extern const struct cclass_info_t ITCompactClassA_Info;
+#define IT_COMPACTA_INFO_DISPLAY COBJECT_INFO_DISPLAY, &ITCompactClassA_Info
+#define IT_COMPACTA_INFO_INTERFACES offsetof(struct ITCompactClassA, itCompactInterface1), \
+	offsetof(struct ITCompactClassA, itCompactInterface1.itCompactInterface0)
+const struct ITCompactClassA_VTable* ITCompactClassA_VTable_Key( );
+void newITCompactClassA( struct ITCompactClassA* );
+
+
+/************************************************************************/
+/* Compact class B							*/
+/************************************************************************/
+struct ITCompactClassB
+{
+	/* Super class must be first member of class declaration. */
+	struct ITCompactClassA classA;
+};
+
+struct ITCompactClassB_VTable
+{
+	struct ITCompactClassA_VTable ITCompactClassA_VTable;
+	const struct ITCompactClassA_VTable* Supers_ITCompactClassA_VTable;
+};
+
+/* This class' type descriptor, and its display list and interfaces for subclasses. */
+extern const struct cclass_info_t ITCompactClassB_Info;
+#define IT_COMPACTB_INFO_DISPLAY IT_COMPACTA_INFO_DISPLAY, &ITCompactClassB_Info
+#define IT_COMPACTB_INFO_INTERFACES IT_COMPACTA_INFO_INTERFACES
+const struct ITCompactClassB_VTable* ITCompactClassB_VTable_Key( );
+void newITCompactClassB( struct ITCompactClassB* );
+
 #endif /* TESTS_TEST_CLASSES_INTERFACE_TEST_CLASSES_H_ */
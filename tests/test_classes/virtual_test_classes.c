@@ -52,23 +52,26 @@ static int method4( struct VTClassA* self )
 	return VT_CLASSA_METHOD4;
 }
 
+const struct cclass_info_t VTClassA_Info =
+	CCLASS_INFO_INIT(struct VTClassA, "VTClassA", &cobject_info, VT_CLASSA_INFO_DISPLAY);
+
+/* Start with the super's vtable and link all of this class' virtual methods. */
+#define VT_CLASSA_VTABLE_INIT				\
+	{						\
+		.CObject_VTable = COBJECT_VTABLE_INIT,	\
+		.method0 = method0,			\
+		.method1 = method1,			\
+		.method2 = method2,			\
+		.method3 = method3,			\
+		.method4 = method4,			\
+		.CObject_VTable.cinfo = &VTClassA_Info	\
+	}
+CCLASS_VTABLE(struct VTClassA_VTable, vtClassA_VTable, VT_CLASSA_VTABLE_INIT);
+
 const struct VTClassA_VTable* VTClassA_VTable_Key( )
 {
-	/* Only need one vtable for every instance of this class. */
-	static struct VTClassA_VTable vtable;
-
-	/* Get a copy of the super's vtable for this class. */
-	vtable.CObject_VTable = *cobject_vtable( );
-
-	/* Link all of this class' virtual methods. */
-	vtable.method0 = method0;
-	vtable.method1 = method1;
-	vtable.method2 = method2;
-	vtable.method3 = method3;
-	vtable.method4 = method4;
-
-	/* Return pointer. */
-	return &vtable;
+	/* Built at compile time, shared by every instance of this class. */
+	return &vtClassA_VTable;
 }
 
 void newVTClassA( struct VTClassA* self )
@@ -113,25 +116,28 @@ static int classBMethod4( struct VTClassA* self_ )
 	return VT_CLASSB_METHOD4 + ((struct VTClassB_VTable*) cclass_get_vtable(self))->Supers_VTClassA_VTable->method4(&self->classA);
 }
 
-const struct VTClassB_VTable* VTClassB_VTable_Key( )
-{
-	/* Only need one vtable for every instance of this class. */
-	static struct VTClassB_VTable vtable;
-
-	/* Get a copy of the super's vtable. */
-	vtable.VTClassA_VTable = *VTClassA_VTable_Key( );
+const struct cclass_info_t VTClassB_Info =
+	CCLASS_INFO_INIT(struct VTClassB, "VTClassB", &VTClassA_Info, VT_CLASSB_INFO_DISPLAY);
 
-	/* We are overriding method1, method2, method3, and method4 - do that now. */
-	vtable.VTClassA_VTable.method1 = classBMethod1;
-	vtable.VTClassA_VTable.method2 = classBMethod2;
-	vtable.VTClassA_VTable.method3 = classBMethod3;
-	vtable.VTClassA_VTable.method4 = classBMethod4;
-
-	/* method2 and method4 need to call their super's implementation, provide that reference here. */
-	vtable.Supers_VTClassA_VTable = VTClassA_VTable_Key( );
+/* Start with the super's vtable, override method1 through method4, and keep a
+ * reference to the super's vtable for method2 and method4 to call into.
+ */
+#define VT_CLASSB_VTABLE_INIT					\
+	{							\
+		.VTClassA_VTable = VT_CLASSA_VTABLE_INIT,	\
+		.VTClassA_VTable.method1 = classBMethod1,	\
+		.VTClassA_VTable.method2 = classBMethod2,	\
+		.VTClassA_VTable.method3 = classBMethod3,	\
+		.VTClassA_VTable.method4 = classBMethod4,	\
+		.Supers_VTClassA_VTable = &vtClassA_VTable,	\
+		.VTClassA_VTable.CObject_VTable.cinfo = &VTClassB_Info	\
+	}
+CCLASS_VTABLE(struct VTClassB_VTable, vtClassB_VTable, VT_CLASSB_VTABLE_INIT);
 
-	/* Return pointer. */
-	return &vtable;
+const struct VTClassB_VTable* VTClassB_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &vtClassB_VTable;
 }
 
 void newVTClassB( struct VTClassB* self )
@@ -164,23 +170,26 @@ static int classCMethod4( struct VTClassA* self_ )
 	return VT_CLASSC_METHOD4 + ((struct VTClassC_VTable*) cclass_get_vtable(self))->Supers_VTClassB_VTable->VTClassA_VTable.method4((struct VTClassA*) self);
 }
 
-const struct VTClassC_VTable* VTClassC_VTable_Key( )
-{
-	/* Only need one vtable for every instance of this class. */
-	static struct VTClassC_VTable vtable;
-
-	/* Get a copy of the supers vtable. */
-	vtable.VTClassB_VTable = *VTClassB_VTable_Key( );
+const struct cclass_info_t VTClassC_Info =
+	CCLASS_INFO_INIT(struct VTClassC, "VTClassC", &VTClassB_Info, VT_CLASSC_INFO_DISPLAY);
 
-	/* Overriding method3 and method4. */
-	vtable.VTClassB_VTable.VTClassA_VTable.method3 = classCMethod3;
-	vtable.VTClassB_VTable.VTClassA_VTable.method4 = classCMethod4;
-
-	/* Need a reference to super's implementation for method3 and method4. */
-	vtable.Supers_VTClassB_VTable = VTClassB_VTable_Key( );
+/* Start with the super's vtable, override method3 and method4, and keep a
+ * reference to the super's vtable for them to call into.
+ */
+#define VT_CLASSC_VTABLE_INIT							\
+	{									\
+		.VTClassB_VTable = VT_CLASSB_VTABLE_INIT,			\
+		.VTClassB_VTable.VTClassA_VTable.method3 = classCMethod3,	\
+		.VTClassB_VTable.VTClassA_VTable.method4 = classCMethod4,	\
+		.Supers_VTClassB_VTable = &vtClassB_VTable,			\
+		.VTClassB_VTable.VTClassA_VTable.CObject_VTable.cinfo = &VTClassC_Info	\
+	}
+CCLASS_VTABLE(struct VTClassC_VTable, vtClassC_VTable, VT_CLASSC_VTABLE_INIT);
 
-	/* Return pointer. */
-	return &vtable;
+const struct VTClassC_VTable* VTClassC_VTable_Key( )
+{
+	/* Built at compile time, shared by every instance of this class. */
+	return &vtClassC_VTable;
 }
 
 void newVTClassC( struct VTClassC* self )
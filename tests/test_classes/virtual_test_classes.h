@@ -73,6 +73,8 @@ struct VTClassA_VTable
 	int (*method4)( struct VTClassA* );
 };
 
+extern const struct cclass_info_t VTClassA_Info;
+#define VT_CLASSA_INFO_DISPLAY COBJECT_INFO_DISPLAY, &VTClassA_Info
 const struct VTClassA_VTable* VTClassA_VTable_Key( );
 void newVTClassA( struct VTClassA* );
 
@@ -116,6 +118,8 @@ struct VTClassB_VTable
 	const struct VTClassA_VTable* Supers_VTClassA_VTable;
 };
 
+extern const struct cclass_info_t VTClassB_Info;
+#define VT_CLASSB_INFO_DISPLAY VT_CLASSA_INFO_DISPLAY, &VTClassB_Info
 const struct VTClassB_VTable* VTClassB_VTable_Key( );
 void newVTClassB( struct VTClassB* );
 
@@ -136,6 +140,8 @@ struct VTClassC_VTable
 	const struct VTClassB_VTable* Supers_VTClassB_VTable;
 };
 
+extern const struct cclass_info_t VTClassC_Info;
+#define VT_CLASSC_INFO_DISPLAY VT_CLASSB_INFO_DISPLAY, &VTClassC_Info
 const struct VTClassC_VTable* VTClassC_VTable_Key( );
 void newVTClassC( struct VTClassC* );
 
@@ -25,3 +25,149 @@ unsigned int unit_tests_run = 0;
 unsigned int unit_tests_aborted = 0;
 unsigned int unit_asserts_failed_pre_test = 0;
 unsigned int unit_tests_passed = 0, unit_tests_failed = 0;
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const char* unit_bench_suite = "";
+
+/* Time spent in the BENCH_LOOP of the last run of a benchmark. */
+static double unit_bench_start_ns, unit_bench_elapsed_ns;
+
+/* Never calibrate a sample past this many iterations, in case a benchmark
+ * has no BENCH_LOOP.
+ */
+#define UNIT_BENCH_MAX_ITERATIONS (1UL << 40)
+
+static double unit_bench_now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+void unit_bench_begin( void )
+{
+	unit_bench_start_ns = unit_bench_now_ns( );
+}
+
+void unit_bench_end( void )
+{
+	unit_bench_elapsed_ns = unit_bench_now_ns( ) - unit_bench_start_ns;
+}
+
+static double unit_bench_sample( void (*bench)( unsigned long ), unsigned long iterations )
+{
+	unit_bench_elapsed_ns = 0;
+	bench(iterations);
+	return unit_bench_elapsed_ns;
+}
+
+static int unit_bench_compare( const void* a_, const void* b_ )
+{
+	double a = *(const double*) a_;
+	double b = *(const double*) b_;
+
+	return (a > b) - (a < b);
+}
+
+/* Look up suite.name in the baseline file. The last entry wins, so records
+ * appended to a baseline replace earlier ones.
+ */
+static int unit_bench_baseline( const char* name, double* median )
+{
+	const char* path;
+	FILE* file;
+	char key[256], entry[256], line[512];
+	double value;
+	int found;
+
+	path = getenv("UNIT_BENCH_BASELINE");
+	if( path == NULL || (file = fopen(path, "r")) == NULL ) {
+		return 0;
+	}
+	snprintf(key, sizeof(key), "%s.%s", unit_bench_suite, name);
+
+	found = 0;
+	while( fgets(line, sizeof(line), file) != NULL ) {
+		if( sscanf(line, "%255s %lf", entry, &value) == 2 && strcmp(entry, key) == 0 ) {
+			*median = value;
+			found = 1;
+		}
+	}
+	fclose(file);
+	return found;
+}
+
+void unit_bench_run( const char* name, void (*bench)( unsigned long ) )
+{
+	double samples[UNIT_BENCH_SAMPLES];
+	double elapsed, warmup, median, low, high, p99, baseline, tolerance;
+	unsigned long iterations;
+	const char* env;
+	FILE* record;
+	size_t n, k, i;
+
+	/* Calibrate, doubling the iterations until one run takes a sample's
+	 * time, then scale them to fit the sample time.
+	 */
+	iterations = 1;
+	warmup = 0;
+	for( ;; ) {
+		elapsed = unit_bench_sample(bench, iterations);
+		warmup += elapsed;
+		if( elapsed >= UNIT_BENCH_SAMPLE_NS || iterations >= UNIT_BENCH_MAX_ITERATIONS ) {
+			break;
+		}
+		iterations *= 2;
+	}
+	if( elapsed > 0 ) {
+		iterations = (unsigned long) (iterations * (UNIT_BENCH_SAMPLE_NS / elapsed));
+	}
+	if( iterations == 0 ) {
+		iterations = 1;
+	}
+
+	/* Warm up. */
+	while( warmup < UNIT_BENCH_WARMUP_NS && elapsed > 0 ) {
+		warmup += unit_bench_sample(bench, iterations);
+	}
+
+	n = UNIT_BENCH_SAMPLES;
+	for( i = 0; i < n; ++i ) {
+		samples[i] = unit_bench_sample(bench, iterations) / iterations;
+	}
+	qsort(samples, n, sizeof(samples[0]), unit_bench_compare);
+
+	/* Distribution free 95% confidence interval of the median, the samples
+	 * ranked n/2 +/- 0.98 * sqrt(n).
+	 */
+	for( k = 0; k * k * 10000 < 9604 * n; ++k ) { }
+	median = samples[n / 2];
+	low = samples[n / 2 >= k ? n / 2 - k : 0];
+	high = samples[n / 2 + k < n ? n / 2 + k : n - 1];
+	p99 = samples[(99 * n + 99) / 100 - 1];
+
+	UNIT_PRINT("\t\tmedian %.2f ns/op (95%% CI %.2f - %.2f), p99 %.2f ns/op, %zu samples of %lu\n",
+		   median, low, high, p99, n, iterations);
+
+	env = getenv("UNIT_BENCH_RECORD");
+	if( env != NULL && (record = fopen(env, "a")) != NULL ) {
+		fprintf(record, "%s.%s %.3f\n", unit_bench_suite, name, median);
+		fclose(record);
+	}
+
+	if( unit_bench_baseline(name, &baseline) ) {
+		env = getenv("UNIT_BENCH_TOLERANCE");
+		tolerance = env != NULL ? strtod(env, NULL) : UNIT_BENCH_TOLERANCE;
+		ASSERT(low <= baseline * (1 + tolerance),
+		       "%s regressed, %.2f ns/op with 95%% CI above baseline %.2f ns/op + %.0f%%",
+		       name, median, baseline, tolerance * 100);
+	}
+	else {
+		++unit_asserts_passed;
+	}
+	UNIT_FLUSH( );
+}
@@ -92,6 +92,87 @@ extern unsigned int unit_tests_passed, unit_tests_failed;
 			unit_asserts_failed - delta_unit_asserts_failed);	\
 	} while(0)
 
+/* Benchmarks. A benchmark times the body of its BENCH_LOOP, anything before
+ * or after the loop is untimed setup and clean up:
+ *
+ *	BENCH(virtual_call)
+ *	{
+ *		struct VTClassC object;
+ *
+ *		newVTClassC(&object);
+ *		BENCH_LOOP {
+ *			VTClassA_Method0((struct VTClassA*) &object);
+ *		}
+ *	}
+ *
+ * ADD_BENCH warms the benchmark up, calibrates the iterations of the loop so
+ * one sample takes UNIT_BENCH_SAMPLE_NS, then takes UNIT_BENCH_SAMPLES samples
+ * and reports the median, a 95% confidence interval of the median, and the
+ * 99th percentile, in ns per iteration.
+ *
+ * Each benchmark counts as a test with one assert. If the file named by the
+ * environment variable UNIT_BENCH_BASELINE has a median for the benchmark,
+ * as a line "suite.name median", the assert fails when the confidence
+ * interval is entirely above the baseline plus a tolerance, UNIT_BENCH_TOLERANCE
+ * (a fraction) from the environment or from this header. Medians are appended
+ * in the same format to the file named by UNIT_BENCH_RECORD, to make a baseline.
+ */
+#ifndef UNIT_BENCH_SAMPLES
+#define UNIT_BENCH_SAMPLES		21
+#endif
+#ifndef UNIT_BENCH_SAMPLE_NS
+#define UNIT_BENCH_SAMPLE_NS		1000000.0
+#endif
+#ifndef UNIT_BENCH_WARMUP_NS
+#define UNIT_BENCH_WARMUP_NS		5000000.0
+#endif
+#ifndef UNIT_BENCH_TOLERANCE
+#define UNIT_BENCH_TOLERANCE		0.25
+#endif
+
+extern const char* unit_bench_suite;
+
+void unit_bench_begin( void );
+void unit_bench_end( void );
+void unit_bench_run( const char* name, void (*bench)( unsigned long ) );
+
+#define BENCH(name)			static void bench_##name (unsigned long _unit_bench_iterations)
+#define BENCH_SUITE(suite)		void all_benches_##suite (void)
+
+#define BENCH_LOOP							\
+	for( unsigned long _unit_bench_i = (unit_bench_begin( ), 0UL);	\
+	     _unit_bench_i < _unit_bench_iterations || (unit_bench_end( ), 0); \
+	     ++_unit_bench_i )
+
+#define ADD_BENCH(name)							\
+	do {								\
+		UNIT_PRINT( "\tBench: %s...\n", #name );		\
+		UNIT_FLUSH( );						\
+		_unit_test_setup( );					\
+		unit_asserts_failed_pre_test = unit_asserts_failed; 	\
+		unit_bench_run(#name, bench_##name);			\
+		_unit_test_teardown( );					\
+		if( unit_asserts_failed > unit_asserts_failed_pre_test ) {	\
+			unit_tests_failed += 1;					\
+		}								\
+		else {								\
+			unit_tests_passed += 1;					\
+		}								\
+		++unit_tests_run;						\
+	} while(0)
+
+#define RUN_BENCH_SUITE(suite)						\
+	  do {								\
+		UNIT_PRINT("Running bench suite: %s...\n", #suite);	\
+		unit_bench_suite = #suite;				\
+		delta_unit_asserts_passed = unit_asserts_passed;	\
+		delta_unit_asserts_failed = unit_asserts_failed;	\
+		all_benches_##suite ();					\
+		UNIT_PRINT("Asserts passed: %d\nAsserts failed: %d\n\n",\
+			unit_asserts_passed - delta_unit_asserts_passed,	\
+			unit_asserts_failed - delta_unit_asserts_failed);	\
+	} while(0)
+
 #define PRINT_DIAG()							\
 	do {								\
 		UNIT_PRINT("DIAGNOSTICS...\n");				\
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify the object arena. Resetting an arena must
+ * run the destructor chain of every object in it, most recent first, skip
+ * objects with nothing to destroy, and reuse the arena's memory.
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <carena.h>
+#include <unit.h>
+
+static struct carena_t arena;
+
+TEST_SETUP( ) { }
+TEST_TEARDOWN( )
+{
+	carena_destroy(&arena);
+}
+
+#define FREE_USED 0
+#define FREE_UNUSED 1
+
+static int freeUsed = FREE_UNUSED;
+
+static void testFree( void* self )
+{
+	(void) self;
+	freeUsed = FREE_USED;
+}
+
+
+TEST(reset_destroys)
+{
+	struct DTClassE* e;
+	struct DTClassD* d;
+	int tempE, tempD;
+
+	carena_init(&arena, 0);
+
+	e = carena_alloc(&arena, sizeof(*e));
+	d = carena_alloc(&arena, sizeof(*d));
+	ASSERT(e != NULL && d != NULL, "Failed to allocate from arena");
+	if( e == NULL || d == NULL ) {
+		return;
+	}
+	newDTClassE(e, &tempE);
+	newDTClassD(d, &tempD);
+
+	carena_reset(&arena);
+	ASSERT(tempE == DT_CLASS_E_VAL + 1, "Failed to cascade E's destructor - %d", tempE);
+	ASSERT(tempD == DT_CLASS_A_VAL + 1, "Failed to cascade D's destructor - %d", tempD);
+}
+
+TEST(reset_order)
+{
+	struct DTClassE* e;
+	struct DTClassC* c;
+	int temp;
+
+	carena_init(&arena, 0);
+
+	/* E sets temp, C increments it. Destroying most recent first, C then E,
+	 * leaves temp at E's value plus one.
+	 */
+	e = carena_alloc(&arena, sizeof(*e));
+	c = carena_alloc(&arena, sizeof(*c));
+	newDTClassE(e, &temp);
+	newDTClassC(c, &temp);
+
+	carena_reset(&arena);
+	ASSERT(temp == DT_CLASS_E_VAL + 1, "Objects destroyed in wrong order - %d", temp);
+}
+
+TEST(skip_trivial)
+{
+	struct DTClassB* b;
+	int temp;
+
+	carena_init(&arena, 0);
+
+	/* DTClassB's destructor is cobject_destructor, so the arena skips it and
+	 * never calls the free hook.
+	 */
+	b = carena_alloc(&arena, sizeof(*b));
+	newDTClassB(b, &temp);
+	freeUsed = FREE_UNUSED;
+	cmalloc(b, testFree);
+
+	/* Allocated but never constructed. */
+	carena_alloc(&arena, sizeof(*b));
+
+	carena_reset(&arena);
+	ASSERT(freeUsed == FREE_UNUSED, "Trivial destructor was not skipped");
+}
+
+TEST(reuse)
+{
+	void* first;
+	void* large;
+	size_t i;
+
+	carena_init(&arena, 1024);
+
+	/* Fill a few blocks and one oversized block. */
+	first = carena_alloc(&arena, sizeof(struct DTClassA));
+	for( i = 0; i < 100; ++i ) {
+		ASSERT(carena_alloc(&arena, sizeof(struct DTClassA)) != NULL, "Failed to allocate %zu", i);
+	}
+	large = carena_alloc(&arena, 4096);
+	ASSERT(large != NULL, "Failed to allocate object larger than a block");
+	ASSERT(((size_t) large) % sizeof(void*) == 0, "Object not aligned");
+
+	/* Memory of the first block is reused after a reset. */
+	carena_reset(&arena);
+	ASSERT(carena_alloc(&arena, sizeof(struct DTClassA)) == first, "Failed to reuse first block");
+}
+
+TEST_SUITE(arena_suite)
+{
+	ADD_TEST(reset_destroys);
+	ADD_TEST(reset_order);
+	ADD_TEST(skip_trivial);
+	ADD_TEST(reuse);
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify the object census. Counts made by the
+ * census hooks, from any number of threads, must be merged exactly by
+ * ccensus_snapshot( ). The hooks are called directly, on classes private
+ * to this file. Counting real objects needs a CCENSUS build.
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <ccensus.h>
+#include <unit.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Two classes, B extends A, which only this file counts. */
+struct CensusA
+{
+	struct cobject_t cobject;
+	char data[24];
+};
+
+static const struct cclass_info_t CensusA_Info;
+static const struct cclass_info_t CensusB_Info;
+static const struct cclass_info_t CensusA_Info =
+	CCLASS_INFO_INIT(struct CensusA, "CensusA", &cobject_info, COBJECT_INFO_DISPLAY, &CensusA_Info);
+static const struct cclass_info_t CensusB_Info =
+	CCLASS_INFO_INIT(struct CensusA, "CensusB", &CensusA_Info, COBJECT_INFO_DISPLAY, &CensusA_Info, &CensusB_Info);
+
+static const struct cobject_vtable_t CensusA_VTable = { .cdestructor = cobject_destructor, .cinfo = &CensusA_Info };
+static const struct cobject_vtable_t CensusB_VTable = { .cdestructor = cobject_destructor, .cinfo = &CensusB_Info };
+
+/* A class' entry in a new snapshot, all zero if it isn't counted.
+ */
+static struct ccensus_entry_t census_of( const struct cclass_info_t* info )
+{
+	static struct ccensus_entry_t entries[CCENSUS_CLASSES];
+	struct ccensus_entry_t none = { 0, 0, 0, 0, 0, 0 };
+	size_t count, i;
+
+	count = ccensus_snapshot(entries, CCENSUS_CLASSES);
+	for( i = 0; i < count && i < CCENSUS_CLASSES; ++i ) {
+		if( entries[i].cinfo == info ) {
+			return entries[i];
+		}
+	}
+	none.cinfo = info;
+	return none;
+}
+
+TEST_SETUP( )
+{
+}
+TEST_TEARDOWN( )
+{
+}
+
+
+#define CENSUS_OBJECTS 100
+
+TEST(counts)
+{
+	struct ccensus_entry_t a, b, a0, b0;
+	struct CensusA object;
+	int i;
+
+	a0 = census_of(&CensusA_Info);
+	b0 = census_of(&CensusB_Info);
+
+	/* Construct as A, a subclass constructor moves half of them to B. */
+	object.cobject.cclass.croot = &object;
+	object.cobject.cclass.cvtable = &CensusA_VTable;
+	for( i = 0; i < CENSUS_OBJECTS; ++i ) {
+		ccensus_construct(&CensusA_Info);
+		if( i % 2 == 0 ) {
+			ccensus_retag(&object, &CensusB_VTable);
+		}
+	}
+	for( i = 0; i < CENSUS_OBJECTS / 2; ++i ) {
+		ccensus_destruct(&CensusA_Info);
+	}
+
+	a = census_of(&CensusA_Info);
+	b = census_of(&CensusB_Info);
+	ASSERT(a.cconstructed - a0.cconstructed == CENSUS_OBJECTS / 2, "Constructed %zu A", a.cconstructed - a0.cconstructed);
+	ASSERT(b.cconstructed - b0.cconstructed == CENSUS_OBJECTS / 2, "Constructed %zu B", b.cconstructed - b0.cconstructed);
+	ASSERT(a.cdestroyed - a0.cdestroyed == CENSUS_OBJECTS / 2, "Destroyed %zu A", a.cdestroyed - a0.cdestroyed);
+	ASSERT(a.clive == a0.clive, "%zu A live", a.clive);
+	ASSERT(b.clive - b0.clive == CENSUS_OBJECTS / 2, "%zu B live", b.clive);
+	ASSERT(b.cbytes == b.clive * sizeof(struct CensusA), "%zu bytes of B", b.cbytes);
+	ASSERT(a.cpeak >= CENSUS_OBJECTS / 2 - CCENSUS_SLOP, "Peak of %zu A", a.cpeak);
+
+	for( i = 0; i < CENSUS_OBJECTS / 2; ++i ) {
+		ccensus_destruct(&CensusB_Info);
+	}
+	b = census_of(&CensusB_Info);
+	ASSERT(b.clive == b0.clive, "%zu B live", b.clive);
+}
+
+TEST(interfaces)
+{
+	struct ccensus_entry_t a, b, a0, b0;
+	struct CensusA object;
+	struct cclass_t iface;
+
+	a0 = census_of(&CensusA_Info);
+	b0 = census_of(&CensusB_Info);
+
+	/* An interface is not an object, mapping its vtable counts nothing. */
+	object.cobject.cclass.croot = &object;
+	object.cobject.cclass.cvtable = &CensusA_VTable;
+	iface.croot = &object;
+	iface.cvtable = &CensusA_VTable;
+	ccensus_retag(&iface, &CensusB_VTable);
+
+	/* Neither does mapping the same vtable again. */
+	ccensus_retag(&object, &CensusA_VTable);
+
+	a = census_of(&CensusA_Info);
+	b = census_of(&CensusB_Info);
+	ASSERT(a.cconstructed == a0.cconstructed && a.clive == a0.clive, "A counted");
+	ASSERT(b.cconstructed == b0.cconstructed && b.clive == b0.clive, "B counted");
+}
+
+#define CENSUS_THREADS 4
+#define CENSUS_PER_THREAD 1000
+
+static void* census_thread( void* arg )
+{
+	int i;
+
+	(void) arg;
+	for( i = 0; i < CENSUS_PER_THREAD; ++i ) {
+		ccensus_construct(&CensusA_Info);
+	}
+	return NULL;
+}
+
+TEST(threads)
+{
+	pthread_t threads[CENSUS_THREADS];
+	struct ccensus_entry_t a, a0;
+	int created, i;
+
+	a0 = census_of(&CensusA_Info);
+	for( created = 0; created < CENSUS_THREADS; ++created ) {
+		if( pthread_create(&threads[created], NULL, census_thread, NULL) != 0 ) {
+			break;
+		}
+	}
+	for( i = 0; i < created; ++i ) {
+		pthread_join(threads[i], NULL);
+	}
+
+	/* Counted by other threads, destroyed by this one. */
+	a = census_of(&CensusA_Info);
+	ASSERT(a.cconstructed - a0.cconstructed == (size_t) created * CENSUS_PER_THREAD, "Constructed %zu", a.cconstructed - a0.cconstructed);
+	ASSERT(a.clive - a0.clive == (size_t) created * CENSUS_PER_THREAD, "%zu live", a.clive - a0.clive);
+
+	for( i = 0; i < created * CENSUS_PER_THREAD; ++i ) {
+		ccensus_destruct(&CensusA_Info);
+	}
+	a = census_of(&CensusA_Info);
+	ASSERT(a.clive == a0.clive, "%zu live after destroying", a.clive);
+	ASSERT(a.cpeak >= a0.clive + created * CENSUS_PER_THREAD - CCENSUS_SLOP, "Peak of %zu", a.cpeak);
+}
+
+TEST(json)
+{
+	char* text;
+	size_t size;
+	FILE* out;
+
+	ccensus_construct(&CensusB_Info);
+	out = open_memstream(&text, &size);
+	if( out == NULL ) {
+		ABORT_TEST("Failed to open stream");
+	}
+	ccensus_dump(out, CCENSUS_JSON);
+	fclose(out);
+
+	ASSERT(strncmp(text, "{\n  \"classes\": [", 16) == 0, "Not a JSON object: %.20s", text);
+	ASSERT(strstr(text, "\"class\": \"CensusB\", \"size\": ") != NULL, "CensusB missing from %s", text);
+	free(text);
+	ccensus_destruct(&CensusB_Info);
+}
+
+#ifdef CCENSUS
+TEST(objects)
+{
+	struct ccensus_entry_t a, c, a0, c0;
+	struct DTClassC object;
+	int temp;
+
+	a0 = census_of(&DTClassA_Info);
+	c0 = census_of(&DTClassC_Info);
+
+	/* Constructors of DTClassA and DTClassB run, but it's a DTClassC. */
+	newDTClassC(&object, &temp);
+	a = census_of(&DTClassA_Info);
+	c = census_of(&DTClassC_Info);
+	ASSERT(a.cconstructed == a0.cconstructed, "Counted as a DTClassA");
+	ASSERT(c.cconstructed == c0.cconstructed + 1 && c.clive == c0.clive + 1, "Not counted as a DTClassC");
+
+	cdestroy(&object);
+	c = census_of(&DTClassC_Info);
+	ASSERT(c.cdestroyed == c0.cdestroyed + 1 && c.clive == c0.clive, "Destruction not counted");
+}
+#endif
+
+TEST_SUITE(census_suite)
+{
+	ADD_TEST(counts);
+	ADD_TEST(interfaces);
+	ADD_TEST(threads);
+	ADD_TEST(json);
+#ifdef CCENSUS
+	ADD_TEST(objects);
+#endif
+}
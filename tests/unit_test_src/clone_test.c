@@ -0,0 +1,308 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify cloning. Copyable classes must be
+ * copied with their interfaces, and nothing else, pointing at the copy,
+ * classes which aren't, or have no cclone method, must not be, and classes
+ * which override cclone must copy what they own.
+ */
+
+#include <test_classes/generated_test_classes.h>
+#include <test_classes/interface_test_classes.h>
+#include <unit.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A class owning memory, which it copies when cloned.
+ */
+struct CLBuffer
+{
+    struct cobject_t cobject;
+    int*   data;
+    size_t count;
+};
+
+struct CLBuffer_VTable
+{
+    struct cobject_vtable_t CObject_VTable;
+};
+
+static const struct cclass_info_t CLBuffer_Info =
+	CCLASS_INFO_INIT(struct CLBuffer, "CLBuffer", &cobject_info, COBJECT_INFO_DISPLAY, &CLBuffer_Info);
+
+static void CLBuffer_destructor( void* self_ )
+{
+	struct CLBuffer* self = self_;
+
+	free(self->data);
+	cobject_destructor(self);
+}
+
+static int CLBuffer_clone( void* self_, void* dst_ )
+{
+	struct CLBuffer* self = self_;
+	struct CLBuffer* dst = dst_;
+
+	cobject_copy(self, dst);
+	dst->data = malloc(self->count * sizeof(*self->data));
+	if( dst->data == NULL ) {
+		return 0;
+	}
+	memcpy(dst->data, self->data, self->count * sizeof(*self->data));
+	return 1;
+}
+
+CCLASS_VTABLE(struct CLBuffer_VTable, clBuffer_VTable,
+	{
+		.CObject_VTable = COBJECT_VTABLE_INIT,
+		.CObject_VTable.cinfo = &CLBuffer_Info,
+		.CObject_VTable.cdestructor = CLBuffer_destructor,
+		.CObject_VTable.cclone = CLBuffer_clone
+	});
+
+static int newCLBuffer( struct CLBuffer* self, size_t count )
+{
+	size_t i;
+
+	cobject_init(&self->cobject);
+	cclass_set_cvtable(self, &clBuffer_VTable);
+	self->count = count;
+	self->data = malloc(count * sizeof(*self->data));
+	if( self->data == NULL ) {
+		return 0;
+	}
+	for( i = 0; i < count; ++i ) {
+		self->data[i] = (int) i;
+	}
+	return 1;
+}
+
+/* A class whose vtable is written out by hand, without a cclone method.
+ */
+static const struct cclass_info_t CLBare_Info =
+	CCLASS_INFO_INIT(struct cobject_t, "CLBare", &cobject_info, COBJECT_INFO_DISPLAY, &CLBare_Info);
+static const struct cobject_vtable_t CLBare_VTable = { .cdestructor = cobject_destructor, .cinfo = &CLBare_Info };
+
+static void construct_rect( void* object, size_t index, void* arg )
+{
+	struct GTRect* rect = object;
+
+	(void) index;
+	newGTRect(rect);
+	rect->height = 1;
+	rect->destroyed = arg;
+}
+
+static void construct_self_rect( void* object, size_t index, void* arg )
+{
+	struct GTRect* rect = object;
+
+	(void) index;
+	(void) arg;
+	newGTRect(rect);
+	rect->width = 4;
+	rect->height = 4;
+	rect->destroyed = object;
+}
+
+static void size_rect( void* object, size_t index, void* arg )
+{
+	(void) arg;
+	((struct GTRect*) object)->width = (int) index;
+}
+
+static void construct_interfaces( void* object, size_t index, void* arg )
+{
+	(void) index;
+	++*(int*) arg;
+	newITClassA(object);
+}
+
+TEST_SETUP( )
+{
+}
+TEST_TEARDOWN( )
+{
+}
+
+
+TEST(copyable)
+{
+	struct GTRect* rect;
+	struct GTRect* copy;
+	struct GTSquare square;
+	struct GTSquare square_copy;
+	int destroyed;
+
+	rect = malloc(sizeof(*rect));
+	copy = malloc(sizeof(*copy));
+	if( rect == NULL || copy == NULL ) {
+		ABORT_TEST("Failed to allocate");
+	}
+	destroyed = 0;
+	newGTRect(rect);
+	cmalloc(rect, free);
+	rect->width = 3;
+	rect->height = 4;
+	rect->destroyed = &destroyed;
+	cretain(rect);
+
+	/* Through its compact interface. */
+	ASSERT(cclone(&rect->gtShape, copy) == copy, "Failed to clone");
+	ASSERT(GTRect_perimeter(copy) == 14, "Copy has perimeter %d", GTRect_perimeter(copy));
+	ASSERT(ccast(&copy->gtShape) == copy, "Copy's interface doesn't cast to it");
+	ASSERT(((struct cobject_t*) copy)->cfree == NULL, "Copy has the original's free method");
+	ASSERT(((struct cobject_t*) copy)->crefs == 1, "Copy has %u references", ((struct cobject_t*) copy)->crefs);
+
+	/* Copies are independent. */
+	GTShape_scale(&copy->gtShape, 2);
+	ASSERT(GTShape_area(&copy->gtShape) == 48 && GTShape_area(&rect->gtShape) == 12, "Copy isn't independent");
+	cmalloc(copy, free);
+	cdestroy(copy);
+	crelease(rect);
+	crelease(rect);
+	ASSERT(destroyed == 2, "Destroyed %d objects", destroyed);
+
+	/* Subclasses aren't copyable unless they say so. */
+	newGTSquare(&square);
+	square.gtRect.destroyed = NULL;
+	ASSERT(cclone(&square, &square_copy) == NULL, "Cloned a class which isn't copyable");
+	ASSERT(cclone(&square, NULL) == NULL, "Cloned into NULL");
+	cdestroy(&square);
+}
+
+TEST(fields)
+{
+	struct GTRect rect;
+	struct GTRect copy;
+	struct cobject_t bare;
+	struct cobject_t bare_copy;
+
+	/* Only croots are pointed at the copy, not a field pointing at the
+	 * original. */
+	newGTRect(&rect);
+	rect.width = 4;
+	rect.height = 4;
+	rect.destroyed = (int*) &rect;
+	ASSERT(cclone(&rect, &copy) == &copy, "Failed to clone");
+	ASSERT(copy.destroyed == (int*) &rect, "Field pointing at the original was changed");
+	ASSERT(copy.width == 4 && GTRect_perimeter(&copy) == 16, "Copy has perimeter %d", GTRect_perimeter(&copy));
+	ASSERT(ccast(&copy.gtShape) == &copy, "Copy's interface doesn't cast to it");
+	rect.destroyed = NULL;
+	copy.destroyed = NULL;
+	cdestroy(&copy);
+	cdestroy(&rect);
+
+	/* Vtables without a cclone method can't be cloned. */
+	cobject_init(&bare);
+	bare.cclass.cvtable = &CLBare_VTable;
+	ASSERT(cclone(&bare, &bare_copy) == NULL, "Cloned a class without a cclone method");
+	bare.cclass.cvtable = cobject_vtable( );
+	cdestroy(&bare);
+}
+
+TEST(interfaces)
+{
+	struct ITClassA object;
+	struct ITClassA copy;
+
+	/* Without the flag, cobject_copy( ) still copies. */
+	newITClassA(&object);
+	ASSERT(cclone(&object, &copy) == NULL, "Cloned a class which isn't copyable");
+	cobject_copy(&object, &copy);
+	ASSERT(ccast(&copy.itInterface2) == &copy, "Interface doesn't cast to the copy");
+	ASSERT(ccast(&copy.itInterface1.itInterface0) == &copy, "Nested interface doesn't cast to the copy");
+	ASSERT(ccast(&object.itInterface1.itInterface0) == &object, "Original was changed");
+	ASSERT(ITInterface2_Method0(&copy.itInterface2) == IT_CLASSA_I2_METHOD0, "Failed to run I2 M0");
+	ASSERT(ITInterface0_Method0(&copy.itInterface1.itInterface0) == IT_CLASSA_I0_METHOD0, "Failed to run I0 M0");
+	cdestroy(&copy);
+	cdestroy(&object);
+}
+
+TEST(deep)
+{
+	struct CLBuffer buffer;
+	struct CLBuffer copy;
+	size_t i;
+
+	if( !newCLBuffer(&buffer, 16) ) {
+		ABORT_TEST("Failed to construct");
+	}
+	ASSERT(cclone(&buffer, &copy) == &copy, "Failed to clone");
+	ASSERT(copy.data != buffer.data && copy.count == 16, "Buffer wasn't copied");
+	for( i = 0; i < copy.count; ++i ) {
+		ASSERT(copy.data[i] == (int) i, "Element %zu is %d", i, copy.data[i]);
+	}
+
+	/* Each frees its own. */
+	copy.data[0] = 100;
+	ASSERT(buffer.data[0] == 0, "Copy shares the original's buffer");
+	cdestroy(&copy);
+	cdestroy(&buffer);
+}
+
+TEST(array)
+{
+	struct GTRect rects[20];
+	struct ITClassA objects[3];
+	int destroyed;
+	int constructed;
+	size_t i;
+
+	/* Copyable, copies of the first. */
+	destroyed = 0;
+	cnew_array(construct_rect, rects, 20, size_rect, &destroyed);
+	for( i = 0; i < 20; ++i ) {
+		ASSERT(GTShape_area(&rects[i].gtShape) == (int) i, "Object %zu has area %d", i, GTShape_area(&rects[i].gtShape));
+		ASSERT(ccast(&rects[i].gtShape) == &rects[i], "Object %zu's interface doesn't cast to it", i);
+		ASSERT(((struct cobject_t*) &rects[i])->crefs == 1, "Object %zu has %u references", i, ((struct cobject_t*) &rects[i])->crefs);
+	}
+	for( i = 0; i < 20; ++i ) {
+		cdestroy(&rects[i]);
+	}
+	ASSERT(destroyed == 20, "Destroyed %d objects", destroyed);
+
+	/* Only croots are pointed at each copy, not a field pointing at the
+	 * first. */
+	cnew_array(construct_self_rect, rects, 20, NULL, NULL);
+	for( i = 0; i < 20; ++i ) {
+		ASSERT(rects[i].destroyed == (int*) &rects[0], "Object %zu's field was changed", i);
+		ASSERT(ccast(&rects[i].gtShape) == &rects[i] && GTRect_perimeter(&rects[i]) == 16, "Object %zu wasn't copied", i);
+		rects[i].destroyed = NULL;
+		cdestroy(&rects[i]);
+	}
+
+	/* Not copyable, each is constructed. */
+	constructed = 0;
+	cnew_array(construct_interfaces, objects, 3, NULL, &constructed);
+	ASSERT(constructed == 3, "Constructed %d objects", constructed);
+	for( i = 0; i < 3; ++i ) {
+		ASSERT(ccast(&objects[i].itInterface1.itInterface0) == &objects[i], "Object %zu's interface doesn't cast to it", i);
+		cdestroy(&objects[i]);
+	}
+	cnew_array(construct_interfaces, objects, 0, NULL, &constructed);
+	ASSERT(constructed == 3, "Constructed an empty array");
+}
+
+TEST_SUITE(clone_suite)
+{
+	ADD_TEST(copyable);
+	ADD_TEST(fields);
+	ADD_TEST(interfaces);
+	ADD_TEST(deep);
+	ADD_TEST(array);
+}
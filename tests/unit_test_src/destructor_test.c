@@ -143,6 +143,106 @@ TEST(deep_override)
 	ASSERT(freeUsed == FREE_USED, "Failed to call free( ) hook");
 }
 
+static int freeCount = 0;
+
+static void countingFree( void* self )
+{
+	(void) self;
+	++freeCount;
+}
+
+/* A class whose destructor keeps the object, by not chaining to
+ * cobject_destructor( ), which would call its free method.
+ */
+struct DTKeeper
+{
+	struct cobject_t cobject;
+	int kept;
+};
+
+static const struct cclass_info_t DTKeeper_Info =
+	CCLASS_INFO_INIT(struct DTKeeper, "DTKeeper", &cobject_info, COBJECT_INFO_DISPLAY, &DTKeeper_Info);
+
+static void dtKeeperDestroy( void* self )
+{
+	++((struct DTKeeper*) self)->kept;
+}
+
+static const struct cobject_vtable_t DTKeeper_VTable =
+	{ .cdestructor = dtKeeperDestroy, .cinfo = &DTKeeper_Info };
+
+static void newDTKeeper( struct DTKeeper* self )
+{
+	cobject_init(&self->cobject);
+	cclass_set_cvtable(self, &DTKeeper_VTable);
+	self->kept = 0;
+}
+
+TEST(batch)
+{
+	struct DTClassE e[3];
+	struct DTClassC c[3];
+	struct DTClassB b[3];
+	int tempE[3], tempC[3], tempB[3];
+	void* objects[9];
+	size_t i;
+
+	/* Interleave classes and free hooks. */
+	for( i = 0; i < 3; ++i ) {
+		newDTClassE(&e[i], &tempE[i]);
+		newDTClassC(&c[i], &tempC[i]);
+		newDTClassB(&b[i], &tempB[i]);
+		cmalloc(&e[i], countingFree);
+		cmalloc(&c[i], (i % 2) ? testFree : countingFree);
+		objects[3*i + 0] = &e[i];
+		objects[3*i + 1] = &c[i];
+		objects[3*i + 2] = &b[i];
+	}
+	cmalloc(&b[1], countingFree);
+
+	freeUsed = FREE_UNUSED;
+	freeCount = 0;
+	cdestroy_batch(objects, 9);
+
+	for( i = 0; i < 3; ++i ) {
+		ASSERT(tempE[i] == DT_CLASS_E_VAL+1, "Failed to cascade E destructor %zu - %d", i, tempE[i]);
+		ASSERT(tempC[i] == DT_CLASS_A_VAL+1, "Failed to cascade C destructor %zu - %d", i, tempC[i]);
+		ASSERT(tempB[i] == DT_CLASS_A_VAL, "B destructor changed test var %zu - %d", i, tempB[i]);
+	}
+	ASSERT(freeCount == 6, "Wrong number of free( ) hook calls - %d", freeCount);
+	ASSERT(freeUsed == FREE_USED, "Failed to call free( ) hook");
+}
+
+TEST(batch_keep)
+{
+	struct DTKeeper keepers[3];
+	struct DTClassB b;
+	int tempB;
+	void* objects[3];
+
+	/* A destructor which doesn't chain keeps its object in a batch, like
+	 * with cdestroy( ), and the others are still freed. */
+	newDTKeeper(&keepers[0]);
+	newDTKeeper(&keepers[1]);
+	newDTKeeper(&keepers[2]);
+	newDTClassB(&b, &tempB);
+	cmalloc(&keepers[0], countingFree);
+	cmalloc(&keepers[1], countingFree);
+	cmalloc(&keepers[2], countingFree);
+	cmalloc(&b, countingFree);
+
+	freeCount = 0;
+	cdestroy(&keepers[2]);
+	ASSERT(keepers[2].kept == 1 && freeCount == 0, "cdestroy( ) freed a kept object");
+
+	objects[0] = &keepers[0];
+	objects[1] = &b;
+	objects[2] = &keepers[1];
+	cdestroy_batch(objects, 3);
+	ASSERT(keepers[0].kept == 1 && keepers[1].kept == 1, "Keeper destructors weren't called");
+	ASSERT(freeCount == 1, "Wrong number of free( ) hook calls - %d", freeCount);
+}
+
 TEST_SUITE(destructor_suite)
 {
 	ADD_TEST(free_hook);
@@ -150,4 +250,6 @@ TEST_SUITE(destructor_suite)
 	ADD_TEST(override_destructor);
 	ADD_TEST(gap_override);
 	ADD_TEST(deep_override);
+	ADD_TEST(batch);
+	ADD_TEST(batch_keep);
 }
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This bench suite times the operations every class relies on: virtual and
+ * interface calls, casts from an interface, type checks, and constructing and
+ * destroying an object. Run with UNIT_BENCH_BASELINE set to catch regressions.
+ */
+
+#include <test_classes/virtual_test_classes.h>
+#include <test_classes/interface_test_classes.h>
+#include <test_classes/destructor_test_classes.h>
+#include <unit.h>
+
+TEST_SETUP( ) { }
+TEST_TEARDOWN( ) { }
+
+static volatile int sink;
+
+
+BENCH(virtual_call)
+{
+	struct VTClassC object;
+	int sum = 0;
+
+	newVTClassC(&object);
+	BENCH_LOOP {
+		sum += VTClassA_Method4((struct VTClassA*) &object);
+	}
+	sink = sum;
+}
+
+BENCH(interface_call)
+{
+	struct ITClassC object;
+	int sum = 0;
+
+	newITClassC(&object);
+	BENCH_LOOP {
+		sum += ITInterface0_Method0(&object.classB.classA.itInterface1.itInterface0);
+	}
+	sink = sum;
+}
+
+BENCH(interface_cast)
+{
+	struct ITClassC object;
+	struct ITInterface0* ref;
+	int sum = 0;
+
+	newITClassC(&object);
+	ref = &object.classB.classA.itInterface1.itInterface0;
+	BENCH_LOOP {
+		sum += ccast(ref) == (void*) &object;
+	}
+	sink = sum;
+}
+
+BENCH(instanceof)
+{
+	struct ITClassC object;
+	int sum = 0;
+
+	newITClassC(&object);
+	BENCH_LOOP {
+		sum += cinstanceof(&object.classB.classA.itInterface2, &ITClassB_Info);
+	}
+	sink = sum;
+}
+
+BENCH(construct_destroy)
+{
+	struct DTClassE object;
+	int temp;
+
+	BENCH_LOOP {
+		newDTClassE(&object, &temp);
+		cdestroy(&object);
+	}
+	sink = temp;
+}
+
+BENCH_SUITE(dispatch_bench)
+{
+	ADD_BENCH(virtual_call);
+	ADD_BENCH(interface_call);
+	ADD_BENCH(interface_cast);
+	ADD_BENCH(instanceof);
+	ADD_BENCH(construct_destroy);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify deferred destruction. An object retired
+ * with cdestroy_deferred( ) must not be destroyed while any thread is in a
+ * critical section it entered before the object was retired, and must be
+ * destroyed once they all leave.
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <cepoch.h>
+#include <unit.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct cepoch_t domain;
+static struct cepoch_thread_t writer;
+static struct cepoch_thread_t reader;
+
+TEST_SETUP( )
+{
+	cepoch_init(&domain);
+	cepoch_register(&domain, &writer);
+	cepoch_register(&domain, &reader);
+}
+TEST_TEARDOWN( )
+{
+	cepoch_unregister(&reader);
+	cepoch_unregister(&writer);
+	cepoch_destroy(&domain);
+}
+
+
+TEST(deferred)
+{
+	struct DTClassE e;
+	int temp, i;
+
+	newDTClassE(&e, &temp);
+
+	/* The reader may have read e before it's retired. */
+	cepoch_enter(&reader);
+	ASSERT(cdestroy_deferred(&writer, &e), "Failed to retire object");
+	for( i = 0; i < 10; ++i ) {
+		cepoch_collect(&writer);
+	}
+	ASSERT(temp == DT_CLASS_A_VAL, "Destroyed inside reader's critical section - %d", temp);
+
+	cepoch_exit(&reader);
+	cepoch_collect(&writer);
+	cepoch_collect(&writer);
+	ASSERT(temp == DT_CLASS_E_VAL + 1, "Not destroyed after reader exited - %d", temp);
+}
+
+TEST(nested)
+{
+	struct DTClassE e;
+	int temp, i;
+
+	newDTClassE(&e, &temp);
+
+	cepoch_enter(&reader);
+	cepoch_enter(&reader);
+	cdestroy_deferred(&writer, &e);
+
+	/* Still inside the outer critical section. */
+	cepoch_exit(&reader);
+	for( i = 0; i < 10; ++i ) {
+		cepoch_collect(&writer);
+	}
+	ASSERT(temp == DT_CLASS_A_VAL, "Destroyed inside outer critical section - %d", temp);
+
+	cepoch_exit(&reader);
+	cepoch_synchronize(&writer);
+	ASSERT(temp == DT_CLASS_E_VAL + 1, "Not destroyed after reader exited - %d", temp);
+}
+
+#define EPOCH_OBJECTS (CEPOCH_COLLECT_THRESHOLD * 3)
+
+TEST(batches)
+{
+	static struct DTClassC objects[EPOCH_OBJECTS];
+	static int temps[EPOCH_OBJECTS];
+	int i, destroyed;
+
+	/* Readers coming and going let objects be destroyed in batches as
+	 * they're retired.
+	 */
+	for( i = 0; i < EPOCH_OBJECTS; ++i ) {
+		newDTClassC(&objects[i], &temps[i]);
+		cepoch_enter(&reader);
+		cdestroy_deferred(&writer, &objects[i]);
+		cepoch_exit(&reader);
+	}
+	ASSERT(writer.cretired < EPOCH_OBJECTS, "Nothing destroyed while retiring");
+
+	cepoch_synchronize(&writer);
+	ASSERT(writer.cretired == 0, "Objects left after synchronize: %zu", writer.cretired);
+	for( destroyed = 0, i = 0; i < EPOCH_OBJECTS; ++i ) {
+		destroyed += temps[i] == DT_CLASS_A_VAL + 1;
+	}
+	ASSERT(destroyed == EPOCH_OBJECTS, "Destroyed %d of %d objects", destroyed, EPOCH_OBJECTS);
+}
+
+/* Readers check objects they load through a shared pointer while a writer
+ * replaces and retires them. Freed objects are poisoned.
+ */
+#define EPOCH_READERS 2
+#define EPOCH_SWAPS 20000
+
+static struct DTClassC* volatile shared;
+static int sentinel;
+static int writer_done;
+static int read_failures;
+static int freed;
+
+static void poison_free( void* object )
+{
+	memset(object, 0, sizeof(struct DTClassC));
+	free(object);
+	++freed;
+}
+
+static struct DTClassC* new_shared( void )
+{
+	struct DTClassC* object = malloc(sizeof(*object));
+
+	if( object != NULL ) {
+		newDTClassC(object, &sentinel);
+		cmalloc(object, poison_free);
+	}
+	return object;
+}
+
+static void* reader_thread( void* arg )
+{
+	struct cepoch_thread_t thread;
+	struct DTClassC* object;
+
+	(void) arg;
+	cepoch_register(&domain, &thread);
+	while( !__atomic_load_n(&writer_done, __ATOMIC_ACQUIRE) ) {
+		cepoch_enter(&thread);
+		object = __atomic_load_n(&shared, __ATOMIC_ACQUIRE);
+		if( object->dtClassA.destructorTestVar != &sentinel || !cinstanceof(object, &DTClassC_Info) ) {
+			__atomic_add_fetch(&read_failures, 1, __ATOMIC_RELAXED);
+		}
+		cepoch_exit(&thread);
+	}
+	cepoch_unregister(&thread);
+	return NULL;
+}
+
+TEST(threads)
+{
+	pthread_t threads[EPOCH_READERS];
+	struct DTClassC* object;
+	int i, created;
+
+	writer_done = 0;
+	read_failures = 0;
+	freed = 0;
+	shared = new_shared( );
+	if( shared == NULL ) {
+		ABORT_TEST("Out of memory");
+	}
+
+	for( created = 0; created < EPOCH_READERS; ++created ) {
+		if( pthread_create(&threads[created], NULL, reader_thread, NULL) != 0 ) {
+			break;
+		}
+	}
+
+	for( i = 0; i < EPOCH_SWAPS; ++i ) {
+		object = new_shared( );
+		if( object == NULL ) {
+			break;
+		}
+		object = __atomic_exchange_n(&shared, object, __ATOMIC_ACQ_REL);
+		cdestroy_deferred(&writer, object);
+	}
+	__atomic_store_n(&writer_done, 1, __ATOMIC_RELEASE);
+	for( --created; created >= 0; --created ) {
+		pthread_join(threads[created], NULL);
+	}
+
+	cdestroy_deferred(&writer, shared);
+	cepoch_synchronize(&writer);
+	ASSERT(read_failures == 0, "Readers saw %d destroyed objects", read_failures);
+	ASSERT(freed == i + 1, "Freed %d of %d objects", freed, i + 1);
+}
+
+TEST_SUITE(epoch_suite)
+{
+	ADD_TEST(deferred);
+	ADD_TEST(nested);
+	ADD_TEST(batches);
+	ADD_TEST(threads);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify classes made by the class generator,
+ * cgen, from test_classes/generated_test_classes.cdef. Virtual methods,
+ * interface methods, super calls, and destructors must dispatch to the
+ * implementations the description gives, and the generated descriptors
+ * must work with RTTI.
+ */
+
+#include <test_classes/generated_test_classes.h>
+#include <unit.h>
+
+static struct GTRect rect;
+static struct GTSquare square;
+static int destroyed;
+
+TEST_SETUP( )
+{
+	destroyed = 0;
+	newGTRect(&rect);
+	rect.width = 2;
+	rect.height = 3;
+	rect.destroyed = &destroyed;
+
+	newGTSquare(&square);
+	square.gtRect.width = 4;
+	square.gtRect.height = 4;
+	square.gtRect.destroyed = &destroyed;
+}
+TEST_TEARDOWN( )
+{
+	cdestroy(&rect);
+	cdestroy(&square);
+}
+
+
+TEST(virtual_methods)
+{
+	ASSERT(GTRect_perimeter(&rect) == 10, "Rect's perimeter is %d", GTRect_perimeter(&rect));
+	ASSERT(GTSquare_side(&square) == 4, "Square's side is %d", GTSquare_side(&square));
+
+	/* Square's override, called through Rect's wrapper. */
+	ASSERT(GTRect_perimeter(&square.gtRect) == 1016, "Square's perimeter is %d", GTRect_perimeter(&square.gtRect));
+}
+
+TEST(interface_methods)
+{
+	ASSERT(GTShape_area(&rect.gtShape) == 6, "Rect's area is %d", GTShape_area(&rect.gtShape));
+	ASSERT(GTShape_area(&square.gtRect.gtShape) == 1016, "Square's area is %d", GTShape_area(&square.gtRect.gtShape));
+
+	/* Inherited from Rect. */
+	GTShape_scale(&square.gtRect.gtShape, 2);
+	ASSERT(GTSquare_side(&square) == 8, "Square's side is %d after scaling", GTSquare_side(&square));
+	ASSERT(GTShape_area(&square.gtRect.gtShape) == 1064, "Square's area is %d after scaling", GTShape_area(&square.gtRect.gtShape));
+}
+
+TEST(super_calls)
+{
+	ASSERT(GTSquare_super_area(&square) == 16, "Rect's area of square is %d", GTSquare_super_area(&square));
+	ASSERT(GTSquare_super_perimeter(&square) == 16, "Rect's perimeter of square is %d", GTSquare_super_perimeter(&square));
+}
+
+TEST(descriptors)
+{
+	ASSERT(ccast(&square.gtRect.gtShape) == (void*) &square, "Interface doesn't cast to its object");
+	ASSERT(cinstanceof(&square, &GTRect_Info), "Square isn't a GTRect");
+	ASSERT(cinstanceof(&square, &GTSquare_Info), "Square isn't a GTSquare");
+	ASSERT(!cinstanceof(&rect, &GTSquare_Info), "Rect is a GTSquare");
+	ASSERT(cobject_get_info(&square.gtRect.gtShape) == &GTSquare_Info, "Wrong descriptor through the interface");
+}
+
+TEST(destructors)
+{
+	struct GTSquare other;
+
+	/* Square's destructor, then Rect's. */
+	newGTSquare(&other);
+	other.gtRect.destroyed = &destroyed;
+	cdestroy(&other.gtRect.gtShape);
+	ASSERT(destroyed == 11, "Destructors added %d", destroyed);
+}
+
+TEST_SUITE(generated_suite)
+{
+	ADD_TEST(virtual_methods);
+	ADD_TEST(interface_methods);
+	ADD_TEST(super_calls);
+	ADD_TEST(descriptors);
+	ADD_TEST(destructors);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify handle tables. Handles must resolve to
+ * their object until it's removed, and never after, even once its slot is
+ * reused. Live objects must stay packed.
+ */
+
+#include <test_classes/generated_test_classes.h>
+#include <chandle.h>
+#include <unit.h>
+
+#define HANDLE_OBJECTS 64
+
+static struct chandle_table_t table;
+static struct GTRect rects[HANDLE_OBJECTS];
+static chandle_t handles[HANDLE_OBJECTS];
+
+TEST_SETUP( )
+{
+	int i;
+
+	chandle_init(&table);
+	for( i = 0; i < HANDLE_OBJECTS; ++i ) {
+		newGTRect(&rects[i]);
+		rects[i].width = i;
+		rects[i].height = 1;
+		rects[i].destroyed = NULL;
+		handles[i] = chandle_insert(&table, &rects[i].gtShape);
+	}
+}
+TEST_TEARDOWN( )
+{
+	int i;
+
+	chandle_destroy(&table);
+	for( i = 0; i < HANDLE_OBJECTS; ++i ) {
+		cdestroy(&rects[i]);
+	}
+}
+
+
+TEST(resolve)
+{
+	int i;
+
+	ASSERT(chandle_count(&table) == HANDLE_OBJECTS, "Table has %zu objects", chandle_count(&table));
+	for( i = 0; i < HANDLE_OBJECTS; ++i ) {
+		ASSERT(handles[i] != CHANDLE_NULL, "Failed to insert %d", i);
+		ASSERT(chandle_get(&table, handles[i]) == &rects[i], "Handle %d doesn't resolve to its object", i);
+	}
+	ASSERT(chandle_get(&table, CHANDLE_NULL) == NULL, "CHANDLE_NULL resolved");
+	ASSERT(chandle_get(&table, (chandle_t) 1 << 32 | 100000) == NULL, "Handle out of range resolved");
+	ASSERT(chandle_get(&table, handles[3] + ((chandle_t) 1 << 32)) == NULL, "Handle of a later generation resolved");
+}
+
+TEST(stale)
+{
+	chandle_t handle;
+
+	ASSERT(chandle_remove(&table, handles[5]) == &rects[5], "Removed the wrong object");
+	ASSERT(chandle_get(&table, handles[5]) == NULL, "Removed handle resolved");
+	ASSERT(chandle_remove(&table, handles[5]) == NULL, "Removed an object twice");
+
+	/* Its slot is reused, old handles still don't resolve. */
+	handle = chandle_insert(&table, &rects[5]);
+	ASSERT((uint32_t) handle == (uint32_t) handles[5], "Slot wasn't reused");
+	ASSERT(handle != handles[5], "Reused slot has the same handle");
+	ASSERT(chandle_get(&table, handles[5]) == NULL, "Stale handle resolved to the new object");
+	ASSERT(chandle_get(&table, handle) == &rects[5], "New handle doesn't resolve");
+
+	/* A slot whose generation would wrap is retired. */
+	table.cslots[(uint32_t) handle].cgeneration = UINT32_MAX;
+	handle = (chandle_t) UINT32_MAX << 32 | (uint32_t) handle;
+	ASSERT(chandle_remove(&table, handle) == &rects[5], "Failed to remove");
+	handle = chandle_insert(&table, &rects[5]);
+	ASSERT((uint32_t) handle != (uint32_t) handles[5], "Retired slot was reused");
+	ASSERT(chandle_get(&table, handle) == &rects[5], "New handle doesn't resolve");
+}
+
+TEST(packed)
+{
+	int seen[HANDLE_OBJECTS] = { 0 };
+	struct GTRect* rect;
+	size_t i;
+	int j;
+
+	/* Every other object, then the last. */
+	for( j = 0; j < HANDLE_OBJECTS; j += 2 ) {
+		chandle_remove(&table, handles[j]);
+	}
+	chandle_remove(&table, handles[HANDLE_OBJECTS - 1]);
+	ASSERT(chandle_count(&table) == HANDLE_OBJECTS / 2 - 1, "Table has %zu objects", chandle_count(&table));
+	for( i = 0; i < chandle_count(&table); ++i ) {
+		rect = chandle_object_at(&table, i);
+		ASSERT(chandle_get(&table, chandle_handle_at(&table, i)) == rect, "Object %zu's handle doesn't resolve to it", i);
+		ASSERT(++seen[rect->width] == 1, "Object %d is in the table twice", rect->width);
+		ASSERT(rect->width % 2 == 1 && rect->width != HANDLE_OBJECTS - 1, "Removed object %d is in the table", rect->width);
+	}
+	for( j = 1; j < HANDLE_OBJECTS - 1; j += 2 ) {
+		ASSERT(chandle_get(&table, handles[j]) == &rects[j], "Handle %d doesn't resolve after removals", j);
+	}
+}
+
+TEST_SUITE(handle_suite)
+{
+	ADD_TEST(resolve);
+	ADD_TEST(stale);
+	ADD_TEST(packed);
+}
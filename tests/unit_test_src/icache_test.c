@@ -0,0 +1,222 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify inline caches. A call through a site
+ * must always resolve the method the vtable holds, the site must remember
+ * its first CICACHE_WAYS vtables and become megamorphic after, and count
+ * one miss for each vtable it remembers. Most tests use vtables private to
+ * this file, so there can be as many as needed.
+ */
+
+#include <test_classes/interface_test_classes.h>
+#include <cicache.h>
+#include <unit.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A one method interface, with an implementation for each of its vtables. */
+struct ICVTable
+{
+	int (*get)( struct cclass_t* self, int arg );
+};
+
+static int ic_get0( struct cclass_t* self, int arg ) { (void) self; return arg; }
+static int ic_get1( struct cclass_t* self, int arg ) { (void) self; return arg + 1; }
+static int ic_get2( struct cclass_t* self, int arg ) { (void) self; return arg + 2; }
+static int ic_get3( struct cclass_t* self, int arg ) { (void) self; return arg + 3; }
+static int ic_get4( struct cclass_t* self, int arg ) { (void) self; return arg + 4; }
+static int ic_get5( struct cclass_t* self, int arg ) { (void) self; return arg + 5; }
+
+#define IC_VTABLES 6
+static const struct ICVTable ic_vtables[IC_VTABLES] = {
+	{ ic_get0 }, { ic_get1 }, { ic_get2 }, { ic_get3 }, { ic_get4 }, { ic_get5 }
+};
+static struct cclass_t ic_objects[IC_VTABLES];
+
+static int ic_call( struct cicache_t* site, struct cclass_t* object, int arg )
+{
+	return CICACHE_CALL(site, struct ICVTable, get, object, (object, arg));
+}
+
+TEST_SETUP( )
+{
+	int i;
+
+	for( i = 0; i < IC_VTABLES; ++i ) {
+		ic_objects[i].croot = &ic_objects[i];
+		ic_objects[i].cvtable = &ic_vtables[i];
+	}
+}
+TEST_TEARDOWN( )
+{
+}
+
+
+TEST(monomorphic)
+{
+	static struct cicache_t site = CICACHE_INIT("monomorphic");
+	int i;
+
+	for( i = 0; i < 100; ++i ) {
+		ASSERT(ic_call(&site, &ic_objects[1], i) == i + 1, "Call %d resolved the wrong method", i);
+	}
+	ASSERT(cicache_ways(&site) == 1, "%u ways", cicache_ways(&site));
+	ASSERT(site.cmisses == 1, "%zu misses", site.cmisses);
+	ASSERT(!site.cmegamorphic, "Megamorphic");
+#ifdef CICACHE_STATS
+	ASSERT(site.chits == 99, "%zu hits", site.chits);
+#endif
+}
+
+TEST(polymorphic)
+{
+	static struct cicache_t site = CICACHE_INIT("polymorphic");
+	int i;
+
+	for( i = 0; i < 100; ++i ) {
+		ASSERT(ic_call(&site, &ic_objects[i % CICACHE_WAYS], i) == i + i % CICACHE_WAYS, "Call %d resolved the wrong method", i);
+	}
+	ASSERT(cicache_ways(&site) == CICACHE_WAYS, "%u ways", cicache_ways(&site));
+	ASSERT(site.cmisses == CICACHE_WAYS, "%zu misses", site.cmisses);
+	ASSERT(!site.cmegamorphic, "Megamorphic");
+}
+
+TEST(megamorphic)
+{
+	static struct cicache_t site = CICACHE_INIT("megamorphic");
+	int i;
+
+	/* Vtables past the ways are resolved, but never remembered. */
+	for( i = 0; i < 100; ++i ) {
+		ASSERT(ic_call(&site, &ic_objects[i % IC_VTABLES], i) == i + i % IC_VTABLES, "Call %d resolved the wrong method", i);
+	}
+	ASSERT(cicache_ways(&site) == CICACHE_WAYS, "%u ways", cicache_ways(&site));
+	ASSERT(site.cmegamorphic, "Not megamorphic");
+	ASSERT(site.cmisses > IC_VTABLES, "%zu misses", site.cmisses);
+}
+
+TEST(direct)
+{
+	static struct cicache_t site = CICACHE_INIT("direct");
+	struct cclass_t* object;
+	int i, sum;
+
+	/* Expected or not, the right method runs. */
+	sum = 0;
+	for( i = 0; i < 10; ++i ) {
+		object = &ic_objects[i % 2 + 2];
+		sum += CICACHE_CALL_DIRECT(&site, struct ICVTable, get, object, ic_get2, (object, 0));
+	}
+	ASSERT(sum == 5 * 2 + 5 * 3, "Sum of %d", sum);
+	ASSERT(cicache_ways(&site) == 2, "%u ways", cicache_ways(&site));
+}
+
+TEST(interfaces)
+{
+	static struct cicache_t site = CICACHE_INIT("interfaces");
+	static struct cicache_t compact_site = CICACHE_INIT("compact interfaces");
+	struct ITClassC object;
+	struct ITCompactClassB compact;
+	struct ITInterface0* ref;
+	struct ITCompactInterface0* compact_ref;
+	int i;
+
+	/* Real interfaces, and compact ones whose cvtable is tagged. */
+	newITClassC(&object);
+	newITCompactClassB(&compact);
+	ref = &object.classB.classA.itInterface1.itInterface0;
+	compact_ref = &compact.classA.itCompactInterface1.itCompactInterface0;
+	for( i = 0; i < 3; ++i ) {
+		ASSERT(CICACHE_CALL(&site, struct ITInterface0_VTable, i0method0, ref, (ref)) == ITInterface0_Method0(ref),
+		       "Interface call resolved the wrong method");
+		ASSERT(CICACHE_CALL(&compact_site, struct ITCompactInterface0_VTable, ci0method0, compact_ref, (compact_ref)) ==
+		       ITCompactInterface0_Method0(compact_ref), "Compact interface call resolved the wrong method");
+	}
+	ASSERT(site.cmisses == 1 && compact_site.cmisses == 1, "%zu and %zu misses", site.cmisses, compact_site.cmisses);
+	cdestroy(&object);
+	cdestroy(&compact);
+}
+
+TEST(dump)
+{
+	static struct cicache_t site = CICACHE_INIT("icache_test dump site");
+	char* text;
+	size_t size;
+	FILE* out;
+
+	ic_call(&site, &ic_objects[0], 0);
+	out = open_memstream(&text, &size);
+	if( out == NULL ) {
+		ABORT_TEST("Failed to open stream");
+	}
+	cicache_dump(out);
+	fclose(out);
+	ASSERT(strstr(text, "icache_test dump site: monomorphic, 1 ways, 1 misses") != NULL, "Site missing from %s", text);
+	free(text);
+}
+
+#define IC_THREADS 4
+#define IC_PER_THREAD 10000
+
+static struct cicache_t ic_shared_site = CICACHE_INIT("icache_test shared site");
+
+static void* ic_thread( void* arg )
+{
+	long wrong;
+	int i, which;
+
+	wrong = 0;
+	for( i = 0; i < IC_PER_THREAD; ++i ) {
+		which = (i + (int) (long) arg) % 2;
+		wrong += ic_call(&ic_shared_site, &ic_objects[which], i) != i + which;
+	}
+	return (void*) wrong;
+}
+
+TEST(threads)
+{
+	pthread_t threads[IC_THREADS];
+	void* wrong;
+	int created, i;
+	long total;
+
+	for( created = 0; created < IC_THREADS; ++created ) {
+		if( pthread_create(&threads[created], NULL, ic_thread, (void*) (long) created) != 0 ) {
+			break;
+		}
+	}
+	total = 0;
+	for( i = 0; i < created; ++i ) {
+		pthread_join(threads[i], &wrong);
+		total += (long) wrong;
+	}
+	ASSERT(total == 0, "%ld calls resolved the wrong method", total);
+	ASSERT(cicache_ways(&ic_shared_site) >= 2, "%u ways", cicache_ways(&ic_shared_site));
+}
+
+TEST_SUITE(icache_suite)
+{
+	ADD_TEST(monomorphic);
+	ADD_TEST(polymorphic);
+	ADD_TEST(megamorphic);
+	ADD_TEST(direct);
+	ADD_TEST(interfaces);
+	ADD_TEST(dump);
+	ADD_TEST(threads);
+}
@@ -82,10 +82,63 @@ TEST(deep_override)
 	cdestroy(&class);
 }
 
+static int compactFreed = 0;
+
+static void compactFree( void* self )
+{
+	(void) self;
+	++compactFreed;
+}
+
+TEST(compact_layout)
+{
+	/* A compact interface is only a vtable pointer. */
+	ASSERT(sizeof(struct ITCompactInterface0) == sizeof(void*), "Compact interface 0 is %zu bytes", sizeof(struct ITCompactInterface0));
+	ASSERT(sizeof(struct ITCompactInterface1) == 2*sizeof(void*), "Compact interface 1 is %zu bytes", sizeof(struct ITCompactInterface1));
+	ASSERT(sizeof(struct ITInterface1) == 2*sizeof(struct ITCompactInterface1), "Regular interface 1 is %zu bytes", sizeof(struct ITInterface1));
+}
+
+TEST(compact_implementing)
+{
+	struct ITCompactClassA class;
+
+	newITCompactClassA(&class);
+
+	ASSERT(ITCompactInterface1_Method0(&class.itCompactInterface1) == IT_COMPACTA_CI1_METHOD0, "Failed to run CI1 M0");
+	ASSERT(ITCompactInterface0_Method0(&class.itCompactInterface1.itCompactInterface0) == IT_COMPACTA_CI0_METHOD0, "Failed to run CI0 M0");
+
+	/* Casting back from either interface finds the object. */
+	ASSERT(ccast(&class.itCompactInterface1) == &class, "Failed to cast from CI1");
+	ASSERT(ccast(&class.itCompactInterface1.itCompactInterface0) == &class, "Failed to cast from CI0");
+	ASSERT(ccast(&class) == &class, "Failed to cast from object");
+
+	cdestroy(&class);
+}
+
+TEST(compact_override)
+{
+	struct ITCompactClassB class;
+
+	newITCompactClassB(&class);
+
+	ASSERT(ITCompactInterface1_Method0(&class.classA.itCompactInterface1) == IT_COMPACTA_CI1_METHOD0 + IT_COMPACTB_CI1_METHOD0, "Failed to override CI1 M0");
+	ASSERT(ITCompactInterface0_Method0(&class.classA.itCompactInterface1.itCompactInterface0) == IT_COMPACTA_CI0_METHOD0 + IT_COMPACTB_CI0_METHOD0, "Failed to override CI0 M0");
+	ASSERT(ccast(&class.classA.itCompactInterface1.itCompactInterface0) == &class, "Failed to cast from CI0");
+
+	/* Destroying through a compact interface destroys the whole object. */
+	compactFreed = 0;
+	cmalloc(&class.classA.itCompactInterface1, compactFree);
+	cdestroy(&class.classA.itCompactInterface1.itCompactInterface0);
+	ASSERT(compactFreed == 1, "Failed to destroy through compact interface");
+}
+
 TEST_SUITE(interface_suite)
 {
 	ADD_TEST(implementing);
 	ADD_TEST(interface_inheritance);
 	ADD_TEST(override);
 	ADD_TEST(deep_override);
+	ADD_TEST(compact_layout);
+	ADD_TEST(compact_implementing);
+	ADD_TEST(compact_override);
 }
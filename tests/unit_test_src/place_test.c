@@ -0,0 +1,118 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify object placement. Sizes and alignments
+ * must come from the class' descriptor, objects must only be constructed
+ * in memory aligned for their class, and memory allocated for a class must
+ * be zeroed, aligned, and padded as asked.
+ */
+
+#include <test_classes/virtual_test_classes.h>
+#include <test_classes/destructor_test_classes.h>
+#include <cplace.h>
+#include <unit.h>
+#include <stdlib.h>
+
+/* A class which is always written concurrently. Only its descriptor is
+ * needed.
+ */
+struct PLCounter
+{
+    struct cobject_t cobject;
+    long count;
+} CCACHE_ALIGNED;
+
+static const struct cclass_info_t PLCounter_Info =
+	CCLASS_INFO_INIT(struct PLCounter, "PLCounter", &cobject_info, COBJECT_INFO_DISPLAY, &PLCounter_Info);
+
+TEST_SETUP( )
+{
+}
+TEST_TEARDOWN( )
+{
+}
+
+
+TEST(sizes)
+{
+	size_t size;
+
+	/* The class' own alignment, or a stricter one, padded to it. */
+	size = cplace_size(&VTClassA_Info, 0);
+	ASSERT(size == sizeof(struct VTClassA), "Natural size is %zu", size);
+	ASSERT(cplace_align(&VTClassA_Info, 0) == CCLASS_ALIGNOF(struct VTClassA), "Natural alignment is wrong");
+	ASSERT(cplace_align(&VTClassA_Info, CCACHE_LINE) == CCACHE_LINE, "Cache line alignment is wrong");
+	size = cplace_size(&VTClassA_Info, CCACHE_LINE);
+	ASSERT(size == CCACHE_LINE, "Padded size is %zu", size);
+
+	/* A cache aligned class is always aligned and padded. */
+	ASSERT(cplace_align(&PLCounter_Info, 0) == CCACHE_LINE, "Aligned class has alignment %zu", cplace_align(&PLCounter_Info, 0));
+	ASSERT(cplace_size(&PLCounter_Info, 0) % CCACHE_LINE == 0, "Aligned class has size %zu", cplace_size(&PLCounter_Info, 0));
+}
+
+TEST(allocate)
+{
+	unsigned char* memory;
+	struct VTClassA* object;
+	size_t i;
+
+	memory = calloc_object(&VTClassA_Info, CCACHE_LINE);
+	if( memory == NULL ) {
+		ABORT_TEST("Failed to allocate object");
+	}
+	ASSERT(((uintptr_t) memory % CCACHE_LINE) == 0, "Memory isn't cache line aligned");
+	for( i = 0; i < cplace_size(&VTClassA_Info, CCACHE_LINE); ++i ) {
+		ASSERT(memory[i] == 0, "Byte %zu isn't zeroed", i);
+	}
+
+	/* Constructed and destroyed like any other object. */
+	object = cnew_in(memory, VTClassA);
+	ASSERT(object == (struct VTClassA*) memory, "Object wasn't constructed in the memory");
+	ASSERT(VTClassA_Method0(object) == VT_CLASSA_METHOD0, "Method 0 returned %d", VTClassA_Method0(object));
+	cmalloc(object, free);
+	cdestroy(object);
+
+	/* Bad alignments. */
+	ASSERT(calloc_object(&VTClassA_Info, CCACHE_LINE + 1) == NULL, "Allocated with an alignment not a power of two");
+}
+
+TEST(place)
+{
+	static struct DTClassA objects[2];
+	int test_var;
+	struct DTClassA* object;
+	void* misaligned;
+
+	/* Constructor arguments are passed along. */
+	test_var = 1;
+	object = cnew_in(&objects[1], DTClassA, &test_var);
+	ASSERT(object == &objects[1], "Object wasn't constructed in the memory");
+	ASSERT(test_var == 0, "Constructor argument wasn't passed");
+	cdestroy(object);
+
+	/* Nothing is constructed in memory which isn't aligned for the class. */
+	misaligned = (char*) &objects[0] + 1;
+	ASSERT(cnew_in(misaligned, DTClassA, &test_var) == NULL, "Constructed in misaligned memory");
+	ASSERT(cnew_in(NULL, DTClassA, &test_var) == NULL, "Constructed in NULL");
+}
+
+TEST_SUITE(place_suite)
+{
+	ADD_TEST(sizes);
+	ADD_TEST(allocate);
+	ADD_TEST(place);
+}
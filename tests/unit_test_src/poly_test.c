@@ -0,0 +1,146 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify polymorphic collections. Objects must
+ * be bucketed by class, found through any of their interfaces, and called
+ * with their own class' methods. Removal must keep every other object in
+ * the collection reachable.
+ */
+
+#include <test_classes/generated_test_classes.h>
+#include <cpoly.h>
+#include <unit.h>
+
+#define POLY_OBJECTS 64
+
+static struct cpoly_vector_t poly;
+static struct GTRect rects[POLY_OBJECTS];
+static struct GTSquare squares[POLY_OBJECTS];
+static int destroyed;
+
+TEST_SETUP( )
+{
+	int i;
+
+	destroyed = 0;
+	cpoly_init(&poly);
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		newGTRect(&rects[i]);
+		rects[i].width = i;
+		rects[i].height = 1;
+		rects[i].destroyed = &destroyed;
+		newGTSquare(&squares[i]);
+		squares[i].gtRect.width = i;
+		squares[i].gtRect.height = i;
+		squares[i].gtRect.destroyed = &destroyed;
+	}
+}
+TEST_TEARDOWN( )
+{
+	int i;
+
+	cpoly_destroy(&poly);
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		cdestroy(&rects[i]);
+		cdestroy(&squares[i]);
+	}
+}
+
+
+TEST(buckets)
+{
+	int i;
+
+	/* Interleaved, but bucketed by class. */
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		ASSERT(cpoly_insert(&poly, &rects[i]), "Failed to insert rect %d", i);
+		ASSERT(cpoly_insert(&poly, &squares[i].gtRect.gtShape), "Failed to insert square %d", i);
+	}
+	ASSERT(cpoly_count(&poly) == 2 * POLY_OBJECTS, "Collection has %zu objects", cpoly_count(&poly));
+	ASSERT(poly.cbucket_count == 2, "Collection has %zu buckets", poly.cbucket_count);
+	ASSERT(poly.cbuckets[0].ccount == POLY_OBJECTS, "Rect bucket has %zu objects", poly.cbuckets[0].ccount);
+	ASSERT(poly.cbuckets[1].cobjects[3] == (void*) &squares[3], "Interface wasn't cast to its object");
+
+	/* Only once, through the object or any interface. */
+	ASSERT(!cpoly_insert(&poly, &rects[5].gtShape), "Inserted a rect twice");
+	ASSERT(!cpoly_insert(&poly, &squares[5]), "Inserted a square twice");
+	ASSERT(cpoly_contains(&poly, &squares[5].gtRect.gtShape), "Square isn't found through its interface");
+}
+
+TEST(foreach)
+{
+	int i;
+
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		cpoly_insert(&poly, &squares[i]);
+		cpoly_insert(&poly, &rects[i]);
+	}
+
+	/* Every object once, with its own class' method. */
+	CPOLY_FOREACH(&poly, struct GTRect_VTable, GTShape_VTable.scale, struct GTRect, self, (&self->gtShape, 2));
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		ASSERT(rects[i].width == 2 * i, "Rect %d has width %d", i, rects[i].width);
+		ASSERT(squares[i].gtRect.width == 2 * i, "Square %d has width %d", i, squares[i].gtRect.width);
+	}
+	ASSERT(GTShape_area(&squares[3].gtRect.gtShape) == 1000 + 6 * 6, "Square 3 has area %d", GTShape_area(&squares[3].gtRect.gtShape));
+}
+
+TEST(remove)
+{
+	struct GTRect* rect;
+	int i;
+
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		cpoly_insert(&poly, &rects[i]);
+		cpoly_insert(&poly, &squares[i]);
+	}
+
+	/* Every other object, through either reference. */
+	for( i = 0; i < POLY_OBJECTS; i += 2 ) {
+		ASSERT(cpoly_remove(&poly, &rects[i].gtShape), "Failed to remove rect %d", i);
+		ASSERT(cpoly_remove(&poly, &squares[i]), "Failed to remove square %d", i);
+	}
+	ASSERT(!cpoly_remove(&poly, &rects[0]), "Removed a rect twice");
+	ASSERT(cpoly_count(&poly) == POLY_OBJECTS, "Collection has %zu objects", cpoly_count(&poly));
+
+	/* The rest are still there, and only they are visited. */
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		ASSERT(cpoly_contains(&poly, &rects[i]) == (i % 2), "Rect %d contained is wrong", i);
+		ASSERT(cpoly_contains(&poly, &squares[i]) == (i % 2), "Square %d contained is wrong", i);
+	}
+	CPOLY_FOREACH(&poly, struct GTRect_VTable, GTShape_VTable.scale, struct GTRect, self, (&self->gtShape, 3));
+	for( i = 0; i < POLY_OBJECTS; ++i ) {
+		ASSERT(rects[i].width == (i % 2 ? 3 * i : i), "Rect %d has width %d", i, rects[i].width);
+	}
+
+	/* And can all be removed, and added again. */
+	for( i = 1; i < POLY_OBJECTS; i += 2 ) {
+		ASSERT(cpoly_remove(&poly, &squares[i]), "Failed to remove square %d", i);
+		ASSERT(cpoly_remove(&poly, &rects[i]), "Failed to remove rect %d", i);
+	}
+	ASSERT(cpoly_count(&poly) == 0, "Collection has %zu objects", cpoly_count(&poly));
+	rect = &squares[4].gtRect;
+	ASSERT(cpoly_insert(&poly, rect), "Failed to insert square again");
+	ASSERT(cpoly_contains(&poly, rect), "Square isn't found after inserting again");
+}
+
+TEST_SUITE(poly_suite)
+{
+	ADD_TEST(buckets);
+	ADD_TEST(foreach);
+	ADD_TEST(remove);
+}
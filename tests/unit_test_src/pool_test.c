@@ -0,0 +1,161 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify the object pool. Objects allocated from a
+ * pool must be returned to it when destroyed with cpool_free( ) as their
+ * memory free hook. It will also verify the pool's growth policy, trimming,
+ * and statistics.
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <cpool.h>
+#include <unit.h>
+
+static struct cpool_t pool;
+
+TEST_SETUP( ) { }
+TEST_TEARDOWN( )
+{
+	cpool_destroy(&pool);
+}
+
+
+TEST(alloc_destroy)
+{
+	struct cpool_stats_t stats;
+	struct DTClassE* object;
+	int temp;
+
+	cpool_init(&pool, sizeof(struct DTClassE), NULL);
+
+	/* Construct an object in pool memory and give it the pool's free hook. */
+	object = cpool_alloc(&pool);
+	ASSERT(object != NULL, "Failed to allocate from pool");
+	if( object == NULL ) {
+		return;
+	}
+	newDTClassE(object, &temp);
+	cmalloc(object, cpool_free);
+
+	cpool_stats(&pool, &stats);
+	ASSERT(stats.callocs == 1 && stats.clive == 1, "Wrong stats after alloc: %zu %zu", stats.callocs, stats.clive);
+
+	/* Destroying the object runs the destructor chain then frees to the pool. */
+	cdestroy(object);
+	ASSERT(temp == DT_CLASS_E_VAL + 1, "Failed to cascade destructor - %d", temp);
+
+	cpool_stats(&pool, &stats);
+	ASSERT(stats.cfrees == 1 && stats.clive == 0, "Failed to return object to pool: %zu %zu", stats.cfrees, stats.clive);
+
+	/* Memory is reused. */
+	ASSERT(cpool_alloc(&pool) == (void*) object, "Failed to reuse freed object");
+}
+
+TEST(growth)
+{
+	struct cpool_config_t config = CPOOL_CONFIG_DEFAULT;
+	struct cpool_stats_t stats;
+	void* objects[15];
+	size_t i;
+
+	/* Slabs of 2, 4, 8, 8, ... objects. */
+	config.cinitial = 2;
+	config.cgrowth = 2;
+	config.cmax_slab = 8;
+	cpool_init(&pool, sizeof(struct DTClassA), &config);
+
+	for( i = 0; i < 15; ++i ) {
+		objects[i] = cpool_alloc(&pool);
+		ASSERT(objects[i] != NULL, "Failed to allocate object %zu", i);
+	}
+
+	cpool_stats(&pool, &stats);
+	ASSERT(stats.cslabs == 4, "Wrong number of slabs: %zu", stats.cslabs);
+	ASSERT(stats.ccapacity == 22, "Wrong capacity: %zu", stats.ccapacity);
+	ASSERT(stats.cpeak == 15, "Wrong peak: %zu", stats.cpeak);
+
+	/* Every object is distinct. */
+	for( i = 1; i < 15; ++i ) {
+		ASSERT(objects[i] != objects[i-1], "Object handed out twice");
+	}
+}
+
+TEST(max_objects)
+{
+	struct cpool_config_t config = CPOOL_CONFIG_DEFAULT;
+	struct cpool_stats_t stats;
+	void* a;
+	void* b;
+
+	config.cinitial = 4;
+	config.cmax_objects = 2;
+	cpool_init(&pool, sizeof(struct DTClassA), &config);
+
+	a = cpool_alloc(&pool);
+	b = cpool_alloc(&pool);
+	ASSERT(a != NULL && b != NULL, "Failed to allocate under limit");
+	ASSERT(cpool_alloc(&pool) == NULL, "Allocated past cmax_objects");
+
+	cpool_stats(&pool, &stats);
+	ASSERT(stats.cfailed == 1, "Failed allocation not counted");
+	ASSERT(stats.ccapacity == 2, "Slab not clamped to limit: %zu", stats.ccapacity);
+
+	/* Freeing makes room again. */
+	cpool_free(a);
+	ASSERT(cpool_alloc(&pool) == a, "Failed to reuse after free at limit");
+}
+
+TEST(trim)
+{
+	struct cpool_config_t config = CPOOL_CONFIG_DEFAULT;
+	struct cpool_stats_t stats;
+	void* objects[6];
+	size_t i;
+
+	/* Slabs of 2 and 4 objects. */
+	config.cinitial = 2;
+	cpool_init(&pool, sizeof(struct DTClassA), &config);
+	for( i = 0; i < 6; ++i ) {
+		objects[i] = cpool_alloc(&pool);
+	}
+
+	/* Empty the second slab only, it is the only one which can be released. */
+	for( i = 2; i < 6; ++i ) {
+		cpool_free(objects[i]);
+	}
+	ASSERT(cpool_trim(&pool) == 1, "Failed to release empty slab");
+
+	cpool_stats(&pool, &stats);
+	ASSERT(stats.cslabs == 1 && stats.ccapacity == 2, "Wrong stats after trim: %zu %zu", stats.cslabs, stats.ccapacity);
+
+	/* Release the rest, the pool restarts its growth policy. */
+	cpool_free(objects[0]);
+	cpool_free(objects[1]);
+	ASSERT(cpool_trim(&pool) == 1, "Failed to release last slab");
+	ASSERT(cpool_reserve(&pool, 1), "Failed to reserve after trim");
+
+	cpool_stats(&pool, &stats);
+	ASSERT(stats.ccapacity == 2, "Growth policy not restarted: %zu", stats.ccapacity);
+}
+
+TEST_SUITE(pool_suite)
+{
+	ADD_TEST(alloc_destroy);
+	ADD_TEST(growth);
+	ADD_TEST(max_objects);
+	ADD_TEST(trim);
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify asynchronous destruction. Objects given
+ * to cdestroy_async( ) must have their destructor chain run and be freed
+ * exactly once, by the time creaper_drain( ) returns, whether they went
+ * through the queue or were destroyed by the caller when it was full.
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <creaper.h>
+#include <unit.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+/* An object with the counter its destructors bump, its own, since reaper
+ * threads destroy objects while others are constructed.
+ */
+struct reaper_object_t
+{
+    struct DTClassC object;
+    int             sentinel;
+};
+
+static struct creaper_t reaper;
+static int freed;
+
+static void counting_free( void* object )
+{
+	free(object);
+	__atomic_add_fetch(&freed, 1, __ATOMIC_RELAXED);
+}
+
+static struct DTClassC* new_object( void )
+{
+	struct reaper_object_t* object = malloc(sizeof(*object));
+
+	if( object == NULL ) {
+		return NULL;
+	}
+	newDTClassC(&object->object, &object->sentinel);
+	cmalloc(&object->object, counting_free);
+	return &object->object;
+}
+
+TEST_SETUP( )
+{
+	freed = 0;
+}
+TEST_TEARDOWN( )
+{
+}
+
+
+TEST(async)
+{
+	struct creaper_stats_t stats;
+	struct DTClassE e;
+	int temp;
+
+	if( !creaper_init(&reaper, NULL) ) {
+		ABORT_TEST("Failed to start reaper");
+	}
+
+	newDTClassE(&e, &temp);
+	ASSERT(cdestroy_async(&reaper, &e), "Object not queued");
+	creaper_drain(&reaper);
+	ASSERT(temp == DT_CLASS_E_VAL + 1, "Destructor chain not run - %d", temp);
+
+	creaper_stats(&reaper, &stats);
+	ASSERT(stats.cqueued == 1 && stats.cdestroyed == 1, "Queued %zu, destroyed %zu", stats.cqueued, stats.cdestroyed);
+	ASSERT(stats.cdepth == 0, "Depth %zu after drain", stats.cdepth);
+	creaper_destroy(&reaper);
+}
+
+#define REAPER_CAPACITY 4
+#define REAPER_OVERFLOW 3
+
+TEST(inline_when_full)
+{
+	static const struct creaper_config_t config = { REAPER_CAPACITY, 0, CREAPER_FULL_INLINE };
+	struct creaper_stats_t stats;
+	struct DTClassC* object;
+	int i, queued;
+
+	/* Without reaper threads, nothing leaves the queue until it's drained. */
+	if( !creaper_init(&reaper, &config) ) {
+		ABORT_TEST("Failed to start reaper");
+	}
+
+	for( queued = 0, i = 0; i < REAPER_CAPACITY + REAPER_OVERFLOW; ++i ) {
+		object = new_object( );
+		if( object == NULL ) {
+			ABORT_TEST("Out of memory");
+		}
+		queued += cdestroy_async(&reaper, object);
+	}
+	ASSERT(queued == REAPER_CAPACITY, "Queued %d of a %d object queue", queued, REAPER_CAPACITY);
+	ASSERT(freed == REAPER_OVERFLOW, "Freed %d objects which didn't fit", freed);
+
+	creaper_stats(&reaper, &stats);
+	ASSERT(stats.cinline == REAPER_OVERFLOW, "Destroyed %zu inline", stats.cinline);
+	ASSERT(stats.cdepth == REAPER_CAPACITY, "Depth %zu", stats.cdepth);
+	ASSERT(stats.cpeak == REAPER_CAPACITY, "Peak %zu", stats.cpeak);
+
+	creaper_drain(&reaper);
+	ASSERT(freed == REAPER_CAPACITY + REAPER_OVERFLOW, "Freed %d objects after drain", freed);
+	creaper_stats(&reaper, &stats);
+	ASSERT(stats.cdepth == 0, "Depth %zu after drain", stats.cdepth);
+	creaper_destroy(&reaper);
+}
+
+/* Producers outrun a small queue, so they block on it.
+ */
+#define REAPER_PRODUCERS 4
+#define REAPER_OBJECTS 5000
+
+static void* producer_thread( void* arg )
+{
+	struct DTClassC* object;
+	int i;
+
+	(void) arg;
+	for( i = 0; i < REAPER_OBJECTS; ++i ) {
+		object = new_object( );
+		if( object == NULL ) {
+			break;
+		}
+		cdestroy_async(&reaper, object);
+	}
+	return NULL;
+}
+
+TEST(threads)
+{
+	static const struct creaper_config_t config = { 16, 2, CREAPER_FULL_BLOCK };
+	pthread_t threads[REAPER_PRODUCERS];
+	struct creaper_stats_t stats;
+	int created, i;
+
+	if( !creaper_init(&reaper, &config) ) {
+		ABORT_TEST("Failed to start reaper");
+	}
+
+	for( created = 0; created < REAPER_PRODUCERS; ++created ) {
+		if( pthread_create(&threads[created], NULL, producer_thread, NULL) != 0 ) {
+			break;
+		}
+	}
+	for( i = 0; i < created; ++i ) {
+		pthread_join(threads[i], NULL);
+	}
+
+	creaper_drain(&reaper);
+	creaper_stats(&reaper, &stats);
+	ASSERT(freed == created * REAPER_OBJECTS, "Freed %d of %d objects", freed, created * REAPER_OBJECTS);
+	ASSERT(stats.cdestroyed == stats.cqueued, "Queued %zu, destroyed %zu", stats.cqueued, stats.cdestroyed);
+	ASSERT(stats.cinline == 0, "Blocking reaper destroyed %zu inline", stats.cinline);
+	ASSERT(stats.cpeak <= 16 + REAPER_PRODUCERS, "Peak %zu past the queue's capacity", stats.cpeak);
+	creaper_destroy(&reaper);
+}
+
+/* Producers keep a queue without reaper threads full, so objects are
+ * destroyed inline, while another thread drains it.
+ */
+#define REAPER_DRAINED 20000
+
+static int producing;
+
+static void* inline_producer_thread( void* arg )
+{
+	struct DTClassC* object;
+	int i;
+
+	(void) arg;
+	for( i = 0; i < REAPER_DRAINED; ++i ) {
+		object = new_object( );
+		if( object == NULL ) {
+			break;
+		}
+		cdestroy_async(&reaper, object);
+	}
+	__atomic_sub_fetch(&producing, 1, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+static void* drain_thread( void* arg )
+{
+	int* drains = arg;
+
+	while( __atomic_load_n(&producing, __ATOMIC_ACQUIRE) > 0 ) {
+		creaper_drain(&reaper);
+		++*drains;
+	}
+	return NULL;
+}
+
+TEST(drain_while_full)
+{
+	static const struct creaper_config_t config = { 4, 0, CREAPER_FULL_INLINE };
+	pthread_t producers[REAPER_PRODUCERS];
+	pthread_t drainer;
+	struct creaper_stats_t stats;
+	int created, drains, i;
+
+	if( !creaper_init(&reaper, &config) ) {
+		ABORT_TEST("Failed to start reaper");
+	}
+
+	/* A drain only waits for objects which made it into the queue, not
+	 * ones about to be destroyed inline. */
+	drains = 0;
+	producing = REAPER_PRODUCERS;
+	for( created = 0; created < REAPER_PRODUCERS; ++created ) {
+		if( pthread_create(&producers[created], NULL, inline_producer_thread, NULL) != 0 ) {
+			break;
+		}
+	}
+	__atomic_sub_fetch(&producing, REAPER_PRODUCERS - created, __ATOMIC_RELEASE);
+	if( pthread_create(&drainer, NULL, drain_thread, &drains) == 0 ) {
+		pthread_join(drainer, NULL);
+	}
+	for( i = 0; i < created; ++i ) {
+		pthread_join(producers[i], NULL);
+	}
+
+	creaper_drain(&reaper);
+	creaper_stats(&reaper, &stats);
+	ASSERT(freed == created * REAPER_DRAINED, "Freed %d of %d objects", freed, created * REAPER_DRAINED);
+	ASSERT(stats.cqueued + stats.cinline == (size_t) created * REAPER_DRAINED, "Queued %zu and destroyed %zu inline", stats.cqueued, stats.cinline);
+	ASSERT(stats.cdestroyed == stats.cqueued && stats.cdepth == 0, "Queued %zu, destroyed %zu", stats.cqueued, stats.cdestroyed);
+	ASSERT(stats.cpeak <= 4, "Peak %zu past the queue's capacity", stats.cpeak);
+	creaper_destroy(&reaper);
+}
+
+TEST_SUITE(reaper_suite)
+{
+	ADD_TEST(async);
+	ADD_TEST(inline_when_full);
+	ADD_TEST(threads);
+	ADD_TEST(drain_while_full);
+}
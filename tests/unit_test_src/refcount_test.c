@@ -0,0 +1,163 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify reference counting. Releasing the last
+ * reference must destroy the object exactly once, whether the count is plain
+ * or atomic, and whether the object or its class chose atomic counting.
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <test_classes/interface_test_classes.h>
+#include <unit.h>
+#include <pthread.h>
+
+TEST_SETUP( ) { }
+TEST_TEARDOWN( ) { }
+
+#define FREE_USED 0
+#define FREE_UNUSED 1
+
+static int freeUsed = FREE_UNUSED;
+
+static void testFree( void* self )
+{
+	(void) self;
+	freeUsed = FREE_USED;
+}
+
+
+TEST(plain)
+{
+	struct DTClassE e;
+	int temp;
+
+	newDTClassE(&e, &temp);
+	ASSERT(!cobject_is_shared(&e), "Object is shared by default");
+	ASSERT(e.dtClassC.dtClassA.cobject.crefs == 1, "Wrong initial count: %u", e.dtClassC.dtClassA.cobject.crefs);
+
+	ASSERT(cretain(&e) == &e, "cretain( ) didn't return its argument");
+	ASSERT(crelease(&e) == 0, "Destroyed with a reference left");
+	ASSERT(temp == DT_CLASS_A_VAL, "Destructor called early - %d", temp);
+
+	ASSERT(crelease(&e) == 1, "Not destroyed on last release");
+	ASSERT(temp == DT_CLASS_E_VAL + 1, "Failed to cascade destructor - %d", temp);
+}
+
+TEST(interface)
+{
+	struct ITClassC c;
+	struct ITInterface2* ref;
+
+	newITClassC(&c);
+	freeUsed = FREE_UNUSED;
+	cmalloc(&c, testFree);
+
+	/* References to interfaces count their object. */
+	ref = cretain(&c.classB.classA.itInterface2);
+	ASSERT(ref == &c.classB.classA.itInterface2, "cretain( ) didn't return its argument");
+	ASSERT(c.classB.classA.cobject.crefs == 2, "Interface retain not counted: %u", c.classB.classA.cobject.crefs);
+
+	crelease(&c);
+	ASSERT(freeUsed == FREE_UNUSED, "Destroyed with a reference left");
+	crelease(ref);
+	ASSERT(freeUsed == FREE_USED, "Not destroyed through interface reference");
+}
+
+TEST(shared_object)
+{
+	struct DTClassE e;
+	int temp;
+
+	newDTClassE(&e, &temp);
+	cobject_set_shared(&e, 1);
+	ASSERT(cobject_is_shared(&e), "Failed to share object");
+
+	cretain(&e);
+	ASSERT(crelease(&e) == 0, "Destroyed with a reference left");
+	ASSERT(crelease(&e) == 1, "Not destroyed on last release");
+	ASSERT(temp == DT_CLASS_E_VAL + 1, "Failed to cascade destructor - %d", temp);
+}
+
+TEST(shared_class)
+{
+	struct DTClassF f;
+	struct DTClassC c;
+	int tempF, tempC;
+
+	newDTClassF(&f, &tempF);
+	newDTClassC(&c, &tempC);
+	ASSERT(cobject_is_shared(&f), "Class flag not applied");
+	ASSERT(!cobject_is_shared(&c), "Super class is shared");
+
+	/* Objects can't opt out of their class' flag. */
+	cobject_set_shared(&f, 0);
+	ASSERT(cobject_is_shared(&f), "Object overrode class flag");
+
+	ASSERT(crelease(&f) == 1, "Not destroyed on last release");
+	ASSERT(tempF == DT_CLASS_A_VAL + 1, "Failed to cascade destructor - %d", tempF);
+	cdestroy(&c);
+}
+
+#define REFCOUNT_THREADS 4
+#define REFCOUNT_ITERATIONS 100000
+
+static void* refcount_thread( void* object )
+{
+	int i;
+
+	for( i = 0; i < REFCOUNT_ITERATIONS; ++i ) {
+		cretain(object);
+		crelease(object);
+	}
+	/* Drop the reference main gave this thread. */
+	crelease(object);
+	return NULL;
+}
+
+TEST(threads)
+{
+	pthread_t threads[REFCOUNT_THREADS];
+	struct DTClassF f;
+	int temp;
+	int i;
+
+	newDTClassF(&f, &temp);
+	for( i = 0; i < REFCOUNT_THREADS; ++i ) {
+		cretain(&f);
+		if( pthread_create(&threads[i], NULL, refcount_thread, &f) != 0 ) {
+			crelease(&f);
+			ABORT_TEST("Failed to create thread");
+		}
+	}
+	for( i = 0; i < REFCOUNT_THREADS; ++i ) {
+		pthread_join(threads[i], NULL);
+	}
+
+	ASSERT(f.dtClassC.dtClassA.cobject.crefs == 1, "Lost updates, count is %u", f.dtClassC.dtClassA.cobject.crefs);
+	ASSERT(temp == DT_CLASS_A_VAL, "Destroyed early - %d", temp);
+	ASSERT(crelease(&f) == 1, "Not destroyed on last release");
+	ASSERT(temp == DT_CLASS_A_VAL + 1, "Destroyed more than once - %d", temp);
+}
+
+TEST_SUITE(refcount_suite)
+{
+	ADD_TEST(plain);
+	ADD_TEST(interface);
+	ADD_TEST(shared_object);
+	ADD_TEST(shared_class);
+	ADD_TEST(threads);
+}
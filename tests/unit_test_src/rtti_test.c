@@ -0,0 +1,121 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify class type descriptors. Every class'
+ * descriptor must describe it and its place in the hierarchy, and
+ * cinstanceof( ) must accept exactly the class and its ancestors, whether
+ * given the class itself or one of its interfaces.
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <test_classes/interface_test_classes.h>
+#include <unit.h>
+#include <string.h>
+
+TEST_SETUP( ) { }
+TEST_TEARDOWN( ) { }
+
+
+TEST(descriptor)
+{
+	const struct cclass_info_t* info;
+	struct DTClassD d;
+	int temp;
+
+	newDTClassD(&d, &temp);
+	info = cobject_get_info(&d);
+
+	ASSERT(info == &DTClassD_Info, "Wrong descriptor");
+	ASSERT(strcmp(info->cname, "DTClassD") == 0, "Wrong name: %s", info->cname);
+	ASSERT(info->csize == sizeof(struct DTClassD), "Wrong size: %zu", info->csize);
+	ASSERT(info->calign == CCLASS_ALIGNOF(struct DTClassD), "Wrong alignment: %zu", info->calign);
+	ASSERT(info->cdepth == 3, "Wrong depth: %zu", info->cdepth);
+
+	/* Parents lead back to cobject_t. */
+	ASSERT(info->cparent == &DTClassB_Info, "Wrong parent");
+	ASSERT(info->cparent->cparent == &DTClassA_Info, "Wrong grandparent");
+	ASSERT(info->cparent->cparent->cparent == &cobject_info, "Not rooted at cobject_t");
+	ASSERT(cobject_info.cparent == NULL && cobject_info.cdepth == 0, "Wrong root descriptor");
+
+	/* The display holds every ancestor at its depth. */
+	ASSERT(info->cdisplay[0] == &cobject_info, "Wrong display[0]");
+	ASSERT(info->cdisplay[1] == &DTClassA_Info, "Wrong display[1]");
+	ASSERT(info->cdisplay[2] == &DTClassB_Info, "Wrong display[2]");
+	ASSERT(info->cdisplay[3] == &DTClassD_Info, "Wrong display[3]");
+	ASSERT(info->cdisplay[4] == NULL, "Display not terminated");
+
+	cdestroy(&d);
+}
+
+TEST(instanceof)
+{
+	struct DTClassD d;
+	struct DTClassE e;
+	int tempD, tempE;
+
+	newDTClassD(&d, &tempD);
+	newDTClassE(&e, &tempE);
+
+	/* The class and its ancestors. */
+	ASSERT(cinstanceof(&d, &DTClassD_Info), "D is not a D");
+	ASSERT(cinstanceof(&d, &DTClassB_Info), "D is not a B");
+	ASSERT(cinstanceof(&d, &DTClassA_Info), "D is not an A");
+	ASSERT(cinstanceof(&d, &cobject_info), "D is not a cobject_t");
+
+	/* Siblings and their subclasses at the same depth. */
+	ASSERT(!cinstanceof(&d, &DTClassC_Info), "D is a C");
+	ASSERT(!cinstanceof(&d, &DTClassE_Info), "D is an E");
+	ASSERT(!cinstanceof(&e, &DTClassB_Info), "E is a B");
+	ASSERT(!cinstanceof(&e, &DTClassD_Info), "E is a D");
+
+	/* Upcast references keep the object's class. */
+	ASSERT(cinstanceof(&d.dtClassB, &DTClassD_Info), "Upcast D is not a D");
+
+	/* Unrelated hierarchies. */
+	ASSERT(!cinstanceof(&e, &ITClassA_Info), "E is an ITClassA");
+
+	cdestroy(&d);
+	cdestroy(&e);
+}
+
+TEST(instanceof_interface)
+{
+	struct ITClassC c;
+	struct ITCompactClassB compactB;
+
+	newITClassC(&c);
+	newITCompactClassB(&compactB);
+
+	/* Interface references resolve to their object. */
+	ASSERT(cinstanceof(&c.classB.classA.itInterface1.itInterface0, &ITClassC_Info), "Interface 0 of C is not a C");
+	ASSERT(cinstanceof(&c.classB.classA.itInterface2, &ITClassA_Info), "Interface 2 of C is not an A");
+	ASSERT(!cinstanceof(&c.classB.classA.itInterface2, &ITCompactClassA_Info), "Interface 2 of C is an ITCompactClassA");
+
+	ASSERT(cinstanceof(&compactB.classA.itCompactInterface1.itCompactInterface0, &ITCompactClassB_Info), "Compact interface of B is not a B");
+	ASSERT(cinstanceof(&compactB.classA.itCompactInterface1, &ITCompactClassA_Info), "Compact interface of B is not an A");
+	ASSERT(cobject_get_info(&compactB.classA.itCompactInterface1) == &ITCompactClassB_Info, "Wrong descriptor through compact interface");
+
+	cdestroy(&c);
+	cdestroy(&compactB);
+}
+
+TEST_SUITE(rtti_suite)
+{
+	ADD_TEST(descriptor);
+	ADD_TEST(instanceof);
+	ADD_TEST(instanceof_interface);
+}
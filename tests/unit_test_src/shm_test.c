@@ -0,0 +1,239 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify shared memory heaps. Freed blocks must
+ * be reused, by any process. Shared objects must call their class' methods
+ * through the object and every interface, cast back to themselves, and be
+ * usable from another process mapping the heap. Objects of unregistered
+ * classes must not be shared.
+ */
+
+#include <test_classes/generated_test_classes.h>
+#include <test_classes/interface_test_classes.h>
+#include <test_classes/virtual_test_classes.h>
+#include <cplace.h>
+#include <cregistry.h>
+#include <cshm.h>
+#include <unit.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define SHM_SIZE	(1 << 20)
+
+static char name[64];
+static struct cshm_t heap;
+
+TEST_SETUP( )
+{
+	/* One registry for the whole program, under snap_test.c's IDs. */
+	CREGISTRY_REGISTER(1, GTRect);
+	CREGISTRY_REGISTER(3, ITClassA);
+	CREGISTRY_REGISTER(4, ITCompactClassA);
+
+	snprintf(name, sizeof(name), "/cshm_test_%ld", (long) getpid( ));
+	cshm_unlink(name);
+	if( !cshm_create(&heap, name, SHM_SIZE) ) {
+		ABORT_TEST("Failed to create a heap");
+	}
+}
+TEST_TEARDOWN( )
+{
+	cshm_close(&heap);
+	cshm_unlink(name);
+}
+
+
+TEST(alloc)
+{
+	void* first;
+	void* second;
+	void* large;
+	size_t count;
+
+	/* Freed blocks are reused for their size. */
+	first = cshm_alloc(&heap, 24);
+	second = cshm_alloc(&heap, 24);
+	ASSERT(first != NULL && second != NULL && first != second, "Failed to allocate");
+	ASSERT((uintptr_t) first % 16 == 0 && (uintptr_t) second % 16 == 0, "Blocks aren't aligned");
+	cshm_free(first);
+	ASSERT(cshm_alloc(&heap, 32) == first, "Freed block wasn't reused");
+	ASSERT(cshm_alloc(&heap, 24) != first, "Block was given out twice");
+
+	/* Until the segment is full. */
+	large = cshm_alloc(&heap, SHM_SIZE / 2);
+	ASSERT(large != NULL, "Failed to allocate half the segment");
+	ASSERT(cshm_alloc(&heap, SHM_SIZE / 2) == NULL, "Allocated past the end of the segment");
+	for( count = 0; cshm_alloc(&heap, 1024) != NULL; ++count ) {
+		continue;
+	}
+	ASSERT(count > 0 && count < SHM_SIZE / 1024 / 2, "Allocated %zu blocks", count);
+	cshm_free(large);
+	ASSERT(cshm_alloc(&heap, SHM_SIZE / 2) == large, "Freed block wasn't reused when full");
+}
+
+#ifdef CSHM
+TEST(share)
+{
+	struct ITClassA* interfaces;
+	struct ITCompactClassA* compact;
+	struct VTClassA* unknown;
+	struct GTRect* rect;
+	const void* vtable;
+	uintptr_t fields;
+	void* memory;
+
+	memory = cshm_alloc(&heap, sizeof(struct ITClassA));
+	interfaces = cnew_in(memory, ITClassA);
+	memory = cshm_alloc(&heap, sizeof(struct ITCompactClassA));
+	compact = cnew_in(memory, ITCompactClassA);
+	if( interfaces == NULL || compact == NULL ) {
+		ABORT_TEST("Failed to construct objects in the heap");
+	}
+	cmalloc(interfaces, cshm_free);
+
+	/* Shared through an interface, every header is. */
+	vtable = ((struct cclass_t*) interfaces)->cvtable;
+	ASSERT(cshm_share(&interfaces->itInterface2), "Failed to share");
+	ASSERT(cshm_share(compact), "Failed to share compact interfaces");
+	ASSERT(cclass_header_word(interfaces) & CCLASS_TAG_SHARED, "Object header isn't shared");
+	ASSERT(cclass_header_word(&interfaces->itInterface1.itInterface0) & CCLASS_TAG_SHARED, "Interface header isn't shared");
+	ASSERT(cclass_header_word(&compact->itCompactInterface1) & CCLASS_TAG_SHARED, "Compact header isn't shared");
+	ASSERT(cclass_get_vtable(interfaces) == vtable, "Shared vtable resolves to %p", cclass_get_vtable(interfaces));
+	ASSERT(((struct cobject_t*) interfaces)->cfree == NULL, "Shared object has a free method");
+
+	/* Methods and casts through every header. */
+	ASSERT(ITInterface2_Method0(&interfaces->itInterface2) == IT_CLASSA_I2_METHOD0, "Failed to run I2 M0");
+	ASSERT(ITInterface0_Method0(&interfaces->itInterface1.itInterface0) == IT_CLASSA_I0_METHOD0, "Failed to run I0 M0");
+	ASSERT(ccast(&interfaces->itInterface1.itInterface0) == interfaces, "Interface doesn't cast to its object");
+	ASSERT(ITCompactInterface0_Method0(&compact->itCompactInterface1.itCompactInterface0) == IT_COMPACTA_CI0_METHOD0, "Failed to run CI0 M0");
+	ASSERT(ccast(&compact->itCompactInterface1) == compact, "Compact interface doesn't cast to its object");
+	ASSERT(cinstanceof(interfaces, &ITClassA_Info), "Shared object isn't an ITClassA");
+
+	/* Sharing twice changes nothing. */
+	vtable = ((struct cclass_t*) interfaces)->cvtable;
+	ASSERT(cshm_share(interfaces) && ((struct cclass_t*) interfaces)->cvtable == vtable, "Shared twice");
+	cdestroy(interfaces);
+	cshm_free(interfaces);
+	cdestroy(compact);
+	cshm_free(compact);
+
+	/* Classes must be registered to be shared. */
+	memory = cshm_alloc(&heap, sizeof(struct VTClassA));
+	unknown = cnew_in(memory, VTClassA);
+	vtable = ((struct cclass_t*) unknown)->cvtable;
+	ASSERT(!cshm_share(unknown), "Shared an unregistered class");
+	ASSERT(((struct cclass_t*) unknown)->cvtable == vtable, "Unregistered object was changed");
+	cdestroy(unknown);
+	cshm_free(unknown);
+
+	/* Only headers are, not fields which look like one. */
+	memory = cshm_alloc(&heap, sizeof(struct GTRect));
+	rect = cnew_in(memory, GTRect);
+	if( rect == NULL ) {
+		ABORT_TEST("Failed to construct a rect in the heap");
+	}
+	fields = (uintptr_t) GTRect_VTable_Key( );
+	memcpy(&rect->width, &fields, sizeof(fields));
+	rect->destroyed = (int*) rect;
+	ASSERT(cshm_share(rect), "Failed to share a rect pointing at itself");
+	ASSERT(memcmp(&rect->width, &fields, sizeof(fields)) == 0 && rect->destroyed == (int*) rect, "Fields of a shared rect were changed");
+	rect->destroyed = NULL;
+	cdestroy(rect);
+	cshm_free(rect);
+
+	/* IDs are only taken once. */
+	ASSERT(!cregistry_register(1, ITClassA_VTable_Key( ), sizeof(struct ITClassA_VTable)), "Registered a taken ID");
+}
+
+TEST(processes)
+{
+	struct GTRect* rect;
+	void* block;
+	void* memory;
+	pid_t child;
+	int status;
+
+	memory = cshm_alloc(&heap, sizeof(struct GTRect));
+	rect = cnew_in(memory, GTRect);
+	if( rect == NULL ) {
+		ABORT_TEST("Failed to construct a rect in the heap");
+	}
+	rect->width = 3;
+	rect->height = 4;
+	rect->destroyed = NULL;
+	ASSERT(cshm_share(rect), "Failed to share");
+	cshm_set_root(&heap, rect);
+	block = cshm_alloc(&heap, 100);
+
+	/* The child maps the heap itself, finds the rect, calls its methods,
+	 * changes it, and frees the parent's block.
+	 */
+	child = fork( );
+	if( child < 0 ) {
+		ABORT_TEST("Failed to fork");
+	}
+	if( child == 0 ) {
+		struct cshm_t mapped;
+		struct GTRect* found;
+
+		cshm_close(&heap);
+		if( !cshm_open(&mapped, name) ) {
+			_exit(1);
+		}
+		found = cshm_root(&mapped);
+		if( found != rect || GTRect_perimeter(found) != 14 || GTShape_area(&found->gtShape) != 12 ) {
+			_exit(2);
+		}
+		GTShape_scale(&found->gtShape, 2);
+		cshm_free(block);
+		cshm_close(&mapped);
+		_exit(0);
+	}
+	ASSERT(waitpid(child, &status, 0) == child && WIFEXITED(status), "Child didn't exit");
+	ASSERT(WEXITSTATUS(status) == 0, "Child failed with %d", WEXITSTATUS(status));
+	ASSERT(rect->width == 6 && GTRect_perimeter(rect) == 28, "Child's change isn't seen");
+	ASSERT(cshm_alloc(&heap, 100) == block, "Block freed by the child wasn't reused");
+
+	/* Mapped already, at the heap's address. */
+	ASSERT(!cshm_open(&(struct cshm_t) { NULL, 0 }, name), "Mapped the heap twice");
+	cdestroy(rect);
+	cshm_free(rect);
+}
+#else
+TEST(share)
+{
+	struct GTRect rect;
+
+	/* Without CSHM, headers aren't resolved, so objects aren't shared. */
+	newGTRect(&rect);
+	rect.destroyed = NULL;
+	ASSERT(!cshm_share(&rect), "Shared an object without CSHM");
+	cdestroy(&rect);
+}
+#endif
+
+TEST_SUITE(shm_suite)
+{
+	ADD_TEST(alloc);
+	ADD_TEST(share);
+#ifdef CSHM
+	ADD_TEST(processes);
+#endif
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify snapshots. Objects loaded from a
+ * snapshot, eagerly or lazily, must call their class' methods through the
+ * object and every interface, cast back to themselves, and keep pointers
+ * between objects, even fields which look like a header. Snapshots of
+ * classes which aren't registered must not be written or loaded.
+ */
+
+#include <test_classes/generated_test_classes.h>
+#include <test_classes/interface_test_classes.h>
+#include <test_classes/virtual_test_classes.h>
+#include <cregistry.h>
+#include <csnap.h>
+#include <unit.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char path[] = "/tmp/csnap_testXXXXXX";
+static struct GTRect rect;
+static struct GTSquare square;
+static struct ITClassA interfaces;
+static struct ITCompactClassA compact;
+
+/* Snapshot of rect, square, interfaces and compact, in that order. The
+ * square's destroyed pointer points at the rect's height.
+ */
+static int write_snapshot( void )
+{
+	struct csnap_writer_t writer;
+	int ok;
+
+	csnap_writer_init(&writer);
+	ok = csnap_add(&writer, &rect) &&
+	     csnap_add(&writer, &square.gtRect.gtShape) &&
+	     csnap_add(&writer, &interfaces) &&
+	     csnap_add(&writer, &compact) &&
+	     csnap_pointer(&writer, (void**) &square.gtRect.destroyed) &&
+	     csnap_write(&writer, path);
+	csnap_writer_destroy(&writer);
+	return ok;
+}
+
+TEST_SETUP( )
+{
+	int fd;
+
+	CREGISTRY_REGISTER(1, GTRect);
+	CREGISTRY_REGISTER(2, GTSquare);
+	CREGISTRY_REGISTER(3, ITClassA);
+	CREGISTRY_REGISTER(4, ITCompactClassA);
+
+	newGTRect(&rect);
+	rect.width = 3;
+	rect.height = 4;
+	rect.destroyed = NULL;
+	newGTSquare(&square);
+	square.gtRect.width = 5;
+	square.gtRect.height = 5;
+	square.gtRect.destroyed = &rect.height;
+	newITClassA(&interfaces);
+	newITCompactClassA(&compact);
+
+	fd = mkstemp(path);
+	if( fd < 0 ) {
+		ABORT_TEST("Failed to create a snapshot file");
+	}
+	close(fd);
+}
+TEST_TEARDOWN( )
+{
+	unlink(path);
+	memcpy(path + sizeof(path) - 7, "XXXXXX", 6);
+	square.gtRect.destroyed = NULL;
+	cdestroy(&rect);
+	cdestroy(&square);
+	cdestroy(&interfaces);
+	cdestroy(&compact);
+}
+
+
+TEST(eager)
+{
+	struct csnap_t snap;
+	struct GTRect* loaded_rect;
+	struct GTSquare* loaded_square;
+	struct ITClassA* loaded_interfaces;
+	struct ITCompactClassA* loaded_compact;
+
+	ASSERT(write_snapshot( ), "Failed to write snapshot");
+	if( !csnap_open(&snap, path, CSNAP_EAGER) ) {
+		ABORT_TEST("Failed to open snapshot");
+	}
+	ASSERT(csnap_count(&snap) == 4, "Snapshot has %zu objects", csnap_count(&snap));
+	loaded_rect = csnap_object(&snap, 0);
+	loaded_square = csnap_object(&snap, 1);
+	loaded_interfaces = csnap_object(&snap, 2);
+	loaded_compact = csnap_object(&snap, 3);
+	ASSERT(csnap_object(&snap, 4) == NULL, "Found an object past the end");
+
+	/* Fields, methods, and compact interfaces. */
+	ASSERT(loaded_rect != &rect && loaded_rect->width == 3, "Rect wasn't loaded");
+	ASSERT(GTRect_perimeter(loaded_rect) == 14, "Rect has perimeter %d", GTRect_perimeter(loaded_rect));
+	ASSERT(GTShape_area(&loaded_square->gtRect.gtShape) == 1025, "Square has area %d", GTShape_area(&loaded_square->gtRect.gtShape));
+	ASSERT(ccast(&loaded_square->gtRect.gtShape) == loaded_square, "Square's interface doesn't cast to it");
+	ASSERT(cinstanceof(loaded_square, &GTRect_Info), "Square isn't a rect");
+
+	/* Pointers between objects. */
+	ASSERT(loaded_square->gtRect.destroyed == &loaded_rect->height, "Pointer wasn't relocated");
+
+	/* Regular and nested interfaces. */
+	ASSERT(ITInterface2_Method0(&loaded_interfaces->itInterface2) == IT_CLASSA_I2_METHOD0, "Failed to run I2 M0");
+	ASSERT(ITInterface0_Method0(&loaded_interfaces->itInterface1.itInterface0) == IT_CLASSA_I0_METHOD0, "Failed to run I0 M0");
+	ASSERT(ccast(&loaded_interfaces->itInterface1.itInterface0) == loaded_interfaces, "Interface doesn't cast to its object");
+	ASSERT(ITCompactInterface0_Method0(&loaded_compact->itCompactInterface1.itCompactInterface0) == IT_COMPACTA_CI0_METHOD0, "Failed to run CI0 M0");
+	ASSERT(ccast(&loaded_compact->itCompactInterface1) == loaded_compact, "Compact interface doesn't cast to its object");
+
+	/* No free method to call on memory the snapshot owns. */
+	ASSERT(((struct cobject_t*) loaded_rect)->cfree == NULL, "Loaded object has a free method");
+	csnap_close(&snap);
+}
+
+TEST(lazy)
+{
+	struct csnap_t snap;
+	struct GTSquare* loaded_square;
+	int* height;
+
+	ASSERT(write_snapshot( ), "Failed to write snapshot");
+	if( !csnap_open(&snap, path, CSNAP_LAZY) ) {
+		ABORT_TEST("Failed to open snapshot");
+	}
+
+	/* Only what's asked for is fixed up. */
+	loaded_square = csnap_object(&snap, 1);
+	ASSERT(GTRect_perimeter(&loaded_square->gtRect) == 1020, "Square has perimeter %d", GTRect_perimeter(&loaded_square->gtRect));
+	ASSERT(((struct cclass_t*) csnap_object(&snap, 1))->cvtable != NULL, "Square wasn't fixed up");
+	ASSERT(snap.cstates[0] == 0, "Rect was fixed up before it was needed");
+
+	/* Following a pointer. */
+	height = csnap_resolve(&snap, loaded_square->gtRect.destroyed);
+	ASSERT(height != NULL && *height == 4, "Pointer wasn't resolved");
+	ASSERT(GTRect_perimeter((struct GTRect*) ((char*) height - offsetof(struct GTRect, height))) == 14, "Resolved rect wasn't fixed up");
+	ASSERT(csnap_resolve(&snap, &rect) == NULL, "Resolved a pointer outside the snapshot");
+	csnap_close(&snap);
+}
+
+TEST(self_pointer)
+{
+	struct csnap_writer_t writer;
+	struct csnap_t snap;
+	struct GTRect* loaded;
+	uintptr_t vtable;
+	int ok;
+
+	/* Fields holding a vtable and the object's own address look like a
+	 * header, they must be written as they are, or as a pointer when named.
+	 */
+	vtable = (uintptr_t) GTRect_VTable_Key( );
+	memcpy(&rect.width, &vtable, sizeof(vtable));
+	rect.destroyed = (int*) &rect;
+	csnap_writer_init(&writer);
+	ok = csnap_add(&writer, &rect) &&
+	     csnap_pointer(&writer, (void**) &rect.destroyed) &&
+	     csnap_write(&writer, path);
+	csnap_writer_destroy(&writer);
+	rect.destroyed = NULL;
+	ASSERT(ok, "Failed to write an object pointing at itself");
+	if( !csnap_open(&snap, path, CSNAP_EAGER) ) {
+		ABORT_TEST("Failed to open snapshot");
+	}
+	loaded = csnap_object(&snap, 0);
+	ASSERT(loaded != NULL && memcmp(&loaded->width, &vtable, sizeof(vtable)) == 0, "Field holding a vtable was rewritten");
+	ASSERT(loaded->destroyed == (int*) loaded, "Pointer at the object wasn't relocated");
+	ASSERT(ccast(&loaded->gtShape) == loaded, "Loaded rect's interface doesn't cast to it");
+	csnap_close(&snap);
+
+	/* Any width, the field before the pointer. */
+	rect.width = 4;
+	rect.height = 4;
+	rect.destroyed = (int*) &rect;
+	csnap_writer_init(&writer);
+	ok = csnap_add(&writer, &rect) &&
+	     csnap_pointer(&writer, (void**) &rect.destroyed) &&
+	     csnap_write(&writer, path);
+	csnap_writer_destroy(&writer);
+	rect.destroyed = NULL;
+	ASSERT(ok, "Failed to write a rect of width 4 pointing at itself");
+	if( !csnap_open(&snap, path, CSNAP_EAGER) ) {
+		ABORT_TEST("Failed to open snapshot");
+	}
+	loaded = csnap_object(&snap, 0);
+	ASSERT(loaded != NULL && loaded->width == 4 && loaded->destroyed == (int*) loaded, "Rect pointing at itself wasn't loaded");
+	ASSERT(GTRect_perimeter(loaded) == 16, "Loaded rect has perimeter %d", GTRect_perimeter(loaded));
+	csnap_close(&snap);
+}
+
+TEST(unregistered)
+{
+	struct csnap_writer_t writer;
+	struct csnap_t snap;
+	struct VTClassA unknown;
+
+	/* Classes must be registered to be written. */
+	newVTClassA(&unknown);
+	csnap_writer_init(&writer);
+	csnap_add(&writer, &unknown);
+	ASSERT(!csnap_write(&writer, path), "Wrote an unregistered class");
+	csnap_writer_destroy(&writer);
+	cdestroy(&unknown);
+
+	/* And pointers must stay in the snapshot. */
+	csnap_writer_init(&writer);
+	csnap_add(&writer, &square);
+	csnap_pointer(&writer, (void**) &square.gtRect.destroyed);
+	ASSERT(!csnap_write(&writer, path), "Wrote a pointer outside the snapshot");
+	csnap_writer_destroy(&writer);
+
+	/* Files which aren't snapshots aren't loaded. */
+	ASSERT(!csnap_open(&snap, path, CSNAP_EAGER), "Opened a file which isn't a snapshot");
+
+	/* IDs are only taken once. */
+	ASSERT(!cregistry_register(1, GTSquare_VTable_Key( ), sizeof(struct GTSquare_VTable)), "Registered a taken ID");
+}
+
+TEST_SUITE(snap_suite)
+{
+	ADD_TEST(eager);
+	ADD_TEST(lazy);
+	ADD_TEST(self_pointer);
+	ADD_TEST(unregistered);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify the thread caching allocator. Freed
+ * memory must be reused by the thread which freed it, objects given to
+ * cmalloc( ) with ctcache_free( ) must be freed by cdestroy( ), and memory
+ * freed by other threads must make its way back through the depot.
+ */
+
+#include <test_classes/virtual_test_classes.h>
+#include <ctcache.h>
+#include <unit.h>
+#include <pthread.h>
+#include <stdint.h>
+
+/* A size class no other test uses, so the depot only has this suite's. */
+#define TCACHE_SIZE		(CTCACHE_MAX_SIZE - 8)
+#define TCACHE_OBJECTS		(4 * CTCACHE_BATCH)
+#define TCACHE_THREADS		4
+
+static void* blocks[TCACHE_OBJECTS];
+
+TEST_SETUP( )
+{
+	ctcache_flush( );
+}
+TEST_TEARDOWN( )
+{
+	ctcache_flush( );
+}
+
+static void* tcache_free_thread( void* arg )
+{
+	size_t first = (size_t) (uintptr_t) arg;
+	size_t i;
+
+	for( i = first; i < TCACHE_OBJECTS; i += TCACHE_THREADS ) {
+		ctcache_free(blocks[i]);
+	}
+	return NULL;
+}
+
+
+TEST(reuse)
+{
+	void* first;
+	void* second;
+	void* large;
+
+	/* Freed memory is the next allocated of its size class. */
+	first = ctcache_alloc(24);
+	ASSERT(first != NULL, "Failed to allocate");
+	ASSERT(((uintptr_t) first % CTCACHE_QUANTUM) == 0, "Memory isn't aligned");
+	ctcache_free(first);
+	ASSERT(ctcache_cached( ) == 1, "Thread caches %zu blocks", ctcache_cached( ));
+	second = ctcache_alloc(32);
+	ASSERT(second == first, "Freed memory wasn't reused");
+	ctcache_free(second);
+
+	/* Large requests aren't cached. */
+	large = ctcache_alloc(CTCACHE_MAX_SIZE + 1);
+	ASSERT(large != NULL, "Failed to allocate a large block");
+	ctcache_free(large);
+	ASSERT(ctcache_cached( ) == 1, "Thread caches %zu blocks", ctcache_cached( ));
+	ctcache_free(NULL);
+}
+
+TEST(objects)
+{
+	struct VTClassA* object;
+
+	object = ctcache_alloc(sizeof(*object));
+	if( object == NULL ) {
+		ABORT_TEST("Failed to allocate object");
+	}
+	newVTClassA(object);
+	cmalloc(object, ctcache_free);
+	ASSERT(VTClassA_Method0(object) == VT_CLASSA_METHOD0, "Method 0 returned %d", VTClassA_Method0(object));
+
+	/* Destroying it frees it to the cache. */
+	cdestroy(object);
+	ASSERT(ctcache_cached( ) == 1, "Thread caches %zu blocks", ctcache_cached( ));
+	ASSERT(ctcache_alloc(sizeof(*object)) == (void*) object, "Object's memory wasn't reused");
+	ctcache_free(object);
+}
+
+TEST(batches)
+{
+	size_t i;
+
+	/* A list past two batches gives one to the depot. */
+	for( i = 0; i < TCACHE_OBJECTS; ++i ) {
+		blocks[i] = ctcache_alloc(TCACHE_SIZE);
+	}
+	for( i = 0; i < TCACHE_OBJECTS; ++i ) {
+		ctcache_free(blocks[i]);
+		ASSERT(ctcache_cached( ) < 2 * CTCACHE_BATCH, "Thread caches %zu blocks", ctcache_cached( ));
+	}
+}
+
+TEST(other_threads)
+{
+	pthread_t threads[TCACHE_THREADS];
+	size_t i, j, reused;
+	void* block;
+
+	for( i = 0; i < TCACHE_OBJECTS; ++i ) {
+		blocks[i] = ctcache_alloc(TCACHE_SIZE);
+		if( blocks[i] == NULL ) {
+			ABORT_TEST("Failed to allocate");
+		}
+	}
+
+	/* Freed by other threads, which give their lists to the depot when
+	 * they exit. */
+	for( i = 0; i < TCACHE_THREADS; ++i ) {
+		pthread_create(&threads[i], NULL, tcache_free_thread, (void*) (uintptr_t) i);
+	}
+	for( i = 0; i < TCACHE_THREADS; ++i ) {
+		pthread_join(threads[i], NULL);
+	}
+	ASSERT(ctcache_cached( ) == 0, "Thread caches %zu blocks", ctcache_cached( ));
+
+	/* Only full batches make it to the depot, so some are reused. */
+	reused = 0;
+	for( i = 0; i < TCACHE_OBJECTS; ++i ) {
+		block = ctcache_alloc(TCACHE_SIZE);
+		for( j = 0; j < TCACHE_OBJECTS; ++j ) {
+			if( block == blocks[j] ) {
+				++reused;
+				break;
+			}
+		}
+		blocks[i] = block;
+	}
+	ASSERT(reused > 0, "No memory came back from other threads");
+	for( i = 0; i < TCACHE_OBJECTS; ++i ) {
+		ctcache_free(blocks[i]);
+	}
+}
+
+TEST_SUITE(tcache_suite)
+{
+	ADD_TEST(reuse);
+	ADD_TEST(objects);
+	ADD_TEST(batches);
+	ADD_TEST(other_threads);
+}
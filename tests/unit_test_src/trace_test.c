@@ -0,0 +1,216 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify tracing. Events recorded on any thread
+ * must be exported, in the order each thread recorded them, as Chrome trace
+ * event JSON, and each thread must keep only its last CTRACE_EVENTS events.
+ * Apart from the object operations a CTRACE build records, every event is
+ * made here with ctrace_record( ).
+ */
+
+#include <test_classes/destructor_test_classes.h>
+#include <test_classes/generated_test_classes.h>
+#include <ctrace.h>
+#include <unit.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char* text;
+
+/* Export the trace into text.
+ */
+static size_t trace_export( void )
+{
+	size_t size, events;
+	FILE* out;
+
+	free(text);
+	text = NULL;
+	out = open_memstream(&text, &size);
+	if( out == NULL ) {
+		return 0;
+	}
+	events = ctrace_export(out);
+	fclose(out);
+	return events;
+}
+
+static size_t trace_count( const char* needle )
+{
+	const char* at;
+	size_t count;
+
+	count = 0;
+	for( at = strstr(text, needle); at != NULL; at = strstr(at + 1, needle) ) {
+		++count;
+	}
+	return count;
+}
+
+TEST_SETUP( )
+{
+	ctrace_reset( );
+	ctrace_start( );
+}
+TEST_TEARDOWN( )
+{
+	ctrace_stop( );
+	ctrace_reset( );
+	free(text);
+	text = NULL;
+}
+
+
+TEST(events)
+{
+	const char* begin;
+	const char* end;
+	size_t events;
+
+	ctrace_record(CTRACE_PHASE_BEGIN, "test", "span");
+	ctrace_record(CTRACE_PHASE_INSTANT, "test", "mark");
+	ctrace_record(CTRACE_PHASE_END, "test", "span");
+	ctrace_stop( );
+	ctrace_record(CTRACE_PHASE_INSTANT, "test", "stopped");
+
+	events = trace_export( );
+	ASSERT(events == 3, "Exported %zu events", events);
+	ASSERT(strstr(text, "\"traceEvents\": [") != NULL, "Not a trace: %.40s", text);
+	ASSERT(strstr(text, "\"name\": \"stopped\"") == NULL, "Recorded while stopped");
+	ASSERT(strstr(text, "\"name\": \"mark\", \"cat\": \"test\", \"ph\": \"i\", \"s\": \"t\"") != NULL, "No instant event");
+
+	begin = strstr(text, "\"ph\": \"B\"");
+	end = strstr(text, "\"ph\": \"E\"");
+	ASSERT(begin != NULL && end != NULL && begin < end, "Begin and end out of order");
+}
+
+TEST(ring)
+{
+	size_t events;
+	int i;
+
+	/* Only the newest events are kept. */
+	ctrace_record(CTRACE_PHASE_INSTANT, "test", "oldest");
+	for( i = 0; i < CTRACE_EVENTS; ++i ) {
+		ctrace_record(CTRACE_PHASE_INSTANT, "test", "newer");
+	}
+	events = trace_export( );
+	ASSERT(events == CTRACE_EVENTS, "Exported %zu events", events);
+	ASSERT(trace_count("\"oldest\"") == 0, "Oldest event not overwritten");
+	ASSERT(trace_count("\"newer\"") == CTRACE_EVENTS, "Kept %zu events", trace_count("\"newer\""));
+}
+
+#define TRACE_THREADS 3
+#define TRACE_PER_THREAD 100
+
+static void* trace_thread( void* arg )
+{
+	int i;
+
+	(void) arg;
+	for( i = 0; i < TRACE_PER_THREAD; ++i ) {
+		ctrace_record(CTRACE_PHASE_BEGIN, "test", "thread");
+		ctrace_record(CTRACE_PHASE_END, "test", "thread");
+	}
+	return NULL;
+}
+
+TEST(threads)
+{
+	pthread_t threads[TRACE_THREADS];
+	int created, i;
+
+	for( created = 0; created < TRACE_THREADS; ++created ) {
+		if( pthread_create(&threads[created], NULL, trace_thread, NULL) != 0 ) {
+			break;
+		}
+	}
+	for( i = 0; i < created; ++i ) {
+		pthread_join(threads[i], NULL);
+	}
+
+	/* Rings outlive their threads. */
+	trace_export( );
+	ASSERT(trace_count("\"thread\"") == (size_t) created * TRACE_PER_THREAD * 2, "Exported %zu events", trace_count("\"thread\""));
+}
+
+#ifdef CTRACE
+TEST(objects)
+{
+	struct GTSquare square;
+	struct DTClassC object;
+	int temp;
+
+	/* The constructor chain, then the destructor span. */
+	newDTClassC(&object, &temp);
+	cdestroy(&object);
+	trace_export( );
+	ASSERT(trace_count("\"cobject_init\"") == 1, "No construction");
+	ASSERT(trace_count("\"DTClassA\"") == 1, "Missing DTClassA constructor step");
+	ASSERT(trace_count("\"DTClassC\"") == 3, "Missing constructor or destructor span");
+	ASSERT(trace_count("\"cobject_destructor\"") == 1, "Missing destructor step");
+
+	/* Generated constructors are spans, around their super's. */
+	ctrace_reset( );
+	newGTSquare(&square);
+	square.gtRect.destroyed = NULL;
+	trace_export( );
+	ASSERT(strstr(text, "\"GTSquare\", \"cat\": \"construct\", \"ph\": \"B\"") != NULL, "No constructor entry");
+	ASSERT(strstr(text, "\"GTSquare\", \"cat\": \"construct\", \"ph\": \"E\"") != NULL, "No constructor exit");
+	ASSERT(trace_count("\"GTRect\"") == 3, "Missing super constructor span");
+	cdestroy(&square);
+}
+
+TEST(batch)
+{
+	struct DTClassC objects[3];
+	void* batch[3];
+	const char* begin;
+	const char* end;
+	int temp, i;
+
+	/* One destructor span per object, inside the batch's span. */
+	for( i = 0; i < 3; ++i ) {
+		newDTClassC(&objects[i], &temp);
+		batch[i] = &objects[i];
+	}
+	ctrace_reset( );
+	cdestroy_batch(batch, 3);
+	trace_export( );
+	ASSERT(trace_count("\"DTClassC\", \"cat\": \"destroy\", \"ph\": \"B\"") == 3, "Missing destructor entry");
+	ASSERT(trace_count("\"DTClassC\", \"cat\": \"destroy\", \"ph\": \"E\"") == 3, "Missing destructor exit");
+	ASSERT(trace_count("\"cobject_destructor\"") == 3, "Missing destructor step");
+
+	begin = strstr(text, "\"cdestroy_batch\", \"cat\": \"destroy\", \"ph\": \"B\"");
+	end = strstr(text, "\"cdestroy_batch\", \"cat\": \"destroy\", \"ph\": \"E\"");
+	ASSERT(begin != NULL && end != NULL, "No batch span");
+	ASSERT(begin < strstr(text, "\"DTClassC\"") && strstr(end, "\"DTClassC\"") == NULL, "Destructors outside the batch span");
+}
+#endif
+
+TEST_SUITE(trace_suite)
+{
+	ADD_TEST(events);
+	ADD_TEST(ring);
+	ADD_TEST(threads);
+#ifdef CTRACE
+	ADD_TEST(objects);
+	ADD_TEST(batch);
+#endif
+}
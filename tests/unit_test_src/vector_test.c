@@ -0,0 +1,152 @@
+/*
+ * Copyright 2015 Brendan Bruner
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * bbruner@ualberta.ca
+ *
+ * This test suite is used to verify object vectors. Objects constructed in
+ * a vector must be full objects, working with wrappers, casts and
+ * interfaces, methods looked up once must be those of the objects' class,
+ * and every object must be destroyed with the vector. A vector only holds
+ * objects of one class.
+ */
+
+#include <test_classes/generated_test_classes.h>
+#include <cvector.h>
+#include <unit.h>
+
+#define VECTOR_OBJECTS 100
+
+static struct cvector_t vector;
+static int destroyed;
+
+/* A GTRect of index by index + 1. */
+static void construct_rect( void* object, size_t index, void* arg )
+{
+	struct GTRect* rect = object;
+
+	(void) arg;
+	newGTRect(rect);
+	rect->width = (int) index;
+	rect->height = (int) index + 1;
+	rect->destroyed = &destroyed;
+}
+
+static void construct_square( void* object, size_t index, void* arg )
+{
+	struct GTSquare* square = object;
+
+	(void) arg;
+	newGTSquare(square);
+	square->gtRect.width = (int) index;
+	square->gtRect.height = (int) index;
+	square->gtRect.destroyed = &destroyed;
+}
+
+TEST_SETUP( )
+{
+	destroyed = 0;
+	if( !cvector_init(&vector, sizeof(struct GTSquare), VECTOR_OBJECTS) ) {
+		ABORT_TEST("Failed to allocate vector");
+	}
+}
+TEST_TEARDOWN( )
+{
+	cvector_destroy(&vector);
+}
+
+
+TEST(emplace)
+{
+	struct GTRect* rect;
+	size_t added;
+
+	/* Only as many as fit. */
+	added = cvector_emplace(&vector, VECTOR_OBJECTS + 10, construct_rect, NULL);
+	ASSERT(added == VECTOR_OBJECTS, "Added %zu objects", added);
+	ASSERT(cvector_count(&vector) == VECTOR_OBJECTS, "Vector has %zu objects", cvector_count(&vector));
+
+	/* Objects are full objects. */
+	rect = cvector_at(&vector, 7);
+	ASSERT(rect->width == 7, "Object 7 has width %d", rect->width);
+	ASSERT(GTRect_perimeter(rect) == 2 * (7 + 8), "Object 7 has perimeter %d", GTRect_perimeter(rect));
+	ASSERT(GTShape_area(&rect->gtShape) == 7 * 8, "Object 7 has area %d", GTShape_area(&rect->gtShape));
+	ASSERT(ccast(&rect->gtShape) == (void*) rect, "Interface doesn't cast to its object");
+}
+
+TEST(one_class)
+{
+	size_t added;
+
+	/* A square in a vector of rects is destroyed, and stops the emplace. */
+	cvector_emplace(&vector, 2, construct_rect, NULL);
+	added = cvector_emplace(&vector, 2, construct_square, NULL);
+	ASSERT(added == 0, "Added %zu squares", added);
+	ASSERT(cvector_count(&vector) == 2, "Vector has %zu objects", cvector_count(&vector));
+	ASSERT(destroyed == 11, "Square destructors added %d", destroyed);
+
+	/* Once cleared, any class. */
+	cvector_clear(&vector);
+	added = cvector_emplace(&vector, 2, construct_square, NULL);
+	ASSERT(added == 2, "Added %zu squares after clearing", added);
+}
+
+TEST(methods)
+{
+	int (*perimeter)( struct GTRect* );
+	int (*area)( struct GTShape* );
+	struct GTRect* rect;
+	int i, expected, sum;
+
+	cvector_emplace(&vector, VECTOR_OBJECTS, construct_square, NULL);
+
+	/* Looked up once, GTSquare's overrides. */
+	perimeter = CVECTOR_METHOD(&vector, struct GTRect_VTable, perimeter);
+	area = CVECTOR_METHOD(&vector, struct GTRect_VTable, GTShape_VTable.area);
+	sum = 0;
+	CVECTOR_FOR_EACH(&vector, struct GTRect, rect) {
+		sum += perimeter(rect) + area(&rect->gtShape);
+	}
+	for( i = 0, expected = 0; i < VECTOR_OBJECTS; ++i ) {
+		expected += 1000 + 4 * i + 1000 + i * i;
+	}
+	ASSERT(sum == expected, "Sum of %d, not %d", sum, expected);
+
+	/* Applied to every object. */
+	CVECTOR_APPLY(&vector, struct GTRect_VTable, GTShape_VTable.scale, struct GTRect, self, (&self->gtShape, 2));
+	rect = cvector_at(&vector, VECTOR_OBJECTS - 1);
+	ASSERT(rect->width == 2 * (VECTOR_OBJECTS - 1), "Last object has width %d", rect->width);
+}
+
+TEST(destroy)
+{
+	struct cvector_t other;
+
+	/* Every object is destroyed, with its whole destructor chain. */
+	if( !cvector_init(&other, sizeof(struct GTSquare), VECTOR_OBJECTS) ) {
+		ABORT_TEST("Failed to allocate vector");
+	}
+	cvector_emplace(&other, VECTOR_OBJECTS, construct_square, NULL);
+	cvector_destroy(&other);
+	ASSERT(destroyed == 11 * VECTOR_OBJECTS, "Destructors added %d", destroyed);
+	ASSERT(cvector_count(&other) == 0, "Destroyed vector has %zu objects", cvector_count(&other));
+}
+
+TEST_SUITE(vector_suite)
+{
+	ADD_TEST(emplace);
+	ADD_TEST(one_class);
+	ADD_TEST(methods);
+	ADD_TEST(destroy);
+}